@@ -69,8 +69,8 @@ vdi_stream_client__audio_init(struct parsec_context_s *parsec_context, bool enab
     want.channels = PARSEC_AUDIO_CHANNELS;
 
     /* The number of audio packets to buffer before playback and overflow. */
-    parsec_context->min_buffer = 1;
-    parsec_context->max_buffer = 6;
+    parsec_context->min_buffer = PARSEC_AUDIO_MIN_BUFFER;
+    parsec_context->max_buffer = PARSEC_AUDIO_MAX_BUFFER;
     parsec_context->audio =
         SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &want, NULL, NULL);
     if (parsec_context->audio == NULL) {
@@ -112,8 +112,17 @@ vdi_stream_client__audio(const Sint16 *pcm, Uint32 frames, void *opaque)
     queued_frames = (Uint32)size / (PARSEC_AUDIO_CHANNELS * sizeof(Sint16));
     queued_packets = queued_frames / PARSEC_AUDIO_FRAMES_PER_PACKET;
 
+    /* Underruns and overflows feed the learned per-peer buffer thresholds. */
+    if (vdi_stream_client__context_playing(parsec_context) && size == 0) {
+        atomic_fetch_add_explicit(
+            &parsec_context->audio_underruns, (uint_fast64_t)1, memory_order_relaxed
+        );
+    }
     if (vdi_stream_client__context_playing(parsec_context) &&
         queued_packets > parsec_context->max_buffer) {
+        atomic_fetch_add_explicit(
+            &parsec_context->audio_overflows, (uint_fast64_t)1, memory_order_relaxed
+        );
         SDL_ClearAudioStream(parsec_context->audio);
         SDL_PauseAudioStreamDevice(parsec_context->audio);
         vdi_stream_client__context_set_playing(parsec_context, false);
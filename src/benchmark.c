@@ -0,0 +1,584 @@
+/*
+ *  benchmark.c -- headless render path benchmark
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "benchmark.h"
+#include "client.h"
+#include "copy.h"
+#include "ffmpeg.h"
+#include "parsec.h"
+#include "placebo.h"
+#include "pool.h"
+#include "quality.h"
+
+/* ffmpeg includes. */
+#include <libavutil/common.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/pixfmt.h>
+
+/* define benchmark defaults. */
+#define VDI_STREAM_CLIENT_BENCHMARK_WIDTH 1920
+#define VDI_STREAM_CLIENT_BENCHMARK_HEIGHT 1080
+#define VDI_STREAM_CLIENT_BENCHMARK_PATTERNS 8
+
+/* Synthetic source formats. NV12 and P010 match VA-API output, YUV420P the
+ * software decoders and YUV444P the 4:4:4 decoder modes. */
+static const struct
+{
+    enum AVPixelFormat format;
+    const char *name;
+} vdi_stream_client__benchmark_formats[] = {
+    { AV_PIX_FMT_NV12, "nv12" },
+    { AV_PIX_FMT_P010, "p010" },
+    { AV_PIX_FMT_YUV420P, "yuv420p" },
+    { AV_PIX_FMT_YUV444P, "yuv444p" },
+};
+
+/* One timed pipeline stage of a benchmark run. */
+struct vdi_stream_client__benchmark_stage_s
+{
+    const char *name;
+    Uint64 ns;
+};
+
+/* Fill an RGBA reference image with a smooth gradient covered by rows of thin
+ * black and red glyph strokes, so chroma subsampling and filtering losses show
+ * up on text edges the same way they do on a remote desktop. The glyphs and
+ * the background tint change with the index. */
+static void
+vdi_stream_client__benchmark_reference(Uint8 *pixels, Sint32 width, Sint32 height, Uint32 index)
+{
+    for (Sint32 y = 0; y < height; y++) {
+        for (Sint32 x = 0; x < width; x++) {
+            Uint8 *pixel = pixels + ((size_t)y * width + x) * 4;
+            Uint32 glyph = (((Uint32)(x / 8) * 73856093u) ^ ((Uint32)(y / 16) * 19349663u) ^
+                            (index * 83492791u)) >> 8;
+            Sint32 column = x % 8;
+            Sint32 row = y % 16;
+            bool stroke = ((glyph & 1) != 0 && column == 1) || ((glyph & 2) != 0 && row == 3) ||
+                          ((glyph & 4) != 0 && column == 5) || ((glyph & 8) != 0 && row == 12) ||
+                          ((glyph & 16) != 0 && column == row / 2);
+
+            if (stroke && (y / 16) % 4 != 3) {
+                pixel[0] = (glyph & 32) != 0 ? 0 : 200;
+                pixel[1] = (glyph & 32) != 0 ? 0 : 20;
+                pixel[2] = (glyph & 32) != 0 ? 0 : 20;
+            } else {
+                pixel[0] = (Uint8)((Sint64)x * 255 / SDL_max(width - 1, 1));
+                pixel[1] = (Uint8)((Sint64)y * 255 / SDL_max(height - 1, 1));
+                pixel[2] = (Uint8)(96 + index * 16);
+            }
+            pixel[3] = 255;
+        }
+    }
+}
+
+/* Convert one RGBA pixel into BT.601 limited range Y, Cb and Cr on an 8-bit
+ * scale, which is the colorspace SDL assumes for YUV textures. */
+static void
+vdi_stream_client__benchmark_ycbcr(const Uint8 *pixel, float *ycbcr)
+{
+    float r = pixel[0] / 255.0f;
+    float g = pixel[1] / 255.0f;
+    float b = pixel[2] / 255.0f;
+    float luma = 0.299f * r + 0.587f * g + 0.114f * b;
+
+    ycbcr[0] = 16.0f + 219.0f * luma;
+    ycbcr[1] = 128.0f + 224.0f * (b - luma) / 1.772f;
+    ycbcr[2] = 128.0f + 224.0f * (r - luma) / 1.402f;
+}
+
+/* Store one 8-bit scale sample into a component of a frame, expanding it to
+ * the component depth and shift of high bit depth formats. */
+static void
+vdi_stream_client__benchmark_sample(
+    AVFrame *frame, const AVPixFmtDescriptor *descriptor, Sint32 component, Sint32 x, Sint32 y,
+    float value
+)
+{
+    const AVComponentDescriptor *comp = &descriptor->comp[component];
+    Uint8 *sample = frame->data[comp->plane] + (ptrdiff_t)y * frame->linesize[comp->plane] +
+                    (ptrdiff_t)x * comp->step + comp->offset;
+    Uint16 scaled = (Uint16)SDL_lroundf(value * (float)(1 << (comp->depth - 8)));
+
+    if (comp->depth > 8) {
+        scaled = (Uint16)(scaled << comp->shift);
+        SDL_memcpy(sample, &scaled, sizeof(scaled));
+    } else {
+        *sample = (Uint8)scaled;
+    }
+}
+
+/* Allocate a synthetic frame converted in software from an RGBA reference.
+ * Subsampled chroma is the average of the covered pixels. Frames are tagged
+ * with sRGB transfer so libplacebo renders them back without tone changes. */
+static AVFrame *
+vdi_stream_client__benchmark_frame(
+    enum AVPixelFormat format, const Uint8 *reference, Sint32 width, Sint32 height
+)
+{
+    const AVPixFmtDescriptor *descriptor = av_pix_fmt_desc_get(format);
+    AVFrame *frame = av_frame_alloc();
+    Sint32 block_w, block_h;
+    float ycbcr[3];
+
+    if (frame == NULL || descriptor == NULL) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    frame->color_range = AVCOL_RANGE_MPEG;
+    frame->colorspace = AVCOL_SPC_BT470BG;
+    frame->color_primaries = AVCOL_PRI_BT709;
+    frame->color_trc = AVCOL_TRC_IEC61966_2_1;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    for (Sint32 y = 0; y < height; y++) {
+        for (Sint32 x = 0; x < width; x++) {
+            vdi_stream_client__benchmark_ycbcr(reference + ((size_t)y * width + x) * 4, ycbcr);
+            vdi_stream_client__benchmark_sample(frame, descriptor, 0, x, y, ycbcr[0]);
+        }
+    }
+
+    block_w = 1 << descriptor->log2_chroma_w;
+    block_h = 1 << descriptor->log2_chroma_h;
+    for (Sint32 y = 0; y < AV_CEIL_RSHIFT(height, descriptor->log2_chroma_h); y++) {
+        for (Sint32 x = 0; x < AV_CEIL_RSHIFT(width, descriptor->log2_chroma_w); x++) {
+            float cb = 0.0f, cr = 0.0f;
+            Sint32 count = 0;
+
+            for (Sint32 j = y * block_h; j < SDL_min((y + 1) * block_h, height); j++) {
+                for (Sint32 i = x * block_w; i < SDL_min((x + 1) * block_w, width); i++) {
+                    vdi_stream_client__benchmark_ycbcr(
+                        reference + ((size_t)j * width + i) * 4, ycbcr
+                    );
+                    cb += ycbcr[1];
+                    cr += ycbcr[2];
+                    count++;
+                }
+            }
+            vdi_stream_client__benchmark_sample(frame, descriptor, 1, x, y, cb / (float)count);
+            vdi_stream_client__benchmark_sample(frame, descriptor, 2, x, y, cr / (float)count);
+        }
+    }
+    return frame;
+}
+
+/* Print the stage timings of one renderer and source format combination and,
+ * when the rendered image could be read back, its quality scores. */
+static void
+vdi_stream_client__benchmark_report(
+    const char *renderer, const char *format, Uint32 frames, Uint32 failures,
+    const struct vdi_stream_client__benchmark_stage_s *stages, size_t stage_count,
+    const struct vdi_stream_client__quality_s *quality
+)
+{
+    Uint64 total_ns = 0;
+    double fps;
+
+    for (size_t i = 0; i < stage_count; i++) {
+        total_ns += stages[i].ns;
+    }
+    fps = total_ns != 0 ? (double)frames * 1000000000.0 / (double)total_ns : 0.0;
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Benchmark: renderer=%s, format=%s\n", renderer, format
+    );
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "  frames: rendered=%u, failed=%u, fps=%.1f, target=%dfps, sustained=%s\n",
+        frames - failures, failures, fps, PARSEC_TARGET_FPS,
+        fps >= PARSEC_TARGET_FPS ? "yes" : "no"
+    );
+    for (size_t i = 0; i < stage_count; i++) {
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION, "  %s: total=%.3fms, avg=%.3fms\n", stages[i].name,
+            (double)stages[i].ns / 1000000.0,
+            frames != 0 ? (double)stages[i].ns / 1000000.0 / (double)frames : 0.0
+        );
+    }
+    if (quality != NULL) {
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "  quality: psnr=%.2fdB, ssim=%.4f, edge_psnr=%.2fdB, edge_retention=%.1f%%\n",
+            quality->psnr, quality->ssim, quality->edge_psnr, quality->edge_retention
+        );
+    }
+}
+
+/* Render every frame through the offscreen libplacebo path. The first frame is
+ * rendered once untimed so shader compilation does not skew the averages, and
+ * read back afterwards to score it against its reference. */
+static void
+vdi_stream_client__benchmark_placebo(
+    struct parsec_context_s *parsec_context, const char *format, AVFrame **patterns, Uint32 frames,
+    const Uint8 *reference, Uint8 *image
+)
+{
+    struct vdi_stream_client__placebo_stages_s placebo_stages = { 0 };
+    struct vdi_stream_client__placebo_stages_s warmup = { 0 };
+    struct vdi_stream_client__quality_s quality;
+    Sint32 width = patterns[0]->width;
+    Sint32 height = patterns[0]->height;
+    bool scored = false;
+    Uint32 failures = 0;
+
+    if (vdi_stream_client__placebo_offscreen_render(parsec_context, patterns[0], &warmup) &&
+        vdi_stream_client__placebo_offscreen_read(parsec_context, image, (size_t)width * 4)) {
+        scored = vdi_stream_client__quality_score(
+            reference, width * 4, image, width * 4, width, height, &quality
+        );
+    } else {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION, "Skip libplacebo quality scoring: %s\n", SDL_GetError()
+        );
+    }
+    for (Uint32 i = 0; i < frames; i++) {
+        if (!vdi_stream_client__placebo_offscreen_render(
+                parsec_context, patterns[i % VDI_STREAM_CLIENT_BENCHMARK_PATTERNS],
+                &placebo_stages
+            )) {
+            failures++;
+        }
+    }
+
+    const struct vdi_stream_client__benchmark_stage_s stages[] = {
+        { "upload", placebo_stages.upload_ns },
+        { "render", placebo_stages.render_ns },
+        { "finish", placebo_stages.finish_ns },
+    };
+    vdi_stream_client__benchmark_report(
+        "placebo", format, frames, failures, stages, SDL_arraysize(stages),
+        scored ? &quality : NULL
+    );
+}
+
+/* Read back the first frame rendered through the SDL texture path and score it
+ * against its reference. */
+static bool
+vdi_stream_client__benchmark_sdl_score(
+    SDL_Renderer *renderer, SDL_Texture *texture, const AVFrame *frame, const Uint8 *reference,
+    struct vdi_stream_client__quality_s *quality
+)
+{
+    SDL_Surface *read = NULL;
+    SDL_Surface *image = NULL;
+    bool scored = false;
+
+    if (!vdi_stream_client__parsec_ffmpeg_avframe_update(texture, frame, NULL) ||
+        !SDL_RenderTexture(renderer, texture, NULL, NULL)) {
+        goto done;
+    }
+    read = SDL_RenderReadPixels(renderer, NULL);
+    if (read != NULL) {
+        image = SDL_ConvertSurface(read, SDL_PIXELFORMAT_RGBA32);
+    }
+    if (image == NULL || image->w != frame->width || image->h != frame->height) {
+        goto done;
+    }
+    scored = vdi_stream_client__quality_score(
+        reference, frame->width * 4, image->pixels, image->pitch, frame->width, frame->height,
+        quality
+    );
+
+done:
+    if (!scored) {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION, "Skip SDL quality scoring: %s\n", SDL_GetError()
+        );
+    }
+    SDL_DestroySurface(image);
+    SDL_DestroySurface(read);
+    return scored;
+}
+
+/* Render every frame through the SDL texture upload path into a software
+ * renderer surface. Formats without an SDL texture equivalent are skipped. */
+static void
+vdi_stream_client__benchmark_sdl(
+    SDL_Renderer *renderer, const char *format, AVFrame **patterns, Uint32 frames,
+    const Uint8 *reference
+)
+{
+    struct vdi_stream_client__benchmark_stage_s stages[] = {
+        { "upload", 0 },
+        { "render", 0 },
+        { "present", 0 },
+    };
+    struct vdi_stream_client__quality_s quality;
+    SDL_PixelFormat pixel_format;
+    SDL_Texture *texture;
+    Uint64 stage_start_ns;
+    Uint32 failures = 0;
+    bool scored;
+
+    if (!vdi_stream_client__parsec_ffmpeg_avframe_texture_format(patterns[0], &pixel_format)) {
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "Benchmark: renderer=sdl, format=%s skipped without SDL texture format\n", format
+        );
+        return;
+    }
+    texture = SDL_CreateTexture(
+        renderer, pixel_format, SDL_TEXTUREACCESS_STREAMING, patterns[0]->width, patterns[0]->height
+    );
+    if (texture == NULL) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Benchmark texture creation failed: %s\n", SDL_GetError()
+        );
+        return;
+    }
+
+    for (Uint32 i = 0; i < frames; i++) {
+        if (!vdi_stream_client__parsec_ffmpeg_avframe_update(
+                texture, patterns[i % VDI_STREAM_CLIENT_BENCHMARK_PATTERNS], &stages[0].ns
+            )) {
+            failures++;
+            continue;
+        }
+        stage_start_ns = SDL_GetTicksNS();
+        SDL_RenderTexture(renderer, texture, NULL, NULL);
+        stages[1].ns += SDL_GetTicksNS() - stage_start_ns;
+        stage_start_ns = SDL_GetTicksNS();
+        SDL_RenderPresent(renderer);
+        stages[2].ns += SDL_GetTicksNS() - stage_start_ns;
+    }
+    scored =
+        vdi_stream_client__benchmark_sdl_score(renderer, texture, patterns[0], reference, &quality);
+    SDL_DestroyTexture(texture);
+
+    vdi_stream_client__benchmark_report(
+        "sdl", format, frames, failures, stages, SDL_arraysize(stages), scored ? &quality : NULL
+    );
+}
+
+/* Pack every plane of a frame into a contiguous 8-bit buffer with the selected
+ * copy kernels, down-converting P010 the way the decoder fallback does and
+ * converting 4:4:4 to XRGB8888 the way the SDL texture path does. */
+static void
+vdi_stream_client__benchmark_pack(const AVFrame *frame, Uint8 *dst)
+{
+    const AVPixFmtDescriptor *descriptor = av_pix_fmt_desc_get(frame->format);
+    Sint32 planes = av_pix_fmt_count_planes(frame->format);
+
+    if (frame->format == AV_PIX_FMT_YUV444P) {
+        const Uint8 *const sources[3] = { frame->data[0], frame->data[1], frame->data[2] };
+
+        vdi_stream_client__copy_yuv444_xrgb(
+            dst, frame->width * 4, sources, frame->linesize, frame->width, frame->height,
+            frame->colorspace == AVCOL_SPC_BT709, frame->color_range == AVCOL_RANGE_JPEG
+        );
+        return;
+    }
+
+    for (Sint32 plane = 0; plane < planes; plane++) {
+        Sint32 bytes = av_image_get_linesize(frame->format, frame->width, plane);
+        Sint32 height =
+            plane == 0 ? frame->height : AV_CEIL_RSHIFT(frame->height, descriptor->log2_chroma_h);
+
+        if (frame->format == AV_PIX_FMT_P010) {
+            vdi_stream_client__copy_p010_nv12(
+                dst, bytes / 2, frame->data[plane], frame->linesize[plane], bytes / 2, height
+            );
+            dst += (size_t)(bytes / 2) * (size_t)height;
+        } else {
+            vdi_stream_client__copy_plane(
+                dst, bytes, frame->data[plane], frame->linesize[plane], bytes, height
+            );
+            dst += (size_t)bytes * (size_t)height;
+        }
+    }
+}
+
+/* Time the plane copy kernels of every instruction set the CPU supports. Each
+ * packed frame is compared with the scalar kernel output, and frames that
+ * differ are reported as failed. Planes of a 1080p frame stay below the size
+ * from which the decoder streams copies, so the threshold is lifted and every
+ * kernel runs on planes of any size. */
+static void
+vdi_stream_client__benchmark_copy(
+    const char *format, AVFrame **patterns, Uint32 frames, Uint8 *expected, Uint8 *packed
+)
+{
+    size_t size = (size_t)patterns[0]->width * (size_t)patterns[0]->height * 4;
+    vdi_copy_kernel_e best = vdi_stream_client__copy_best();
+    size_t stream_bytes = vdi_stream_client__copy_stream_threshold(0);
+
+    for (Sint32 kernel = VDI_COPY_KERNEL_SCALAR; kernel < VDI_COPY_KERNEL_MAX; kernel++) {
+        struct vdi_stream_client__benchmark_stage_s stages[] = {
+            { "copy", 0 },
+        };
+        char renderer[32];
+        Uint64 stage_start_ns;
+        Uint32 failures = 0;
+
+        if (!vdi_stream_client__copy_select((vdi_copy_kernel_e)kernel)) {
+            continue;
+        }
+        for (Uint32 i = 0; i < frames; i++) {
+            const AVFrame *frame = patterns[i % VDI_STREAM_CLIENT_BENCHMARK_PATTERNS];
+
+            SDL_memset(packed, 0, size);
+            stage_start_ns = SDL_GetTicksNS();
+            vdi_stream_client__benchmark_pack(frame, packed);
+            stages[0].ns += SDL_GetTicksNS() - stage_start_ns;
+
+            vdi_stream_client__copy_select(VDI_COPY_KERNEL_SCALAR);
+            SDL_memset(expected, 0, size);
+            vdi_stream_client__benchmark_pack(frame, expected);
+            vdi_stream_client__copy_select((vdi_copy_kernel_e)kernel);
+            if (SDL_memcmp(packed, expected, size) != 0) {
+                failures++;
+            }
+        }
+        SDL_snprintf(
+            renderer, sizeof(renderer), "copy-%s",
+            vdi_stream_client__copy_name((vdi_copy_kernel_e)kernel)
+        );
+        vdi_stream_client__benchmark_report(
+            renderer, format, frames, failures, stages, SDL_arraysize(stages), NULL
+        );
+    }
+    vdi_stream_client__copy_select(best);
+    vdi_stream_client__copy_stream_threshold(stream_bytes);
+}
+
+/* Run the headless render benchmark selected with --benchmark. Synthetic frames
+ * of every source format are rendered through libplacebo on any Vulkan device,
+ * including lavapipe, and through the SDL software renderer without a window
+ * or Parsec session. Each path is scored against the RGBA reference the frames
+ * were converted from. */
+Sint32
+vdi_stream_client__benchmark(struct vdi_config_s *vdi_config)
+{
+    struct parsec_context_s parsec_context = { 0 };
+    AVFrame *patterns[VDI_STREAM_CLIENT_BENCHMARK_PATTERNS] = { 0 };
+    Uint8 *reference = NULL;
+    Uint8 *scratch = NULL;
+    Uint8 *image = NULL;
+    SDL_Surface *surface = NULL;
+    SDL_Renderer *renderer = NULL;
+    Sint32 width = vdi_config->width != 0 ? vdi_config->width : VDI_STREAM_CLIENT_BENCHMARK_WIDTH;
+    Sint32 height =
+        vdi_config->height != 0 ? vdi_config->height : VDI_STREAM_CLIENT_BENCHMARK_HEIGHT;
+    Sint32 result = VDI_STREAM_CLIENT_ERROR;
+    bool placebo;
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Benchmark %u frames at %dx%d\n", vdi_config->benchmark,
+        width, height
+    );
+    if (!SDL_Init(0)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Initialization failed: %s\n", SDL_GetError());
+        return VDI_STREAM_CLIENT_ERROR;
+    }
+    vdi_stream_client__pool_init(vdi_config->worker_threads);
+    vdi_stream_client__copy_init();
+
+    placebo = vdi_stream_client__placebo_offscreen_init(&parsec_context, width, height);
+    if (!placebo) {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION, "Skip libplacebo benchmark: %s\n", SDL_GetError()
+        );
+    }
+    surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGBA32);
+    if (surface != NULL) {
+        renderer = SDL_CreateSoftwareRenderer(surface);
+    }
+    if (renderer == NULL) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "SDL software renderer creation failed: %s\n",
+            SDL_GetError()
+        );
+        goto done;
+    }
+    reference = SDL_malloc((size_t)width * (size_t)height * 4);
+    scratch = SDL_malloc((size_t)width * (size_t)height * 4);
+    image = SDL_malloc((size_t)width * (size_t)height * 4);
+    if (reference == NULL || scratch == NULL || image == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Benchmark reference allocation failed\n");
+        goto done;
+    }
+    vdi_stream_client__benchmark_reference(reference, width, height, 0);
+
+    for (size_t i = 0; i < SDL_arraysize(vdi_stream_client__benchmark_formats); i++) {
+        const char *name = vdi_stream_client__benchmark_formats[i].name;
+
+        for (Uint32 j = 0; j < VDI_STREAM_CLIENT_BENCHMARK_PATTERNS; j++) {
+            if (j != 0) {
+                vdi_stream_client__benchmark_reference(scratch, width, height, j);
+            }
+            patterns[j] = vdi_stream_client__benchmark_frame(
+                vdi_stream_client__benchmark_formats[i].format, j != 0 ? scratch : reference,
+                width, height
+            );
+            if (patterns[j] == NULL) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Benchmark frame allocation failed for %s\n",
+                    name
+                );
+                goto done;
+            }
+        }
+
+        if (placebo) {
+            vdi_stream_client__benchmark_placebo(
+                &parsec_context, name, patterns, vdi_config->benchmark, reference, image
+            );
+        }
+        vdi_stream_client__benchmark_sdl(
+            renderer, name, patterns, vdi_config->benchmark, reference
+        );
+        vdi_stream_client__benchmark_copy(name, patterns, vdi_config->benchmark, scratch, image);
+
+        for (Uint32 j = 0; j < VDI_STREAM_CLIENT_BENCHMARK_PATTERNS; j++) {
+            av_frame_free(&patterns[j]);
+        }
+    }
+    result = VDI_STREAM_CLIENT_SUCCESS;
+
+done:
+    for (Uint32 j = 0; j < VDI_STREAM_CLIENT_BENCHMARK_PATTERNS; j++) {
+        av_frame_free(&patterns[j]);
+    }
+    SDL_free(image);
+    SDL_free(scratch);
+    SDL_free(reference);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+    vdi_stream_client__placebo_destroy(&parsec_context);
+    vdi_stream_client__copy_destroy();
+    vdi_stream_client__pool_destroy();
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,426 @@
+/*
+ *  cache.c -- persistent cache of startup probe results
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "cache.h"
+
+/* system includes. */
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+/* drm includes. */
+#include <xf86drm.h>
+
+/* va-api includes. */
+#include <va/va.h>
+
+/* define cache defaults. */
+#define VDI_STREAM_CLIENT_CACHE_DIRECTORY "vdi-stream-client"
+#define VDI_STREAM_CLIENT_CACHE_FILE "probe.cache"
+#define VDI_STREAM_CLIENT_CACHE_HEADER "# vdi-stream-client probe cache v1\n"
+#define VDI_STREAM_CLIENT_CACHE_RENDER_NODE_FIRST 128
+#define VDI_STREAM_CLIENT_CACHE_RENDER_NODE_LAST 135
+#define VDI_STREAM_CLIENT_CACHE_BUILD_ID_MAX 64u
+#define VDI_STREAM_CLIENT_CACHE_VAAPI_DRIVERS_PATH \
+    "/usr/lib/x86_64-linux-gnu/dri:/usr/lib64/dri:/usr/lib/dri:/usr/local/lib/dri"
+
+/* VA drivers libva tries for a DRM kernel driver, in its order. Other kernel
+ * drivers load the VA driver of the same name. */
+static const struct
+{
+    const char *kernel;
+    const char *drivers[2];
+} vdi_stream_client__cache_vaapi_drivers[] = {
+    { "i915", { "iHD", "i965" } },
+    { "xe", { "iHD", NULL } },
+    { "amdgpu", { "radeonsi", NULL } },
+    { "radeon", { "radeonsi", "r600" } },
+};
+
+/* Shared object lookup state for dl_iterate_phdr(). */
+struct vdi_stream_client__cache_object_s
+{
+    uintptr_t address;
+    char *key;
+    size_t key_len;
+    bool found;
+};
+
+/* Replace characters which would break the space separated cache format. */
+static void
+vdi_stream_client__cache_sanitize(char *key)
+{
+    for (; *key != '\0'; key++) {
+        if (!SDL_isgraph((unsigned char)*key)) {
+            *key = '_';
+        }
+    }
+}
+
+/* Resolve the cache directory from $XDG_CACHE_HOME, falling back to
+ * $HOME/.cache as described by the XDG base directory specification. */
+static bool
+vdi_stream_client__cache_directory(char *directory, size_t directory_len)
+{
+    const char *base = SDL_getenv("XDG_CACHE_HOME");
+    const char *home;
+
+    if (base != NULL && base[0] == '/') {
+        return SDL_snprintf(
+                   directory, directory_len, "%s/" VDI_STREAM_CLIENT_CACHE_DIRECTORY, base
+               ) < (int)directory_len;
+    }
+    home = SDL_getenv("HOME");
+    if (home == NULL || home[0] != '/') {
+        return false;
+    }
+    return SDL_snprintf(
+               directory, directory_len, "%s/.cache/" VDI_STREAM_CLIENT_CACHE_DIRECTORY, home
+           ) < (int)directory_len;
+}
+
+/* Load the cache file. A missing file or a file written by another cache
+ * format version is treated as empty. */
+static char *
+vdi_stream_client__cache_load(char *path, size_t path_len)
+{
+    char directory[4096];
+    char *data;
+
+    if (!vdi_stream_client__cache_directory(directory, sizeof(directory)) ||
+        SDL_snprintf(path, path_len, "%s/" VDI_STREAM_CLIENT_CACHE_FILE, directory) >=
+            (int)path_len) {
+        return NULL;
+    }
+    data = SDL_LoadFile(path, NULL);
+    if (data != NULL &&
+        SDL_strncmp(
+            data, VDI_STREAM_CLIENT_CACHE_HEADER, sizeof(VDI_STREAM_CLIENT_CACHE_HEADER) - 1
+        ) != 0) {
+        SDL_free(data);
+        data = NULL;
+    }
+    return data;
+}
+
+/* Return true if a cache line belongs to the named entry. */
+static bool
+vdi_stream_client__cache_match(const char *line, const char *name)
+{
+    size_t name_len = SDL_strlen(name);
+
+    return SDL_strncmp(line, name, name_len) == 0 && line[name_len] == ' ';
+}
+
+/* Collect the GNU build-id note of the loaded object containing the cached
+ * symbol. Objects without a build-id are keyed by file size and mtime. */
+static int
+vdi_stream_client__cache_object(struct dl_phdr_info *info, size_t size, void *data)
+{
+    struct vdi_stream_client__cache_object_s *object = data;
+    const char *path;
+    struct stat status;
+    bool contains = false;
+
+    (void)size;
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *header = &info->dlpi_phdr[i];
+        uintptr_t start = info->dlpi_addr + header->p_vaddr;
+
+        if (header->p_type == PT_LOAD && object->address >= start &&
+            object->address < start + header->p_memsz) {
+            contains = true;
+        }
+    }
+    if (!contains) {
+        return 0;
+    }
+
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *header = &info->dlpi_phdr[i];
+        const Uint8 *note = (const Uint8 *)(info->dlpi_addr + header->p_vaddr);
+        const Uint8 *end = note + header->p_memsz;
+
+        if (header->p_type != PT_NOTE) {
+            continue;
+        }
+        while (note + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *entry = (const ElfW(Nhdr) *)note;
+            const Uint8 *name = note + sizeof(*entry);
+            const Uint8 *desc = name + ((entry->n_namesz + 3u) & ~3u);
+            size_t written;
+
+            if (desc + entry->n_descsz > end) {
+                break;
+            }
+            if (entry->n_type != NT_GNU_BUILD_ID || entry->n_namesz != sizeof("GNU") ||
+                SDL_memcmp(name, "GNU", sizeof("GNU")) != 0 || entry->n_descsz == 0 ||
+                entry->n_descsz > VDI_STREAM_CLIENT_CACHE_BUILD_ID_MAX) {
+                note = desc + ((entry->n_descsz + 3u) & ~3u);
+                continue;
+            }
+            written = (size_t)SDL_snprintf(object->key, object->key_len, "build-id-");
+            for (ElfW(Word) j = 0; j < entry->n_descsz && written + 2 < object->key_len; j++) {
+                written += (size_t)SDL_snprintf(
+                    object->key + written, object->key_len - written, "%02x", desc[j]
+                );
+            }
+            object->found = written == sizeof("build-id-") - 1 + entry->n_descsz * 2u;
+            return 1;
+        }
+    }
+
+    path = info->dlpi_name != NULL && info->dlpi_name[0] != '\0' ? info->dlpi_name
+                                                                 : "/proc/self/exe";
+    if (stat(path, &status) == 0) {
+        object->found = SDL_snprintf(
+                            object->key, object->key_len, "file-%llu-%lld",
+                            (unsigned long long)status.st_size, (long long)status.st_mtime
+                        ) < (int)object->key_len;
+    }
+    return 1;
+}
+
+/* Build the cache key of the shared object which contains a Parsec SDK
+ * symbol, so cached signature offsets die with the library build. */
+bool
+vdi_stream_client__cache_parsec_key(const void *symbol, char *key, size_t key_len)
+{
+    struct vdi_stream_client__cache_object_s object = {
+        .address = (uintptr_t)symbol,
+        .key = key,
+        .key_len = key_len,
+    };
+
+    key[0] = '\0';
+    (void)dl_iterate_phdr(vdi_stream_client__cache_object, &object);
+    if (!object.found) {
+        key[0] = '\0';
+    }
+    return object.found;
+}
+
+/* Find the user-space VA driver libva would load for a DRM kernel driver,
+ * without loading it: $LIBVA_DRIVER_NAME or the drivers libva maps the kernel
+ * driver to, searched in $LIBVA_DRIVERS_PATH or the usual driver directories. */
+static bool
+vdi_stream_client__cache_vaapi_driver(
+    const char *kernel, char *path, size_t path_len, struct stat *status
+)
+{
+    const char *drivers[2] = { SDL_getenv("LIBVA_DRIVER_NAME"), NULL };
+    const char *directories = SDL_getenv("LIBVA_DRIVERS_PATH");
+
+    if (drivers[0] == NULL || drivers[0][0] == '\0') {
+        drivers[0] = kernel;
+        for (size_t i = 0; i < SDL_arraysize(vdi_stream_client__cache_vaapi_drivers); i++) {
+            if (SDL_strcmp(vdi_stream_client__cache_vaapi_drivers[i].kernel, kernel) == 0) {
+                drivers[0] = vdi_stream_client__cache_vaapi_drivers[i].drivers[0];
+                drivers[1] = vdi_stream_client__cache_vaapi_drivers[i].drivers[1];
+                break;
+            }
+        }
+    }
+    if (directories == NULL || directories[0] == '\0') {
+        directories = VDI_STREAM_CLIENT_CACHE_VAAPI_DRIVERS_PATH;
+    }
+
+    for (size_t i = 0; i < SDL_arraysize(drivers) && drivers[i] != NULL; i++) {
+        const char *directory = directories;
+
+        while (*directory != '\0') {
+            const char *end = SDL_strchr(directory, ':');
+            size_t length = end != NULL ? (size_t)(end - directory) : SDL_strlen(directory);
+
+            if (length > 0 && length < path_len) {
+                SDL_memcpy(path, directory, length);
+                if (SDL_snprintf(
+                        path + length, path_len - length, "/%s_drv_video.so", drivers[i]
+                    ) < (int)(path_len - length) &&
+                    stat(path, status) == 0) {
+                    return true;
+                }
+            }
+            directory += end != NULL ? length + 1 : length;
+        }
+    }
+    return false;
+}
+
+/* Build the cache key of the VA-API device from the first DRM render node,
+ * its kernel driver version, the kernel release, the user-space VA driver
+ * file with its size and mtime and the libva version. Only the DRM version
+ * ioctl is issued and the VA driver file is looked at, but never loaded. */
+bool
+vdi_stream_client__cache_vaapi_key(char *key, size_t key_len)
+{
+    drmVersionPtr version = NULL;
+    struct utsname system;
+    struct stat status = { 0 };
+    char driver[512];
+    char node[32];
+    bool built = false;
+    int fd = -1;
+
+    key[0] = '\0';
+    for (Sint32 minor = VDI_STREAM_CLIENT_CACHE_RENDER_NODE_FIRST;
+         minor <= VDI_STREAM_CLIENT_CACHE_RENDER_NODE_LAST && fd < 0; minor++) {
+        SDL_snprintf(node, sizeof(node), "/dev/dri/renderD%d", minor);
+        fd = open(node, O_RDWR | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    version = drmGetVersion(fd);
+    close(fd);
+    if (version == NULL || version->name == NULL || uname(&system) != 0) {
+        goto done;
+    }
+
+    if (!vdi_stream_client__cache_vaapi_driver(version->name, driver, sizeof(driver), &status)) {
+        SDL_strlcpy(driver, "none", sizeof(driver));
+    }
+    built = SDL_snprintf(
+                key, key_len, "%s-%s-%d.%d.%d-%s-%s-%llu-%lld-libva-%s",
+                node + sizeof("/dev/dri/") - 1, version->name, version->version_major,
+                version->version_minor, version->version_patchlevel, system.release, driver,
+                (unsigned long long)status.st_size, (long long)status.st_mtime, VA_VERSION_S
+            ) < (int)key_len;
+    if (built) {
+        vdi_stream_client__cache_sanitize(key);
+    } else {
+        key[0] = '\0';
+    }
+
+done:
+    if (version != NULL) {
+        drmFreeVersion(version);
+    }
+    return built;
+}
+
+/* Look up a cached value. Entries only match when they were stored with the
+ * same key, any other key means the probed component changed. */
+bool
+vdi_stream_client__cache_lookup(const char *name, const char *key, Uint64 *value)
+{
+    char path[4096];
+    char *data;
+    char *line;
+    bool found = false;
+
+    if (key == NULL || key[0] == '\0') {
+        return false;
+    }
+    data = vdi_stream_client__cache_load(path, sizeof(path));
+    if (data == NULL) {
+        return false;
+    }
+
+    for (line = data; line != NULL && *line != '\0'; line = SDL_strchr(line, '\n')) {
+        const char *entry_key;
+        char *entry_value;
+        char *end;
+        size_t key_len = SDL_strlen(key);
+
+        if (*line == '\n') {
+            line++;
+        }
+        if (!vdi_stream_client__cache_match(line, name)) {
+            continue;
+        }
+        entry_key = line + SDL_strlen(name) + 1;
+        if (SDL_strncmp(entry_key, key, key_len) != 0 || entry_key[key_len] != ' ') {
+            continue;
+        }
+        entry_value = (char *)entry_key + key_len + 1;
+        *value = SDL_strtoull(entry_value, &end, 16);
+        found = end != entry_value && (*end == '\n' || *end == '\0');
+        break;
+    }
+
+    SDL_free(data);
+    return found;
+}
+
+/* Store a cached value, replacing any previous entry of the same name. The
+ * file is written next to the old one and renamed so readers never see a
+ * partial cache. Failures are silent, the next start simply probes again. */
+void
+vdi_stream_client__cache_store(const char *name, const char *key, Uint64 value)
+{
+    char directory[4096];
+    char path[4096];
+    char temporary[4096];
+    char *data;
+    char *buffer = NULL;
+    char *line;
+    size_t capacity;
+    size_t written;
+
+    if (key == NULL || key[0] == '\0' ||
+        !vdi_stream_client__cache_directory(directory, sizeof(directory)) ||
+        !SDL_CreateDirectory(directory)) {
+        return;
+    }
+    data = vdi_stream_client__cache_load(path, sizeof(path));
+    capacity = sizeof(VDI_STREAM_CLIENT_CACHE_HEADER) + SDL_strlen(name) + SDL_strlen(key) + 32 +
+               (data != NULL ? SDL_strlen(data) : 0);
+    buffer = SDL_malloc(capacity);
+    if (buffer == NULL ||
+        SDL_snprintf(temporary, sizeof(temporary), "%s.tmp", path) >= (int)sizeof(temporary)) {
+        goto done;
+    }
+
+    written = SDL_strlcpy(buffer, VDI_STREAM_CLIENT_CACHE_HEADER, capacity);
+    for (line = data != NULL ? SDL_strchr(data, '\n') : NULL; line != NULL && line[1] != '\0';) {
+        char *next = SDL_strchr(line + 1, '\n');
+        size_t line_len = next != NULL ? (size_t)(next - line) : SDL_strlen(line);
+
+        if (line_len > 1 && !vdi_stream_client__cache_match(line + 1, name)) {
+            SDL_memcpy(buffer + written, line + 1, line_len - 1);
+            written += line_len - 1;
+            buffer[written++] = '\n';
+        }
+        line = next;
+    }
+    written += (size_t)SDL_snprintf(
+        buffer + written, capacity - written, "%s %s %llx\n", name, key, (unsigned long long)value
+    );
+
+    if (SDL_SaveFile(temporary, buffer, written) && !SDL_RenamePath(temporary, path)) {
+        (void)SDL_RemovePath(temporary);
+    }
+
+done:
+    SDL_free(buffer);
+    SDL_free(data);
+}
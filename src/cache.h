@@ -0,0 +1,37 @@
+/*
+ *  cache.h -- persistent cache of startup probe results
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_CACHE_H
+#define VDI_STREAM_CLIENT_CACHE_H
+
+/* internal includes. */
+#include "client.h"
+
+/* cache keys. */
+bool vdi_stream_client__cache_parsec_key(const void *symbol, char *key, size_t key_len);
+bool vdi_stream_client__cache_vaapi_key(char *key, size_t key_len);
+
+/* cache entries. */
+bool vdi_stream_client__cache_lookup(const char *name, const char *key, Uint64 *value);
+void vdi_stream_client__cache_store(const char *name, const char *key, Uint64 value);
+
+#endif /* VDI_STREAM_CLIENT_CACHE_H */
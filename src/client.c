@@ -29,6 +29,7 @@
 #include <SDL3/SDL_main.h>
 
 /* internal includes. */
+#include "benchmark.h"
 #include "client.h"
 #include "parsec.h"
 
@@ -111,7 +112,44 @@ vdi_stream_client__usage(char *program_name)
         "        420      4:2:0 chroma subsampling\n"
         "\n"
         "      valid modes: hw-hevc-444, hw-hevc-420, hw-h264-420,\n"
-        "                   sw-hevc-420, sw-h264-420\n"
+        "                   sw-hevc-444, sw-hevc-420, sw-h264-420\n"
+        "\n"
+        "      auto-bench measures every available mode at startup and\n"
+        "      selects the best one sustaining the frame rate\n"
+        "\n"
+        "  --decoder-threads N\n"
+        "      software decoder threads, 0 for one per CPU core (default: 0)\n"
+        "\n"
+        "  --decoder-thread-type TYPE\n"
+        "      software decoder threading model (default: slice)\n"
+        "\n"
+        "        slice  split each frame, no added latency\n"
+        "        frame  decode consecutive frames in parallel, one frame\n"
+        "               of added latency per extra thread\n"
+        "        auto   two frame threads, at most one frame of added latency\n"
+        "\n"
+        "  --worker-threads N\n"
+        "      shared decode and conversion worker threads, 0 for one per CPU core\n"
+        "      except the render core (default: 0)\n"
+        "\n"
+        "  --degradation MODE\n"
+        "      reduce decoding work while the client can't keep up (default: decoder)\n"
+        "\n"
+        "        none        never degrade\n"
+        "        decoder     skip loop filtering on non-reference frames\n"
+        "        resolution  also request a lower resolution from the host\n"
+        "\n"
+        "  --progressive-upload\n"
+        "      prepare software frames for upload while they decode (experimental)\n"
+        "\n"
+        "  --present-mode MODE\n"
+        "      presentation mode and frame pacing (default: fifo)\n"
+        "\n"
+        "        fifo       vsync, render just before the vblank deadline\n"
+        "        mailbox    no vsync, at most one present per refresh, newest\n"
+        "                   frame wins\n"
+        "        immediate  no vsync, present every frame at once\n"
+        "        adaptive   vsync, late frames tear instead of waiting\n"
         "\n"
         "USB options:\n"
         "  --redirect SPEC\n"
@@ -124,6 +162,22 @@ vdi_stream_client__usage(char *program_name)
         "  --stats SECONDS\n"
         "      display render stats every SECONDS seconds\n"
         "\n"
+        "  --clock-sync MODE\n"
+        "      estimate host clock offset and capture-to-present latency\n"
+        "\n"
+        "        host      exchange timestamps with a host clock agent\n"
+        "        loopback  answer timestamps locally for testing\n"
+        "\n"
+        "  --shadow-decoder MODE\n"
+        "      also decode the live stream in the background and report it\n"
+        "\n"
+        "        sw-slice  software decoder with slice threads\n"
+        "        sw-frame  software decoder with frame threads\n"
+        "        hw        VA-API hardware decoder\n"
+        "\n"
+        "  --benchmark FRAMES\n"
+        "      render FRAMES synthetic frames per format offscreen and exit\n"
+        "\n"
         "Report bugs to <%s>.\n",
         program_name, PACKAGE_BUGREPORT
     );
@@ -145,8 +199,10 @@ vdi_stream_client__video_decoder_parse(const char *value, vdi_video_decoder_e *v
         { "hw-hevc-444", VDI_VIDEO_DECODER_HW_HEVC_444 },
         { "hw-hevc-420", VDI_VIDEO_DECODER_HW_HEVC_420 },
         { "hw-h264-420", VDI_VIDEO_DECODER_HW_H264_420 },
+        { "sw-hevc-444", VDI_VIDEO_DECODER_SW_HEVC_444 },
         { "sw-hevc-420", VDI_VIDEO_DECODER_SW_HEVC_420 },
         { "sw-h264-420", VDI_VIDEO_DECODER_SW_H264_420 },
+        { "auto-bench", VDI_VIDEO_DECODER_AUTO_BENCH },
     };
 
     if (value == NULL || video_decoder == NULL) {
@@ -161,6 +217,143 @@ vdi_stream_client__video_decoder_parse(const char *value, vdi_video_decoder_e *v
     return false;
 }
 
+/* Convert the user-facing --decoder-thread-type string into the software
+ * decoder threading model. */
+static bool
+vdi_stream_client__decoder_thread_type_parse(
+    const char *value, vdi_decoder_thread_type_e *decoder_thread_type
+)
+{
+    static const struct
+    {
+        const char *name;
+        vdi_decoder_thread_type_e value;
+    } types[] = {
+        { "slice", VDI_DECODER_THREAD_SLICE },
+        { "frame", VDI_DECODER_THREAD_FRAME },
+        { "auto", VDI_DECODER_THREAD_AUTO },
+    };
+
+    if (value == NULL || decoder_thread_type == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < SDL_arraysize(types); i++) {
+        if (SDL_strcmp(value, types[i].name) == 0) {
+            *decoder_thread_type = types[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Convert the user-facing --degradation string into the highest rung the
+ * load-adaptive degradation ladder may climb to. */
+static bool
+vdi_stream_client__degradation_parse(const char *value, vdi_degradation_e *degradation)
+{
+    static const struct
+    {
+        const char *name;
+        vdi_degradation_e value;
+    } modes[] = {
+        { "none", VDI_DEGRADATION_NONE },
+        { "decoder", VDI_DEGRADATION_DECODER },
+        { "resolution", VDI_DEGRADATION_RESOLUTION },
+    };
+
+    if (value == NULL || degradation == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < SDL_arraysize(modes); i++) {
+        if (SDL_strcmp(value, modes[i].name) == 0) {
+            *degradation = modes[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Convert the user-facing --present-mode string into the presentation mode
+ * applied to the renderer. */
+static bool
+vdi_stream_client__present_mode_parse(const char *value, vdi_present_mode_e *present_mode)
+{
+    static const struct
+    {
+        const char *name;
+        vdi_present_mode_e value;
+    } modes[] = {
+        { "fifo", VDI_PRESENT_MODE_FIFO },
+        { "mailbox", VDI_PRESENT_MODE_MAILBOX },
+        { "immediate", VDI_PRESENT_MODE_IMMEDIATE },
+        { "adaptive", VDI_PRESENT_MODE_ADAPTIVE },
+    };
+
+    if (value == NULL || present_mode == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < SDL_arraysize(modes); i++) {
+        if (SDL_strcmp(value, modes[i].name) == 0) {
+            *present_mode = modes[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Convert the user-facing --clock-sync string into the internal clock
+ * synchronization mode used by the user-data timestamp exchange. */
+static bool
+vdi_stream_client__clock_sync_parse(const char *value, vdi_clock_sync_e *clock_sync)
+{
+    static const struct
+    {
+        const char *name;
+        vdi_clock_sync_e value;
+    } modes[] = {
+        { "host", VDI_CLOCK_SYNC_HOST },
+        { "loopback", VDI_CLOCK_SYNC_LOOPBACK },
+    };
+
+    if (value == NULL || clock_sync == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < SDL_arraysize(modes); i++) {
+        if (SDL_strcmp(value, modes[i].name) == 0) {
+            *clock_sync = modes[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Convert the user-facing --shadow-decoder string into the decoder
+ * configuration fed with a copy of the live bitstream. */
+static bool
+vdi_stream_client__shadow_decoder_parse(const char *value, vdi_shadow_decoder_e *shadow_decoder)
+{
+    static const struct
+    {
+        const char *name;
+        vdi_shadow_decoder_e value;
+    } modes[] = {
+        { "sw-slice", VDI_SHADOW_DECODER_SW_SLICE },
+        { "sw-frame", VDI_SHADOW_DECODER_SW_FRAME },
+        { "hw", VDI_SHADOW_DECODER_HW },
+    };
+
+    if (value == NULL || shadow_decoder == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < SDL_arraysize(modes); i++) {
+        if (SDL_strcmp(value, modes[i].name) == 0) {
+            *shadow_decoder = modes[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
 /* Print version, license, and author information for --version without starting
  * SDL, Parsec, or any streaming resources. */
 Sint32
@@ -210,7 +403,10 @@ main(int argc, char **argv)
     Sint64 speed;
     Sint64 width;
     Sint64 height;
+    Sint64 decoder_threads;
+    Sint64 worker_threads;
     Sint64 stats_period;
+    Sint64 benchmark;
 
     /* Command-line option identifiers. */
     enum
@@ -233,6 +429,15 @@ main(int argc, char **argv)
         OPTION_REDIRECT = 16,
         OPTION_STATS = 17,
         OPTION_NO_DECORATION = 18,
+        OPTION_CLOCK_SYNC = 19,
+        OPTION_BENCHMARK = 20,
+        OPTION_SHADOW_DECODER = 21,
+        OPTION_DECODER_THREADS = 22,
+        OPTION_DECODER_THREAD_TYPE = 23,
+        OPTION_DEGRADATION = 24,
+        OPTION_PROGRESSIVE_UPLOAD = 25,
+        OPTION_WORKER_THREADS = 26,
+        OPTION_PRESENT_MODE = 27,
     };
 
     struct option long_options[] = {
@@ -243,6 +448,9 @@ main(int argc, char **argv)
 
         /* Debug options. */
         { "stats", required_argument, NULL, OPTION_STATS },
+        { "clock-sync", required_argument, NULL, OPTION_CLOCK_SYNC },
+        { "shadow-decoder", required_argument, NULL, OPTION_SHADOW_DECODER },
+        { "benchmark", required_argument, NULL, OPTION_BENCHMARK },
 
         /* Parsec options. */
         { "session", required_argument, NULL, OPTION_SESSION },
@@ -254,6 +462,12 @@ main(int argc, char **argv)
 
         /* Client options. */
         { "video-decoder", required_argument, NULL, OPTION_VIDEO_DECODER },
+        { "decoder-threads", required_argument, NULL, OPTION_DECODER_THREADS },
+        { "decoder-thread-type", required_argument, NULL, OPTION_DECODER_THREAD_TYPE },
+        { "worker-threads", required_argument, NULL, OPTION_WORKER_THREADS },
+        { "degradation", required_argument, NULL, OPTION_DEGRADATION },
+        { "progressive-upload", no_argument, NULL, OPTION_PROGRESSIVE_UPLOAD },
+        { "present-mode", required_argument, NULL, OPTION_PRESENT_MODE },
         { "no-upnp", no_argument, NULL, OPTION_NO_UPNP },
         { "no-reconnect", no_argument, NULL, OPTION_NO_RECONNECT },
         { "no-grab", no_argument, NULL, OPTION_NO_GRAB },
@@ -284,6 +498,13 @@ main(int argc, char **argv)
 
     /* Client defaults. */
     vdi_config->video_decoder = VDI_VIDEO_DECODER_HW_HEVC_444;
+    vdi_config->software_placebo = 0;
+    vdi_config->decoder_threads = 0;
+    vdi_config->decoder_thread_type = VDI_DECODER_THREAD_SLICE;
+    vdi_config->worker_threads = 0;
+    vdi_config->degradation = VDI_DEGRADATION_DECODER;
+    vdi_config->progressive_upload = 0;
+    vdi_config->present_mode = VDI_PRESENT_MODE_FIFO;
     vdi_config->upnp = 1;
     vdi_config->reconnect = 1;
     vdi_config->grab = 1;
@@ -293,6 +514,9 @@ main(int argc, char **argv)
     vdi_config->audio = 1;
     vdi_config->stats = 0;
     vdi_config->stats_period = 0;
+    vdi_config->clock_sync = VDI_CLOCK_SYNC_NONE;
+    vdi_config->shadow_decoder = VDI_SHADOW_DECODER_NONE;
+    vdi_config->benchmark = 0;
 
     program_name = argv[0];
     if (program_name && SDL_strrchr(program_name, '/')) {
@@ -413,7 +637,92 @@ main(int argc, char **argv)
                 );
                 SDL_LogError(
                     SDL_LOG_CATEGORY_APPLICATION, "Valid video decoders: hw-hevc-444, hw-hevc-420, "
-                                                  "hw-h264-420, sw-hevc-420, sw-h264-420\n"
+                                                  "hw-h264-420, sw-hevc-444, sw-hevc-420, "
+                                                  "sw-h264-420, auto-bench\n"
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            continue;
+        case OPTION_DECODER_THREADS:
+            decoder_threads = SDL_strtol(optarg, &endptr, 10);
+            if (endptr == optarg || *endptr != '\0' || decoder_threads < 0 ||
+                decoder_threads > DECODER_THREADS_MAX) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid decoder threads: %s\n",
+                    program_name, optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            vdi_config->decoder_threads = decoder_threads;
+            continue;
+        case OPTION_DECODER_THREAD_TYPE:
+            if (!vdi_stream_client__decoder_thread_type_parse(
+                    optarg, &vdi_config->decoder_thread_type
+                )) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid decoder thread type: %s\n",
+                    program_name, optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Valid decoder thread types: slice, frame, auto\n"
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            continue;
+        case OPTION_WORKER_THREADS:
+            worker_threads = SDL_strtol(optarg, &endptr, 10);
+            if (endptr == optarg || *endptr != '\0' || worker_threads < 0 ||
+                worker_threads > WORKER_THREADS_MAX) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid worker threads: %s\n",
+                    program_name, optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            vdi_config->worker_threads = worker_threads;
+            continue;
+        case OPTION_DEGRADATION:
+            if (!vdi_stream_client__degradation_parse(optarg, &vdi_config->degradation)) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid degradation mode: %s\n",
+                    program_name, optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION,
+                    "Valid degradation modes: none, decoder, resolution\n"
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            continue;
+        case OPTION_PRESENT_MODE:
+            if (!vdi_stream_client__present_mode_parse(optarg, &vdi_config->present_mode)) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid present mode: %s\n", program_name,
+                    optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION,
+                    "Valid present modes: fifo, mailbox, immediate, adaptive\n"
                 );
                 SDL_LogError(
                     SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
@@ -440,6 +749,9 @@ main(int argc, char **argv)
         case OPTION_NO_CLIPBOARD:
             vdi_config->clipboard = 0;
             continue;
+        case OPTION_PROGRESSIVE_UPLOAD:
+            vdi_config->progressive_upload = 1;
+            continue;
         case OPTION_NO_AUDIO:
             vdi_config->audio = 0;
             continue;
@@ -459,6 +771,54 @@ main(int argc, char **argv)
             vdi_config->stats = 1;
             vdi_config->stats_period = stats_period;
             continue;
+        case OPTION_CLOCK_SYNC:
+            if (!vdi_stream_client__clock_sync_parse(optarg, &vdi_config->clock_sync)) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid clock sync mode: %s\n", program_name,
+                    optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Valid clock sync modes: host, loopback\n"
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            continue;
+        case OPTION_SHADOW_DECODER:
+            if (!vdi_stream_client__shadow_decoder_parse(optarg, &vdi_config->shadow_decoder)) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid shadow decoder mode: %s\n",
+                    program_name, optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION,
+                    "Valid shadow decoder modes: sw-slice, sw-frame, hw\n"
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            continue;
+        case OPTION_BENCHMARK:
+            benchmark = SDL_strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || benchmark <= 0 || benchmark > UINT32_MAX) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "%s: invalid benchmark frames: %s\n",
+                    program_name, optarg
+                );
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION, "Try `%s --help' for more information.\n",
+                    program_name
+                );
+                goto error;
+            }
+            vdi_config->benchmark = benchmark;
+            continue;
 
         /* USB options. */
         case OPTION_REDIRECT:
@@ -712,9 +1072,10 @@ main(int argc, char **argv)
         }
     }
 
-    /* Mandatory arguments not given. */
-    if (vdi_config->session == NULL || vdi_config->peer == NULL ||
-        SDL_strlen(vdi_config->session) == 0 || SDL_strlen(vdi_config->peer) == 0) {
+    /* Mandatory arguments not given. (the benchmark needs no session) */
+    if (vdi_config->benchmark == 0 &&
+        (vdi_config->session == NULL || vdi_config->peer == NULL ||
+         SDL_strlen(vdi_config->session) == 0 || SDL_strlen(vdi_config->peer) == 0)) {
         SDL_LogError(
             SDL_LOG_CATEGORY_APPLICATION, "%s: mandatory arguments missing\n", program_name
         );
@@ -748,6 +1109,14 @@ main(int argc, char **argv)
         goto error;
     }
 
+    /* Headless render benchmark. */
+    if (vdi_config->benchmark > 0) {
+        if (vdi_stream_client__benchmark(vdi_config) != 0) {
+            goto error;
+        }
+        goto done;
+    }
+
     /* Main event loop. */
     if (vdi_stream_client__event_loop(vdi_config) != 0) {
         goto error;
@@ -34,7 +34,9 @@
 #define VDI_STREAM_CLIENT_ERROR (-1)  /* generic error. */
 
 /* define limits. */
-#define USB_MAX (8) /* maximum number of usb redirects. */
+#define USB_MAX (8)              /* maximum number of usb redirects. */
+#define DECODER_THREADS_MAX (64) /* maximum number of software decoder threads. */
+#define WORKER_THREADS_MAX (15)  /* maximum number of worker pool threads. */
 
 typedef union
 {
@@ -47,10 +49,49 @@ typedef enum
     VDI_VIDEO_DECODER_HW_HEVC_444,
     VDI_VIDEO_DECODER_HW_HEVC_420,
     VDI_VIDEO_DECODER_HW_H264_420,
+    VDI_VIDEO_DECODER_SW_HEVC_444,
     VDI_VIDEO_DECODER_SW_HEVC_420,
     VDI_VIDEO_DECODER_SW_H264_420,
+    VDI_VIDEO_DECODER_AUTO_BENCH,
 } vdi_video_decoder_e;
 
+typedef enum
+{
+    VDI_DECODER_THREAD_SLICE,
+    VDI_DECODER_THREAD_FRAME,
+    VDI_DECODER_THREAD_AUTO,
+} vdi_decoder_thread_type_e;
+
+typedef enum
+{
+    VDI_DEGRADATION_NONE,
+    VDI_DEGRADATION_DECODER,
+    VDI_DEGRADATION_RESOLUTION,
+} vdi_degradation_e;
+
+typedef enum
+{
+    VDI_PRESENT_MODE_FIFO,
+    VDI_PRESENT_MODE_MAILBOX,
+    VDI_PRESENT_MODE_IMMEDIATE,
+    VDI_PRESENT_MODE_ADAPTIVE,
+} vdi_present_mode_e;
+
+typedef enum
+{
+    VDI_CLOCK_SYNC_NONE,
+    VDI_CLOCK_SYNC_HOST,
+    VDI_CLOCK_SYNC_LOOPBACK,
+} vdi_clock_sync_e;
+
+typedef enum
+{
+    VDI_SHADOW_DECODER_NONE,
+    VDI_SHADOW_DECODER_SW_SLICE,
+    VDI_SHADOW_DECODER_SW_FRAME,
+    VDI_SHADOW_DECODER_HW,
+} vdi_shadow_decoder_e;
+
 /* stored command line options. */
 typedef struct vdi_config_s
 {
@@ -66,6 +107,28 @@ typedef struct vdi_config_s
     /* video codec, color mode and acceleration policy. */
     vdi_video_decoder_e video_decoder;
 
+    /* software decoded frames rendered through libplacebo. (0 = upload through the SDL renderer,
+     * 1 = render through libplacebo on a vulkan window, chosen by auto-bench) */
+    Uint16 software_placebo;
+
+    /* software decoder threads and threading model. (0 threads = one per cpu core) */
+    Uint16 decoder_threads;
+    vdi_decoder_thread_type_e decoder_thread_type;
+
+    /* shared worker pool threads. (0 = one per cpu core except the render core) */
+    Uint16 worker_threads;
+
+    /* load-adaptive degradation ladder. (none, decoder knobs or decoder knobs and host
+     * resolution) */
+    vdi_degradation_e degradation;
+
+    /* progressive upload of decoded row bands. (0 = upload whole frames, 1 = prepare row bands
+     * while the software decoder is still running) */
+    Uint16 progressive_upload;
+
+    /* presentation mode. (fifo, mailbox, immediate or adaptive vsync) */
+    vdi_present_mode_e present_mode;
+
     /* upnp nat traversal support. (0 = disable upnp, 1 = enable upnp) */
     Uint16 upnp;
 
@@ -95,6 +158,15 @@ typedef struct vdi_config_s
     /* render stats logging interval in seconds. */
     Uint64 stats_period;
 
+    /* host clock synchronization over parsec user data. (none, host agent or local loopback) */
+    vdi_clock_sync_e clock_sync;
+
+    /* second decoder fed with the live bitstream for comparison. (none, software or hardware) */
+    vdi_shadow_decoder_e shadow_decoder;
+
+    /* headless render benchmark frames per format and renderer. (0 = disable benchmark) */
+    Uint32 benchmark;
+
     /* usb options. */
     Uint32 usb_count; /* number of configured usb redirects. */
     vdi_server_addr_u server_addrs[USB_MAX];
@@ -0,0 +1,356 @@
+/*
+ *  clock.c -- host clock synchronization over parsec user data
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "client.h"
+#include "clock.h"
+#include "ffmpeg.h"
+#include "parsec.h"
+
+/* define clock synchronization defaults. */
+#define VDI_STREAM_CLIENT_CLOCK_PING_MS 1000
+#define VDI_STREAM_CLIENT_CLOCK_SAMPLES 8
+#define VDI_STREAM_CLIENT_CLOCK_MESSAGE_SIZE 128
+#define VDI_STREAM_CLIENT_CLOCK_LOOPBACK_OFFSET_NS 3600000000000ll
+
+/* One completed ping/pong exchange. Offset is host time minus client time. */
+struct vdi_stream_client__clock_sample_s
+{
+    Sint64 offset_ns;
+    Uint64 rtt_ns;
+};
+
+/* clock synchronization state. */
+struct vdi_stream_client__clock_s
+{
+
+    /* timestamp exchange. */
+    vdi_clock_sync_e mode;
+    Uint64 next_ping_tick;
+    Uint64 sequence;
+    bool loopback_pending;
+    char loopback_ping[VDI_STREAM_CLIENT_CLOCK_MESSAGE_SIZE];
+
+    /* minimum round-trip filter over the most recent exchanges. */
+    struct vdi_stream_client__clock_sample_s samples[VDI_STREAM_CLIENT_CLOCK_SAMPLES];
+    Uint32 sample_count;
+    Uint32 sample_next;
+    bool synchronized;
+    Sint64 offset_ns;
+    Uint64 rtt_ns;
+
+    /* host capture time of the frame waiting for present. */
+    bool frame_pending;
+    Uint64 frame_capture_ns;
+
+    /* per-period stats. */
+    Uint64 stats_pings;
+    Uint64 stats_pongs;
+    Uint64 stats_rtt_ns;
+    Uint64 stats_rtt_max_ns;
+    Uint64 stats_frames;
+    Uint64 stats_unstamped;
+    Uint64 stats_latency_ns;
+    Uint64 stats_latency_max_ns;
+};
+
+/* Convert nanosecond clock values into milliseconds for log output. */
+static double
+vdi_stream_client__clock_ms(Sint64 ns)
+{
+    return (double)ns / 1000000.0;
+}
+
+/* Select the exchange with the smallest round trip. Queueing delay only ever
+ * adds to the round trip and skews the offset, so the fastest exchange in the
+ * window carries the least asymmetric error. */
+static void
+vdi_stream_client__clock_filter(struct vdi_stream_client__clock_s *clock)
+{
+    const struct vdi_stream_client__clock_sample_s *best = &clock->samples[0];
+
+    for (Uint32 i = 1; i < clock->sample_count; i++) {
+        if (clock->samples[i].rtt_ns < best->rtt_ns) {
+            best = &clock->samples[i];
+        }
+    }
+    clock->offset_ns = best->offset_ns;
+    clock->rtt_ns = best->rtt_ns;
+}
+
+/* Parse a pong and derive offset and round trip from the four timestamps the
+ * same way NTP does: t1 client send, t2 host receive, t3 host send and t4 the
+ * local receive time. */
+static void
+vdi_stream_client__clock_pong(struct vdi_stream_client__clock_s *clock, const char *msg)
+{
+    struct vdi_stream_client__clock_sample_s *sample;
+    unsigned long long sequence;
+    unsigned long long t1;
+    unsigned long long t2;
+    unsigned long long t3;
+    Uint64 t4 = SDL_GetTicksNS();
+    Uint64 elapsed_ns;
+    Uint64 host_ns;
+
+    if (SDL_sscanf(msg, "pong %llu %llu %llu %llu", &sequence, &t1, &t2, &t3) != 4) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Ignore malformed clock message\n");
+        return;
+    }
+    if (sequence > clock->sequence || t1 > t4 || t3 < t2) {
+        return;
+    }
+
+    sample = &clock->samples[clock->sample_next];
+    clock->sample_next = (clock->sample_next + 1) % VDI_STREAM_CLIENT_CLOCK_SAMPLES;
+    clock->sample_count = SDL_min(clock->sample_count + 1, VDI_STREAM_CLIENT_CLOCK_SAMPLES);
+    elapsed_ns = t4 - t1;
+    host_ns = t3 - t2;
+    sample->rtt_ns = elapsed_ns > host_ns ? elapsed_ns - host_ns : 0;
+    sample->offset_ns = (((Sint64)t2 - (Sint64)t1) + ((Sint64)t3 - (Sint64)t4)) / 2;
+    vdi_stream_client__clock_filter(clock);
+
+    clock->stats_pongs++;
+    clock->stats_rtt_ns += sample->rtt_ns;
+    clock->stats_rtt_max_ns = SDL_max(clock->stats_rtt_max_ns, sample->rtt_ns);
+
+    if (!clock->synchronized) {
+        clock->synchronized = true;
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION, "Clock synchronized with offset %.3fms, rtt %.3fms\n",
+            vdi_stream_client__clock_ms(clock->offset_ns),
+            vdi_stream_client__clock_ms((Sint64)clock->rtt_ns)
+        );
+    }
+}
+
+/* Answer a queued loopback ping as a host agent would. The fake host clock runs
+ * VDI_STREAM_CLIENT_CLOCK_LOOPBACK_OFFSET_NS ahead and stamps receive and send
+ * in the middle of the round trip, so the estimator should report exactly that
+ * offset. */
+static void
+vdi_stream_client__clock_loopback(struct vdi_stream_client__clock_s *clock)
+{
+    char msg[VDI_STREAM_CLIENT_CLOCK_MESSAGE_SIZE];
+    unsigned long long sequence;
+    unsigned long long t1;
+    Uint64 host_ns;
+
+    if (!clock->loopback_pending) {
+        return;
+    }
+    clock->loopback_pending = false;
+    if (SDL_sscanf(clock->loopback_ping, "ping %llu %llu", &sequence, &t1) != 2) {
+        return;
+    }
+
+    host_ns = t1 + (SDL_GetTicksNS() - t1) / 2 + VDI_STREAM_CLIENT_CLOCK_LOOPBACK_OFFSET_NS;
+    SDL_snprintf(
+        msg, sizeof(msg), "pong %llu %llu %llu %llu", sequence, t1, (unsigned long long)host_ns,
+        (unsigned long long)host_ns
+    );
+    vdi_stream_client__clock_pong(clock, msg);
+}
+
+/* Allocate clock synchronization state when --clock-sync selected a mode. */
+bool
+vdi_stream_client__clock_init(struct parsec_context_s *parsec_context, vdi_clock_sync_e clock_sync)
+{
+    if (clock_sync == VDI_CLOCK_SYNC_NONE) {
+        return true;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Initialize clock sync with %s\n",
+        clock_sync == VDI_CLOCK_SYNC_LOOPBACK ? "local loopback" : "host agent"
+    );
+    parsec_context->clock = SDL_calloc(1, sizeof(*parsec_context->clock));
+    if (parsec_context->clock == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate clock sync state\n");
+        return false;
+    }
+    parsec_context->clock->mode = clock_sync;
+    return true;
+}
+
+/* Send the next ping when due. Loopback replies are delivered one loop later so
+ * the measured round trip still spans a real main loop iteration. */
+void
+vdi_stream_client__clock_update(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__clock_s *clock = parsec_context->clock;
+    char msg[VDI_STREAM_CLIENT_CLOCK_MESSAGE_SIZE];
+    Uint64 now;
+    ParsecStatus e;
+
+    if (clock == NULL || !vdi_stream_client__context_connected(parsec_context)) {
+        return;
+    }
+    vdi_stream_client__clock_loopback(clock);
+
+    now = SDL_GetTicks();
+    if (now < clock->next_ping_tick) {
+        return;
+    }
+    clock->next_ping_tick = now + VDI_STREAM_CLIENT_CLOCK_PING_MS;
+
+    clock->sequence++;
+    SDL_snprintf(
+        msg, sizeof(msg), "ping %llu %llu", (unsigned long long)clock->sequence,
+        (unsigned long long)SDL_GetTicksNS()
+    );
+    clock->stats_pings++;
+    if (clock->mode == VDI_CLOCK_SYNC_LOOPBACK) {
+        SDL_strlcpy(clock->loopback_ping, msg, sizeof(clock->loopback_ping));
+        clock->loopback_pending = true;
+        return;
+    }
+
+    e = ParsecClientSendUserData(parsec_context->parsec, PARSEC_CLOCK_MSG, msg);
+    if (e != PARSEC_OK) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Clock ping failed with code: %d\n", e);
+    }
+}
+
+/* Handle a PARSEC_CLOCK_MSG user-data packet from the host agent and free the
+ * SDK-owned buffer. */
+void
+vdi_stream_client__clock_user_data(struct parsec_context_s *parsec_context, Uint32 buffer_key)
+{
+    char *msg = ParsecGetBuffer(parsec_context->parsec, buffer_key);
+
+    if (msg != NULL && parsec_context->clock != NULL &&
+        parsec_context->clock->mode == VDI_CLOCK_SYNC_HOST) {
+        vdi_stream_client__clock_pong(parsec_context->clock, msg);
+    }
+
+#ifdef HAVE_LIBPARSEC
+    ParsecFree(msg);
+#else
+    ParsecFree(parsec_context->parsec, msg);
+#endif
+}
+
+/* Remember the host capture time of a newly decoded frame until it is presented.
+ * Host mode reads the SEI stamp of the host encoder, while loopback stamps the
+ * frame on arrival in the fake host clock so the render share stays visible. */
+void
+vdi_stream_client__clock_frame(
+    struct parsec_context_s *parsec_context, const ParsecFrame *frame, const void *image
+)
+{
+    struct vdi_stream_client__clock_s *clock = parsec_context->clock;
+    Uint64 capture_ns;
+
+    if (clock == NULL) {
+        return;
+    }
+    if (vdi_stream_client__parsec_ffmpeg_frame_capture_ns(frame, image, &capture_ns)) {
+        clock->frame_capture_ns = capture_ns;
+        clock->frame_pending = true;
+    } else if (clock->mode == VDI_CLOCK_SYNC_LOOPBACK) {
+        clock->frame_capture_ns = SDL_GetTicksNS() + VDI_STREAM_CLIENT_CLOCK_LOOPBACK_OFFSET_NS;
+        clock->frame_pending = true;
+    } else {
+        clock->frame_pending = false;
+        clock->stats_unstamped++;
+    }
+}
+
+/* Account capture-to-present latency once the frame is on screen. The host
+ * capture time is mapped into the local clock with the filtered offset. */
+void
+vdi_stream_client__clock_present(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__clock_s *clock = parsec_context->clock;
+    Sint64 latency_ns;
+
+    if (clock == NULL || !clock->frame_pending) {
+        return;
+    }
+    clock->frame_pending = false;
+    if (!clock->synchronized) {
+        return;
+    }
+
+    latency_ns = (Sint64)SDL_GetTicksNS() - ((Sint64)clock->frame_capture_ns - clock->offset_ns);
+    latency_ns = SDL_max(latency_ns, 0);
+    clock->stats_frames++;
+    clock->stats_latency_ns += (Uint64)latency_ns;
+    clock->stats_latency_max_ns = SDL_max(clock->stats_latency_max_ns, (Uint64)latency_ns);
+}
+
+/* Emit the clock estimate and capture-to-present latency of the period next to
+ * the render statistics and reset the period counters. */
+void
+vdi_stream_client__clock_stats(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__clock_s *clock = parsec_context->clock;
+
+    if (clock == NULL) {
+        return;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Clock:\n"
+        "  sync: mode=%s, synchronized=%s, samples=%u, offset=%.3fms, rtt=%.3fms\n"
+        "  pings: sent=%llu, answered=%llu, rtt_avg=%.3fms, rtt_max=%.3fms\n"
+        "  capture_to_present: frames=%llu, unstamped=%llu, avg=%.3fms, max=%.3fms\n",
+        clock->mode == VDI_CLOCK_SYNC_LOOPBACK ? "loopback" : "host",
+        clock->synchronized ? "yes" : "no", clock->sample_count,
+        vdi_stream_client__clock_ms(clock->offset_ns),
+        vdi_stream_client__clock_ms((Sint64)clock->rtt_ns), (unsigned long long)clock->stats_pings,
+        (unsigned long long)clock->stats_pongs,
+        clock->stats_pongs != 0
+            ? vdi_stream_client__clock_ms((Sint64)(clock->stats_rtt_ns / clock->stats_pongs))
+            : 0.0,
+        vdi_stream_client__clock_ms((Sint64)clock->stats_rtt_max_ns),
+        (unsigned long long)clock->stats_frames, (unsigned long long)clock->stats_unstamped,
+        clock->stats_frames != 0
+            ? vdi_stream_client__clock_ms((Sint64)(clock->stats_latency_ns / clock->stats_frames))
+            : 0.0,
+        vdi_stream_client__clock_ms((Sint64)clock->stats_latency_max_ns)
+    );
+
+    clock->stats_pings = 0;
+    clock->stats_pongs = 0;
+    clock->stats_rtt_ns = 0;
+    clock->stats_rtt_max_ns = 0;
+    clock->stats_frames = 0;
+    clock->stats_unstamped = 0;
+    clock->stats_latency_ns = 0;
+    clock->stats_latency_max_ns = 0;
+}
+
+/* Release clock synchronization state. */
+void
+vdi_stream_client__clock_destroy(struct parsec_context_s *parsec_context)
+{
+    SDL_free(parsec_context->clock);
+    parsec_context->clock = NULL;
+}
@@ -0,0 +1,647 @@
+/*
+ *  copy.c -- accelerated video plane copy kernels
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "copy.h"
+#include "pool.h"
+
+/* system includes. */
+#include <stdint.h>
+
+/* simd includes. */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VDI_STREAM_CLIENT_COPY_X86 1
+#endif
+
+/* define copy defaults. */
+#define VDI_STREAM_CLIENT_COPY_STREAM_BYTES (4u * 1024u * 1024u)
+#define VDI_STREAM_CLIENT_COPY_BAND_BYTES (8u * 1024u * 1024u)
+#define VDI_STREAM_CLIENT_COPY_BANDS 4
+#define VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT 13
+#define VDI_STREAM_CLIENT_COPY_MATRIX_ROUND (1 << (VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT - 1))
+
+/* YCbCr to RGB coefficients in Q13 fixed point, with the luma offset. */
+struct vdi_stream_client__copy_matrix_s
+{
+    Sint16 y_offset;
+    Sint16 y;
+    Sint16 r_v;
+    Sint16 g_u;
+    Sint16 g_v;
+    Sint16 b_u;
+};
+
+/* Conversion matrices indexed by BT.709 and full range. */
+static const struct vdi_stream_client__copy_matrix_s vdi_stream_client__copy_matrices[2][2] = {
+    {
+        { 16, 9539, 13075, 3209, 6660, 16525 },
+        { 0, 8192, 11485, 2819, 5850, 14516 },
+    },
+    {
+        { 16, 9539, 14686, 1747, 4366, 17305 },
+        { 0, 8192, 12901, 1535, 3835, 15201 },
+    },
+};
+
+/* One band of rows converted by the calling thread or a pool worker. Plane
+ * rows use src[0] only, YCbCr conversion rows read all three planes. */
+struct vdi_stream_client__copy_band_s
+{
+    void (*row)(Uint8 *dst, const Uint8 *src, Sint32 width);
+    void (*yuv_row)(
+        Uint8 *dst, const Uint8 *const src[3], Sint32 width,
+        const struct vdi_stream_client__copy_matrix_s *matrix
+    );
+    const struct vdi_stream_client__copy_matrix_s *matrix;
+    Uint8 *dst;
+    Sint32 dst_pitch;
+    const Uint8 *src[3];
+    Sint32 src_pitch[3];
+    Sint32 width;
+    Sint32 rows;
+    Sint32 band_rows;
+};
+
+/* Copy one row with the C library, which is the fastest choice for rows that
+ * stay cache resident. */
+static void
+vdi_stream_client__copy_row(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    SDL_memcpy(dst, src, (size_t)width);
+}
+
+/* Down-convert one row of little-endian P010 samples to 8 bits, rounding to
+ * nearest. This is the reference every SIMD kernel must match exactly. */
+static void
+vdi_stream_client__copy_p010_scalar(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    for (Sint32 x = 0; x < width; x++) {
+        Uint32 sample = (Uint32)src[x * 2] | ((Uint32)src[x * 2 + 1] << 8);
+
+        dst[x] = (Uint8)(SDL_min(sample + 0x80u, 0xffffu) >> 8);
+    }
+}
+
+/* Convert one row of 8-bit YCbCr 4:4:4 to XRGB8888. This is the reference
+ * every SIMD kernel must match exactly. */
+static void
+vdi_stream_client__copy_yuv444_scalar(
+    Uint8 *dst, const Uint8 *const src[3], Sint32 width,
+    const struct vdi_stream_client__copy_matrix_s *matrix
+)
+{
+    for (Sint32 x = 0; x < width; x++) {
+        Sint32 y = matrix->y * ((Sint32)src[0][x] - matrix->y_offset);
+        Sint32 u = (Sint32)src[1][x] - 128;
+        Sint32 v = (Sint32)src[2][x] - 128;
+        Sint32 r = (y + matrix->r_v * v + VDI_STREAM_CLIENT_COPY_MATRIX_ROUND) >>
+                   VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT;
+        Sint32 g = (y - matrix->g_u * u - matrix->g_v * v + VDI_STREAM_CLIENT_COPY_MATRIX_ROUND) >>
+                   VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT;
+        Sint32 b = (y + matrix->b_u * u + VDI_STREAM_CLIENT_COPY_MATRIX_ROUND) >>
+                   VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT;
+        Uint32 pixel = 0xff000000u | ((Uint32)SDL_clamp(r, 0, 255) << 16) |
+                       ((Uint32)SDL_clamp(g, 0, 255) << 8) | (Uint32)SDL_clamp(b, 0, 255);
+
+        SDL_memcpy(dst + (size_t)x * 4, &pixel, sizeof(pixel));
+    }
+}
+
+/* Pack two Q13 coefficients into the 16-bit pairs multiplied by pmaddwd, low
+ * half first. */
+static Sint32
+vdi_stream_client__copy_pair(Sint32 low, Sint32 high)
+{
+    return (Sint32)(((Uint32)(Uint16)high << 16) | (Uint16)low);
+}
+
+#ifdef VDI_STREAM_CLIENT_COPY_X86
+
+/* Copy one row with SSE2 non-temporal stores once the destination is aligned,
+ * so large planes do not evict the decoder working set from the caches. */
+__attribute__((target("sse2"))) static void
+vdi_stream_client__copy_stream_sse2(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    Sint32 x = SDL_min((Sint32)((16u - ((uintptr_t)dst & 15u)) & 15u), width);
+
+    SDL_memcpy(dst, src, (size_t)x);
+    for (; x + 16 <= width; x += 16) {
+        _mm_stream_si128((__m128i *)(dst + x), _mm_loadu_si128((const __m128i *)(src + x)));
+    }
+    SDL_memcpy(dst + x, src + x, (size_t)(width - x));
+}
+
+/* Copy one row with AVX2 non-temporal stores. */
+__attribute__((target("avx2"))) static void
+vdi_stream_client__copy_stream_avx2(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    Sint32 x = SDL_min((Sint32)((32u - ((uintptr_t)dst & 31u)) & 31u), width);
+
+    SDL_memcpy(dst, src, (size_t)x);
+    for (; x + 32 <= width; x += 32) {
+        _mm256_stream_si256(
+            (__m256i *)(dst + x), _mm256_loadu_si256((const __m256i *)(src + x))
+        );
+    }
+    SDL_memcpy(dst + x, src + x, (size_t)(width - x));
+}
+
+/* Copy one row with AVX-512 non-temporal stores. */
+__attribute__((target("avx512f"))) static void
+vdi_stream_client__copy_stream_avx512(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    Sint32 x = SDL_min((Sint32)((64u - ((uintptr_t)dst & 63u)) & 63u), width);
+
+    SDL_memcpy(dst, src, (size_t)x);
+    for (; x + 64 <= width; x += 64) {
+        _mm512_stream_si512((void *)(dst + x), _mm512_loadu_si512((const void *)(src + x)));
+    }
+    SDL_memcpy(dst + x, src + x, (size_t)(width - x));
+}
+
+/* Down-convert one P010 row with SSE2, 16 samples per iteration. */
+__attribute__((target("sse2"))) static void
+vdi_stream_client__copy_p010_sse2(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    const __m128i bias = _mm_set1_epi16(0x80);
+    Sint32 x = 0;
+
+    for (; x + 16 <= width; x += 16) {
+        __m128i low = _mm_loadu_si128((const __m128i *)(src + x * 2));
+        __m128i high = _mm_loadu_si128((const __m128i *)(src + x * 2 + 16));
+
+        low = _mm_srli_epi16(_mm_adds_epu16(low, bias), 8);
+        high = _mm_srli_epi16(_mm_adds_epu16(high, bias), 8);
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_packus_epi16(low, high));
+    }
+    vdi_stream_client__copy_p010_scalar(dst + x, src + x * 2, width - x);
+}
+
+/* Down-convert one P010 row with AVX2, 32 samples per iteration. The pack
+ * works per 128-bit lane, so the quadwords are put back in order afterwards. */
+__attribute__((target("avx2"))) static void
+vdi_stream_client__copy_p010_avx2(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    const __m256i bias = _mm256_set1_epi16(0x80);
+    Sint32 x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m256i low = _mm256_loadu_si256((const __m256i *)(src + x * 2));
+        __m256i high = _mm256_loadu_si256((const __m256i *)(src + x * 2 + 32));
+
+        low = _mm256_srli_epi16(_mm256_adds_epu16(low, bias), 8);
+        high = _mm256_srli_epi16(_mm256_adds_epu16(high, bias), 8);
+        _mm256_storeu_si256(
+            (__m256i *)(dst + x),
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0))
+        );
+    }
+    vdi_stream_client__copy_p010_scalar(dst + x, src + x * 2, width - x);
+}
+
+/* Down-convert one P010 row with AVX-512BW, 32 samples per iteration. */
+__attribute__((target("avx512bw"))) static void
+vdi_stream_client__copy_p010_avx512(Uint8 *dst, const Uint8 *src, Sint32 width)
+{
+    const __m512i bias = _mm512_set1_epi16(0x80);
+    Sint32 x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m512i samples = _mm512_loadu_si512((const void *)(src + x * 2));
+
+        samples = _mm512_srli_epi16(_mm512_adds_epu16(samples, bias), 8);
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm512_cvtepi16_epi8(samples));
+    }
+    vdi_stream_client__copy_p010_scalar(dst + x, src + x * 2, width - x);
+}
+
+/* Round, scale and narrow two vectors of 32-bit channel sums to 16 bits. */
+__attribute__((target("sse2"))) static inline __m128i
+vdi_stream_client__copy_scale_sse2(__m128i low, __m128i high)
+{
+    const __m128i round = _mm_set1_epi32(VDI_STREAM_CLIENT_COPY_MATRIX_ROUND);
+
+    return _mm_packs_epi32(
+        _mm_srai_epi32(_mm_add_epi32(low, round), VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT),
+        _mm_srai_epi32(_mm_add_epi32(high, round), VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT)
+    );
+}
+
+/* Convert one YCbCr 4:4:4 row with SSE2, 8 pixels per iteration. Luma is
+ * interleaved with each chroma plane so one pmaddwd yields a channel sum. */
+__attribute__((target("sse2"))) static void
+vdi_stream_client__copy_yuv444_sse2(
+    Uint8 *dst, const Uint8 *const src[3], Sint32 width,
+    const struct vdi_stream_client__copy_matrix_s *matrix
+)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi8((char)0xff);
+    const __m128i y_offset = _mm_set1_epi16(matrix->y_offset);
+    const __m128i c_offset = _mm_set1_epi16(128);
+    const __m128i yu_b = _mm_set1_epi32(vdi_stream_client__copy_pair(matrix->y, matrix->b_u));
+    const __m128i yu_g = _mm_set1_epi32(vdi_stream_client__copy_pair(matrix->y, -matrix->g_u));
+    const __m128i yv_r = _mm_set1_epi32(vdi_stream_client__copy_pair(matrix->y, matrix->r_v));
+    const __m128i yv_g = _mm_set1_epi32(vdi_stream_client__copy_pair(0, -matrix->g_v));
+    Sint32 x = 0;
+
+    for (; x + 8 <= width; x += 8) {
+        __m128i y = _mm_sub_epi16(
+            _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src[0] + x)), zero), y_offset
+        );
+        __m128i u = _mm_sub_epi16(
+            _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src[1] + x)), zero), c_offset
+        );
+        __m128i v = _mm_sub_epi16(
+            _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src[2] + x)), zero), c_offset
+        );
+        __m128i yu_low = _mm_unpacklo_epi16(y, u);
+        __m128i yu_high = _mm_unpackhi_epi16(y, u);
+        __m128i yv_low = _mm_unpacklo_epi16(y, v);
+        __m128i yv_high = _mm_unpackhi_epi16(y, v);
+        __m128i b = vdi_stream_client__copy_scale_sse2(
+            _mm_madd_epi16(yu_low, yu_b), _mm_madd_epi16(yu_high, yu_b)
+        );
+        __m128i g = vdi_stream_client__copy_scale_sse2(
+            _mm_add_epi32(_mm_madd_epi16(yu_low, yu_g), _mm_madd_epi16(yv_low, yv_g)),
+            _mm_add_epi32(_mm_madd_epi16(yu_high, yu_g), _mm_madd_epi16(yv_high, yv_g))
+        );
+        __m128i r = vdi_stream_client__copy_scale_sse2(
+            _mm_madd_epi16(yv_low, yv_r), _mm_madd_epi16(yv_high, yv_r)
+        );
+        __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+        __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), alpha);
+
+        _mm_storeu_si128((__m128i *)(dst + x * 4), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128((__m128i *)(dst + x * 4 + 16), _mm_unpackhi_epi16(bg, ra));
+    }
+    if (x < width) {
+        const Uint8 *tail[3] = { src[0] + x, src[1] + x, src[2] + x };
+
+        vdi_stream_client__copy_yuv444_scalar(dst + x * 4, tail, width - x, matrix);
+    }
+}
+
+/* Round, scale and narrow two vectors of 32-bit channel sums to 16 bits. The
+ * pack interleaves the 128-bit lanes back into pixel order because the sums
+ * come from per-lane unpacks. */
+__attribute__((target("avx2"))) static inline __m256i
+vdi_stream_client__copy_scale_avx2(__m256i low, __m256i high)
+{
+    const __m256i round = _mm256_set1_epi32(VDI_STREAM_CLIENT_COPY_MATRIX_ROUND);
+
+    return _mm256_packs_epi32(
+        _mm256_srai_epi32(_mm256_add_epi32(low, round), VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT),
+        _mm256_srai_epi32(_mm256_add_epi32(high, round), VDI_STREAM_CLIENT_COPY_MATRIX_SHIFT)
+    );
+}
+
+/* Convert one YCbCr 4:4:4 row with AVX2, 16 pixels per iteration. The pixel
+ * halves end up in separate lanes and are put back in order when stored. */
+__attribute__((target("avx2"))) static void
+vdi_stream_client__copy_yuv444_avx2(
+    Uint8 *dst, const Uint8 *const src[3], Sint32 width,
+    const struct vdi_stream_client__copy_matrix_s *matrix
+)
+{
+    const __m256i alpha = _mm256_set1_epi8((char)0xff);
+    const __m256i y_offset = _mm256_set1_epi16(matrix->y_offset);
+    const __m256i c_offset = _mm256_set1_epi16(128);
+    const __m256i yu_b = _mm256_set1_epi32(vdi_stream_client__copy_pair(matrix->y, matrix->b_u));
+    const __m256i yu_g = _mm256_set1_epi32(vdi_stream_client__copy_pair(matrix->y, -matrix->g_u));
+    const __m256i yv_r = _mm256_set1_epi32(vdi_stream_client__copy_pair(matrix->y, matrix->r_v));
+    const __m256i yv_g = _mm256_set1_epi32(vdi_stream_client__copy_pair(0, -matrix->g_v));
+    Sint32 x = 0;
+
+    for (; x + 16 <= width; x += 16) {
+        __m256i y = _mm256_sub_epi16(
+            _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src[0] + x))), y_offset
+        );
+        __m256i u = _mm256_sub_epi16(
+            _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src[1] + x))), c_offset
+        );
+        __m256i v = _mm256_sub_epi16(
+            _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src[2] + x))), c_offset
+        );
+        __m256i yu_low = _mm256_unpacklo_epi16(y, u);
+        __m256i yu_high = _mm256_unpackhi_epi16(y, u);
+        __m256i yv_low = _mm256_unpacklo_epi16(y, v);
+        __m256i yv_high = _mm256_unpackhi_epi16(y, v);
+        __m256i b = vdi_stream_client__copy_scale_avx2(
+            _mm256_madd_epi16(yu_low, yu_b), _mm256_madd_epi16(yu_high, yu_b)
+        );
+        __m256i g = vdi_stream_client__copy_scale_avx2(
+            _mm256_add_epi32(_mm256_madd_epi16(yu_low, yu_g), _mm256_madd_epi16(yv_low, yv_g)),
+            _mm256_add_epi32(_mm256_madd_epi16(yu_high, yu_g), _mm256_madd_epi16(yv_high, yv_g))
+        );
+        __m256i r = vdi_stream_client__copy_scale_avx2(
+            _mm256_madd_epi16(yv_low, yv_r), _mm256_madd_epi16(yv_high, yv_r)
+        );
+        __m256i bg = _mm256_unpacklo_epi8(_mm256_packus_epi16(b, b), _mm256_packus_epi16(g, g));
+        __m256i ra = _mm256_unpacklo_epi8(_mm256_packus_epi16(r, r), alpha);
+        __m256i low = _mm256_unpacklo_epi16(bg, ra);
+        __m256i high = _mm256_unpackhi_epi16(bg, ra);
+
+        _mm256_storeu_si256((__m256i *)(dst + x * 4), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(
+            (__m256i *)(dst + x * 4 + 32), _mm256_permute2x128_si256(low, high, 0x31)
+        );
+    }
+    if (x < width) {
+        const Uint8 *tail[3] = { src[0] + x, src[1] + x, src[2] + x };
+
+        vdi_stream_client__copy_yuv444_scalar(dst + x * 4, tail, width - x, matrix);
+    }
+}
+
+#endif /* VDI_STREAM_CLIENT_COPY_X86 */
+
+/* Row kernels of every instruction set, indexed by vdi_copy_kernel_e. The
+ * YCbCr conversion has no AVX-512 variant and uses the AVX2 row there. */
+static const struct
+{
+    const char *name;
+    void (*stream_row)(Uint8 *dst, const Uint8 *src, Sint32 width);
+    void (*p010_row)(Uint8 *dst, const Uint8 *src, Sint32 width);
+    void (*yuv444_row)(
+        Uint8 *dst, const Uint8 *const src[3], Sint32 width,
+        const struct vdi_stream_client__copy_matrix_s *matrix
+    );
+} vdi_stream_client__copy_kernels[VDI_COPY_KERNEL_MAX] = {
+    { "scalar", vdi_stream_client__copy_row, vdi_stream_client__copy_p010_scalar,
+      vdi_stream_client__copy_yuv444_scalar },
+#ifdef VDI_STREAM_CLIENT_COPY_X86
+    { "sse2", vdi_stream_client__copy_stream_sse2, vdi_stream_client__copy_p010_sse2,
+      vdi_stream_client__copy_yuv444_sse2 },
+    { "avx2", vdi_stream_client__copy_stream_avx2, vdi_stream_client__copy_p010_avx2,
+      vdi_stream_client__copy_yuv444_avx2 },
+    { "avx512", vdi_stream_client__copy_stream_avx512, vdi_stream_client__copy_p010_avx512,
+      vdi_stream_client__copy_yuv444_avx2 },
+#else
+    { "sse2", NULL, NULL, NULL },
+    { "avx2", NULL, NULL, NULL },
+    { "avx512", NULL, NULL, NULL },
+#endif
+};
+
+/* selected kernels and the plane size from which plane copies stream. */
+static struct
+{
+    vdi_copy_kernel_e kernel;
+    size_t stream_bytes;
+} vdi_stream_client__copy = {
+    .kernel = VDI_COPY_KERNEL_SCALAR,
+    .stream_bytes = VDI_STREAM_CLIENT_COPY_STREAM_BYTES,
+};
+
+/* Report whether the CPU supports the instruction set of a kernel. */
+static bool
+vdi_stream_client__copy_supported(vdi_copy_kernel_e kernel)
+{
+    switch (kernel) {
+    case VDI_COPY_KERNEL_SCALAR:
+        return true;
+#ifdef VDI_STREAM_CLIENT_COPY_X86
+    case VDI_COPY_KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case VDI_COPY_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case VDI_COPY_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    default:
+        return false;
+    }
+}
+
+/* Run the row kernel over one band and drain pending non-temporal stores, so
+ * the rows are visible to other threads once the band is reported done. */
+static void
+vdi_stream_client__copy_band(const struct vdi_stream_client__copy_band_s *band)
+{
+    for (Sint32 y = 0; y < band->rows; y++) {
+        Uint8 *dst = band->dst + (ptrdiff_t)y * band->dst_pitch;
+
+        if (band->yuv_row != NULL) {
+            const Uint8 *src[3] = {
+                band->src[0] + (ptrdiff_t)y * band->src_pitch[0],
+                band->src[1] + (ptrdiff_t)y * band->src_pitch[1],
+                band->src[2] + (ptrdiff_t)y * band->src_pitch[2],
+            };
+
+            band->yuv_row(dst, src, band->width, band->matrix);
+        } else {
+            band->row(dst, band->src[0] + (ptrdiff_t)y * band->src_pitch[0], band->width);
+        }
+    }
+#ifdef VDI_STREAM_CLIENT_COPY_X86
+    _mm_sfence();
+#endif
+}
+
+/* Pool job converting the index-th band of a plane. The plane rows are split
+ * into bands of band_rows rows. */
+static void
+vdi_stream_client__copy_job(void *data, Sint32 index, Sint32 thread)
+{
+    const struct vdi_stream_client__copy_band_s *plane = data;
+    struct vdi_stream_client__copy_band_s band = *plane;
+    Sint32 first = plane->band_rows * index;
+
+    (void)thread;
+    if (first >= plane->rows) {
+        return;
+    }
+    band.rows = SDL_min(plane->band_rows, plane->rows - first);
+    band.dst += (ptrdiff_t)first * band.dst_pitch;
+    for (size_t j = 0; j < 3 && band.src[j] != NULL; j++) {
+        band.src[j] += (ptrdiff_t)first * band.src_pitch[j];
+    }
+    vdi_stream_client__copy_band(&band);
+}
+
+/* Apply a row kernel to a whole plane. Planes writing 4K worth of bytes are
+ * split into row bands run on the worker pool. More than four bands gain
+ * nothing once memory bandwidth is saturated. */
+static void
+vdi_stream_client__copy_run(struct vdi_stream_client__copy_band_s band, size_t bytes)
+{
+    Sint32 bands = SDL_min((Sint32)vdi_stream_client__pool_threads(), VDI_STREAM_CLIENT_COPY_BANDS);
+
+    if (bands == 1 || bytes < VDI_STREAM_CLIENT_COPY_BAND_BYTES) {
+        vdi_stream_client__copy_band(&band);
+        return;
+    }
+    band.band_rows = (band.rows + bands - 1) / bands;
+    vdi_stream_client__pool_run(vdi_stream_client__copy_job, &band, bands, bands);
+}
+
+/* Select the fastest kernel the CPU supports. Band splitting uses the worker
+ * pool, which must be started first. */
+bool
+vdi_stream_client__copy_init(void)
+{
+    vdi_stream_client__copy_select(vdi_stream_client__copy_best());
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Use %s plane copy kernels\n",
+        vdi_stream_client__copy_name(vdi_stream_client__copy.kernel)
+    );
+    return true;
+}
+
+/* Switch to the kernels of one instruction set. The benchmark uses this to
+ * compare every supported kernel with the scalar reference. */
+bool
+vdi_stream_client__copy_select(vdi_copy_kernel_e kernel)
+{
+    if (kernel >= VDI_COPY_KERNEL_MAX || !vdi_stream_client__copy_supported(kernel)) {
+        return false;
+    }
+    vdi_stream_client__copy.kernel = kernel;
+    return true;
+}
+
+/* Set the plane size in bytes from which plane copies use the non-temporal
+ * stores of the selected kernel instead of the C library, and return the
+ * previous size. The benchmark and the tests pass zero to run the kernels on
+ * planes of any size. */
+size_t
+vdi_stream_client__copy_stream_threshold(size_t bytes)
+{
+    size_t previous = vdi_stream_client__copy.stream_bytes;
+
+    vdi_stream_client__copy.stream_bytes = bytes;
+    return previous;
+}
+
+/* Return the widest kernel the CPU supports, detected with cpuid. */
+vdi_copy_kernel_e
+vdi_stream_client__copy_best(void)
+{
+    for (Sint32 kernel = VDI_COPY_KERNEL_MAX - 1; kernel > VDI_COPY_KERNEL_SCALAR; kernel--) {
+        if (vdi_stream_client__copy_supported((vdi_copy_kernel_e)kernel)) {
+            return (vdi_copy_kernel_e)kernel;
+        }
+    }
+    return VDI_COPY_KERNEL_SCALAR;
+}
+
+/* Return the printable name of a kernel. */
+const char *
+vdi_stream_client__copy_name(vdi_copy_kernel_e kernel)
+{
+    return kernel < VDI_COPY_KERNEL_MAX ? vdi_stream_client__copy_kernels[kernel].name : "unknown";
+}
+
+/* Copy a plane of 8-bit samples between pitched buffers. Small planes use the C
+ * library copy, in one call when both pitches match, and large planes the
+ * non-temporal stores of the selected kernel. */
+void
+vdi_stream_client__copy_plane(
+    Uint8 *dst, Sint32 dst_pitch, const Uint8 *src, Sint32 src_pitch, Sint32 width, Sint32 height
+)
+{
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    if (dst_pitch == src_pitch && dst_pitch >= width &&
+        (size_t)width * (size_t)height < vdi_stream_client__copy.stream_bytes) {
+        SDL_memcpy(dst, src, (size_t)dst_pitch * (size_t)(height - 1) + (size_t)width);
+        return;
+    }
+    vdi_stream_client__copy_run(
+        (struct vdi_stream_client__copy_band_s){
+            .row = (size_t)width * (size_t)height < vdi_stream_client__copy.stream_bytes
+                       ? vdi_stream_client__copy_row
+                       : vdi_stream_client__copy_kernels[vdi_stream_client__copy.kernel].stream_row,
+            .dst = dst,
+            .dst_pitch = dst_pitch,
+            .src = { src },
+            .src_pitch = { src_pitch },
+            .width = width,
+            .rows = height,
+        },
+        (size_t)width * (size_t)height
+    );
+}
+
+/* Down-convert a plane of P010 samples to 8 bits. The width counts samples, so
+ * the interleaved chroma plane of a frame passes twice its chroma width. */
+void
+vdi_stream_client__copy_p010_nv12(
+    Uint8 *dst, Sint32 dst_pitch, const Uint8 *src, Sint32 src_pitch, Sint32 width, Sint32 height
+)
+{
+    vdi_stream_client__copy_run(
+        (struct vdi_stream_client__copy_band_s){
+            .row = vdi_stream_client__copy_kernels[vdi_stream_client__copy.kernel].p010_row,
+            .dst = dst,
+            .dst_pitch = dst_pitch,
+            .src = { src },
+            .src_pitch = { src_pitch },
+            .width = width,
+            .rows = height,
+        },
+        (size_t)width * (size_t)height
+    );
+}
+
+/* Convert 8-bit YCbCr 4:4:4 planes to XRGB8888 with the BT.601 or BT.709
+ * matrix in limited or full range. The conversion costs far more than a copy,
+ * so the band split is sized by the four output bytes per pixel. */
+void
+vdi_stream_client__copy_yuv444_xrgb(
+    Uint8 *dst, Sint32 dst_pitch, const Uint8 *const src[3], const Sint32 src_pitch[3],
+    Sint32 width, Sint32 height, bool bt709, bool full_range
+)
+{
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    vdi_stream_client__copy_run(
+        (struct vdi_stream_client__copy_band_s){
+            .yuv_row = vdi_stream_client__copy_kernels[vdi_stream_client__copy.kernel].yuv444_row,
+            .matrix = &vdi_stream_client__copy_matrices[bt709][full_range],
+            .dst = dst,
+            .dst_pitch = dst_pitch,
+            .src = { src[0], src[1], src[2] },
+            .src_pitch = { src_pitch[0], src_pitch[1], src_pitch[2] },
+            .width = width,
+            .rows = height,
+        },
+        (size_t)width * (size_t)height * 4
+    );
+}
+
+/* Fall back to the scalar kernels and the default stream threshold. */
+void
+vdi_stream_client__copy_destroy(void)
+{
+    vdi_stream_client__copy.kernel = VDI_COPY_KERNEL_SCALAR;
+    vdi_stream_client__copy.stream_bytes = VDI_STREAM_CLIENT_COPY_STREAM_BYTES;
+}
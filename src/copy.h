@@ -0,0 +1,56 @@
+/*
+ *  copy.h -- accelerated video plane copy kernels
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_COPY_H
+#define VDI_STREAM_CLIENT_COPY_H
+
+/* sdl includes. */
+#include <SDL3/SDL.h>
+
+typedef enum
+{
+    VDI_COPY_KERNEL_SCALAR,
+    VDI_COPY_KERNEL_SSE2,
+    VDI_COPY_KERNEL_AVX2,
+    VDI_COPY_KERNEL_AVX512,
+    VDI_COPY_KERNEL_MAX,
+} vdi_copy_kernel_e;
+
+/* plane copy kernels. */
+bool vdi_stream_client__copy_init(void);
+bool vdi_stream_client__copy_select(vdi_copy_kernel_e kernel);
+size_t vdi_stream_client__copy_stream_threshold(size_t bytes);
+vdi_copy_kernel_e vdi_stream_client__copy_best(void);
+const char *vdi_stream_client__copy_name(vdi_copy_kernel_e kernel);
+void vdi_stream_client__copy_plane(
+    Uint8 *dst, Sint32 dst_pitch, const Uint8 *src, Sint32 src_pitch, Sint32 width, Sint32 height
+);
+void vdi_stream_client__copy_p010_nv12(
+    Uint8 *dst, Sint32 dst_pitch, const Uint8 *src, Sint32 src_pitch, Sint32 width, Sint32 height
+);
+void vdi_stream_client__copy_yuv444_xrgb(
+    Uint8 *dst, Sint32 dst_pitch, const Uint8 *const src[3], const Sint32 src_pitch[3],
+    Sint32 width, Sint32 height, bool bt709, bool full_range
+);
+void vdi_stream_client__copy_destroy(void);
+
+#endif /* VDI_STREAM_CLIENT_COPY_H */
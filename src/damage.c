@@ -0,0 +1,583 @@
+/*
+ *  damage.c -- damage tracking for partial texture uploads
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "client.h"
+#include "damage.h"
+#include "parsec.h"
+#include "pool.h"
+
+/* system includes. */
+#include <stdint.h>
+
+/* simd includes. */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VDI_STREAM_CLIENT_DAMAGE_X86 1
+#endif
+
+/* define damage tracking defaults. */
+#define VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH 64
+#define VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT 16
+#define VDI_STREAM_CLIENT_DAMAGE_MAX_RECTS 16
+#define VDI_STREAM_CLIENT_DAMAGE_FULL_SHARE 2
+#define VDI_STREAM_CLIENT_DAMAGE_BYPASS_FRAMES 15
+#define VDI_STREAM_CLIENT_DAMAGE_BAND_BYTES (8u * 1024u * 1024u)
+#define VDI_STREAM_CLIENT_DAMAGE_BANDS 4
+#define VDI_STREAM_CLIENT_DAMAGE_MIX 0x9e3779b1u
+#define VDI_STREAM_CLIENT_DAMAGE_SEED 0x243f6a8885a308d3u
+
+/* damage tracking state. */
+struct vdi_stream_client__damage_s
+{
+
+    /* tile hash kernel. */
+    Uint64 (*hash)(const Uint8 *src, Sint32 pitch, Sint32 bytes, Sint32 rows);
+    const char *kernel;
+
+    /* tile hashes of the frame the texture holds, and per tile row the first
+     * and last dirty column of the current frame or -1 while clean. */
+    Uint64 *tiles;
+    Sint32 *spans;
+    Sint32 columns;
+    Sint32 rows;
+    Sint32 width;
+    Sint32 height;
+    Uint32 layout;
+    bool valid;
+    Uint32 bypass;
+    SDL_Rect rects[VDI_STREAM_CLIENT_DAMAGE_MAX_RECTS];
+
+    /* per-period stats. */
+    Uint64 stats_full;
+    Uint64 stats_partial;
+    Uint64 stats_unchanged;
+    Uint64 stats_rects;
+    Uint64 stats_bytes;
+    Uint64 stats_frame_bytes;
+    Uint64 stats_hashes;
+    Uint64 stats_hash_ns;
+};
+
+/* One band of tile rows hashed by the calling thread or a pool worker. */
+struct vdi_stream_client__damage_job_s
+{
+    struct vdi_stream_client__damage_s *damage;
+    const struct vdi_stream_client__damage_plane_s *planes;
+    Sint32 plane_count;
+    Sint32 band_rows;
+    Uint64 dirty[VDI_STREAM_CLIENT_DAMAGE_BANDS];
+};
+
+/* Advance one 64-bit hash lane: the low half is multiplied and the high half
+ * carried in, which the SIMD kernels compute with one widening multiply. */
+static inline Uint64
+vdi_stream_client__damage_lane(Uint64 lane)
+{
+    return (lane & 0xffffffffu) * VDI_STREAM_CLIENT_DAMAGE_MIX + (lane >> 32);
+}
+
+/* Finalize a 64-bit value with the splitmix64 mixer. */
+static inline Uint64
+vdi_stream_client__damage_mix(Uint64 value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9u;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebu;
+    return value ^ (value >> 31);
+}
+
+/* Hash the bytes of a row that do not fill a 32-byte block, eight at a time. */
+static Uint64
+vdi_stream_client__damage_tail(Uint64 tail, const Uint8 *src, Sint32 bytes)
+{
+    for (Sint32 x = 0; x < bytes; x += 8) {
+        Uint64 value = 0;
+
+        SDL_memcpy(&value, src + x, (size_t)SDL_min(bytes - x, 8));
+        tail = vdi_stream_client__damage_lane(tail ^ value);
+    }
+    return tail;
+}
+
+/* Fold the four block lanes and the tail lane into the tile hash. */
+static Uint64
+vdi_stream_client__damage_fold(const Uint64 lanes[4], Uint64 tail)
+{
+    for (size_t i = 0; i < 4; i++) {
+        tail = vdi_stream_client__damage_mix(tail ^ lanes[i]);
+    }
+    return tail;
+}
+
+/* Hash a tile of one plane in four lanes over 32-byte blocks. This is the
+ * reference every SIMD kernel must match exactly. */
+static Uint64
+vdi_stream_client__damage_hash_scalar(const Uint8 *src, Sint32 pitch, Sint32 bytes, Sint32 rows)
+{
+    Uint64 lanes[4] = {
+        VDI_STREAM_CLIENT_DAMAGE_SEED, VDI_STREAM_CLIENT_DAMAGE_SEED + 1,
+        VDI_STREAM_CLIENT_DAMAGE_SEED + 2, VDI_STREAM_CLIENT_DAMAGE_SEED + 3
+    };
+    Sint32 blocks = bytes & ~31;
+    Uint64 tail = VDI_STREAM_CLIENT_DAMAGE_SEED;
+
+    for (Sint32 y = 0; y < rows; y++) {
+        const Uint8 *row = src + (ptrdiff_t)y * pitch;
+
+        for (Sint32 x = 0; x < blocks; x += 32) {
+            for (size_t i = 0; i < 4; i++) {
+                Uint64 value;
+
+                SDL_memcpy(&value, row + x + i * 8, sizeof(value));
+                lanes[i] = vdi_stream_client__damage_lane(lanes[i] ^ value);
+            }
+        }
+        tail = vdi_stream_client__damage_tail(tail, row + blocks, bytes - blocks);
+    }
+    return vdi_stream_client__damage_fold(lanes, tail);
+}
+
+#ifdef VDI_STREAM_CLIENT_DAMAGE_X86
+
+/* Hash a tile with the four lanes split over two SSE2 registers. */
+__attribute__((target("sse2"))) static Uint64
+vdi_stream_client__damage_hash_sse2(const Uint8 *src, Sint32 pitch, Sint32 bytes, Sint32 rows)
+{
+    const __m128i mix = _mm_set1_epi64x(VDI_STREAM_CLIENT_DAMAGE_MIX);
+    __m128i low = _mm_set_epi64x(VDI_STREAM_CLIENT_DAMAGE_SEED + 1, VDI_STREAM_CLIENT_DAMAGE_SEED);
+    __m128i high =
+        _mm_set_epi64x(VDI_STREAM_CLIENT_DAMAGE_SEED + 3, VDI_STREAM_CLIENT_DAMAGE_SEED + 2);
+    Sint32 blocks = bytes & ~31;
+    Uint64 tail = VDI_STREAM_CLIENT_DAMAGE_SEED;
+    Uint64 lanes[4];
+
+    for (Sint32 y = 0; y < rows; y++) {
+        const Uint8 *row = src + (ptrdiff_t)y * pitch;
+
+        for (Sint32 x = 0; x < blocks; x += 32) {
+            low = _mm_xor_si128(low, _mm_loadu_si128((const __m128i *)(row + x)));
+            high = _mm_xor_si128(high, _mm_loadu_si128((const __m128i *)(row + x + 16)));
+            low = _mm_add_epi64(_mm_mul_epu32(low, mix), _mm_srli_epi64(low, 32));
+            high = _mm_add_epi64(_mm_mul_epu32(high, mix), _mm_srli_epi64(high, 32));
+        }
+        tail = vdi_stream_client__damage_tail(tail, row + blocks, bytes - blocks);
+    }
+    _mm_storeu_si128((__m128i *)&lanes[0], low);
+    _mm_storeu_si128((__m128i *)&lanes[2], high);
+    return vdi_stream_client__damage_fold(lanes, tail);
+}
+
+/* Hash a tile with the four lanes in one AVX2 register. */
+__attribute__((target("avx2"))) static Uint64
+vdi_stream_client__damage_hash_avx2(const Uint8 *src, Sint32 pitch, Sint32 bytes, Sint32 rows)
+{
+    const __m256i mix = _mm256_set1_epi64x(VDI_STREAM_CLIENT_DAMAGE_MIX);
+    __m256i acc = _mm256_set_epi64x(
+        VDI_STREAM_CLIENT_DAMAGE_SEED + 3, VDI_STREAM_CLIENT_DAMAGE_SEED + 2,
+        VDI_STREAM_CLIENT_DAMAGE_SEED + 1, VDI_STREAM_CLIENT_DAMAGE_SEED
+    );
+    Sint32 blocks = bytes & ~31;
+    Uint64 tail = VDI_STREAM_CLIENT_DAMAGE_SEED;
+    Uint64 lanes[4];
+
+    for (Sint32 y = 0; y < rows; y++) {
+        const Uint8 *row = src + (ptrdiff_t)y * pitch;
+
+        for (Sint32 x = 0; x < blocks; x += 32) {
+            acc = _mm256_xor_si256(acc, _mm256_loadu_si256((const __m256i *)(row + x)));
+            acc = _mm256_add_epi64(_mm256_mul_epu32(acc, mix), _mm256_srli_epi64(acc, 32));
+        }
+        tail = vdi_stream_client__damage_tail(tail, row + blocks, bytes - blocks);
+    }
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    return vdi_stream_client__damage_fold(lanes, tail);
+}
+
+#endif /* VDI_STREAM_CLIENT_DAMAGE_X86 */
+
+/* Count the bytes of all planes covering an area of luma pixels. */
+static Uint64
+vdi_stream_client__damage_bytes(
+    const struct vdi_stream_client__damage_plane_s *planes, Sint32 plane_count, Sint32 width,
+    Sint32 height
+)
+{
+    Uint64 bytes = 0;
+
+    for (Sint32 i = 0; i < plane_count; i++) {
+        Sint32 plane_width = (width + (1 << planes[i].shift_x) - 1) >> planes[i].shift_x;
+        Sint32 plane_height = (height + (1 << planes[i].shift_y) - 1) >> planes[i].shift_y;
+
+        bytes += (Uint64)plane_width * (Uint64)plane_height * planes[i].sample_bytes;
+    }
+    return bytes;
+}
+
+/* Size the tile grid for a frame. A new size or plane layout invalidates the
+ * stored hashes. */
+static bool
+vdi_stream_client__damage_resize(
+    struct vdi_stream_client__damage_s *damage,
+    const struct vdi_stream_client__damage_plane_s *planes, Sint32 plane_count, Sint32 width,
+    Sint32 height
+)
+{
+    Sint32 columns = (width + VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH - 1) /
+                     VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH;
+    Sint32 rows = (height + VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT - 1) /
+                  VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT;
+    Uint32 layout = (Uint32)plane_count;
+    Uint64 *tiles;
+    Sint32 *spans;
+
+    for (Sint32 i = 0; i < plane_count; i++) {
+        layout = layout * 64u + planes[i].shift_x + planes[i].shift_y * 2u +
+                 planes[i].sample_bytes * 4u;
+    }
+    if (damage->tiles != NULL && damage->width == width && damage->height == height &&
+        damage->layout == layout) {
+        return true;
+    }
+
+    tiles = SDL_realloc(damage->tiles, (size_t)columns * (size_t)rows * sizeof(*tiles));
+    if (tiles == NULL) {
+        return false;
+    }
+    damage->tiles = tiles;
+    spans = SDL_realloc(damage->spans, (size_t)rows * 2 * sizeof(*spans));
+    if (spans == NULL) {
+        return false;
+    }
+    damage->spans = spans;
+    damage->columns = columns;
+    damage->rows = rows;
+    damage->width = width;
+    damage->height = height;
+    damage->layout = layout;
+    damage->valid = false;
+    return true;
+}
+
+/* Hash the tiles of a range of tile rows, store the new hashes and record the
+ * dirty column span of every row. Returns the number of dirty tiles. */
+static Uint64
+vdi_stream_client__damage_rows(
+    struct vdi_stream_client__damage_s *damage,
+    const struct vdi_stream_client__damage_plane_s *planes, Sint32 plane_count, Sint32 first,
+    Sint32 last
+)
+{
+    Uint64 dirty = 0;
+
+    for (Sint32 ty = first; ty < last; ty++) {
+        Sint32 *span = &damage->spans[ty * 2];
+
+        span[0] = -1;
+        span[1] = -1;
+        for (Sint32 tx = 0; tx < damage->columns; tx++) {
+            Uint64 *tile = &damage->tiles[(size_t)ty * (size_t)damage->columns + (size_t)tx];
+            Uint64 hash = VDI_STREAM_CLIENT_DAMAGE_SEED;
+
+            for (Sint32 i = 0; i < plane_count; i++) {
+                const struct vdi_stream_client__damage_plane_s *plane = &planes[i];
+                Sint32 plane_width = (damage->width + (1 << plane->shift_x) - 1) >> plane->shift_x;
+                Sint32 plane_height =
+                    (damage->height + (1 << plane->shift_y) - 1) >> plane->shift_y;
+                Sint32 x0 = (tx * VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH) >> plane->shift_x;
+                Sint32 x1 = SDL_min(
+                    ((tx + 1) * VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH) >> plane->shift_x, plane_width
+                );
+                Sint32 y0 = (ty * VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT) >> plane->shift_y;
+                Sint32 y1 = SDL_min(
+                    ((ty + 1) * VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT) >> plane->shift_y,
+                    plane_height
+                );
+
+                hash = vdi_stream_client__damage_mix(
+                    hash ^ damage->hash(
+                               plane->data + (ptrdiff_t)y0 * plane->pitch +
+                                   (ptrdiff_t)x0 * plane->sample_bytes,
+                               plane->pitch, (x1 - x0) * plane->sample_bytes, y1 - y0
+                           )
+                );
+            }
+            if (damage->valid && *tile == hash) {
+                continue;
+            }
+            *tile = hash;
+            if (span[0] < 0) {
+                span[0] = tx;
+            }
+            span[1] = tx;
+            dirty++;
+        }
+    }
+    return dirty;
+}
+
+/* Pool job hashing the index-th band of tile rows. */
+static void
+vdi_stream_client__damage_job(void *data, Sint32 index, Sint32 thread)
+{
+    struct vdi_stream_client__damage_job_s *job = data;
+    Sint32 first = job->band_rows * index;
+
+    (void)thread;
+    job->dirty[index] = 0;
+    if (first >= job->damage->rows) {
+        return;
+    }
+    job->dirty[index] = vdi_stream_client__damage_rows(
+        job->damage, job->planes, job->plane_count, first,
+        SDL_min(first + job->band_rows, job->damage->rows)
+    );
+}
+
+/* Merge the dirty spans of consecutive tile rows into rectangles. Once the
+ * rectangle budget is spent, further damage grows the last rectangle. Returns
+ * the number of rectangles. */
+static Sint32
+vdi_stream_client__damage_rects(struct vdi_stream_client__damage_s *damage)
+{
+    Sint32 count = 0;
+    bool open = false;
+
+    for (Sint32 ty = 0; ty < damage->rows; ty++) {
+        const Sint32 *span = &damage->spans[ty * 2];
+        Sint32 x;
+        Sint32 y;
+        Sint32 right;
+        Sint32 bottom;
+
+        if (span[0] < 0) {
+            open = false;
+            continue;
+        }
+        x = span[0] * VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH;
+        y = ty * VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT;
+        right = SDL_min((span[1] + 1) * VDI_STREAM_CLIENT_DAMAGE_TILE_WIDTH, damage->width);
+        bottom = SDL_min(y + VDI_STREAM_CLIENT_DAMAGE_TILE_HEIGHT, damage->height);
+        if (open || count == VDI_STREAM_CLIENT_DAMAGE_MAX_RECTS) {
+            SDL_Rect *rect = &damage->rects[count - 1];
+
+            right = SDL_max(rect->x + rect->w, right);
+            rect->x = SDL_min(rect->x, x);
+            rect->w = right - rect->x;
+            rect->h = bottom - rect->y;
+        } else {
+            damage->rects[count++] = (SDL_Rect){ x, y, right - x, bottom - y };
+        }
+        open = true;
+    }
+    return count;
+}
+
+/* Allocate the damage tracking state and select the widest tile hash kernel
+ * the CPU supports. */
+bool
+vdi_stream_client__damage_init(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__damage_s *damage;
+
+    damage = SDL_calloc(1, sizeof(*damage));
+    if (damage == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate damage tracking state\n");
+        return false;
+    }
+    damage->hash = vdi_stream_client__damage_hash_scalar;
+    damage->kernel = "scalar";
+#ifdef VDI_STREAM_CLIENT_DAMAGE_X86
+    if (__builtin_cpu_supports("avx2")) {
+        damage->hash = vdi_stream_client__damage_hash_avx2;
+        damage->kernel = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        damage->hash = vdi_stream_client__damage_hash_sse2;
+        damage->kernel = "sse2";
+    }
+#endif
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Use %s damage tracking tile hashes\n", damage->kernel
+    );
+    parsec_context->damage = damage;
+    return true;
+}
+
+/* Compare a frame with the frame the texture holds by hashing tiles of 64x16
+ * pixels. Returns the number of dirty rectangles to upload, zero for an
+ * unchanged frame, or -1 when the whole frame must be uploaded: without stored
+ * hashes, without tracking state, or when most of the frame changed. Frames
+ * changing almost entirely, such as video playback, skip hashing for a while. */
+Sint32
+vdi_stream_client__damage_detect(
+    struct vdi_stream_client__damage_s *damage,
+    const struct vdi_stream_client__damage_plane_s *planes, Sint32 plane_count, Sint32 width,
+    Sint32 height, const SDL_Rect **rects
+)
+{
+    struct vdi_stream_client__damage_job_s job;
+    Uint64 frame_bytes;
+    Uint64 hash_start_ns;
+    Uint64 dirty = 0;
+    Uint64 bytes = 0;
+    Sint32 bands;
+    Sint32 count;
+    bool valid;
+
+    if (damage == NULL || width <= 0 || height <= 0) {
+        return -1;
+    }
+
+    frame_bytes = vdi_stream_client__damage_bytes(planes, plane_count, width, height);
+    damage->stats_frame_bytes += frame_bytes;
+    if (damage->bypass > 0 ||
+        !vdi_stream_client__damage_resize(damage, planes, plane_count, width, height)) {
+        damage->bypass -= damage->bypass > 0 ? 1 : 0;
+        damage->valid = false;
+        goto full;
+    }
+
+    hash_start_ns = SDL_GetTicksNS();
+    job = (struct vdi_stream_client__damage_job_s){
+        .damage = damage,
+        .planes = planes,
+        .plane_count = plane_count,
+        .band_rows = damage->rows,
+    };
+    bands = SDL_min((Sint32)vdi_stream_client__pool_threads(), VDI_STREAM_CLIENT_DAMAGE_BANDS);
+    if (bands == 1 || frame_bytes < VDI_STREAM_CLIENT_DAMAGE_BAND_BYTES) {
+        bands = 1;
+    }
+    job.band_rows = (damage->rows + bands - 1) / bands;
+    vdi_stream_client__pool_run(vdi_stream_client__damage_job, &job, bands, bands);
+    for (Sint32 i = 0; i < bands; i++) {
+        dirty += job.dirty[i];
+    }
+    damage->stats_hashes++;
+    damage->stats_hash_ns += SDL_GetTicksNS() - hash_start_ns;
+
+    valid = damage->valid;
+    damage->valid = true;
+    if (!valid) {
+        goto full;
+    }
+    if (dirty * 8 >= (Uint64)damage->columns * (Uint64)damage->rows * 7) {
+        damage->bypass = VDI_STREAM_CLIENT_DAMAGE_BYPASS_FRAMES;
+        damage->valid = false;
+        goto full;
+    }
+
+    count = vdi_stream_client__damage_rects(damage);
+    if (count == 0) {
+        damage->stats_unchanged++;
+        return 0;
+    }
+    for (Sint32 i = 0; i < count; i++) {
+        bytes += vdi_stream_client__damage_bytes(
+            planes, plane_count, damage->rects[i].w, damage->rects[i].h
+        );
+    }
+    if (bytes * VDI_STREAM_CLIENT_DAMAGE_FULL_SHARE > frame_bytes) {
+        goto full;
+    }
+
+    damage->stats_partial++;
+    damage->stats_rects += (Uint64)count;
+    damage->stats_bytes += bytes;
+    *rects = damage->rects;
+    return count;
+
+full:
+    damage->stats_full++;
+    damage->stats_bytes += frame_bytes;
+    return -1;
+}
+
+/* Forget the stored hashes after the texture was recreated or written without
+ * damage tracking, so the next frame is uploaded whole. */
+void
+vdi_stream_client__damage_reset(struct vdi_stream_client__damage_s *damage)
+{
+    if (damage != NULL) {
+        damage->valid = false;
+    }
+}
+
+/* Print how frames were uploaded during the stats period and the bytes
+ * uploaded per frame next to the bytes of a whole frame. */
+void
+vdi_stream_client__damage_stats(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__damage_s *damage = parsec_context->damage;
+    Uint64 frames;
+
+    if (damage == NULL) {
+        return;
+    }
+
+    frames = damage->stats_full + damage->stats_partial + damage->stats_unchanged;
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Damage:\n"
+        "  frames: full=%llu, partial=%llu, unchanged=%llu, rects=%llu\n"
+        "  upload: per_frame=%.1fKiB, whole_frame=%.1fKiB, saved=%.1f%%\n"
+        "  hash: kernel=%s, calls=%llu, avg=%.3fms\n",
+        (unsigned long long)damage->stats_full, (unsigned long long)damage->stats_partial,
+        (unsigned long long)damage->stats_unchanged, (unsigned long long)damage->stats_rects,
+        frames != 0 ? (double)damage->stats_bytes / (double)frames / 1024.0 : 0.0,
+        frames != 0 ? (double)damage->stats_frame_bytes / (double)frames / 1024.0 : 0.0,
+        damage->stats_frame_bytes != 0
+            ? 100.0 - (double)damage->stats_bytes * 100.0 / (double)damage->stats_frame_bytes
+            : 0.0,
+        damage->kernel, (unsigned long long)damage->stats_hashes,
+        damage->stats_hashes != 0
+            ? (double)damage->stats_hash_ns / (double)damage->stats_hashes / 1000000.0
+            : 0.0
+    );
+
+    damage->stats_full = 0;
+    damage->stats_partial = 0;
+    damage->stats_unchanged = 0;
+    damage->stats_rects = 0;
+    damage->stats_bytes = 0;
+    damage->stats_frame_bytes = 0;
+    damage->stats_hashes = 0;
+    damage->stats_hash_ns = 0;
+}
+
+/* Release the tile hashes and the damage tracking state. */
+void
+vdi_stream_client__damage_destroy(struct parsec_context_s *parsec_context)
+{
+    if (parsec_context->damage != NULL) {
+        SDL_free(parsec_context->damage->tiles);
+        SDL_free(parsec_context->damage->spans);
+    }
+    SDL_free(parsec_context->damage);
+    parsec_context->damage = NULL;
+}
@@ -0,0 +1,52 @@
+/*
+ *  damage.h -- damage tracking for partial texture uploads
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_DAMAGE_H
+#define VDI_STREAM_CLIENT_DAMAGE_H
+
+/* internal includes. */
+#include "client.h"
+#include "parsec.h"
+
+/* One plane of a frame checked for damage. Chroma planes are subsampled by
+ * the shifts, and interleaved or packed planes have several sample bytes. */
+struct vdi_stream_client__damage_plane_s
+{
+    const Uint8 *data;
+    Sint32 pitch;
+    Uint8 shift_x;
+    Uint8 shift_y;
+    Uint8 sample_bytes;
+};
+
+/* damage tracking. */
+bool vdi_stream_client__damage_init(struct parsec_context_s *parsec_context);
+Sint32 vdi_stream_client__damage_detect(
+    struct vdi_stream_client__damage_s *damage,
+    const struct vdi_stream_client__damage_plane_s *planes, Sint32 plane_count, Sint32 width,
+    Sint32 height, const SDL_Rect **rects
+);
+void vdi_stream_client__damage_reset(struct vdi_stream_client__damage_s *damage);
+void vdi_stream_client__damage_stats(struct parsec_context_s *parsec_context);
+void vdi_stream_client__damage_destroy(struct parsec_context_s *parsec_context);
+
+#endif /* VDI_STREAM_CLIENT_DAMAGE_H */
@@ -0,0 +1,352 @@
+/*
+ *  degrade.c -- load-adaptive decoder degradation ladder
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "client.h"
+#include "degrade.h"
+#include "ffmpeg.h"
+#include "parsec.h"
+
+/* ffmpeg includes. */
+#include <libavcodec/avcodec.h>
+
+/* define degradation ladder defaults. */
+#define VDI_STREAM_CLIENT_DEGRADE_WINDOW_MS 1000
+#define VDI_STREAM_CLIENT_DEGRADE_MIN_FRAMES 10
+#define VDI_STREAM_CLIENT_DEGRADE_OVERLOAD 0.90
+#define VDI_STREAM_CLIENT_DEGRADE_UNDERLOAD 0.60
+#define VDI_STREAM_CLIENT_DEGRADE_QUEUED_FRAMES 2
+#define VDI_STREAM_CLIENT_DEGRADE_UP_WINDOWS 2
+#define VDI_STREAM_CLIENT_DEGRADE_DOWN_WINDOWS 5
+#define VDI_STREAM_CLIENT_DEGRADE_DOWN_WINDOWS_MAX 80
+#define VDI_STREAM_CLIENT_DEGRADE_SCALE_NUM 3
+#define VDI_STREAM_CLIENT_DEGRADE_SCALE_DEN 4
+
+/* One rung of the ladder. Loop filter rungs are skipped while VA-API decodes,
+ * because hardware decoders ignore the loop filter discard level. The loop
+ * filter is only ever skipped on non-reference frames, as skipping it on
+ * reference frames corrupts every picture predicted from them until the next
+ * keyframe, which an infinite GOP never sends. Parsec's low-latency streams
+ * carry no non-reference frames at all, so there the loop filter rung saves
+ * nothing and only the host resolution rung relieves the decoder. Skipping
+ * non-reference frames is not a rung for the same reason. */
+struct vdi_stream_client__degrade_rung_s
+{
+    const char *name;
+    enum AVDiscard skip_loop_filter;
+    bool software_only;
+    bool resolution;
+};
+
+/* Ladder rungs from full quality to the cheapest stream. */
+static const struct vdi_stream_client__degrade_rung_s vdi_stream_client__degrade_rungs[] = {
+    { "full quality", AVDISCARD_DEFAULT, false, false },
+    { "no loop filter on non-reference frames", AVDISCARD_NONREF, true, false },
+    { "reduced host resolution", AVDISCARD_NONREF, false, true },
+};
+
+/* degradation ladder state. */
+struct vdi_stream_client__degrade_s
+{
+
+    /* ladder position and hysteresis. */
+    vdi_degradation_e mode;
+    Uint32 rung;
+    Uint32 overloaded_windows;
+    Uint32 underloaded_windows;
+    Uint32 hold_windows;
+    Uint32 windows_since_restore;
+    Uint64 window_start_ns;
+    Uint32 queued_max;
+
+    /* host resolution override, zero while the host picks the resolution. The
+     * base is the window size outside the override, which the window keeps
+     * while the renderer scales the smaller stream up. */
+    Sint32 base_width;
+    Sint32 base_height;
+    Sint32 width;
+    Sint32 height;
+
+    /* last evaluated window and per-period stats. */
+    double load;
+    Uint32 load_queued_max;
+    Uint64 load_dropped;
+    Uint64 stats_steps_up;
+    Uint64 stats_steps_down;
+};
+
+/* Find the next rung in a direction that applies to the active decoder and
+ * degradation mode. Returns the current rung if there is none. */
+static Uint32
+vdi_stream_client__degrade_next(const struct vdi_stream_client__degrade_s *degrade, bool up)
+{
+    bool hardware = vdi_stream_client__parsec_ffmpeg_decoder_is_hardware();
+    Sint32 rung = (Sint32)degrade->rung;
+
+    for (rung += up ? 1 : -1;
+         rung >= 0 && rung < (Sint32)SDL_arraysize(vdi_stream_client__degrade_rungs);
+         rung += up ? 1 : -1) {
+        const struct vdi_stream_client__degrade_rung_s *next =
+            &vdi_stream_client__degrade_rungs[rung];
+
+        if (next->resolution && degrade->mode != VDI_DEGRADATION_RESOLUTION) {
+            break;
+        }
+        if (!next->software_only || !hardware || rung == 0) {
+            return (Uint32)rung;
+        }
+    }
+    return degrade->rung;
+}
+
+/* Move to another rung, publish its discard level to the decoder and manage
+ * the host resolution override. Climbing again shortly after a restore doubles
+ * the number of calm windows required before the next restore. */
+static void
+vdi_stream_client__degrade_step(struct vdi_stream_client__degrade_s *degrade, Uint32 rung)
+{
+    const struct vdi_stream_client__degrade_rung_s *next = &vdi_stream_client__degrade_rungs[rung];
+    bool up = rung > degrade->rung;
+
+    if (up && degrade->windows_since_restore < degrade->hold_windows) {
+        degrade->hold_windows =
+            SDL_min(degrade->hold_windows * 2, VDI_STREAM_CLIENT_DEGRADE_DOWN_WINDOWS_MAX);
+    }
+    if (!up) {
+        degrade->windows_since_restore = 0;
+    }
+
+    if (next->resolution) {
+        degrade->width = (degrade->base_width * VDI_STREAM_CLIENT_DEGRADE_SCALE_NUM /
+                          VDI_STREAM_CLIENT_DEGRADE_SCALE_DEN) &
+                         ~7;
+        degrade->height = (degrade->base_height * VDI_STREAM_CLIENT_DEGRADE_SCALE_NUM /
+                           VDI_STREAM_CLIENT_DEGRADE_SCALE_DEN) &
+                          ~7;
+    } else if (degrade->width != 0) {
+        degrade->width = degrade->base_width;
+        degrade->height = degrade->base_height;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "%s decoding to %s: load=%.2f, queued_max=%u, dropped=%llu, restore_after=%us\n",
+        up ? "Degrade" : "Restore", next->name, degrade->load, degrade->load_queued_max,
+        (unsigned long long)degrade->load_dropped,
+        degrade->hold_windows * VDI_STREAM_CLIENT_DEGRADE_WINDOW_MS / 1000
+    );
+    if (next->resolution) {
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION, "Request host resolution %dx%d instead of %dx%d\n",
+            degrade->width, degrade->height, degrade->base_width, degrade->base_height
+        );
+    }
+
+    vdi_stream_client__parsec_ffmpeg_discard(next->skip_loop_filter);
+    degrade->rung = rung;
+    degrade->overloaded_windows = 0;
+    degrade->underloaded_windows = 0;
+    if (up) {
+        degrade->stats_steps_up++;
+    } else {
+        degrade->stats_steps_down++;
+    }
+}
+
+/* Initialize the degradation ladder at full quality and start accounting the
+ * decoder load. */
+bool
+vdi_stream_client__degrade_init(
+    struct parsec_context_s *parsec_context, vdi_degradation_e degradation
+)
+{
+    if (degradation == VDI_DEGRADATION_NONE) {
+        return true;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Initialize degradation ladder with %s\n",
+        degradation == VDI_DEGRADATION_RESOLUTION ? "decoder and host resolution"
+                                                  : "decoder only"
+    );
+    parsec_context->degrade = SDL_calloc(1, sizeof(*parsec_context->degrade));
+    if (parsec_context->degrade == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate degradation state\n");
+        return false;
+    }
+    parsec_context->degrade->mode = degradation;
+    parsec_context->degrade->hold_windows = VDI_STREAM_CLIENT_DEGRADE_DOWN_WINDOWS;
+    vdi_stream_client__parsec_ffmpeg_discard(AVDISCARD_DEFAULT);
+    vdi_stream_client__parsec_ffmpeg_load_enable(true);
+    return true;
+}
+
+/* Evaluate the decoder once per window. The client is overloaded when the
+ * decode callback is busy for most of the wall time or frames queue up in front
+ * of the decoder. Decoded frames superseded before the renderer takes them are
+ * only reported, because a slow present or display supersedes them just as
+ * well and degrading the decoder would not help there. It climbs after
+ * consecutive overloaded windows and restores one rung after a longer run of
+ * calm windows. */
+void
+vdi_stream_client__degrade_update(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__degrade_s *degrade = parsec_context->degrade;
+    const ParsecMetrics *metrics = &parsec_context->client_status.self.metrics[DEFAULT_STREAM];
+    Uint64 frames;
+    Uint64 decode_ns;
+    Uint64 dropped;
+    Uint64 now;
+    bool overloaded;
+    bool underloaded;
+
+    if (degrade == NULL || !vdi_stream_client__context_connected(parsec_context) ||
+        !parsec_context->decoder) {
+        return;
+    }
+
+    /* The override ends once the host runs at the restored resolution again.
+     * Outside the override the window follows the host, so it is the base. */
+    if (degrade->width != 0 && !vdi_stream_client__degrade_rungs[degrade->rung].resolution &&
+        parsec_context->client_status.decoder[DEFAULT_STREAM].width == degrade->base_width &&
+        parsec_context->client_status.decoder[DEFAULT_STREAM].height == degrade->base_height) {
+        degrade->width = 0;
+        degrade->height = 0;
+    }
+    if (degrade->width == 0) {
+        degrade->base_width = parsec_context->window_width;
+        degrade->base_height = parsec_context->window_height;
+    }
+
+    degrade->queued_max = SDL_max(degrade->queued_max, metrics->queuedFrames);
+    now = SDL_GetTicksNS();
+    if (degrade->window_start_ns == 0) {
+        vdi_stream_client__parsec_ffmpeg_drain_load(&frames, &decode_ns, &dropped);
+        degrade->window_start_ns = now;
+        degrade->queued_max = 0;
+        return;
+    }
+    if (now - degrade->window_start_ns < (Uint64)VDI_STREAM_CLIENT_DEGRADE_WINDOW_MS * 1000000) {
+        return;
+    }
+
+    vdi_stream_client__parsec_ffmpeg_drain_load(&frames, &decode_ns, &dropped);
+    degrade->load = (double)decode_ns / (double)(now - degrade->window_start_ns);
+    degrade->load_queued_max = degrade->queued_max;
+    degrade->load_dropped = dropped;
+    degrade->window_start_ns = now;
+    degrade->queued_max = 0;
+    if (degrade->windows_since_restore < UINT32_MAX) {
+        degrade->windows_since_restore++;
+    }
+    if (degrade->rung == 0 &&
+        degrade->windows_since_restore >= VDI_STREAM_CLIENT_DEGRADE_DOWN_WINDOWS_MAX) {
+        degrade->hold_windows = VDI_STREAM_CLIENT_DEGRADE_DOWN_WINDOWS;
+    }
+
+    /* An idle host delivers too few frames to judge, which counts as calm. */
+    overloaded = frames >= VDI_STREAM_CLIENT_DEGRADE_MIN_FRAMES &&
+                 (degrade->load > VDI_STREAM_CLIENT_DEGRADE_OVERLOAD ||
+                  degrade->load_queued_max >= VDI_STREAM_CLIENT_DEGRADE_QUEUED_FRAMES);
+    underloaded = degrade->load < VDI_STREAM_CLIENT_DEGRADE_UNDERLOAD &&
+                  degrade->load_queued_max == 0;
+
+    if (overloaded) {
+        degrade->underloaded_windows = 0;
+        if (++degrade->overloaded_windows >= VDI_STREAM_CLIENT_DEGRADE_UP_WINDOWS &&
+            vdi_stream_client__degrade_next(degrade, true) != degrade->rung) {
+            vdi_stream_client__degrade_step(
+                degrade, vdi_stream_client__degrade_next(degrade, true)
+            );
+        }
+    } else if (underloaded) {
+        degrade->overloaded_windows = 0;
+        if (++degrade->underloaded_windows >= degrade->hold_windows &&
+            vdi_stream_client__degrade_next(degrade, false) != degrade->rung) {
+            vdi_stream_client__degrade_step(
+                degrade, vdi_stream_client__degrade_next(degrade, false)
+            );
+        }
+    } else {
+        degrade->overloaded_windows = 0;
+        degrade->underloaded_windows = 0;
+    }
+}
+
+/* Return the host resolution requested by the reduced resolution rung, or
+ * false while the host resolution follows the window. */
+bool
+vdi_stream_client__degrade_dimensions(
+    struct parsec_context_s *parsec_context, Sint32 *width, Sint32 *height
+)
+{
+    const struct vdi_stream_client__degrade_s *degrade = parsec_context->degrade;
+
+    if (degrade == NULL || degrade->width == 0 || degrade->height == 0) {
+        return false;
+    }
+    *width = degrade->width;
+    *height = degrade->height;
+    return true;
+}
+
+/* Print the ladder position, the last evaluated window and the steps taken
+ * during the stats period. */
+void
+vdi_stream_client__degrade_stats(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__degrade_s *degrade = parsec_context->degrade;
+
+    if (degrade == NULL) {
+        return;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Degradation:\n"
+        "  ladder: level=%s, steps_up=%llu, steps_down=%llu, restore_after=%us\n"
+        "  load: decode=%.2f, queued_max=%u, dropped=%llu\n",
+        vdi_stream_client__degrade_rungs[degrade->rung].name,
+        (unsigned long long)degrade->stats_steps_up, (unsigned long long)degrade->stats_steps_down,
+        degrade->hold_windows * VDI_STREAM_CLIENT_DEGRADE_WINDOW_MS / 1000, degrade->load,
+        degrade->load_queued_max, (unsigned long long)degrade->load_dropped
+    );
+
+    degrade->stats_steps_up = 0;
+    degrade->stats_steps_down = 0;
+}
+
+/* Stop accounting decoder load and release the degradation ladder state. */
+void
+vdi_stream_client__degrade_destroy(struct parsec_context_s *parsec_context)
+{
+    if (parsec_context->degrade != NULL) {
+        vdi_stream_client__parsec_ffmpeg_load_enable(false);
+    }
+    SDL_free(parsec_context->degrade);
+    parsec_context->degrade = NULL;
+}
@@ -13,13 +13,20 @@
  */
 
 #include "ffmpeg.h"
+#include "cache.h"
 #include "client.h"
+#include "copy.h"
+#include "damage.h"
+#include "pool.h"
+#include "shadow.h"
 
 #include <libavcodec/avcodec.h>
 #include <libavutil/avutil.h>
+#include <libavutil/buffer.h>
 #include <libavutil/frame.h>
 #include <libavutil/hwcontext.h>
 #include <libavutil/hwcontext_vaapi.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/pixdesc.h>
 #include <libavutil/pixfmt.h>
 #include <limits.h>
@@ -52,18 +59,51 @@
 #define VDI_STREAM_CLIENT_PARSEC_FFMPEG_DECODER_INDEX 2u
 #define VDI_STREAM_CLIENT_PARSEC_MAX_FRAME_BUFFER 0x1fa4000u
 #define VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_MAGIC 0x56444646u
-#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_VERSION 1u
-#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS 16u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_VERSION 2u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS 3u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE 0u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_H264 0x1u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_HEVC 0x2u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_HEVC444 0x4u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY 1u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_HELD 2u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER 3u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_STATE(generation, owner) \
+    (((Uint64)(generation) << 2) | (owner))
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_BOUNDED_FRAME_THREADS 2
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_DROP 0u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_CONCEAL 1u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_RESYNC 2u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_FATAL 3u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_PACKETS 3u
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_RESYNC_MS 2000
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_REPORT_MS 500
+#define VDI_STREAM_CLIENT_PARSEC_FFMPEG_BUFFER_ALIGN 64
 
 /* The public Parsec frame callback only carries a raw image pointer. For FFmpeg
  * frames, carry a small descriptor through that buffer so the renderer can
  * upload directly from retained AVFrame planes instead of copying them into a
- * second contiguous ParsecFrame image first. */
+ * second contiguous ParsecFrame image first. The slots form a lock-free
+ * latest-frame-wins mailbox: the state word packs the frame generation with
+ * the owner, a free slot belongs to the decoder, a ready slot is published and
+ * can be taken by the renderer, and a held slot belongs to the renderer. Every
+ * held slot counts as a reference to its decoder, so a decoder torn down while
+ * the renderer uploads stays allocated until that slot is released. */
 struct vdi_stream_client__parsec_ffmpeg_frame_slot_s
 {
-    SDL_Mutex *lock;
+    atomic_uint_fast64_t state;
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *decoder;
     AVFrame *frame;
-    Uint64 generation;
+    size_t bytes;
+    bool retained;
+    bool hardware;
+    Uint8 *band_pixels;
+    size_t band_size;
+    Sint32 band_pitch;
+    Sint32 band_width;
+    Sint32 band_height;
+    SDL_PixelFormat band_format;
+    bool band_ready;
 };
 
 struct vdi_stream_client__parsec_ffmpeg_frame_descriptor_s
@@ -85,11 +125,28 @@ struct vdi_stream_client__parsec_ffmpeg_decoder_s
     enum AVPixelFormat hw_pix_fmt;
     bool hwaccel;
     bool mode_published;
-    SDL_Mutex *frame_lock;
     struct vdi_stream_client__parsec_ffmpeg_frame_slot_s
         frame_slots[VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS];
+    atomic_uintptr_t frame_latest;
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *frame_held;
+    atomic_int refs;
     Uint64 frame_generation;
-    Uint32 frame_slot;
+    const void *pool_frames_context;
+    Uint32 pipeline_depth;
+    AVFrame *upload_frame;
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *band_slot;
+    const Uint8 *band_data;
+    atomic_int band_rows;
+    bool resync;
+    Uint64 resync_start_ns;
+    Uint32 error_packets;
+    Uint64 error_start_ns;
+    Uint64 error_mark_ns;
+    Uint64 error_report_ns;
+    AVBufferPool *buffer_pool;
+    size_t buffer_size;
+    Uint32 buffer_generation;
+    SDL_SpinLock buffer_lock;
 };
 
 static atomic_bool vdi_stream_client__parsec_ffmpeg_stats_enabled;
@@ -102,12 +159,75 @@ static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_hwframe_transfer_ca
 static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_hwframe_transfer_ns;
 static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_descriptor_fallback_calls;
 static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_descriptor_fallback_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pipeline_frames;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pipeline_depth;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pipeline_depth_max;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_frame_allocations;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_frames_dropped;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_retained_frames;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_retained_hardware_frames;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_retained_bytes;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pool_surfaces;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pool_bytes;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_decoder_inits;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_decoder_init_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_device_reuses;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_context_reuses;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pool_reuses;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_reuse_saved_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_decode_errors;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_decode_flushes;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_resync_dropped;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_recoveries;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_error_ns;
+static atomic_bool vdi_stream_client__parsec_ffmpeg_load_enabled;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_load_frames;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_load_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_load_dropped;
+static atomic_int vdi_stream_client__parsec_ffmpeg_skip_loop_filter;
+static atomic_bool vdi_stream_client__parsec_ffmpeg_progressive;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_band_calls;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_band_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_band_frames;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_band_incomplete;
 static atomic_bool vdi_stream_client__parsec_ffmpeg_hardware_active;
 static atomic_bool vdi_stream_client__parsec_ffmpeg_h264_acceleration;
 static atomic_bool vdi_stream_client__parsec_ffmpeg_hevc_acceleration;
 static atomic_bool vdi_stream_client__parsec_ffmpeg_color444;
+static atomic_uint vdi_stream_client__parsec_ffmpeg_threads;
+static atomic_int vdi_stream_client__parsec_ffmpeg_thread_type;
+static atomic_uint vdi_stream_client__parsec_ffmpeg_active_threads;
+static atomic_bool vdi_stream_client__parsec_ffmpeg_active_frame_threads;
+
+/* Optional allocator backing the software frame pools, registered by a renderer
+ * that can read decoded planes straight from its own buffers. The generation
+ * counts registrations, so pools filled by another provider are rebuilt. */
+static SDL_SpinLock vdi_stream_client__parsec_ffmpeg_buffer_provider_lock;
+static AVBufferRef *(*vdi_stream_client__parsec_ffmpeg_buffer_provider_alloc)(size_t size);
+static atomic_uint vdi_stream_client__parsec_ffmpeg_buffer_provider_generation;
+
+/* Process-wide VA-API state which outlives single decoder instances. Parsec
+ * reinitializes its decoder on every resolution change, codec fallback and
+ * reconnect, so the device, the last surface pool and the last hardware codec
+ * context are kept here instead of being torn down with each decoder. The
+ * cold setup costs are remembered to account the time saved by reuse. */
+static SDL_SpinLock vdi_stream_client__parsec_ffmpeg_shared_lock;
+static AVBufferRef *vdi_stream_client__parsec_ffmpeg_shared_device;
+static AVBufferRef *vdi_stream_client__parsec_ffmpeg_shared_frames;
+static AVCodecContext *vdi_stream_client__parsec_ffmpeg_parked_codec;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_device_create_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_pool_create_ns;
+static atomic_uint_fast64_t vdi_stream_client__parsec_ffmpeg_codec_open_ns;
+
+static const Uint8 vdi_stream_client__parsec_ffmpeg_capture_uuid[16] = {
+    'v', 'd', 'i', '-', 's', 't', 'r', 'e', 'a', 'm', '-', 'c', 'l', 'o', 'c', 'k',
+};
 
 static const char *vdi_stream_client__parsec_ffmpeg_error(Sint32 errnum, char *buffer, size_t len);
+static void vdi_stream_client__parsec_ffmpeg_band(
+    AVCodecContext *codec, const AVFrame *src, int offset[AV_NUM_DATA_POINTERS], int y, int type,
+    int height
+);
 
 /* Return the CPU-visible pixel format for an AVFrame. VA-API frames expose this
  * through their hardware frames context, while software frames store it directly
@@ -128,16 +248,153 @@ vdi_stream_client__parsec_ffmpeg_frame_software_format(const AVFrame *frame)
     return frames_context != NULL ? frames_context->sw_format : AV_PIX_FMT_NONE;
 }
 
+/* Allocate one buffer for the software frame pool and count it as a frame
+ * allocation, so --stats and the tests see every buffer the pool creates. The
+ * registered buffer provider is asked first, heap memory is the fallback. */
+#if LIBAVUTIL_VERSION_MAJOR < 57
+static AVBufferRef *
+vdi_stream_client__parsec_ffmpeg_buffer_alloc(int size)
+#else
+static AVBufferRef *
+vdi_stream_client__parsec_ffmpeg_buffer_alloc(size_t size)
+#endif
+{
+    AVBufferRef *buffer = NULL;
+
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_frame_allocations, (uint_fast64_t)1, memory_order_relaxed
+    );
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_buffer_provider_lock);
+    if (vdi_stream_client__parsec_ffmpeg_buffer_provider_alloc != NULL) {
+        buffer = vdi_stream_client__parsec_ffmpeg_buffer_provider_alloc((size_t)size);
+    }
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_buffer_provider_lock);
+    return buffer != NULL ? buffer : av_buffer_alloc(size);
+}
+
+/* Back a software AVFrame of the given format and padded dimensions with one
+ * buffer from the decoder's frame pool. Planes start on aligned offsets with
+ * aligned pitches. The pool is rebuilt when the layout size or the buffer
+ * provider changes, so a session only allocates while the pool grows to the
+ * frames in flight. */
+static Sint32
+vdi_stream_client__parsec_ffmpeg_buffer_attach(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, AVFrame *frame, Sint32 width,
+    Sint32 height
+)
+{
+    const AVPixFmtDescriptor *descriptor = av_pix_fmt_desc_get((enum AVPixelFormat)frame->format);
+    int linesizes[4];
+    size_t offsets[4] = { 0 };
+    size_t size = 0;
+    AVBufferRef *buffer;
+    Uint32 generation;
+    Sint32 err;
+
+    if (descriptor == NULL ||
+        (descriptor->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL)) != 0) {
+        return AVERROR(EINVAL);
+    }
+    err = av_image_fill_linesizes(linesizes, (enum AVPixelFormat)frame->format, width);
+    if (err < 0) {
+        return err;
+    }
+    for (Sint32 i = 0; i < 4 && linesizes[i] > 0; i++) {
+        Sint32 rows = i == 1 || i == 2 ? AV_CEIL_RSHIFT(height, descriptor->log2_chroma_h) : height;
+
+        linesizes[i] = FFALIGN(linesizes[i], VDI_STREAM_CLIENT_PARSEC_FFMPEG_BUFFER_ALIGN);
+        offsets[i] = size;
+        size += FFALIGN(
+            (size_t)linesizes[i] * (size_t)rows + AV_INPUT_BUFFER_PADDING_SIZE,
+            (size_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_BUFFER_ALIGN
+        );
+    }
+
+    /* Frame threads call get_buffer2 concurrently. */
+    generation = atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_buffer_provider_generation, memory_order_relaxed
+    );
+    SDL_LockSpinlock(&ffmpeg->buffer_lock);
+    if (ffmpeg->buffer_pool == NULL || ffmpeg->buffer_size != size ||
+        ffmpeg->buffer_generation != generation) {
+        av_buffer_pool_uninit(&ffmpeg->buffer_pool);
+        ffmpeg->buffer_pool =
+            av_buffer_pool_init(size, vdi_stream_client__parsec_ffmpeg_buffer_alloc);
+        ffmpeg->buffer_size = size;
+        ffmpeg->buffer_generation = generation;
+    }
+    buffer = ffmpeg->buffer_pool != NULL ? av_buffer_pool_get(ffmpeg->buffer_pool) : NULL;
+    SDL_UnlockSpinlock(&ffmpeg->buffer_lock);
+    if (buffer == NULL) {
+        return AVERROR(ENOMEM);
+    }
+
+    frame->buf[0] = buffer;
+    for (Sint32 i = 0; i < 4; i++) {
+        frame->data[i] = linesizes[i] > 0 ? buffer->data + offsets[i] : NULL;
+        frame->linesize[i] = linesizes[i] > 0 ? linesizes[i] : 0;
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+/* FFmpeg get_buffer2 callback of software decoders. Pictures come from the
+ * decoder's frame pool, padded to the dimensions the codec asks for. Frames
+ * the pool cannot lay out use FFmpeg's default allocator. */
+static int
+vdi_stream_client__parsec_ffmpeg_get_buffer(AVCodecContext *codec, AVFrame *frame, int flags)
+{
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg = codec->opaque;
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    int width = frame->width;
+    int height = frame->height;
+
+    if (ffmpeg == NULL || (codec->codec->capabilities & AV_CODEC_CAP_DR1) == 0) {
+        return avcodec_default_get_buffer2(codec, frame, flags);
+    }
+    avcodec_align_dimensions2(codec, &width, &height, linesize_align);
+    if (vdi_stream_client__parsec_ffmpeg_buffer_attach(ffmpeg, frame, width, height) < 0) {
+        return avcodec_default_get_buffer2(codec, frame, flags);
+    }
+    return 0;
+}
+
 /* Transfer a hardware AVFrame into a software AVFrame and record timing
- * counters used by --stats. */
+ * counters used by --stats. A destination that still holds writable buffers of
+ * the same format and size is reused, so callers keeping one destination frame
+ * transfer without allocating once warmed up. FFmpeg only copies frame
+ * properties into destinations it allocates, so reused ones get them here. */
 Sint32
 vdi_stream_client__parsec_ffmpeg_hwframe_transfer(AVFrame *destination, const AVFrame *source)
 {
     bool stats_enabled =
         atomic_load_explicit(&vdi_stream_client__parsec_ffmpeg_stats_enabled, memory_order_relaxed);
-    Uint64 stage_start_ns = stats_enabled ? SDL_GetTicksNS() : 0;
-    Sint32 err = av_hwframe_transfer_data(destination, source, 0);
+    enum AVPixelFormat format = vdi_stream_client__parsec_ffmpeg_frame_software_format(source);
+    Uint64 stage_start_ns;
+    bool reused;
+    Sint32 err;
+
+    if (destination->buf[0] != NULL &&
+        (destination->format != format || destination->width != source->width ||
+         destination->height != source->height || !av_frame_is_writable(destination))) {
+        av_frame_unref(destination);
+    }
+    while (destination->nb_side_data > 0) {
+        av_frame_remove_side_data(destination, destination->side_data[0]->type);
+    }
+    reused = destination->buf[0] != NULL;
+    if (!reused) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_frame_allocations, (uint_fast64_t)1,
+            memory_order_relaxed
+        );
+    }
 
+    stage_start_ns = stats_enabled ? SDL_GetTicksNS() : 0;
+    err = av_hwframe_transfer_data(destination, source, 0);
+    if (err >= 0 && reused) {
+        err = av_frame_copy_props(destination, source);
+    }
     if (stats_enabled) {
         atomic_fetch_add_explicit(
             &vdi_stream_client__parsec_ffmpeg_hwframe_transfer_calls, (uint_fast64_t)1,
@@ -166,9 +423,159 @@ vdi_stream_client__parsec_ffmpeg_frame_descriptor(const ParsecFrame *frame, cons
     return descriptor;
 }
 
-/* Map supported FFmpeg pixel formats to Parsec and SDL formats. Planar 4:4:4 is
- * accepted only for descriptor-based paths because SDL has no direct texture
- * upload format for it here. */
+/* Estimate the memory kept alive by one retained AVFrame. Software frames report
+ * their referenced buffer sizes, while VA-API frames report the size of the
+ * surface layout they pin outside the decoder pool. */
+static size_t
+vdi_stream_client__parsec_ffmpeg_frame_bytes(const AVFrame *frame)
+{
+    size_t bytes = 0;
+    Sint32 surface_bytes;
+
+    if (frame == NULL) {
+        return 0;
+    }
+    if (frame->format == AV_PIX_FMT_VAAPI) {
+        surface_bytes = av_image_get_buffer_size(
+            vdi_stream_client__parsec_ffmpeg_frame_software_format(frame), frame->width,
+            frame->height, 1
+        );
+        return surface_bytes > 0 ? (size_t)surface_bytes : 0;
+    }
+
+    for (size_t i = 0; i < AV_NUM_DATA_POINTERS; i++) {
+        if (frame->buf[i] != NULL) {
+            bytes += frame->buf[i]->size;
+        }
+    }
+    for (Sint32 i = 0; i < frame->nb_extended_buf; i++) {
+        if (frame->extended_buf[i] != NULL) {
+            bytes += frame->extended_buf[i]->size;
+        }
+    }
+    return bytes;
+}
+
+/* Drop the references retained by a descriptor slot, keeping its AVFrame for
+ * reuse, and remove it from the memory gauges reported by --stats. Callers own
+ * the slot exclusively. */
+static void
+vdi_stream_client__parsec_ffmpeg_slot_clear(
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot
+)
+{
+    if (slot->retained) {
+        atomic_fetch_sub_explicit(
+            &vdi_stream_client__parsec_ffmpeg_retained_frames, (uint_fast64_t)1,
+            memory_order_relaxed
+        );
+        atomic_fetch_sub_explicit(
+            &vdi_stream_client__parsec_ffmpeg_retained_bytes, (uint_fast64_t)slot->bytes,
+            memory_order_relaxed
+        );
+        if (slot->hardware) {
+            atomic_fetch_sub_explicit(
+                &vdi_stream_client__parsec_ffmpeg_retained_hardware_frames, (uint_fast64_t)1,
+                memory_order_relaxed
+            );
+        }
+    }
+    if (slot->frame != NULL) {
+        av_frame_unref(slot->frame);
+    }
+    slot->bytes = 0;
+    slot->retained = false;
+    slot->hardware = false;
+    slot->band_ready = false;
+}
+
+/* Move a decoded AVFrame into the preallocated frame of a descriptor slot and
+ * add it to the memory gauges. The source is left blank. Callers own the slot
+ * exclusively and have cleared the previous frame. */
+static void
+vdi_stream_client__parsec_ffmpeg_slot_store(
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot, AVFrame *frame, size_t bytes
+)
+{
+    av_frame_move_ref(slot->frame, frame);
+    slot->bytes = bytes;
+    slot->retained = true;
+    slot->hardware = slot->frame->format == AV_PIX_FMT_VAAPI;
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_retained_frames, (uint_fast64_t)1, memory_order_relaxed
+    );
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_retained_bytes, (uint_fast64_t)bytes,
+        memory_order_relaxed
+    );
+    if (slot->hardware) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_retained_hardware_frames, (uint_fast64_t)1,
+            memory_order_relaxed
+        );
+    }
+}
+
+/* Drop one reference to a decoder. The last one, left by teardown or by the
+ * release of a slot held across it, frees the slots, the renderer's upload
+ * scratch frame and the decoder itself. */
+static void
+vdi_stream_client__parsec_ffmpeg_unref(struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg)
+{
+    if (atomic_fetch_sub_explicit(&ffmpeg->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS; i++) {
+        vdi_stream_client__parsec_ffmpeg_slot_clear(&ffmpeg->frame_slots[i]);
+        av_frame_free(&ffmpeg->frame_slots[i].frame);
+        SDL_free(ffmpeg->frame_slots[i].band_pixels);
+    }
+    av_frame_free(&ffmpeg->upload_frame);
+    SDL_free(ffmpeg);
+}
+
+/* Publish the size of the VA-API surface pool behind a decoded frame. FFmpeg
+ * preallocates the decoder pool, so its surface count stays fixed until the
+ * codec renegotiates a new hardware frames context. */
+static void
+vdi_stream_client__parsec_ffmpeg_pool_update(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, const AVFrame *frame
+)
+{
+    const AVHWFramesContext *frames_context;
+    const AVVAAPIFramesContext *vaapi_frames;
+    Sint32 surface_bytes;
+    Uint64 surfaces;
+
+    if (frame->hw_frames_ctx == NULL || frame->hw_frames_ctx->data == NULL ||
+        ffmpeg->pool_frames_context == frame->hw_frames_ctx->data) {
+        return;
+    }
+
+    frames_context = (const AVHWFramesContext *)frame->hw_frames_ctx->data;
+    vaapi_frames = frames_context->hwctx;
+    surfaces = vaapi_frames != NULL && vaapi_frames->nb_surfaces > 0
+                   ? (Uint64)vaapi_frames->nb_surfaces
+                   : (Uint64)SDL_max(frames_context->initial_pool_size, 0);
+    surface_bytes = av_image_get_buffer_size(
+        frames_context->sw_format, frames_context->width, frames_context->height, 1
+    );
+    ffmpeg->pool_frames_context = frames_context;
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pool_surfaces, (uint_fast64_t)surfaces,
+        memory_order_relaxed
+    );
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pool_bytes,
+        (uint_fast64_t)(surfaces * (Uint64)SDL_max(surface_bytes, 0)), memory_order_relaxed
+    );
+}
+
+/* Map supported FFmpeg pixel formats to Parsec and SDL formats. SDL has no
+ * planar 4:4:4 texture format, so 8-bit 4:4:4 is converted into XRGB8888
+ * textures and deeper 4:4:4 formats are accepted only for descriptor-based
+ * paths. */
 static bool
 vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
     enum AVPixelFormat format, ParsecColorFormat *parsec_format, SDL_PixelFormat *sdl_format
@@ -196,6 +603,17 @@ vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
             *sdl_format = SDL_PIXELFORMAT_NV12;
         }
         return true;
+    case AV_PIX_FMT_YUV444P:
+#if LIBAVUTIL_VERSION_MAJOR < 59
+    case AV_PIX_FMT_YUVJ444P:
+#endif
+        if (parsec_format != NULL) {
+            *parsec_format = FORMAT_I444;
+        }
+        if (sdl_format != NULL) {
+            *sdl_format = SDL_PIXELFORMAT_XRGB8888;
+        }
+        return true;
     default:
         break;
     }
@@ -212,16 +630,20 @@ vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
     return sdl_format == NULL;
 }
 
-/* Resolve a descriptor to its retained AVFrame slot and hold the shared slot
- * mutex while the caller inspects or clones the frame. */
+/* Resolve a descriptor to the AVFrame the renderer holds for the current frame.
+ * The first call takes the described slot, or the newest published slot of the
+ * same size once the described one was superseded, and later calls reuse it
+ * until vdi_stream_client__parsec_ffmpeg_frame_release(). */
 static AVFrame *
-vdi_stream_client__parsec_ffmpeg_frame_lock(
+vdi_stream_client__parsec_ffmpeg_frame_hold(
     const ParsecFrame *frame, const void *image,
     struct vdi_stream_client__parsec_ffmpeg_frame_slot_s **slot_out
 )
 {
     const struct vdi_stream_client__parsec_ffmpeg_frame_descriptor_s *descriptor;
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg;
     struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
+    uint_fast64_t expected;
 
     if (slot_out != NULL) {
         *slot_out = NULL;
@@ -232,33 +654,60 @@ vdi_stream_client__parsec_ffmpeg_frame_lock(
     }
 
     slot = (struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *)(uintptr_t)descriptor->slot;
-    if (slot->lock != NULL) {
-        SDL_LockMutex(slot->lock);
+    ffmpeg = slot->decoder;
+    if (ffmpeg->frame_held != NULL) {
+        slot = ffmpeg->frame_held;
+        goto done;
     }
-    if (slot->generation != descriptor->generation || slot->frame == NULL) {
-        if (slot->lock != NULL) {
-            SDL_UnlockMutex(slot->lock);
-        }
+
+    expected = VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_STATE(
+        descriptor->generation, VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY
+    );
+    if (atomic_compare_exchange_strong_explicit(
+            &slot->state, &expected,
+            VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_STATE(
+                descriptor->generation, VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_HELD
+            ),
+            memory_order_acquire, memory_order_relaxed
+        )) {
+        atomic_fetch_add_explicit(&ffmpeg->refs, 1, memory_order_relaxed);
+        ffmpeg->frame_held = slot;
+        goto done;
+    }
+
+    /* The described frame was superseded, so present the newest one instead. */
+    slot = (struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *)atomic_load_explicit(
+        &ffmpeg->frame_latest, memory_order_acquire
+    );
+    if (slot == NULL) {
+        return NULL;
+    }
+    expected = atomic_load_explicit(&slot->state, memory_order_relaxed);
+    if ((expected & VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER) !=
+            VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY ||
+        (expected >> 2) < descriptor->generation ||
+        !atomic_compare_exchange_strong_explicit(
+            &slot->state, &expected,
+            (expected & ~(uint_fast64_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER) |
+                VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_HELD,
+            memory_order_acquire, memory_order_relaxed
+        )) {
+        return NULL;
+    }
+    if (slot->frame->width != (int)frame->width || slot->frame->height != (int)frame->height) {
+        atomic_store_explicit(&slot->state, expected, memory_order_release);
         return NULL;
     }
+    atomic_fetch_add_explicit(&ffmpeg->refs, 1, memory_order_relaxed);
+    ffmpeg->frame_held = slot;
 
+done:
     if (slot_out != NULL) {
         *slot_out = slot;
     }
     return slot->frame;
 }
 
-/* Release a frame slot lock acquired by vdi_stream_client__parsec_ffmpeg_frame_lock(). */
-static void
-vdi_stream_client__parsec_ffmpeg_frame_unlock(
-    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot
-)
-{
-    if (slot != NULL && slot->lock != NULL) {
-        SDL_UnlockMutex(slot->lock);
-    }
-}
-
 /* Report whether the frame/image pair carries an FFmpeg descriptor instead of a
  * raw Parsec image buffer. */
 bool
@@ -272,34 +721,54 @@ vdi_stream_client__parsec_ffmpeg_frame_is_descriptor(const ParsecFrame *frame, c
 bool
 vdi_stream_client__parsec_ffmpeg_frame_is_hardware(const ParsecFrame *frame, const void *image)
 {
-    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
     AVFrame *av_frame;
-    bool hardware;
 
-    av_frame = vdi_stream_client__parsec_ffmpeg_frame_lock(frame, image, &slot);
+    av_frame = vdi_stream_client__parsec_ffmpeg_frame_hold(frame, image, NULL);
     if (av_frame == NULL) {
         return false;
     }
-    hardware = av_frame->format == AV_PIX_FMT_VAAPI && av_frame->hw_frames_ctx != NULL;
-    vdi_stream_client__parsec_ffmpeg_frame_unlock(slot);
-    return hardware;
+    return av_frame->format == AV_PIX_FMT_VAAPI && av_frame->hw_frames_ctx != NULL;
 }
 
-/* Clone the retained AVFrame referenced by a descriptor. Callers own the
- * returned reference and can safely use it after the descriptor slot unlocks. */
+/* Take the retained AVFrame referenced by a descriptor without cloning it. The
+ * renderer owns the frame until vdi_stream_client__parsec_ffmpeg_frame_release()
+ * recycles its slot, and the decoder publishes into the other slots meanwhile. */
 AVFrame *
-vdi_stream_client__parsec_ffmpeg_frame_ref(const ParsecFrame *frame, const void *image)
+vdi_stream_client__parsec_ffmpeg_frame_acquire(const ParsecFrame *frame, const void *image)
 {
-    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
-    AVFrame *av_frame;
-    AVFrame *reference = NULL;
+    return vdi_stream_client__parsec_ffmpeg_frame_hold(frame, image, NULL);
+}
+
+/* Hold a descriptor-backed frame beyond the Parsec frame callback, which owns
+ * the descriptor buffer, by taking its slot now and copying the descriptor to
+ * caller storage. Later queries and the release go through the copy. Raw
+ * Parsec images are only valid inside the callback and can't be kept. */
+bool
+vdi_stream_client__parsec_ffmpeg_frame_keep(
+    const ParsecFrame *frame, const void *image, void *descriptor, size_t size
+)
+{
+    const struct vdi_stream_client__parsec_ffmpeg_frame_descriptor_s *source;
 
-    av_frame = vdi_stream_client__parsec_ffmpeg_frame_lock(frame, image, &slot);
-    if (av_frame != NULL) {
-        reference = av_frame_clone(av_frame);
-        vdi_stream_client__parsec_ffmpeg_frame_unlock(slot);
+    source = vdi_stream_client__parsec_ffmpeg_frame_descriptor(frame, image);
+    if (source == NULL || size < sizeof(*source) ||
+        vdi_stream_client__parsec_ffmpeg_frame_hold(frame, image, NULL) == NULL) {
+        return false;
     }
-    return reference;
+    SDL_memcpy(descriptor, source, sizeof(*source));
+    return true;
+}
+
+/* Query the SDL texture format required to upload a software AVFrame through
+ * the SDL renderer path. */
+bool
+vdi_stream_client__parsec_ffmpeg_avframe_texture_format(
+    const AVFrame *av_frame, SDL_PixelFormat *pixel_format
+)
+{
+    return vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
+        (enum AVPixelFormat)av_frame->format, NULL, pixel_format
+    );
 }
 
 /* Query the SDL texture format required to upload a descriptor-backed FFmpeg
@@ -309,61 +778,54 @@ vdi_stream_client__parsec_ffmpeg_frame_texture_format(
     const ParsecFrame *frame, const void *image, SDL_PixelFormat *pixel_format
 )
 {
-    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
     AVFrame *av_frame;
-    bool supported;
 
-    av_frame = vdi_stream_client__parsec_ffmpeg_frame_lock(frame, image, &slot);
+    av_frame = vdi_stream_client__parsec_ffmpeg_frame_hold(frame, image, NULL);
     if (av_frame == NULL) {
         return false;
     }
-
-    supported = vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
+    return vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
         vdi_stream_client__parsec_ffmpeg_frame_software_format(av_frame), NULL, pixel_format
     );
-    vdi_stream_client__parsec_ffmpeg_frame_unlock(slot);
-    return supported;
 }
 
-/* Upload a descriptor-backed FFmpeg frame into an SDL texture. Hardware frames
- * are transferred to a software AVFrame before SDL receives the planes. */
-bool
-vdi_stream_client__parsec_ffmpeg_frame_update(
-    SDL_Texture *texture, const ParsecFrame *frame, const void *image, Uint64 *upload_ns
-)
+/* Convert the planes of a software 4:4:4 AVFrame straight into the memory of
+ * a locked XRGB8888 streaming texture with the copy kernels. The BT.601 matrix
+ * SDL uses for YUV textures applies unless the frame is tagged BT.709. */
+static bool
+vdi_stream_client__parsec_ffmpeg_texture_write(SDL_Texture *texture, const AVFrame *av_frame)
 {
-    AVFrame *av_frame;
-    AVFrame *sw_frame = NULL;
-    Uint64 upload_start_ns;
-    Sint32 err;
-    char errbuf[AV_ERROR_MAX_STRING_SIZE];
-    bool ok = false;
-
-    av_frame = vdi_stream_client__parsec_ffmpeg_frame_ref(frame, image);
-    if (av_frame == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg frame descriptor is no longer valid\n");
+    const Uint8 *const planes[3] = { av_frame->data[0], av_frame->data[1], av_frame->data[2] };
+    Uint8 *pixels;
+    Sint32 pitch;
+    float width;
+    float height;
+
+    if (!SDL_GetTextureSize(texture, &width, &height) || (Sint32)width != av_frame->width ||
+        (Sint32)height != av_frame->height ||
+        !SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch)) {
         return false;
     }
+    vdi_stream_client__copy_yuv444_xrgb(
+        pixels, pitch, planes, av_frame->linesize, av_frame->width, av_frame->height,
+        av_frame->colorspace == AVCOL_SPC_BT709, av_frame->color_range == AVCOL_RANGE_JPEG
+    );
+    SDL_UnlockTexture(texture);
+    return true;
+}
 
-    if (av_frame->format == AV_PIX_FMT_VAAPI) {
-        sw_frame = av_frame_alloc();
-        if (sw_frame == NULL) {
-            goto done;
-        }
-        err = vdi_stream_client__parsec_ffmpeg_hwframe_transfer(sw_frame, av_frame);
-        if (err < 0) {
-            SDL_LogWarn(
-                SDL_LOG_CATEGORY_APPLICATION, "FFmpeg hardware frame transfer failed: %s\n",
-                vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
-            );
-            goto done;
-        }
-        av_frame_free(&av_frame);
-        av_frame = sw_frame;
-        sw_frame = NULL;
-    }
+/* Upload the planes of a software AVFrame into an SDL texture created with the
+ * format reported by vdi_stream_client__parsec_ffmpeg_frame_pixel_format().
+ * 4:2:0 planes go through the SDL update functions, which let the GL renderer
+ * upload from the decoder buffers without staging them in locked memory. */
+bool
+vdi_stream_client__parsec_ffmpeg_avframe_update(
+    SDL_Texture *texture, const AVFrame *av_frame, Uint64 *upload_ns
+)
+{
+    Uint64 upload_start_ns = upload_ns != NULL ? SDL_GetTicksNS() : 0;
+    bool ok = false;
 
-    upload_start_ns = upload_ns != NULL ? SDL_GetTicksNS() : 0;
     switch (av_frame->format) {
     case AV_PIX_FMT_YUV420P:
 #if LIBAVUTIL_VERSION_MAJOR < 59
@@ -384,52 +846,331 @@ vdi_stream_client__parsec_ffmpeg_frame_update(
             );
         }
         break;
+    case AV_PIX_FMT_YUV444P:
+#if LIBAVUTIL_VERSION_MAJOR < 59
+    case AV_PIX_FMT_YUVJ444P:
+#endif
+        if (av_frame->data[0] != NULL && av_frame->data[1] != NULL && av_frame->data[2] != NULL) {
+            ok = vdi_stream_client__parsec_ffmpeg_texture_write(texture, av_frame);
+        }
+        break;
     default:
         break;
     }
     if (upload_ns != NULL) {
         *upload_ns += SDL_GetTicksNS() - upload_start_ns;
     }
+    return ok;
+}
 
-done:
-    av_frame_free(&sw_frame);
-    av_frame_free(&av_frame);
-    if (!ok) {
-        SDL_LogError(
-            SDL_LOG_CATEGORY_APPLICATION, "Video texture update failed: %s\n", SDL_GetError()
+/* Upload one dirty rectangle of a software AVFrame. 4:4:4 frames are converted
+ * into the locked rectangle of the XRGB8888 texture, while 4:2:0 planes go
+ * through the SDL update functions, because the layout of a locked rectangle of
+ * a YUV texture depends on the renderer. */
+static bool
+vdi_stream_client__parsec_ffmpeg_rect_update(
+    SDL_Texture *texture, const AVFrame *av_frame, const SDL_Rect *rect
+)
+{
+    const Uint8 *luma = av_frame->data[0] + (ptrdiff_t)rect->y * av_frame->linesize[0] + rect->x;
+    Uint8 *pixels;
+    Sint32 pitch;
+
+    switch (av_frame->format) {
+    case AV_PIX_FMT_YUV420P:
+#if LIBAVUTIL_VERSION_MAJOR < 59
+    case AV_PIX_FMT_YUVJ420P:
+#endif
+        return SDL_UpdateYUVTexture(
+            texture, rect, luma, av_frame->linesize[0],
+            av_frame->data[1] + (ptrdiff_t)(rect->y / 2) * av_frame->linesize[1] + rect->x / 2,
+            av_frame->linesize[1],
+            av_frame->data[2] + (ptrdiff_t)(rect->y / 2) * av_frame->linesize[2] + rect->x / 2,
+            av_frame->linesize[2]
+        );
+    case AV_PIX_FMT_NV12:
+        return SDL_UpdateNVTexture(
+            texture, rect, luma, av_frame->linesize[0],
+            av_frame->data[1] + (ptrdiff_t)(rect->y / 2) * av_frame->linesize[1] + rect->x,
+            av_frame->linesize[1]
+        );
+    case AV_PIX_FMT_YUV444P:
+#if LIBAVUTIL_VERSION_MAJOR < 59
+    case AV_PIX_FMT_YUVJ444P:
+#endif
+        if (!SDL_LockTexture(texture, rect, (void **)&pixels, &pitch)) {
+            return false;
+        }
+        vdi_stream_client__copy_yuv444_xrgb(
+            pixels, pitch,
+            (const Uint8 *const[3]){
+                luma,
+                av_frame->data[1] + (ptrdiff_t)rect->y * av_frame->linesize[1] + rect->x,
+                av_frame->data[2] + (ptrdiff_t)rect->y * av_frame->linesize[2] + rect->x,
+            },
+            av_frame->linesize, rect->w, rect->h, av_frame->colorspace == AVCOL_SPC_BT709,
+            av_frame->color_range == AVCOL_RANGE_JPEG
         );
+        SDL_UnlockTexture(texture);
+        return true;
+    default:
+        return false;
     }
-    return ok;
 }
 
-/* Release the retained AVFrame slot after the renderer has consumed a
- * descriptor-backed frame. Raw Parsec image buffers are ignored. */
-void
-vdi_stream_client__parsec_ffmpeg_frame_release(const ParsecFrame *frame, const void *image)
+/* Upload only the tiles of a software AVFrame that changed since the frame the
+ * texture holds. Frames the damage tracker reports as mostly changed, formats
+ * without a rectangle upload and textures of another size are uploaded whole;
+ * the tracker forgets the texture whenever it can't vouch for its contents. */
+static bool
+vdi_stream_client__parsec_ffmpeg_damage_update(
+    SDL_Texture *texture, const AVFrame *av_frame, struct vdi_stream_client__damage_s *damage,
+    Uint64 *upload_ns
+)
 {
-    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
-    AVFrame *av_frame;
+    const AVPixFmtDescriptor *descriptor = av_pix_fmt_desc_get(av_frame->format);
+    struct vdi_stream_client__damage_plane_s planes[3];
+    const SDL_Rect *rects = NULL;
+    Uint64 upload_start_ns;
+    Sint32 plane_count = 0;
+    Sint32 count = -1;
+    float width;
+    float height;
+    bool ok = true;
 
-    av_frame = vdi_stream_client__parsec_ffmpeg_frame_lock(frame, image, &slot);
-    if (av_frame == NULL) {
-        return;
+    switch (av_frame->format) {
+    case AV_PIX_FMT_YUV420P:
+#if LIBAVUTIL_VERSION_MAJOR < 59
+    case AV_PIX_FMT_YUVJ420P:
+#endif
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_YUV444P:
+#if LIBAVUTIL_VERSION_MAJOR < 59
+    case AV_PIX_FMT_YUVJ444P:
+#endif
+        if (descriptor == NULL || !SDL_GetTextureSize(texture, &width, &height) ||
+            (Sint32)width != av_frame->width || (Sint32)height != av_frame->height) {
+            break;
+        }
+        for (; plane_count < 3 && av_frame->data[plane_count] != NULL; plane_count++) {
+            planes[plane_count] = (struct vdi_stream_client__damage_plane_s){
+                .data = av_frame->data[plane_count],
+                .pitch = av_frame->linesize[plane_count],
+                .shift_x = plane_count != 0 ? descriptor->log2_chroma_w : 0,
+                .shift_y = plane_count != 0 ? descriptor->log2_chroma_h : 0,
+                .sample_bytes = av_frame->format == AV_PIX_FMT_NV12 && plane_count != 0 ? 2 : 1,
+            };
+        }
+        count = vdi_stream_client__damage_detect(
+            damage, planes, plane_count, av_frame->width, av_frame->height, &rects
+        );
+        break;
+    default:
+        vdi_stream_client__damage_reset(damage);
+        break;
     }
 
-    (void)av_frame;
-    av_frame_free(&slot->frame);
-    slot->generation = 0;
-    vdi_stream_client__parsec_ffmpeg_frame_unlock(slot);
+    if (count < 0) {
+        ok = vdi_stream_client__parsec_ffmpeg_avframe_update(texture, av_frame, upload_ns);
+    } else {
+        upload_start_ns = upload_ns != NULL ? SDL_GetTicksNS() : 0;
+        for (Sint32 i = 0; i < count && ok; i++) {
+            ok = vdi_stream_client__parsec_ffmpeg_rect_update(texture, av_frame, &rects[i]);
+        }
+        if (upload_ns != NULL) {
+            *upload_ns += SDL_GetTicksNS() - upload_start_ns;
+        }
+    }
+    if (!ok) {
+        vdi_stream_client__damage_reset(damage);
+    }
+    return ok;
 }
 
-/* Atomically drain FFmpeg decoder counters into the caller's stats structure and
- * reset them for the next render statistics interval. */
-void
-vdi_stream_client__parsec_ffmpeg_drain_stats(struct vdi_stream_client__parsec_ffmpeg_stats_s *stats)
+/* Upload the row bands prepared while the frame was still decoding with one
+ * texture update. Returns false when the texture does not match the prepared
+ * layout, so the caller can upload the frame planes instead. */
+static bool
+vdi_stream_client__parsec_ffmpeg_band_update(
+    SDL_Texture *texture, const struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot,
+    Uint64 *upload_ns
+)
 {
-    if (stats == NULL) {
-        return;
-    }
-
+    Uint64 upload_start_ns = upload_ns != NULL ? SDL_GetTicksNS() : 0;
+    bool stats_enabled =
+        atomic_load_explicit(&vdi_stream_client__parsec_ffmpeg_stats_enabled, memory_order_relaxed);
+    bool ok;
+
+    if (texture->format != slot->band_format || texture->w != slot->band_width ||
+        texture->h != slot->band_height) {
+        return false;
+    }
+    ok = SDL_UpdateTexture(texture, NULL, slot->band_pixels, slot->band_pitch);
+    if (ok && stats_enabled) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_band_frames, (uint_fast64_t)1, memory_order_relaxed
+        );
+    }
+    if (upload_ns != NULL) {
+        *upload_ns += SDL_GetTicksNS() - upload_start_ns;
+    }
+    return ok;
+}
+
+/* Upload a descriptor-backed FFmpeg frame into an SDL texture. The retained
+ * frame is used in place, and hardware frames are transferred into the
+ * decoder's reusable upload frame before SDL receives the planes. With damage
+ * tracking only the changed parts of the frame are uploaded. */
+bool
+vdi_stream_client__parsec_ffmpeg_frame_update(
+    SDL_Texture *texture, const ParsecFrame *frame, const void *image,
+    struct vdi_stream_client__damage_s *damage, Uint64 *upload_ns
+)
+{
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
+    AVFrame *av_frame;
+    AVFrame *upload_frame;
+    Sint32 err;
+    char errbuf[AV_ERROR_MAX_STRING_SIZE];
+    bool ok = false;
+
+    av_frame = vdi_stream_client__parsec_ffmpeg_frame_hold(frame, image, &slot);
+    if (av_frame == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg frame descriptor is no longer valid\n");
+        return false;
+    }
+
+    /* Frames prepared band by band during decode only need the final upload. */
+    if (slot->band_ready &&
+        vdi_stream_client__parsec_ffmpeg_band_update(texture, slot, upload_ns)) {
+        vdi_stream_client__damage_reset(damage);
+        return true;
+    }
+
+    upload_frame = slot->decoder->upload_frame;
+    if (av_frame->format == AV_PIX_FMT_VAAPI) {
+        err = vdi_stream_client__parsec_ffmpeg_hwframe_transfer(upload_frame, av_frame);
+        if (err < 0) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION, "FFmpeg hardware frame transfer failed: %s\n",
+                vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
+            );
+            goto done;
+        }
+        ok = vdi_stream_client__parsec_ffmpeg_damage_update(
+            texture, upload_frame, damage, upload_ns
+        );
+    } else {
+        ok = vdi_stream_client__parsec_ffmpeg_damage_update(texture, av_frame, damage, upload_ns);
+    }
+
+done:
+    if (!ok) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Video texture update failed: %s\n", SDL_GetError()
+        );
+    }
+    return ok;
+}
+
+/* Read the host capture timestamp a cooperating encoder attached to the frame
+ * as user-data-unregistered SEI. The payload is a big-endian nanosecond value in
+ * the host clock domain following the "vdi-stream-clock" UUID. */
+bool
+vdi_stream_client__parsec_ffmpeg_frame_capture_ns(
+    const ParsecFrame *frame, const void *image, Uint64 *capture_ns
+)
+{
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(56, 70, 100)
+    const Uint8 *uuid = vdi_stream_client__parsec_ffmpeg_capture_uuid;
+    const size_t uuid_size = sizeof(vdi_stream_client__parsec_ffmpeg_capture_uuid);
+    AVFrame *av_frame;
+    bool found = false;
+
+    av_frame = vdi_stream_client__parsec_ffmpeg_frame_hold(frame, image, NULL);
+    if (av_frame == NULL) {
+        return false;
+    }
+    for (Sint32 i = 0; i < av_frame->nb_side_data && !found; i++) {
+        const AVFrameSideData *side_data = av_frame->side_data[i];
+
+        if (side_data->type != AV_FRAME_DATA_SEI_UNREGISTERED || side_data->size < uuid_size + 8 ||
+            SDL_memcmp(side_data->data, uuid, uuid_size) != 0) {
+            continue;
+        }
+        *capture_ns = 0;
+        for (size_t j = 0; j < 8; j++) {
+            *capture_ns = (*capture_ns << 8) | side_data->data[uuid_size + j];
+        }
+        found = true;
+    }
+    return found;
+#else
+    (void)frame;
+    (void)image;
+    (void)capture_ns;
+    return false;
+#endif
+}
+
+/* Recycle the slot held by the renderer after it has consumed a
+ * descriptor-backed frame, or the described slot if it was never taken. A held
+ * slot gives back its decoder reference, which frees a decoder torn down in
+ * the meantime. Raw Parsec image buffers are ignored. */
+void
+vdi_stream_client__parsec_ffmpeg_frame_release(const ParsecFrame *frame, const void *image)
+{
+    const struct vdi_stream_client__parsec_ffmpeg_frame_descriptor_s *descriptor;
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg;
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
+    uint_fast64_t expected;
+    bool held;
+
+    descriptor = vdi_stream_client__parsec_ffmpeg_frame_descriptor(frame, image);
+    if (descriptor == NULL || descriptor->slot == 0) {
+        return;
+    }
+
+    slot = (struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *)(uintptr_t)descriptor->slot;
+    ffmpeg = slot->decoder;
+    held = ffmpeg->frame_held != NULL;
+    if (held) {
+        slot = ffmpeg->frame_held;
+        ffmpeg->frame_held = NULL;
+    } else {
+        expected = VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_STATE(
+            descriptor->generation, VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY
+        );
+        if (!atomic_compare_exchange_strong_explicit(
+                &slot->state, &expected,
+                VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_STATE(
+                    descriptor->generation, VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_HELD
+                ),
+                memory_order_acquire, memory_order_relaxed
+            )) {
+            return;
+        }
+    }
+
+    vdi_stream_client__parsec_ffmpeg_slot_clear(slot);
+    atomic_store_explicit(
+        &slot->state, (uint_fast64_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE,
+        memory_order_release
+    );
+    if (held) {
+        vdi_stream_client__parsec_ffmpeg_unref(ffmpeg);
+    }
+}
+
+/* Atomically drain FFmpeg decoder counters into the caller's stats structure and
+ * reset them for the next render statistics interval. */
+void
+vdi_stream_client__parsec_ffmpeg_drain_stats(struct vdi_stream_client__parsec_ffmpeg_stats_s *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
     stats->video_packet_bytes = (Uint64)atomic_exchange_explicit(
         &vdi_stream_client__parsec_ffmpeg_video_packet_bytes, (uint_fast64_t)0, memory_order_relaxed
     );
@@ -462,6 +1203,99 @@ vdi_stream_client__parsec_ffmpeg_drain_stats(struct vdi_stream_client__parsec_ff
         &vdi_stream_client__parsec_ffmpeg_descriptor_fallback_ns, (uint_fast64_t)0,
         memory_order_relaxed
     );
+    stats->band_calls = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_band_calls, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->band_ns = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_band_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->band_frames = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_band_frames, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->band_incomplete = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_band_incomplete, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->pipeline_frames = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pipeline_frames, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->pipeline_depth = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pipeline_depth, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->pipeline_depth_max = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pipeline_depth_max, (uint_fast64_t)0,
+        memory_order_relaxed
+    );
+    stats->frame_allocations = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_frame_allocations, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->frames_dropped = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_frames_dropped, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->decoder_inits = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decoder_inits, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->decoder_init_ns = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decoder_init_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->device_reuses = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_device_reuses, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->context_reuses = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_context_reuses, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->pool_reuses = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pool_reuses, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->reuse_saved_ns = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_reuse_saved_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->decode_errors = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decode_errors, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->decode_flushes = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decode_flushes, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->resync_dropped = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_resync_dropped, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->recoveries = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_recoveries, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->error_ns = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_error_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+    stats->thread_count = atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_active_threads, memory_order_relaxed
+    );
+    stats->frame_threads = atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_active_frame_threads, memory_order_relaxed
+    );
+}
+
+/* Read the memory gauges for retained descriptor frames and the VA-API surface
+ * pool. Unlike the timing counters these are levels, so they are not reset. */
+void
+vdi_stream_client__parsec_ffmpeg_memory(struct vdi_stream_client__parsec_ffmpeg_memory_s *memory)
+{
+    if (memory == NULL) {
+        return;
+    }
+
+    memory->retained_frames = (Uint64)atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_retained_frames, memory_order_relaxed
+    );
+    memory->retained_hardware_frames = (Uint64)atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_retained_hardware_frames, memory_order_relaxed
+    );
+    memory->retained_bytes = (Uint64)atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_retained_bytes, memory_order_relaxed
+    );
+    memory->pool_surfaces = (Uint64)atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pool_surfaces, memory_order_relaxed
+    );
+    memory->pool_bytes = (Uint64)atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pool_bytes, memory_order_relaxed
+    );
 }
 
 /* Return whether the currently published FFmpeg decoder instance is using
@@ -526,11 +1360,71 @@ vdi_stream_client__parsec_ffmpeg_vaapi_profile_yuv444(VADisplay display, VAProfi
            attribute.value != VA_ATTRIB_NOT_SUPPORTED && (attribute.value & formats) != 0;
 }
 
+/* Account one reuse of a shared VA-API resource together with the cold setup
+ * time it avoided, as measured when the resource was last created. */
+static void
+vdi_stream_client__parsec_ffmpeg_reuse(
+    atomic_uint_fast64_t *reuses, const atomic_uint_fast64_t *cost_ns
+)
+{
+    atomic_fetch_add_explicit(reuses, (uint_fast64_t)1, memory_order_relaxed);
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_reuse_saved_ns,
+        atomic_load_explicit(cost_ns, memory_order_relaxed), memory_order_relaxed
+    );
+}
+
+/* Return a new reference to the process-wide VA-API device, opening the DRM
+ * node and initializing the VA driver only on first use. The device is created
+ * outside the lock, a racing creator simply drops its duplicate. */
+AVBufferRef *
+vdi_stream_client__parsec_ffmpeg_vaapi_device(void)
+{
+    AVBufferRef *device = NULL;
+    AVBufferRef *created = NULL;
+    Uint64 start_ns;
+
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    if (vdi_stream_client__parsec_ffmpeg_shared_device != NULL) {
+        device = av_buffer_ref(vdi_stream_client__parsec_ffmpeg_shared_device);
+    }
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    if (device != NULL) {
+        vdi_stream_client__parsec_ffmpeg_reuse(
+            &vdi_stream_client__parsec_ffmpeg_device_reuses,
+            &vdi_stream_client__parsec_ffmpeg_device_create_ns
+        );
+        return device;
+    }
+
+    start_ns = SDL_GetTicksNS();
+    if (av_hwdevice_ctx_create(&created, AV_HWDEVICE_TYPE_VAAPI, NULL, NULL, 0) < 0 ||
+        created == NULL) {
+        return NULL;
+    }
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_device_create_ns,
+        (uint_fast64_t)(SDL_GetTicksNS() - start_ns), memory_order_relaxed
+    );
+
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    if (vdi_stream_client__parsec_ffmpeg_shared_device == NULL) {
+        vdi_stream_client__parsec_ffmpeg_shared_device = av_buffer_ref(created);
+    }
+    device = av_buffer_ref(vdi_stream_client__parsec_ffmpeg_shared_device);
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    av_buffer_unref(&created);
+    return device;
+}
+
 /* Probe VA-API decode capabilities used by the decoder policy. The probe only
- * queries profile metadata and does not allocate decode surfaces. */
+ * queries profile metadata and does not allocate decode surfaces. Results are
+ * cached per render node, DRM driver version, kernel and libva release. */
 bool
 vdi_stream_client__parsec_ffmpeg_vaapi_codecs(bool *h264, bool *hevc, bool *hevc444)
 {
+    char key[256];
+    Uint64 cached;
     AVBufferRef *device_ref = NULL;
     AVHWDeviceContext *device_context;
     AVVAAPIDeviceContext *vaapi_context;
@@ -548,10 +1442,19 @@ vdi_stream_client__parsec_ffmpeg_vaapi_codecs(bool *h264, bool *hevc, bool *hevc
     *h264 = false;
     *hevc = false;
     *hevc444 = false;
+    if (vdi_stream_client__cache_vaapi_key(key, sizeof(key)) &&
+        vdi_stream_client__cache_lookup("vaapi.codecs", key, &cached)) {
+        *h264 = (cached & VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_H264) != 0;
+        *hevc = (cached & VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_HEVC) != 0;
+        *hevc444 = (cached & VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_HEVC444) != 0;
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Use cached VA-API profiles for %s\n", key);
+        return true;
+    }
 
-    /* Query profile metadata only. No VA config, context, surface or frame is created. */
-    if (av_hwdevice_ctx_create(&device_ref, AV_HWDEVICE_TYPE_VAAPI, NULL, NULL, 0) < 0 ||
-        device_ref == NULL) {
+    /* Query profile metadata only. No VA config, context, surface or frame is
+     * created, and the opened device is kept for the first decoder. */
+    device_ref = vdi_stream_client__parsec_ffmpeg_vaapi_device();
+    if (device_ref == NULL) {
         goto cleanup;
     }
     device_context = (AVHWDeviceContext *)device_ref->data;
@@ -599,6 +1502,12 @@ vdi_stream_client__parsec_ffmpeg_vaapi_codecs(bool *h264, bool *hevc, bool *hevc
             }
         }
     }
+    vdi_stream_client__cache_store(
+        "vaapi.codecs", key,
+        (*h264 ? VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_H264 : 0u) |
+            (*hevc ? VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_HEVC : 0u) |
+            (*hevc444 ? VDI_STREAM_CLIENT_PARSEC_FFMPEG_VAAPI_HEVC444 : 0u)
+    );
 
 cleanup:
     SDL_free(entrypoints);
@@ -626,6 +1535,39 @@ vdi_stream_client__parsec_make_writable(void *address, size_t len, int prot)
     return mprotect((void *)start, (size_t)(end - start), prot) == 0;
 }
 
+/* Find a code signature followed by a rel32 operand within scan_len bytes of
+ * base. The offset is cached per Parsec SDK build and only reused while the
+ * signature bytes at that offset still match, otherwise the range is scanned. */
+static bool
+vdi_stream_client__parsec_ffmpeg_signature(
+    const Uint8 *base, const void *symbol, Uint32 scan_len, const Uint8 *pattern,
+    size_t pattern_len, const char *name, Uint32 *offset
+)
+{
+    char key[128];
+    Uint64 cached;
+
+    (void)vdi_stream_client__cache_parsec_key(symbol, key, sizeof(key));
+    if (vdi_stream_client__cache_lookup(name, key, &cached) &&
+        cached + pattern_len + sizeof(int32_t) <= scan_len &&
+        SDL_memcmp(base + cached, pattern, pattern_len) == 0) {
+        *offset = (Uint32)cached;
+        return true;
+    }
+
+    for (*offset = 0; *offset + pattern_len + sizeof(int32_t) <= scan_len; (*offset)++) {
+        if (SDL_memcmp(base + *offset, pattern, pattern_len) == 0) {
+            SDL_LogInfo(
+                SDL_LOG_CATEGORY_APPLICATION, "Found Parsec SDK %s signature at +0x%x\n", name,
+                *offset
+            );
+            vdi_stream_client__cache_store(name, key, *offset);
+            return true;
+        }
+    }
+    return false;
+}
+
 /* Patch the Parsec SDK branch that rejects 4:4:4 negotiation based on its
  * bundled decoder. The injected FFmpeg decoder owns that capability instead. */
 static bool
@@ -665,36 +1607,34 @@ vdi_stream_client__parsec_ffmpeg_patch_decoder444_gate(struct parsec_context_s *
      * decoder444. The injected decoder replaces that implementation, so bypass
      * only the result branch of that dependency check. */
     scan = (Uint8 *)((uintptr_t)func - 0x10000u);
-    for (offset = 0; offset + sizeof(pattern) + sizeof(old_relative) <= 0x14000u; offset++) {
-        if (SDL_memcmp(scan + offset, pattern, sizeof(pattern)) != 0) {
-            continue;
-        }
+    if (!vdi_stream_client__parsec_ffmpeg_signature(
+            scan, func, 0x14000u, pattern, sizeof(pattern), "parsec.decoder444_gate", &offset
+        )) {
+        return false;
+    }
 
-        branch = scan + offset + 9u;
-        SDL_memcpy(&old_relative, branch + 2u, sizeof(old_relative));
-        target = (uintptr_t)(branch + 6u + old_relative);
-        new_relative = (int32_t)(target - (uintptr_t)(branch + 5u));
-        replacement[0] = 0xe9;
-        SDL_memcpy(replacement + 1u, &new_relative, sizeof(new_relative));
-        replacement[5] = 0x90;
+    branch = scan + offset + 9u;
+    SDL_memcpy(&old_relative, branch + 2u, sizeof(old_relative));
+    target = (uintptr_t)(branch + 6u + old_relative);
+    new_relative = (int32_t)(target - (uintptr_t)(branch + 5u));
+    replacement[0] = 0xe9;
+    SDL_memcpy(replacement + 1u, &new_relative, sizeof(new_relative));
+    replacement[5] = 0x90;
 
-        if (!vdi_stream_client__parsec_make_writable(
-                branch, sizeof(replacement), PROT_READ | PROT_WRITE
-            )) {
-            return false;
-        }
-        SDL_memcpy(branch, replacement, sizeof(replacement));
-        __builtin___clear_cache((char *)branch, (char *)branch + sizeof(replacement));
-        if (!vdi_stream_client__parsec_make_writable(
-                branch, sizeof(replacement), PROT_READ | PROT_EXEC
-            )) {
-            return false;
-        }
-        patched = true;
-        return true;
+    if (!vdi_stream_client__parsec_make_writable(
+            branch, sizeof(replacement), PROT_READ | PROT_WRITE
+        )) {
+        return false;
     }
-
-    return false;
+    SDL_memcpy(branch, replacement, sizeof(replacement));
+    __builtin___clear_cache((char *)branch, (char *)branch + sizeof(replacement));
+    if (!vdi_stream_client__parsec_make_writable(
+            branch, sizeof(replacement), PROT_READ | PROT_EXEC
+        )) {
+        return false;
+    }
+    patched = true;
+    return true;
 }
 
 /* Set the hidden flag on a raw Parsec decoder table entry so only the injected
@@ -741,17 +1681,16 @@ vdi_stream_client__parsec_decoder_table(struct parsec_context_s *parsec_context)
     func = (const Uint8 *)(const void *)parsec_context->parsec->api.ParsecGetDecoders;
 #endif
 
-    for (offset = 0; offset + sizeof(pattern) + sizeof(displacement_raw) < scan_len; offset++) {
-        if (SDL_memcmp(func + offset, pattern, sizeof(pattern)) != 0) {
-            continue;
-        }
-
-        displacement_raw = (Uint32)func[offset + 3] | ((Uint32)func[offset + 4] << 8) |
-                           ((Uint32)func[offset + 5] << 16) | ((Uint32)func[offset + 6] << 24);
-        return (Uint8 *)(func + offset + sizeof(pattern) + sizeof(displacement_raw) +
-                         (int32_t)displacement_raw);
+    if (!vdi_stream_client__parsec_ffmpeg_signature(
+            func, func, scan_len, pattern, sizeof(pattern), "parsec.decoder_table", &offset
+        )) {
+        return NULL;
     }
-    return NULL;
+
+    displacement_raw = (Uint32)func[offset + 3] | ((Uint32)func[offset + 4] << 8) |
+                       ((Uint32)func[offset + 5] << 16) | ((Uint32)func[offset + 6] << 24);
+    return (Uint8 *)(func + offset + sizeof(pattern) + sizeof(displacement_raw) +
+                     (int32_t)displacement_raw);
 }
 
 /* Query Parsec's public decoder list and return the index for the requested
@@ -830,9 +1769,69 @@ vdi_stream_client__parsec_ffmpeg_error(Sint32 errnum, char *buffer, size_t len)
     return buffer;
 }
 
+/* Attach a VA-API surface pool to a codec renegotiating its hardware format.
+ * The last pool is reused when nothing else references it and it matches the
+ * format, dimensions and surface count FFmpeg asks for. Otherwise a new pool
+ * is created and kept for the next decoder. On failure FFmpeg creates its own. */
+static void
+vdi_stream_client__parsec_ffmpeg_frames_attach(AVCodecContext *codec, enum AVPixelFormat format)
+{
+    AVBufferRef *frames_ref = NULL;
+    AVBufferRef *previous = NULL;
+    const AVHWFramesContext *wanted;
+    const AVHWFramesContext *shared;
+    Uint64 start_ns;
+
+    av_buffer_unref(&codec->hw_frames_ctx);
+    if (codec->hw_device_ctx == NULL ||
+        avcodec_get_hw_frames_parameters(codec, codec->hw_device_ctx, format, &frames_ref) < 0) {
+        return;
+    }
+    wanted = (const AVHWFramesContext *)frames_ref->data;
+
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    if (vdi_stream_client__parsec_ffmpeg_shared_frames != NULL &&
+        av_buffer_get_ref_count(vdi_stream_client__parsec_ffmpeg_shared_frames) == 1) {
+        shared = (const AVHWFramesContext *)vdi_stream_client__parsec_ffmpeg_shared_frames->data;
+        if (shared->device_ref->data == wanted->device_ref->data &&
+            shared->format == wanted->format && shared->sw_format == wanted->sw_format &&
+            shared->width == wanted->width && shared->height == wanted->height &&
+            shared->initial_pool_size >= wanted->initial_pool_size) {
+            codec->hw_frames_ctx = av_buffer_ref(vdi_stream_client__parsec_ffmpeg_shared_frames);
+        }
+    }
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    if (codec->hw_frames_ctx != NULL) {
+        av_buffer_unref(&frames_ref);
+        vdi_stream_client__parsec_ffmpeg_reuse(
+            &vdi_stream_client__parsec_ffmpeg_pool_reuses,
+            &vdi_stream_client__parsec_ffmpeg_pool_create_ns
+        );
+        return;
+    }
+
+    start_ns = SDL_GetTicksNS();
+    if (av_hwframe_ctx_init(frames_ref) < 0) {
+        av_buffer_unref(&frames_ref);
+        return;
+    }
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pool_create_ns,
+        (uint_fast64_t)(SDL_GetTicksNS() - start_ns), memory_order_relaxed
+    );
+    codec->hw_frames_ctx = av_buffer_ref(frames_ref);
+
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    previous = vdi_stream_client__parsec_ffmpeg_shared_frames;
+    vdi_stream_client__parsec_ffmpeg_shared_frames = frames_ref;
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    av_buffer_unref(&previous);
+}
+
 /* FFmpeg get_format callback that selects the VA-API hardware pixel format
  * discovered during decoder initialization, falling back to FFmpeg's first
- * offered format if the expected one is absent. */
+ * offered format if the expected one is absent. The selected format gets a
+ * shared surface pool attached. */
 static enum AVPixelFormat
 vdi_stream_client__parsec_ffmpeg_get_hw_format(
     AVCodecContext *codec, const enum AVPixelFormat *formats
@@ -845,6 +1844,7 @@ vdi_stream_client__parsec_ffmpeg_get_hw_format(
     if (ffmpeg != NULL) {
         for (format = formats; format != NULL && *format != AV_PIX_FMT_NONE; format++) {
             if (*format == ffmpeg->hw_pix_fmt) {
+                vdi_stream_client__parsec_ffmpeg_frames_attach(codec, *format);
                 return *format;
             }
         }
@@ -862,7 +1862,6 @@ vdi_stream_client__parsec_ffmpeg_setup_vaapi(
 )
 {
     const AVCodecHWConfig *config;
-    Sint32 err;
     int i;
 
     if (ffmpeg == NULL || codec == NULL || !acceleration) {
@@ -886,8 +1885,8 @@ vdi_stream_client__parsec_ffmpeg_setup_vaapi(
         return false;
     }
 
-    err = av_hwdevice_ctx_create(&ffmpeg->hw_device_ctx, AV_HWDEVICE_TYPE_VAAPI, NULL, NULL, 0);
-    if (err < 0) {
+    ffmpeg->hw_device_ctx = vdi_stream_client__parsec_ffmpeg_vaapi_device();
+    if (ffmpeg->hw_device_ctx == NULL) {
         return false;
     }
 
@@ -902,21 +1901,267 @@ vdi_stream_client__parsec_ffmpeg_setup_vaapi(
     return true;
 }
 
-/* Apply low-latency FFmpeg codec settings shared by hardware and software
- * decoder contexts. */
+/* Arguments of one libavcodec execute or execute2 call run on the worker pool. */
+struct vdi_stream_client__parsec_ffmpeg_execute_s
+{
+    AVCodecContext *codec;
+    int (*func)(AVCodecContext *codec, void *arg);
+    int (*func2)(AVCodecContext *codec, void *arg, int job, int thread);
+    Uint8 *arg;
+    int *ret;
+    int size;
+};
+
+/* Pool job running one libavcodec job. execute passes every job its own
+ * element of the argument array, execute2 the shared argument. */
 static void
-vdi_stream_client__parsec_ffmpeg_configure_context(AVCodecContext *codec)
+vdi_stream_client__parsec_ffmpeg_execute_job(void *data, Sint32 index, Sint32 thread)
+{
+    const struct vdi_stream_client__parsec_ffmpeg_execute_s *execute = data;
+    int ret;
+
+    if (execute->func2 != NULL) {
+        ret = execute->func2(execute->codec, execute->arg, index, thread);
+    } else {
+        ret = execute->func(execute->codec, execute->arg + (size_t)index * (size_t)execute->size);
+    }
+    if (execute->ret != NULL) {
+        execute->ret[index] = ret;
+    }
+}
+
+/* libavcodec execute replacement running slice jobs on the shared worker pool
+ * instead of the codec's own slice threads. */
+static int
+vdi_stream_client__parsec_ffmpeg_execute(
+    AVCodecContext *codec, int (*func)(AVCodecContext *codec, void *arg), void *arg, int *ret,
+    int count, int size
+)
 {
+    struct vdi_stream_client__parsec_ffmpeg_execute_s execute = {
+        .codec = codec, .func = func, .arg = arg, .ret = ret, .size = size
+    };
+
+    vdi_stream_client__pool_run(
+        vdi_stream_client__parsec_ffmpeg_execute_job, &execute, count, codec->thread_count
+    );
+    return 0;
+}
+
+/* libavcodec execute2 replacement. The pool hands out thread indices below the
+ * codec thread count, which codecs use to pick per-thread scratch state. */
+static int
+vdi_stream_client__parsec_ffmpeg_execute2(
+    AVCodecContext *codec, int (*func)(AVCodecContext *codec, void *arg, int job, int thread),
+    void *arg, int *ret, int count
+)
+{
+    struct vdi_stream_client__parsec_ffmpeg_execute_s execute = {
+        .codec = codec, .func2 = func, .arg = arg, .ret = ret
+    };
+
+    vdi_stream_client__pool_run(
+        vdi_stream_client__parsec_ffmpeg_execute_job, &execute, count, codec->thread_count
+    );
+    return 0;
+}
+
+/* Apply FFmpeg codec threading and latency settings. Hardware contexts and the
+ * slice model decode each frame before returning it. Frame threading trades
+ * one frame of delay per extra thread for throughput on single-slice streams,
+ * and the auto model bounds that delay to one frame. Zero threads sizes the
+ * codec to the worker pool, so decoding never runs more threads than cores. */
+static void
+vdi_stream_client__parsec_ffmpeg_configure_context(AVCodecContext *codec, bool hardware)
+{
+    Uint32 threads =
+        atomic_load_explicit(&vdi_stream_client__parsec_ffmpeg_threads, memory_order_relaxed);
+    vdi_decoder_thread_type_e thread_type = atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_thread_type, memory_order_relaxed
+    );
+
     if (codec == NULL) {
         return;
     }
+    if (hardware) {
+        threads = 0;
+        thread_type = VDI_DECODER_THREAD_SLICE;
+    } else if (threads == 0) {
+        threads = vdi_stream_client__pool_threads();
+    }
 
-    codec->thread_count = 0;
-    codec->thread_type = FF_THREAD_SLICE;
-    codec->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    switch (thread_type) {
+    case VDI_DECODER_THREAD_FRAME:
+        codec->thread_count = (int)threads;
+        codec->thread_type = FF_THREAD_FRAME;
+        break;
+    case VDI_DECODER_THREAD_AUTO:
+        codec->thread_count = VDI_STREAM_CLIENT_PARSEC_FFMPEG_BOUNDED_FRAME_THREADS;
+        codec->thread_type = FF_THREAD_FRAME;
+        break;
+    default:
+        codec->thread_count = (int)threads;
+        codec->thread_type = FF_THREAD_SLICE;
+        codec->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        break;
+    }
     codec->flags2 |= AV_CODEC_FLAG2_FAST;
 }
 
+/* FFmpeg get_format callback for sample decoders. They let FFmpeg allocate a
+ * private VA-API surface pool instead of sharing the live decoder pool. */
+static enum AVPixelFormat
+vdi_stream_client__parsec_ffmpeg_sample_format(
+    AVCodecContext *codec, const enum AVPixelFormat *formats
+)
+{
+    (void)codec;
+
+    for (const enum AVPixelFormat *format = formats; *format != AV_PIX_FMT_NONE; format++) {
+        if (*format == AV_PIX_FMT_VAAPI) {
+            return *format;
+        }
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+/* Decode sample packets with a private decoder configured like the live one and
+ * return the average time per packet, leaving out the first one which pays for
+ * decoder setup. Hardware surfaces are synced so asynchronous VA-API work counts.
+ * Decoding stops early once the deadline passes and two packets were timed. */
+bool
+vdi_stream_client__parsec_ffmpeg_sample_decode(
+    bool hevc, bool hardware, AVPacket *const *packets, Uint32 count, Uint64 deadline_ns,
+    Uint64 *frame_ns
+)
+{
+    const AVCodec *codec = avcodec_find_decoder(hevc ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264);
+    AVCodecContext *context = NULL;
+    AVBufferRef *device = NULL;
+    AVFrame *frame = av_frame_alloc();
+    VADisplay display = NULL;
+    Uint64 elapsed_ns = 0;
+    Uint32 frames = 0;
+    Uint32 timed = 0;
+    bool decoded = false;
+
+    *frame_ns = 0;
+    if (codec == NULL || frame == NULL || count < 2) {
+        goto done;
+    }
+    context = avcodec_alloc_context3(codec);
+    if (context == NULL) {
+        goto done;
+    }
+    if (hardware) {
+        AVHWDeviceContext *device_context;
+        AVVAAPIDeviceContext *vaapi_context;
+
+        device = vdi_stream_client__parsec_ffmpeg_vaapi_device();
+        if (device == NULL) {
+            goto done;
+        }
+        device_context = (AVHWDeviceContext *)device->data;
+        vaapi_context = device_context->hwctx;
+        display = vaapi_context->display;
+        context->hw_device_ctx = av_buffer_ref(device);
+        if (context->hw_device_ctx == NULL) {
+            goto done;
+        }
+        context->get_format = vdi_stream_client__parsec_ffmpeg_sample_format;
+    }
+    vdi_stream_client__parsec_ffmpeg_configure_context(context, hardware);
+    if (avcodec_open2(context, codec, NULL) < 0) {
+        goto done;
+    }
+    if (!hardware && (context->active_thread_type & FF_THREAD_SLICE) != 0) {
+        context->execute = vdi_stream_client__parsec_ffmpeg_execute;
+        context->execute2 = vdi_stream_client__parsec_ffmpeg_execute2;
+    }
+
+    for (Uint32 i = 0; i < count && (timed < 2 || SDL_GetTicksNS() <= deadline_ns); i++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        Sint32 err = avcodec_send_packet(context, packets[i]);
+
+        while (err >= 0) {
+            err = avcodec_receive_frame(context, frame);
+            if (err < 0) {
+                break;
+            }
+            if (hardware && vaSyncSurface(display, (VASurfaceID)(uintptr_t)frame->data[3]) !=
+                                VA_STATUS_SUCCESS) {
+                err = AVERROR_EXTERNAL;
+            }
+            av_frame_unref(frame);
+            if (err < 0) {
+                goto done;
+            }
+            frames++;
+        }
+        if (err != AVERROR(EAGAIN)) {
+            goto done;
+        }
+        if (i != 0) {
+            elapsed_ns += SDL_GetTicksNS() - start_ns;
+            timed++;
+        }
+    }
+    if (frames == 0 || timed == 0) {
+        goto done;
+    }
+    *frame_ns = elapsed_ns / timed;
+    decoded = true;
+
+done:
+    av_frame_free(&frame);
+    avcodec_free_context(&context);
+    av_buffer_unref(&device);
+    return decoded;
+}
+
+/* Account one frame returned by FFmpeg against the packets still inside the
+ * decoder, which is the pipeline depth frame threading adds. */
+static void
+vdi_stream_client__parsec_ffmpeg_pipeline_sample(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg
+)
+{
+    uint_fast64_t depth_max;
+
+    if (ffmpeg->pipeline_depth > 0) {
+        ffmpeg->pipeline_depth--;
+    }
+    if (atomic_load_explicit(
+            &vdi_stream_client__parsec_ffmpeg_load_enabled, memory_order_relaxed
+        )) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_load_frames, (uint_fast64_t)1, memory_order_relaxed
+        );
+    }
+    if (!atomic_load_explicit(
+            &vdi_stream_client__parsec_ffmpeg_stats_enabled, memory_order_relaxed
+        )) {
+        return;
+    }
+
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pipeline_frames, (uint_fast64_t)1, memory_order_relaxed
+    );
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pipeline_depth, (uint_fast64_t)ffmpeg->pipeline_depth,
+        memory_order_relaxed
+    );
+    depth_max = atomic_load_explicit(
+        &vdi_stream_client__parsec_ffmpeg_pipeline_depth_max, memory_order_relaxed
+    );
+    if (ffmpeg->pipeline_depth > depth_max) {
+        atomic_store_explicit(
+            &vdi_stream_client__parsec_ffmpeg_pipeline_depth_max,
+            (uint_fast64_t)ffmpeg->pipeline_depth, memory_order_relaxed
+        );
+    }
+}
+
 /* Log each codec/acceleration mode once so reconnects or multiple decoder
  * instances do not spam identical mode messages. */
 static void
@@ -941,14 +2186,93 @@ vdi_stream_client__parsec_ffmpeg_log_decoder_mode(
     }
 
     SDL_LogInfo(
-        SDL_LOG_CATEGORY_APPLICATION, "Use FFmpeg %s decoder for %s\n",
+        SDL_LOG_CATEGORY_APPLICATION, "Use FFmpeg %s decoder for %s with %d %s threads\n",
         ffmpeg->hwaccel ? "VAAPI hardware" : "software",
-        ffmpeg->codec_id == AV_CODEC_ID_HEVC ? "H.265 (HEVC)" : "H.264 (AVC)"
+        ffmpeg->codec_id == AV_CODEC_ID_HEVC ? "H.265 (HEVC)" : "H.264 (AVC)",
+        ffmpeg->codec->thread_count,
+        (ffmpeg->codec->active_thread_type & FF_THREAD_FRAME) != 0 ? "frame" : "slice"
+    );
+}
+
+/* Keep an opened VA-API codec context after its decoder is released. It is
+ * flushed, so no reference frame or queued packet leaks into the next stream,
+ * while its hwaccel state and surface pool stay alive. */
+static bool
+vdi_stream_client__parsec_ffmpeg_codec_park(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg
+)
+{
+    AVCodecContext *previous;
+
+    if (ffmpeg->codec == NULL || !ffmpeg->hwaccel || !avcodec_is_open(ffmpeg->codec)) {
+        return false;
+    }
+
+    avcodec_flush_buffers(ffmpeg->codec);
+    ffmpeg->codec->opaque = NULL;
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    previous = vdi_stream_client__parsec_ffmpeg_parked_codec;
+    vdi_stream_client__parsec_ffmpeg_parked_codec = ffmpeg->codec;
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    ffmpeg->codec = NULL;
+    avcodec_free_context(&previous);
+    return true;
+}
+
+/* Resume the parked VA-API codec context if it decodes the requested codec.
+ * A parked context for another codec is released, so its surface pool can be
+ * reused by the newly opened context. */
+static bool
+vdi_stream_client__parsec_ffmpeg_codec_resume(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, bool acceleration
+)
+{
+    AVCodecContext *parked;
+
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    parked = vdi_stream_client__parsec_ffmpeg_parked_codec;
+    vdi_stream_client__parsec_ffmpeg_parked_codec = NULL;
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    if (parked == NULL) {
+        return false;
+    }
+    if (!acceleration || parked->codec_id != ffmpeg->codec_id) {
+        avcodec_free_context(&parked);
+        return false;
+    }
+
+    ffmpeg->hw_device_ctx = av_buffer_ref(parked->hw_device_ctx);
+    if (ffmpeg->hw_device_ctx == NULL) {
+        avcodec_free_context(&parked);
+        return false;
+    }
+    parked->opaque = ffmpeg;
+    ffmpeg->codec = parked;
+    ffmpeg->hw_pix_fmt = AV_PIX_FMT_VAAPI;
+    ffmpeg->hwaccel = true;
+    vdi_stream_client__parsec_ffmpeg_reuse(
+        &vdi_stream_client__parsec_ffmpeg_context_reuses,
+        &vdi_stream_client__parsec_ffmpeg_codec_open_ns
     );
+    return true;
 }
 
-/* Release all resources owned by one injected FFmpeg decoder instance,
- * including retained frame slots that may still be referenced by descriptors. */
+/* Release the process-wide VA-API device, surface pool and parked codec
+ * context. Called once at shutdown after the Parsec client is destroyed. */
+void
+vdi_stream_client__parsec_ffmpeg_release(void)
+{
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+    avcodec_free_context(&vdi_stream_client__parsec_ffmpeg_parked_codec);
+    av_buffer_unref(&vdi_stream_client__parsec_ffmpeg_shared_frames);
+    av_buffer_unref(&vdi_stream_client__parsec_ffmpeg_shared_device);
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_shared_lock);
+}
+
+/* Release all resources owned by one injected FFmpeg decoder instance. Ready
+ * slots are recycled here, while a slot the renderer holds keeps the slots and
+ * the decoder allocated until its release. An opened VA-API codec context is
+ * parked for the next decoder instead. */
 static void
 vdi_stream_client__parsec_ffmpeg_free(struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg)
 {
@@ -962,29 +2286,51 @@ vdi_stream_client__parsec_ffmpeg_free(struct vdi_stream_client__parsec_ffmpeg_de
         );
     }
 
-    if (ffmpeg->frame_lock != NULL) {
-        SDL_LockMutex(ffmpeg->frame_lock);
-    }
+    atomic_store_explicit(&ffmpeg->frame_latest, (uintptr_t)0, memory_order_release);
     for (Uint32 i = 0; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS; i++) {
-        av_frame_free(&ffmpeg->frame_slots[i].frame);
-        ffmpeg->frame_slots[i].generation = 0;
+        struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot = &ffmpeg->frame_slots[i];
+        uint_fast64_t expected = atomic_load_explicit(&slot->state, memory_order_relaxed);
+
+        /* The renderer may take a ready slot concurrently and then releases it. */
+        if ((expected & VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER) ==
+                VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY &&
+            atomic_compare_exchange_strong_explicit(
+                &slot->state, &expected,
+                (expected & ~(uint_fast64_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER) |
+                    VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_HELD,
+                memory_order_acquire, memory_order_relaxed
+            )) {
+            vdi_stream_client__parsec_ffmpeg_slot_clear(slot);
+            atomic_store_explicit(
+                &slot->state, (uint_fast64_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE,
+                memory_order_release
+            );
+        }
     }
-    if (ffmpeg->frame_lock != NULL) {
-        SDL_UnlockMutex(ffmpeg->frame_lock);
-        SDL_DestroyMutex(ffmpeg->frame_lock);
+    if (ffmpeg->pool_frames_context != NULL) {
+        atomic_store_explicit(
+            &vdi_stream_client__parsec_ffmpeg_pool_surfaces, (uint_fast64_t)0, memory_order_relaxed
+        );
+        atomic_store_explicit(
+            &vdi_stream_client__parsec_ffmpeg_pool_bytes, (uint_fast64_t)0, memory_order_relaxed
+        );
     }
 
     av_packet_free(&ffmpeg->packet);
     av_frame_free(&ffmpeg->sw_frame);
     av_frame_free(&ffmpeg->frame);
-    avcodec_free_context(&ffmpeg->codec);
+    if (!vdi_stream_client__parsec_ffmpeg_codec_park(ffmpeg)) {
+        avcodec_free_context(&ffmpeg->codec);
+    }
     av_buffer_unref(&ffmpeg->hw_device_ctx);
-    SDL_free(ffmpeg);
+    av_buffer_pool_uninit(&ffmpeg->buffer_pool);
+    vdi_stream_client__parsec_ffmpeg_unref(ffmpeg);
 }
 
 /* Common Parsec decoder init callback. It allocates FFmpeg state, selects H.264
- * or H.265 from Parsec's selector byte, tries VA-API first when allowed, and
- * falls back to software decoding if opening the hardware context fails. */
+ * or H.265 from Parsec's selector byte, resumes or tries VA-API first when
+ * allowed, and falls back to software decoding if opening the hardware context
+ * fails. */
 static Sint32
 vdi_stream_client__parsec_ffmpeg_init_common(
     void *decoder, void *stream, Uint32 stream_id, void *codec_selector, void *flags
@@ -994,6 +2340,8 @@ vdi_stream_client__parsec_ffmpeg_init_common(
     const AVCodec *codec;
     Uint8 selector;
     bool acceleration;
+    Uint64 init_start_ns = SDL_GetTicksNS();
+    Uint64 open_start_ns;
     Sint32 err;
     char errbuf[AV_ERROR_MAX_STRING_SIZE];
 
@@ -1010,15 +2358,16 @@ vdi_stream_client__parsec_ffmpeg_init_common(
         return DECODE_ERR_BUFFER;
     }
     *((void **)decoder) = ffmpeg;
+    atomic_init(&ffmpeg->refs, 1);
 
-    ffmpeg->frame_lock = SDL_CreateMutex();
-    if (ffmpeg->frame_lock == NULL) {
-        vdi_stream_client__parsec_ffmpeg_free(ffmpeg);
-        *((void **)decoder) = NULL;
-        return DECODE_ERR_BUFFER;
-    }
     for (Uint32 i = 0; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS; i++) {
-        ffmpeg->frame_slots[i].lock = ffmpeg->frame_lock;
+        ffmpeg->frame_slots[i].decoder = ffmpeg;
+        ffmpeg->frame_slots[i].frame = av_frame_alloc();
+        if (ffmpeg->frame_slots[i].frame == NULL) {
+            vdi_stream_client__parsec_ffmpeg_free(ffmpeg);
+            *((void **)decoder) = NULL;
+            return DECODE_ERR_BUFFER;
+        }
     }
 
     selector = codec_selector != NULL ? ((const Uint8 *)codec_selector)[0] : 2;
@@ -1028,6 +2377,9 @@ vdi_stream_client__parsec_ffmpeg_init_common(
                                              : &vdi_stream_client__parsec_ffmpeg_h264_acceleration,
         memory_order_relaxed
     );
+    if (vdi_stream_client__parsec_ffmpeg_codec_resume(ffmpeg, acceleration)) {
+        goto opened;
+    }
 
     codec = avcodec_find_decoder(ffmpeg->codec_id);
     if (codec == NULL) {
@@ -1043,10 +2395,17 @@ vdi_stream_client__parsec_ffmpeg_init_common(
         return DECODE_ERR_BUFFER;
     }
 
-    vdi_stream_client__parsec_ffmpeg_configure_context(ffmpeg->codec);
     (void)vdi_stream_client__parsec_ffmpeg_setup_vaapi(ffmpeg, codec, acceleration);
+    vdi_stream_client__parsec_ffmpeg_configure_context(ffmpeg->codec, ffmpeg->hwaccel);
 
+    open_start_ns = SDL_GetTicksNS();
     err = avcodec_open2(ffmpeg->codec, codec, NULL);
+    if (err >= 0 && ffmpeg->hwaccel) {
+        atomic_store_explicit(
+            &vdi_stream_client__parsec_ffmpeg_codec_open_ns,
+            (uint_fast64_t)(SDL_GetTicksNS() - open_start_ns), memory_order_relaxed
+        );
+    }
     if (err < 0 && ffmpeg->hwaccel) {
         avcodec_free_context(&ffmpeg->codec);
         av_buffer_unref(&ffmpeg->hw_device_ctx);
@@ -1059,7 +2418,7 @@ vdi_stream_client__parsec_ffmpeg_init_common(
             *((void **)decoder) = NULL;
             return DECODE_ERR_BUFFER;
         }
-        vdi_stream_client__parsec_ffmpeg_configure_context(ffmpeg->codec);
+        vdi_stream_client__parsec_ffmpeg_configure_context(ffmpeg->codec, false);
         err = avcodec_open2(ffmpeg->codec, codec, NULL);
     }
     if (err < 0) {
@@ -1072,96 +2431,329 @@ vdi_stream_client__parsec_ffmpeg_init_common(
         return DECODE_ERR_INIT;
     }
 
+opened:
     ffmpeg->frame = av_frame_alloc();
     ffmpeg->sw_frame = av_frame_alloc();
+    ffmpeg->upload_frame = av_frame_alloc();
     ffmpeg->packet = av_packet_alloc();
-    if (ffmpeg->frame == NULL || ffmpeg->sw_frame == NULL || ffmpeg->packet == NULL) {
+    if (ffmpeg->frame == NULL || ffmpeg->sw_frame == NULL || ffmpeg->upload_frame == NULL ||
+        ffmpeg->packet == NULL) {
         vdi_stream_client__parsec_ffmpeg_free(ffmpeg);
         *((void **)decoder) = NULL;
         return DECODE_ERR_BUFFER;
     }
 
-    vdi_stream_client__parsec_ffmpeg_log_decoder_mode(ffmpeg);
-    atomic_store_explicit(
-        &vdi_stream_client__parsec_ffmpeg_hardware_active, ffmpeg->hwaccel, memory_order_release
-    );
-    ffmpeg->mode_published = true;
-    return PARSEC_OK;
+    /* Slice jobs run on the shared worker pool instead of the codec's own threads. */
+    if (!ffmpeg->hwaccel && (ffmpeg->codec->active_thread_type & FF_THREAD_SLICE) != 0) {
+        ffmpeg->codec->execute = vdi_stream_client__parsec_ffmpeg_execute;
+        ffmpeg->codec->execute2 = vdi_stream_client__parsec_ffmpeg_execute2;
+    }
+
+    /* Software pictures come from the decoder's frame pool. */
+    if (!ffmpeg->hwaccel) {
+        ffmpeg->codec->opaque = ffmpeg;
+        ffmpeg->codec->get_buffer2 = vdi_stream_client__parsec_ffmpeg_get_buffer;
+    }
+
+    /* Frame threads decode several pictures at once, so bands need slice threading. */
+    if (!ffmpeg->hwaccel && (ffmpeg->codec->active_thread_type & FF_THREAD_FRAME) == 0 &&
+        (ffmpeg->codec->codec->capabilities & AV_CODEC_CAP_DRAW_HORIZ_BAND) != 0 &&
+        atomic_load_explicit(&vdi_stream_client__parsec_ffmpeg_progressive, memory_order_relaxed)) {
+        ffmpeg->codec->draw_horiz_band = vdi_stream_client__parsec_ffmpeg_band;
+    }
+
+    vdi_stream_client__parsec_ffmpeg_log_decoder_mode(ffmpeg);
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_hardware_active, ffmpeg->hwaccel, memory_order_release
+    );
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_active_threads, (unsigned int)ffmpeg->codec->thread_count,
+        memory_order_relaxed
+    );
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_active_frame_threads,
+        (ffmpeg->codec->active_thread_type & FF_THREAD_FRAME) != 0, memory_order_relaxed
+    );
+    ffmpeg->mode_published = true;
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decoder_inits, (uint_fast64_t)1, memory_order_relaxed
+    );
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decoder_init_ns,
+        (uint_fast64_t)(SDL_GetTicksNS() - init_start_ns), memory_order_relaxed
+    );
+    return PARSEC_OK;
+}
+
+/* Parsec decoder init callback installed into the SDK decoder table. It exists
+ * as a stable callback symbol and delegates to the shared initializer. */
+static Sint32
+vdi_stream_client__parsec_ffmpeg_init(
+    void *decoder, void *stream, Uint32 stream_id, void *codec_selector, void *flags
+)
+{
+    return vdi_stream_client__parsec_ffmpeg_init_common(
+        decoder, stream, stream_id, codec_selector, flags
+    );
+}
+
+/* Parsec decoder cleanup callback that releases the FFmpeg instance and clears
+ * Parsec's decoder-private pointer. */
+static void
+vdi_stream_client__parsec_ffmpeg_cleanup(void *decoder)
+{
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg;
+
+    if (decoder == NULL) {
+        return;
+    }
+
+    ffmpeg = *((struct vdi_stream_client__parsec_ffmpeg_decoder_s **)decoder);
+    if (ffmpeg == NULL) {
+        return;
+    }
+
+    vdi_stream_client__parsec_ffmpeg_free(ffmpeg);
+    *((void **)decoder) = NULL;
+}
+
+/* Copy one AVFrame plane into a tightly packed destination plane, honoring the
+ * source and destination pitches for every row. */
+static bool
+vdi_stream_client__parsec_ffmpeg_copy_plane(
+    Uint8 *dst, const Uint8 *src, Sint32 dst_pitch, Sint32 src_pitch, Sint32 width, Sint32 height
+)
+{
+    if (dst == NULL || src == NULL || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    vdi_stream_client__copy_plane(dst, dst_pitch, src, src_pitch, width, height);
+    return true;
+}
+
+/* Recycle every published slot superseded by the newest frame. These frames
+ * were never taken by the renderer, so they count as dropped before present. */
+static void
+vdi_stream_client__parsec_ffmpeg_slot_recycle(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg,
+    const struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *latest
+)
+{
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS; i++) {
+        struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot = &ffmpeg->frame_slots[i];
+        uint_fast64_t expected = atomic_load_explicit(&slot->state, memory_order_relaxed);
+
+        if (slot == latest || (expected & VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER) !=
+                                  VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY) {
+            continue;
+        }
+
+        /* The renderer may take the slot concurrently, in which case it recycles it. */
+        if (!atomic_compare_exchange_strong_explicit(
+                &slot->state, &expected,
+                (expected & ~(uint_fast64_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_OWNER) |
+                    VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_HELD,
+                memory_order_acquire, memory_order_relaxed
+            )) {
+            continue;
+        }
+        vdi_stream_client__parsec_ffmpeg_slot_clear(slot);
+        atomic_store_explicit(
+            &slot->state, (uint_fast64_t)VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE,
+            memory_order_release
+        );
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_frames_dropped, (uint_fast64_t)1,
+            memory_order_relaxed
+        );
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_load_dropped, (uint_fast64_t)1, memory_order_relaxed
+        );
+    }
+}
+
+/* Size the upload buffer of a slot for the frame whose first band arrived. The
+ * layout matches what SDL_UpdateTexture() takes for the texture format the
+ * frame maps to: contiguous Y, U and V planes with half pitch chroma for IYUV,
+ * or packed pixels for 8-bit 4:4:4 frames converted to XRGB8888. */
+static bool
+vdi_stream_client__parsec_ffmpeg_band_prepare(
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot, const AVFrame *src
+)
+{
+    SDL_PixelFormat format;
+    Sint32 pitch;
+    size_t size;
+
+    if (!vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
+            (enum AVPixelFormat)src->format, NULL, &format
+        ) ||
+        format == SDL_PIXELFORMAT_NV12 || src->width <= 0 || src->height <= 0 ||
+        (src->width & 1) != 0 || (src->height & 1) != 0) {
+        return false;
+    }
+
+    if (format == SDL_PIXELFORMAT_IYUV) {
+        pitch = FFALIGN(src->width, 64);
+        size = (size_t)pitch * (size_t)src->height * 3 / 2;
+    } else {
+        pitch = src->width * 4;
+        size = (size_t)pitch * (size_t)src->height;
+    }
+    if (slot->band_size < size) {
+        Uint8 *pixels = SDL_realloc(slot->band_pixels, size);
+
+        if (pixels == NULL) {
+            return false;
+        }
+        slot->band_pixels = pixels;
+        slot->band_size = size;
+    }
+    slot->band_pitch = pitch;
+    slot->band_width = src->width;
+    slot->band_height = src->height;
+    slot->band_format = format;
+    return true;
 }
 
-/* Parsec decoder init callback installed into the SDK decoder table. It exists
- * as a stable callback symbol and delegates to the shared initializer. */
-static Sint32
-vdi_stream_client__parsec_ffmpeg_init(
-    void *decoder, void *stream, Uint32 stream_id, void *codec_selector, void *flags
+/* libavcodec draw_horiz_band callback. Rows the software decoder has finished
+ * are written into the upload buffer of the slot that will receive the frame
+ * while later rows are still decoding, so the renderer uploads a prepared
+ * buffer instead of gathering and converting planes after decode. Bands must
+ * continue where the previous one ended; anything else leaves the buffer
+ * incomplete and the frame takes the regular upload path. */
+static void
+vdi_stream_client__parsec_ffmpeg_band(
+    AVCodecContext *codec, const AVFrame *src, int offset[AV_NUM_DATA_POINTERS], int y, int type,
+    int height
 )
 {
-    return vdi_stream_client__parsec_ffmpeg_init_common(
-        decoder, stream, stream_id, codec_selector, flags
-    );
-}
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg = codec->opaque;
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
+    bool stats_enabled =
+        atomic_load_explicit(&vdi_stream_client__parsec_ffmpeg_stats_enabled, memory_order_relaxed);
+    Uint64 band_start_ns = stats_enabled ? SDL_GetTicksNS() : 0;
+    int expected = y;
+    Uint8 *pixels;
+
+    (void)type;
+    if (ffmpeg == NULL || ffmpeg->band_slot == NULL || height <= 0 ||
+        atomic_load_explicit(&ffmpeg->band_rows, memory_order_acquire) != y) {
+        goto incomplete;
+    }
+    slot = ffmpeg->band_slot;
+    if (y == 0) {
+        if (!vdi_stream_client__parsec_ffmpeg_band_prepare(slot, src)) {
+            goto incomplete;
+        }
+        ffmpeg->band_data = src->data[0];
+    }
+    if (src->data[0] != ffmpeg->band_data || y + height > slot->band_height) {
+        goto incomplete;
+    }
 
-/* Parsec decoder cleanup callback that releases the FFmpeg instance and clears
- * Parsec's decoder-private pointer. */
-static void
-vdi_stream_client__parsec_ffmpeg_cleanup(void *decoder)
-{
-    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg;
+    pixels = slot->band_pixels + (size_t)y * (size_t)slot->band_pitch;
+    if (slot->band_format == SDL_PIXELFORMAT_IYUV) {
+        Sint32 chroma_pitch = slot->band_pitch / 2;
+        Sint32 chroma_width = slot->band_width / 2;
+        Sint32 chroma_height = slot->band_height / 2;
+        Sint32 chroma_top = y / 2;
+        Sint32 chroma_rows = SDL_min((y + height + 1) / 2, chroma_height) - chroma_top;
+        Uint8 *chroma = slot->band_pixels + (size_t)slot->band_pitch * (size_t)slot->band_height +
+                        (size_t)chroma_top * (size_t)chroma_pitch;
 
-    if (decoder == NULL) {
-        return;
+        vdi_stream_client__copy_plane(
+            pixels, slot->band_pitch, src->data[0] + offset[0], src->linesize[0], slot->band_width,
+            height
+        );
+        vdi_stream_client__copy_plane(
+            chroma, chroma_pitch, src->data[1] + offset[1], src->linesize[1], chroma_width,
+            chroma_rows
+        );
+        chroma += (size_t)chroma_pitch * (size_t)chroma_height;
+        vdi_stream_client__copy_plane(
+            chroma, chroma_pitch, src->data[2] + offset[2], src->linesize[2], chroma_width,
+            chroma_rows
+        );
+    } else {
+        const Uint8 *const planes[3] = { src->data[0] + offset[0], src->data[1] + offset[1],
+                                         src->data[2] + offset[2] };
+
+        vdi_stream_client__copy_yuv444_xrgb(
+            pixels, slot->band_pitch, planes, src->linesize, slot->band_width, height,
+            src->colorspace == AVCOL_SPC_BT709, src->color_range == AVCOL_RANGE_JPEG
+        );
     }
 
-    ffmpeg = *((struct vdi_stream_client__parsec_ffmpeg_decoder_s **)decoder);
-    if (ffmpeg == NULL) {
-        return;
+    /* Slice threads may deliver bands of different slices concurrently. */
+    if (!atomic_compare_exchange_strong_explicit(
+            &ffmpeg->band_rows, &expected, y + height, memory_order_release, memory_order_relaxed
+        )) {
+        goto incomplete;
+    }
+    if (stats_enabled) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_band_calls, (uint_fast64_t)1, memory_order_relaxed
+        );
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_band_ns,
+            (uint_fast64_t)(SDL_GetTicksNS() - band_start_ns), memory_order_relaxed
+        );
     }
+    return;
 
-    vdi_stream_client__parsec_ffmpeg_free(ffmpeg);
-    *((void **)decoder) = NULL;
+incomplete:
+    if (ffmpeg != NULL) {
+        atomic_store_explicit(&ffmpeg->band_rows, -1, memory_order_release);
+    }
 }
 
-/* Copy one AVFrame plane into a tightly packed destination plane, honoring the
- * source and destination pitches for every row. */
-static bool
-vdi_stream_client__parsec_ffmpeg_copy_plane(
-    Uint8 *dst, const Uint8 *src, Sint32 dst_pitch, Sint32 src_pitch, Sint32 width, Sint32 height
+/* Pick the free slot the next decoded frame will be published into, so its
+ * rows can be prepared while the packet decodes. */
+static void
+vdi_stream_client__parsec_ffmpeg_band_begin(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg
 )
 {
-    Sint32 row;
-
-    if (dst == NULL || src == NULL || width <= 0 || height <= 0) {
-        return false;
+    ffmpeg->band_slot = NULL;
+    ffmpeg->band_data = NULL;
+    atomic_store_explicit(&ffmpeg->band_rows, 0, memory_order_relaxed);
+    if (ffmpeg->codec->draw_horiz_band == NULL) {
+        return;
     }
 
-    for (row = 0; row < height; row++) {
-        Uint8 *dst_row = dst + (size_t)row * (size_t)dst_pitch;
-        const Uint8 *src_row = src + (size_t)row * (size_t)src_pitch;
-
-        SDL_memcpy(dst_row, src_row, (size_t)width);
+    /* Free slots belong to the decoder, so the renderer never touches the buffer. */
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS; i++) {
+        if (atomic_load_explicit(&ffmpeg->frame_slots[i].state, memory_order_acquire) ==
+            VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE) {
+            ffmpeg->band_slot = &ffmpeg->frame_slots[i];
+            break;
+        }
     }
-    return true;
 }
 
 /* Write a ParsecFrame header that points at a retained AVFrame descriptor
- * instead of copying pixel planes. The renderer later clones and releases the
- * retained frame through the descriptor slot. */
+ * instead of copying pixel planes. The source references are moved into a free
+ * mailbox slot without blocking, so the source is left blank on success and
+ * untouched on failure. The renderer later takes the frame through the
+ * descriptor slot, or the newest slot once this one was superseded. */
 static Sint32
 vdi_stream_client__parsec_ffmpeg_write_frame_descriptor(
-    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, const AVFrame *source,
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, AVFrame *source,
     ParsecFrame *frame, Uint32 *frame_size
 )
 {
     struct vdi_stream_client__parsec_ffmpeg_frame_descriptor_s *descriptor;
-    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot;
-    AVFrame *retained;
+    struct vdi_stream_client__parsec_ffmpeg_frame_slot_s *slot = NULL;
     ParsecColorFormat parsec_format;
     Uint32 width;
     Uint32 height;
     Uint32 required = (Uint32)sizeof(*frame) + (Uint32)sizeof(*descriptor);
     Uint64 generation;
+    size_t bytes;
 
-    if (ffmpeg == NULL || source == NULL || frame == NULL || ffmpeg->frame_lock == NULL) {
+    if (ffmpeg == NULL || source == NULL || frame == NULL) {
         return DECODE_ERR_BUFFER;
     }
 
@@ -1176,23 +2768,56 @@ vdi_stream_client__parsec_ffmpeg_write_frame_descriptor(
         return DECODE_ERR_PIXEL_FORMAT;
     }
 
-    retained = av_frame_clone(source);
-    if (retained == NULL) {
+    bytes = vdi_stream_client__parsec_ffmpeg_frame_bytes(source);
+    vdi_stream_client__parsec_ffmpeg_pool_update(ffmpeg, source);
+
+    /* Free slots belong to the decoder, so no compare-and-swap is needed here. */
+    if (ffmpeg->band_slot != NULL &&
+        atomic_load_explicit(&ffmpeg->band_slot->state, memory_order_acquire) ==
+            VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE) {
+        slot = ffmpeg->band_slot;
+    }
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS && slot == NULL; i++) {
+        if (atomic_load_explicit(&ffmpeg->frame_slots[i].state, memory_order_acquire) ==
+            VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_FREE) {
+            slot = &ffmpeg->frame_slots[i];
+        }
+    }
+    if (slot == NULL) {
         return DECODE_ERR_BUFFER;
     }
-
-    SDL_LockMutex(ffmpeg->frame_lock);
-    slot = &ffmpeg->frame_slots[ffmpeg->frame_slot % VDI_STREAM_CLIENT_PARSEC_FFMPEG_FRAME_SLOTS];
-    ffmpeg->frame_slot++;
-    av_frame_free(&slot->frame);
-    slot->frame = retained;
+    vdi_stream_client__parsec_ffmpeg_slot_clear(slot);
+    vdi_stream_client__parsec_ffmpeg_slot_store(slot, source, bytes);
+    if (ffmpeg->band_slot != NULL) {
+        slot->band_ready = slot == ffmpeg->band_slot && slot->frame->data[0] == ffmpeg->band_data &&
+                           atomic_load_explicit(&ffmpeg->band_rows, memory_order_acquire) ==
+                               slot->band_height &&
+                           slot->frame->width == slot->band_width;
+        if (!slot->band_ready &&
+            atomic_load_explicit(
+                &vdi_stream_client__parsec_ffmpeg_stats_enabled, memory_order_relaxed
+            )) {
+            atomic_fetch_add_explicit(
+                &vdi_stream_client__parsec_ffmpeg_band_incomplete, (uint_fast64_t)1,
+                memory_order_relaxed
+            );
+        }
+        ffmpeg->band_slot = NULL;
+    }
     ffmpeg->frame_generation++;
     if (ffmpeg->frame_generation == 0) {
         ffmpeg->frame_generation++;
     }
-    slot->generation = ffmpeg->frame_generation;
-    generation = slot->generation;
-    SDL_UnlockMutex(ffmpeg->frame_lock);
+    generation = ffmpeg->frame_generation;
+    atomic_store_explicit(
+        &slot->state,
+        VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_STATE(
+            generation, VDI_STREAM_CLIENT_PARSEC_FFMPEG_SLOT_READY
+        ),
+        memory_order_release
+    );
+    atomic_store_explicit(&ffmpeg->frame_latest, (uintptr_t)slot, memory_order_release);
+    vdi_stream_client__parsec_ffmpeg_slot_recycle(ffmpeg, slot);
 
     frame->format = parsec_format;
     frame->rotation = ROTATION_NONE;
@@ -1325,6 +2950,54 @@ vdi_stream_client__parsec_ffmpeg_write_nv12(
     return PARSEC_OK;
 }
 
+/* Serialize a P010 AVFrame, as transferred from 10-bit VA-API surfaces, into
+ * Parsec's contiguous NV12 frame buffer by rounding every sample to 8 bits. */
+static Sint32
+vdi_stream_client__parsec_ffmpeg_write_p010(
+    const AVFrame *source, ParsecFrame *frame, Uint32 *frame_size
+)
+{
+    Uint32 width = (Uint32)source->width;
+    Uint32 height = (Uint32)source->height;
+    Uint32 y_size = width * height;
+    Uint32 uv_size = width * (height / 2);
+    Uint32 required = (Uint32)sizeof(*frame) + y_size + uv_size;
+    Uint8 *dst = (Uint8 *)frame + sizeof(*frame);
+
+    if (width == 0 || height == 0 || (width & 1u) != 0 || (height & 1u) != 0) {
+        return DECODE_ERR_RESOLUTION;
+    }
+    if (required > VDI_STREAM_CLIENT_PARSEC_MAX_FRAME_BUFFER) {
+        if (frame_size != NULL) {
+            *frame_size = required;
+        }
+        return DECODE_ERR_BUFFER;
+    }
+    if (source->data[0] == NULL || source->data[1] == NULL) {
+        return DECODE_ERR_BUFFER;
+    }
+
+    frame->format = FORMAT_NV12;
+    frame->rotation = ROTATION_NONE;
+    frame->size = required - (Uint32)sizeof(*frame);
+    frame->width = width;
+    frame->height = height;
+    frame->fullWidth = width;
+    frame->fullHeight = height;
+    if (frame_size != NULL) {
+        *frame_size = required;
+    }
+
+    vdi_stream_client__copy_p010_nv12(
+        dst, (Sint32)width, source->data[0], source->linesize[0], (Sint32)width, (Sint32)height
+    );
+    vdi_stream_client__copy_p010_nv12(
+        dst + y_size, (Sint32)width, source->data[1], source->linesize[1], (Sint32)width,
+        (Sint32)(height / 2)
+    );
+    return PARSEC_OK;
+}
+
 /* Convert the most recently decoded FFmpeg frame into Parsec decoder output.
  * Hardware frames prefer descriptor-based zero-copy handoff, then transfer and
  * fall back to software descriptors or packed buffers as needed. */
@@ -1354,7 +3027,16 @@ vdi_stream_client__parsec_ffmpeg_write_frame(
             return PARSEC_OK;
         }
 
-        av_frame_unref(ffmpeg->sw_frame);
+        /* The previous copy moved into a slot, so take a pooled buffer for this one. */
+        if (ffmpeg->sw_frame->buf[0] == NULL) {
+            ffmpeg->sw_frame->format =
+                vdi_stream_client__parsec_ffmpeg_frame_software_format(ffmpeg->frame);
+            ffmpeg->sw_frame->width = ffmpeg->frame->width;
+            ffmpeg->sw_frame->height = ffmpeg->frame->height;
+            (void)vdi_stream_client__parsec_ffmpeg_buffer_attach(
+                ffmpeg, ffmpeg->sw_frame, ffmpeg->frame->width, ffmpeg->frame->height
+            );
+        }
         err = vdi_stream_client__parsec_ffmpeg_hwframe_transfer(ffmpeg->sw_frame, ffmpeg->frame);
         if (err < 0) {
             SDL_LogWarn(
@@ -1363,6 +3045,9 @@ vdi_stream_client__parsec_ffmpeg_write_frame(
             );
             return DECODE_ERR_DECODE;
         }
+
+        /* Keep SEI side data such as host capture timestamps on the copy. */
+        av_frame_copy_props(ffmpeg->sw_frame, ffmpeg->frame);
         source = ffmpeg->sw_frame;
     }
 
@@ -1394,6 +3079,12 @@ vdi_stream_client__parsec_ffmpeg_write_frame(
             source, (ParsecFrame *)frame_data, frame_size
         );
         break;
+    case AV_PIX_FMT_P010:
+        stage_start_ns = stats_enabled ? SDL_GetTicksNS() : 0;
+        err = vdi_stream_client__parsec_ffmpeg_write_p010(
+            source, (ParsecFrame *)frame_data, frame_size
+        );
+        break;
     default:
         if (vdi_stream_client__parsec_ffmpeg_frame_pixel_format(
                 (enum AVPixelFormat)source->format, NULL, NULL
@@ -1469,17 +3160,160 @@ vdi_stream_client__parsec_ffmpeg_receive_frame(AVCodecContext *codec, AVFrame *f
     return err;
 }
 
-/* Parsec decoder decode callback. It feeds one compressed packet into FFmpeg,
- * handles EAGAIN/EOF as accepted input, and emits a ParsecFrame when FFmpeg has
- * a decoded frame ready. */
+/* Classify a failed send or receive call. A frame lost on output leaves the
+ * references intact, corrupt input is concealed by FFmpeg unless it keeps
+ * coming, a packet lost in the decoder breaks the reference chain, and
+ * anything else points at the decoder itself. */
+static Uint32
+vdi_stream_client__parsec_ffmpeg_recover_action(Sint32 err, bool sent)
+{
+    if (err == AVERROR(ENOMEM)) {
+        return sent ? VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_DROP
+                    : VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_RESYNC;
+    }
+    if (err == AVERROR_INVALIDDATA) {
+        return VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_CONCEAL;
+    }
+    if (err == AVERROR(EIO)) {
+        return VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_RESYNC;
+    }
+    return VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_FATAL;
+}
+
+/* Add the time spent in the current error episode since the last call to the
+ * statistics, so an episode which never recovers still shows up. */
+static void
+vdi_stream_client__parsec_ffmpeg_error_account(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, Uint64 now_ns
+)
+{
+    if (ffmpeg->error_start_ns == 0) {
+        return;
+    }
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_error_ns,
+        (uint_fast64_t)(now_ns - ffmpeg->error_mark_ns), memory_order_relaxed
+    );
+    ffmpeg->error_mark_ns = now_ns;
+}
+
+/* Close the error episode once a frame decodes again. */
+static void
+vdi_stream_client__parsec_ffmpeg_error_clear(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg
+)
+{
+    Uint64 now_ns;
+
+    if (ffmpeg->error_start_ns == 0) {
+        return;
+    }
+    now_ns = SDL_GetTicksNS();
+    vdi_stream_client__parsec_ffmpeg_error_account(ffmpeg, now_ns);
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_recoveries, (uint_fast64_t)1, memory_order_relaxed
+    );
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "FFmpeg decoder recovered after %.3fms\n",
+        (double)(now_ns - ffmpeg->error_start_ns) / 1000000.0
+    );
+    ffmpeg->error_start_ns = 0;
+    ffmpeg->error_report_ns = 0;
+    ffmpeg->error_packets = 0;
+}
+
+/* Report an error episode to the SDK, which asks the host for a new keyframe
+ * on every reported decode error. The first failure is reported at once and
+ * later ones at most every 500ms, so a lost keyframe request is repeated
+ * without flooding the host. */
 static Sint32
-vdi_stream_client__parsec_ffmpeg_decode(
+vdi_stream_client__parsec_ffmpeg_error_report(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, Uint64 now_ns
+)
+{
+    if (ffmpeg->error_report_ns != 0 &&
+        now_ns - ffmpeg->error_report_ns <
+            (Uint64)VDI_STREAM_CLIENT_PARSEC_FFMPEG_REPORT_MS * 1000000) {
+        return DECODE_WRN_ACCEPTED;
+    }
+    ffmpeg->error_report_ns = now_ns;
+    return DECODE_ERR_DECODE;
+}
+
+/* Recover from a failed send or receive call without reinitializing the
+ * decoder. Corrupt packets are skipped and left to FFmpeg's error concealment,
+ * which keeps the references. Only a lost packet or corruption in several
+ * packets in a row flushes the decoder in place and waits for the next
+ * keyframe, while the last good frame stays on screen. Decoder failures are
+ * reported without touching the decoder state. */
+static Sint32
+vdi_stream_client__parsec_ffmpeg_recover(
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg, Sint32 err, bool sent
+)
+{
+    Uint32 action = vdi_stream_client__parsec_ffmpeg_recover_action(err, sent);
+    Uint64 now_ns = SDL_GetTicksNS();
+    char errbuf[AV_ERROR_MAX_STRING_SIZE];
+
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decode_errors, (uint_fast64_t)1, memory_order_relaxed
+    );
+    if (ffmpeg->error_start_ns == 0) {
+        ffmpeg->error_start_ns = now_ns;
+        ffmpeg->error_mark_ns = now_ns;
+    }
+    vdi_stream_client__parsec_ffmpeg_error_account(ffmpeg, now_ns);
+
+    if (action == VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_DROP) {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION, "FFmpeg frame receive failed, dropping frame: %s\n",
+            vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
+        );
+        return DECODE_WRN_ACCEPTED;
+    }
+    if (action == VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_FATAL) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "FFmpeg %s failed: %s\n",
+            sent ? "frame receive" : "packet decode",
+            vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
+        );
+        return DECODE_ERR_DECODE;
+    }
+    if (action == VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_CONCEAL &&
+        ++ffmpeg->error_packets < VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_PACKETS) {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION, "FFmpeg %s failed, concealing errors: %s\n",
+            sent ? "frame receive" : "packet decode",
+            vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
+        );
+        return vdi_stream_client__parsec_ffmpeg_error_report(ffmpeg, now_ns);
+    }
+
+    avcodec_flush_buffers(ffmpeg->codec);
+    ffmpeg->pipeline_depth = 0;
+    ffmpeg->resync = true;
+    ffmpeg->resync_start_ns = now_ns;
+    ffmpeg->error_packets = 0;
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_decode_flushes, (uint_fast64_t)1, memory_order_relaxed
+    );
+    SDL_LogWarn(
+        SDL_LOG_CATEGORY_APPLICATION, "FFmpeg %s failed, waiting for next keyframe: %s\n",
+        sent ? "frame receive" : "packet decode",
+        vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
+    );
+    return vdi_stream_client__parsec_ffmpeg_error_report(ffmpeg, now_ns);
+}
+
+/* Feed one compressed packet into FFmpeg, handle EAGAIN/EOF as accepted input,
+ * and emit a ParsecFrame when FFmpeg has a decoded frame ready. */
+static Sint32
+vdi_stream_client__parsec_ffmpeg_decode_packet(
     void *decoder, const void *packet_data, Uint32 packet_size, void *frame_data, Uint32 *frame_size
 )
 {
     struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg = decoder;
     Sint32 err;
-    char errbuf[AV_ERROR_MAX_STRING_SIZE];
 
     if (ffmpeg == NULL || ffmpeg->codec == NULL || ffmpeg->frame == NULL ||
         ffmpeg->packet == NULL) {
@@ -1496,41 +3330,79 @@ vdi_stream_client__parsec_ffmpeg_decode(
             memory_order_relaxed
         );
     }
+    vdi_stream_client__shadow_submit(ffmpeg->codec_id, packet_data, packet_size);
+
+    /* Pictures before the next keyframe reference lost data, so they are
+     * dropped and the last good frame stays published meanwhile. Hosts with
+     * an infinite GOP may never send one, so after two seconds decoding goes
+     * on and FFmpeg's own recovery point handling heals the picture. */
+    if (ffmpeg->resync) {
+        Uint64 now_ns = SDL_GetTicksNS();
+        bool keyframe =
+            vdi_stream_client__shadow_keyframe(ffmpeg->codec_id, packet_data, packet_size);
+
+        if (!keyframe && now_ns - ffmpeg->resync_start_ns <
+                (Uint64)VDI_STREAM_CLIENT_PARSEC_FFMPEG_RESYNC_MS * 1000000) {
+            atomic_fetch_add_explicit(
+                &vdi_stream_client__parsec_ffmpeg_resync_dropped, (uint_fast64_t)1,
+                memory_order_relaxed
+            );
+            vdi_stream_client__parsec_ffmpeg_error_account(ffmpeg, now_ns);
+            return vdi_stream_client__parsec_ffmpeg_error_report(ffmpeg, now_ns);
+        }
+        if (!keyframe) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "FFmpeg received no keyframe within %ums, resuming decode\n",
+                VDI_STREAM_CLIENT_PARSEC_FFMPEG_RESYNC_MS
+            );
+        }
+        ffmpeg->resync = false;
+    }
 
     av_packet_unref(ffmpeg->packet);
     ffmpeg->packet->data = (Uint8 *)packet_data;
     ffmpeg->packet->size = (int)packet_size;
+    vdi_stream_client__parsec_ffmpeg_band_begin(ffmpeg);
 
     err = vdi_stream_client__parsec_ffmpeg_send_packet(ffmpeg->codec, ffmpeg->packet);
     if (err == AVERROR(EAGAIN)) {
         err = vdi_stream_client__parsec_ffmpeg_receive_frame(ffmpeg->codec, ffmpeg->frame);
-        if (err == 0) {
-            if (frame_data == NULL) {
-                return DECODE_WRN_ACCEPTED;
-            }
-            return vdi_stream_client__parsec_ffmpeg_write_frame(ffmpeg, frame_data, frame_size);
+        if (err == AVERROR(EAGAIN) || err == AVERROR_EOF) {
+            return DECODE_WRN_ACCEPTED;
         }
-        return DECODE_WRN_ACCEPTED;
+        if (err < 0) {
+            return vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, err, true);
+        }
+        vdi_stream_client__parsec_ffmpeg_pipeline_sample(ffmpeg);
+
+        /* The output queue has room again, so the packet is not lost. */
+        err = vdi_stream_client__parsec_ffmpeg_send_packet(ffmpeg->codec, ffmpeg->packet);
+        if (err < 0) {
+            av_frame_unref(ffmpeg->frame);
+            return vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, err, false);
+        }
+        ffmpeg->pipeline_depth++;
+        vdi_stream_client__parsec_ffmpeg_error_clear(ffmpeg);
+        if (frame_data == NULL) {
+            return DECODE_WRN_ACCEPTED;
+        }
+        return vdi_stream_client__parsec_ffmpeg_write_frame(ffmpeg, frame_data, frame_size);
     }
     if (err < 0) {
-        SDL_LogWarn(
-            SDL_LOG_CATEGORY_APPLICATION, "FFmpeg packet decode failed: %s\n",
-            vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
-        );
-        return DECODE_ERR_DECODE;
+        return vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, err, false);
     }
+    ffmpeg->pipeline_depth++;
 
     err = vdi_stream_client__parsec_ffmpeg_receive_frame(ffmpeg->codec, ffmpeg->frame);
     if (err == AVERROR(EAGAIN) || err == AVERROR_EOF) {
         return DECODE_WRN_ACCEPTED;
     }
     if (err < 0) {
-        SDL_LogWarn(
-            SDL_LOG_CATEGORY_APPLICATION, "FFmpeg frame receive failed: %s\n",
-            vdi_stream_client__parsec_ffmpeg_error(err, errbuf, sizeof(errbuf))
-        );
-        return DECODE_ERR_DECODE;
+        return vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, err, true);
     }
+    vdi_stream_client__parsec_ffmpeg_pipeline_sample(ffmpeg);
+    vdi_stream_client__parsec_ffmpeg_error_clear(ffmpeg);
     if (frame_data == NULL) {
         return DECODE_WRN_ACCEPTED;
     }
@@ -1538,13 +3410,106 @@ vdi_stream_client__parsec_ffmpeg_decode(
     return vdi_stream_client__parsec_ffmpeg_write_frame(ffmpeg, frame_data, frame_size);
 }
 
+/* Parsec decoder decode callback. It applies the loop filter discard level
+ * requested by the degradation ladder, which FFmpeg reads per packet, and
+ * accounts the time spent in the callback as decoder load. */
+static Sint32
+vdi_stream_client__parsec_ffmpeg_decode(
+    void *decoder, const void *packet_data, Uint32 packet_size, void *frame_data, Uint32 *frame_size
+)
+{
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg = decoder;
+    bool load_enabled =
+        atomic_load_explicit(&vdi_stream_client__parsec_ffmpeg_load_enabled, memory_order_relaxed);
+    Uint64 start_ns = load_enabled ? SDL_GetTicksNS() : 0;
+    Sint32 status;
+
+    if (ffmpeg != NULL && ffmpeg->codec != NULL) {
+        ffmpeg->codec->skip_loop_filter = (enum AVDiscard)atomic_load_explicit(
+            &vdi_stream_client__parsec_ffmpeg_skip_loop_filter, memory_order_relaxed
+        );
+    }
+    status = vdi_stream_client__parsec_ffmpeg_decode_packet(
+        decoder, packet_data, packet_size, frame_data, frame_size
+    );
+    if (load_enabled) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__parsec_ffmpeg_load_ns, (uint_fast64_t)(SDL_GetTicksNS() - start_ns),
+            memory_order_relaxed
+        );
+    }
+    return status;
+}
+
+/* Start or stop accounting decoder load for the degradation ladder. */
+void
+vdi_stream_client__parsec_ffmpeg_load_enable(bool enabled)
+{
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_load_enabled, enabled, memory_order_relaxed
+    );
+}
+
+/* Enable row band preparation for software decoders opened from now on. Only
+ * codecs that report finished rows, such as FFmpeg's H.264 decoder, use it. */
+void
+vdi_stream_client__parsec_ffmpeg_progressive_enable(bool enabled)
+{
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_progressive, enabled, memory_order_relaxed
+    );
+}
+
+/* Register the allocator backing the software frame pools, or clear it with
+ * NULL. Pools of running decoders are rebuilt on their next frame, so buffers
+ * allocated before a renderer registered do not linger. Buffers the provider
+ * returns must stay valid until their AVBuffer free callback runs. Once this
+ * returns, no allocation through the previous provider is in flight. */
+void
+vdi_stream_client__parsec_ffmpeg_buffer_provider(AVBufferRef *(*alloc)(size_t size))
+{
+    SDL_LockSpinlock(&vdi_stream_client__parsec_ffmpeg_buffer_provider_lock);
+    vdi_stream_client__parsec_ffmpeg_buffer_provider_alloc = alloc;
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__parsec_ffmpeg_buffer_provider_generation, 1u, memory_order_relaxed
+    );
+    SDL_UnlockSpinlock(&vdi_stream_client__parsec_ffmpeg_buffer_provider_lock);
+}
+
+/* Drain the decoder load counters: frames returned, nanoseconds spent in the
+ * decode callback and decoded frames superseded in the mailbox before the
+ * renderer took them. */
+void
+vdi_stream_client__parsec_ffmpeg_drain_load(Uint64 *frames, Uint64 *decode_ns, Uint64 *dropped)
+{
+    *frames = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_load_frames, (uint_fast64_t)0, memory_order_relaxed
+    );
+    *decode_ns = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_load_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+    *dropped = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__parsec_ffmpeg_load_dropped, (uint_fast64_t)0, memory_order_relaxed
+    );
+}
+
+/* Publish the AVDiscard level for loop filtering. It is applied by the decode
+ * callback before the next packet. */
+void
+vdi_stream_client__parsec_ffmpeg_discard(Sint32 skip_loop_filter)
+{
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_skip_loop_filter, skip_loop_filter, memory_order_relaxed
+    );
+}
+
 /* Install the injected FFmpeg decoder into Parsec's decoder table, hide the SDK
  * software/hardware decoders, publish startup policy for callbacks, and return
  * the decoder index Parsec should request. */
 bool
 vdi_stream_client__parsec_ffmpeg_decoder_enable(
     struct parsec_context_s *parsec_context, Uint32 *decoder_index, bool h264_acceleration,
-    bool hevc_acceleration, bool color444
+    bool hevc_acceleration, bool color444, Uint32 threads, vdi_decoder_thread_type_e thread_type
 )
 {
     Uint8 *table;
@@ -1566,6 +3531,10 @@ vdi_stream_client__parsec_ffmpeg_decoder_enable(
     atomic_store_explicit(
         &vdi_stream_client__parsec_ffmpeg_color444, color444, memory_order_relaxed
     );
+    atomic_store_explicit(&vdi_stream_client__parsec_ffmpeg_threads, threads, memory_order_relaxed);
+    atomic_store_explicit(
+        &vdi_stream_client__parsec_ffmpeg_thread_type, (int)thread_type, memory_order_relaxed
+    );
 
     table = vdi_stream_client__parsec_decoder_table(parsec_context);
     if (table == NULL) {
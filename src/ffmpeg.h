@@ -15,8 +15,11 @@
 #ifndef _FFMPEG_H
 #define _FFMPEG_H
 
+#include "client.h"
 #include "parsec.h"
 
+struct AVBufferRef;
+struct AVPacket;
 struct AVFrame;
 
 struct vdi_stream_client__parsec_ffmpeg_stats_s
@@ -30,6 +33,37 @@ struct vdi_stream_client__parsec_ffmpeg_stats_s
     Uint64 hwframe_transfer_ns;
     Uint64 descriptor_fallback_calls;
     Uint64 descriptor_fallback_ns;
+    Uint64 band_calls;
+    Uint64 band_ns;
+    Uint64 band_frames;
+    Uint64 band_incomplete;
+    Uint64 pipeline_frames;
+    Uint64 pipeline_depth;
+    Uint64 pipeline_depth_max;
+    Uint64 frame_allocations;
+    Uint64 frames_dropped;
+    Uint64 decoder_inits;
+    Uint64 decoder_init_ns;
+    Uint64 device_reuses;
+    Uint64 context_reuses;
+    Uint64 pool_reuses;
+    Uint64 reuse_saved_ns;
+    Uint64 decode_errors;
+    Uint64 decode_flushes;
+    Uint64 resync_dropped;
+    Uint64 recoveries;
+    Uint64 error_ns;
+    Uint32 thread_count;
+    bool frame_threads;
+};
+
+struct vdi_stream_client__parsec_ffmpeg_memory_s
+{
+    Uint64 retained_frames;
+    Uint64 retained_hardware_frames;
+    Uint64 retained_bytes;
+    Uint64 pool_surfaces;
+    Uint64 pool_bytes;
 };
 
 bool
@@ -37,26 +71,57 @@ vdi_stream_client__parsec_ffmpeg_frame_is_descriptor(const ParsecFrame *frame, c
 bool
 vdi_stream_client__parsec_ffmpeg_frame_is_hardware(const ParsecFrame *frame, const void *image);
 struct AVFrame *
-vdi_stream_client__parsec_ffmpeg_frame_ref(const ParsecFrame *frame, const void *image);
+vdi_stream_client__parsec_ffmpeg_frame_acquire(const ParsecFrame *frame, const void *image);
+bool vdi_stream_client__parsec_ffmpeg_frame_keep(
+    const ParsecFrame *frame, const void *image, void *descriptor, size_t size
+);
 Sint32 vdi_stream_client__parsec_ffmpeg_hwframe_transfer(
     struct AVFrame *destination, const struct AVFrame *source
 );
 bool vdi_stream_client__parsec_ffmpeg_frame_texture_format(
     const ParsecFrame *frame, const void *image, SDL_PixelFormat *pixel_format
 );
+bool vdi_stream_client__parsec_ffmpeg_avframe_texture_format(
+    const struct AVFrame *av_frame, SDL_PixelFormat *pixel_format
+);
+bool vdi_stream_client__parsec_ffmpeg_avframe_update(
+    SDL_Texture *texture, const struct AVFrame *av_frame, Uint64 *upload_ns
+);
 bool vdi_stream_client__parsec_ffmpeg_frame_update(
-    SDL_Texture *texture, const ParsecFrame *frame, const void *image, Uint64 *upload_ns
+    SDL_Texture *texture, const ParsecFrame *frame, const void *image,
+    struct vdi_stream_client__damage_s *damage, Uint64 *upload_ns
+);
+bool vdi_stream_client__parsec_ffmpeg_frame_capture_ns(
+    const ParsecFrame *frame, const void *image, Uint64 *capture_ns
 );
 void vdi_stream_client__parsec_ffmpeg_frame_release(const ParsecFrame *frame, const void *image);
 void vdi_stream_client__parsec_ffmpeg_drain_stats(
     struct vdi_stream_client__parsec_ffmpeg_stats_s *stats
 );
+void vdi_stream_client__parsec_ffmpeg_memory(
+    struct vdi_stream_client__parsec_ffmpeg_memory_s *memory
+);
 bool vdi_stream_client__parsec_ffmpeg_decoder_is_hardware(void);
 bool vdi_stream_client__parsec_ffmpeg_vaapi_codecs(bool *h264, bool *hevc, bool *hevc444);
+struct AVBufferRef *vdi_stream_client__parsec_ffmpeg_vaapi_device(void);
+void vdi_stream_client__parsec_ffmpeg_release(void);
+void vdi_stream_client__parsec_ffmpeg_load_enable(bool enabled);
+void vdi_stream_client__parsec_ffmpeg_progressive_enable(bool enabled);
+void vdi_stream_client__parsec_ffmpeg_buffer_provider(
+    struct AVBufferRef *(*alloc)(size_t size)
+);
+void vdi_stream_client__parsec_ffmpeg_drain_load(
+    Uint64 *frames, Uint64 *decode_ns, Uint64 *dropped
+);
+void vdi_stream_client__parsec_ffmpeg_discard(Sint32 skip_loop_filter);
+bool vdi_stream_client__parsec_ffmpeg_sample_decode(
+    bool hevc, bool hardware, struct AVPacket *const *packets, Uint32 count, Uint64 deadline_ns,
+    Uint64 *frame_ns
+);
 
 bool vdi_stream_client__parsec_ffmpeg_decoder_enable(
     struct parsec_context_s *parsec_context, Uint32 *decoder_index, bool h264_acceleration,
-    bool hevc_acceleration, bool color444
+    bool hevc_acceleration, bool color444, Uint32 threads, vdi_decoder_thread_type_e thread_type
 );
 
 #endif /* _FFMPEG_H */
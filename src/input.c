@@ -128,12 +128,44 @@ vdi_stream_client__input_next_command(
     return true;
 }
 
+/* Account the time from SDL queuing an input event to its Parsec send. It
+ * covers main-thread event pumping, so it stays flat only while nothing else
+ * on the main thread blocks. */
+static void
+vdi_stream_client__input_latency(struct parsec_context_s *parsec_context, Uint64 timestamp_ns)
+{
+    Uint64 now_ns = SDL_GetTicksNS();
+    Uint64 latency_ns;
+    uint_fast64_t latency_max_ns;
+
+    if (timestamp_ns == 0 || timestamp_ns > now_ns) {
+        return;
+    }
+    latency_ns = now_ns - timestamp_ns;
+
+    atomic_fetch_add_explicit(
+        &parsec_context->stats_input_messages, (uint_fast64_t)1, memory_order_relaxed
+    );
+    atomic_fetch_add_explicit(
+        &parsec_context->stats_input_latency_ns, (uint_fast64_t)latency_ns, memory_order_relaxed
+    );
+    latency_max_ns = atomic_load_explicit(
+        &parsec_context->stats_input_latency_max_ns, memory_order_relaxed
+    );
+    if (latency_ns > latency_max_ns) {
+        atomic_store_explicit(
+            &parsec_context->stats_input_latency_max_ns, (uint_fast64_t)latency_ns,
+            memory_order_relaxed
+        );
+    }
+}
+
 /* Send a populated Parsec input message only while the connection is active.
  * The input_polling flag lets reconnect and shutdown paths wait until this
  * short critical section stops using the Parsec client. */
 static void
 vdi_stream_client__input_send_message(
-    struct parsec_context_s *parsec_context, const ParsecMessage *pmsg
+    struct parsec_context_s *parsec_context, const ParsecMessage *pmsg, Uint64 timestamp_ns
 )
 {
     if (pmsg == NULL || pmsg->type == 0 || !vdi_stream_client__context_connected(parsec_context)) {
@@ -144,6 +176,9 @@ vdi_stream_client__input_send_message(
     if (vdi_stream_client__context_connected(parsec_context) &&
         !vdi_stream_client__context_done(parsec_context)) {
         ParsecClientSendMessage(parsec_context->parsec, pmsg);
+        if (parsec_context->stats_enabled) {
+            vdi_stream_client__input_latency(parsec_context, timestamp_ns);
+        }
     }
     vdi_stream_client__context_set_input_polling(parsec_context, false);
 }
@@ -200,8 +235,7 @@ vdi_stream_client__input_handle_key_down(
 }
 
 /* Convert one SDL event into a Parsec input message and/or a command for the
- * main thread. It also marks local interaction so the render loop can shorten
- * frame polling latency after fresh user input. */
+ * main thread. */
 static void
 vdi_stream_client__input_handle_event(
     vdi_stream_client__input_context_s *input_context, const SDL_Event *msg
@@ -215,7 +249,6 @@ vdi_stream_client__input_handle_event(
             &parsec_context->stats_sdl_events, (uint_fast64_t)1, memory_order_relaxed
         );
     }
-    vdi_stream_client__context_set_input_local_interaction(parsec_context);
     if (!vdi_stream_client__context_connected(parsec_context)) {
         vdi_stream_client__context_set_input_force_redraw(parsec_context);
     }
@@ -300,11 +333,13 @@ vdi_stream_client__input_handle_event(
         break;
     }
 
-    vdi_stream_client__input_send_message(parsec_context, &pmsg);
+    vdi_stream_client__input_send_message(parsec_context, &pmsg, msg->common.timestamp);
 }
 
 /* Drain SDL events on a worker thread and hand each event to the input
- * translator. Window-affecting operations are queued back to the main thread. */
+ * translator. Window-affecting operations are queued back to the main thread.
+ * Registered user events such as the frame wakeup belong to the main thread
+ * and stay queued. */
 Sint32
 vdi_stream_client__input_thread(void *opaque)
 {
@@ -315,7 +350,7 @@ vdi_stream_client__input_thread(void *opaque)
     while (!vdi_stream_client__context_done(input_context->parsec_context)) {
         int count = SDL_PeepEvents(
             events, (int)(sizeof(events) / sizeof(events[0])), SDL_GETEVENT, SDL_EVENT_FIRST,
-            SDL_EVENT_LAST
+            SDL_EVENT_USER - 1
         );
 
         if (count <= 0) {
@@ -28,10 +28,20 @@
 /* internal includes. */
 #include "audio.h"
 #include "client.h"
+#include "clock.h"
+#include "copy.h"
+#include "damage.h"
+#include "degrade.h"
 #include "ffmpeg.h"
 #include "input.h"
 #include "parsec.h"
+#include "placebo.h"
+#include "pool.h"
+#include "present.h"
+#include "profile.h"
 #include "redirect.h"
+#include "shadow.h"
+#include "tune.h"
 #include "video.h"
 
 /* font include. */
@@ -102,6 +112,91 @@ vdi_stream_client__stats_avg_ms(Uint64 ns, Uint64 calls)
     return vdi_stream_client__stats_ms(ns) / (double)calls;
 }
 
+/* Compute the frame rate a stage could sustain if it ran back to back, from
+ * the frames it handled and the time it spent on them. */
+static double
+vdi_stream_client__stats_fps(Uint64 frames, Uint64 ns)
+{
+    if (ns == 0) {
+        return 0.0;
+    }
+
+    return (double)frames * 1000000000.0 / (double)ns;
+}
+
+/* Convert a byte count into mebibytes for memory statistics output. */
+static double
+vdi_stream_client__stats_mib(Uint64 bytes)
+{
+    return (double)bytes / (1024.0 * 1024.0);
+}
+
+/* Read the resident and proportional set sizes of this process from procfs.
+ * PSS splits pages shared with other processes, such as GPU driver mappings,
+ * and both values stay zero when smaps_rollup is unavailable. */
+static void
+vdi_stream_client__stats_process_memory(Uint64 *rss_bytes, Uint64 *pss_bytes)
+{
+    char line[256];
+    unsigned long long value;
+    FILE *file;
+
+    *rss_bytes = 0;
+    *pss_bytes = 0;
+    file = fopen("/proc/self/smaps_rollup", "r");
+    if (file == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "Rss: %llu kB", &value) == 1) {
+            *rss_bytes = (Uint64)value * 1024u;
+        } else if (sscanf(line, "Pss: %llu kB", &value) == 1) {
+            *pss_bytes = (Uint64)value * 1024u;
+        }
+    }
+    fclose(file);
+}
+
+/* Emit current memory levels next to the render statistics. Unlike the stage
+ * counters these are gauges, so they describe the state at the end of the
+ * period and are never reset. */
+static void
+vdi_stream_client__memory_stats(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__parsec_ffmpeg_memory_s ffmpeg_memory = { 0 };
+    struct vdi_stream_client__placebo_memory_s placebo_memory = { 0 };
+    Uint64 rss_bytes;
+    Uint64 pss_bytes;
+
+    vdi_stream_client__stats_process_memory(&rss_bytes, &pss_bytes);
+    vdi_stream_client__parsec_ffmpeg_memory(&ffmpeg_memory);
+    vdi_stream_client__placebo_memory(parsec_context, &placebo_memory);
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Memory:\n"
+        "  process: rss=%.1fMiB, pss=%.1fMiB\n"
+        "  frames: retained=%llu, vaapi=%llu, total=%.1fMiB, avg=%.1fMiB\n"
+        "  vaapi: surfaces=%llu, pool=%.1fMiB\n"
+        "  vulkan: target=%.1fMiB, heap=%.1fMiB, budget=%.1fMiB\n"
+        "  sdl: textures=%.1fMiB\n",
+        vdi_stream_client__stats_mib(rss_bytes), vdi_stream_client__stats_mib(pss_bytes),
+        (unsigned long long)ffmpeg_memory.retained_frames,
+        (unsigned long long)ffmpeg_memory.retained_hardware_frames,
+        vdi_stream_client__stats_mib(ffmpeg_memory.retained_bytes),
+        ffmpeg_memory.retained_frames != 0
+            ? vdi_stream_client__stats_mib(ffmpeg_memory.retained_bytes) /
+                  (double)ffmpeg_memory.retained_frames
+            : 0.0,
+        (unsigned long long)ffmpeg_memory.pool_surfaces,
+        vdi_stream_client__stats_mib(ffmpeg_memory.pool_bytes),
+        vdi_stream_client__stats_mib(placebo_memory.target_bytes),
+        vdi_stream_client__stats_mib(placebo_memory.heap_usage),
+        vdi_stream_client__stats_mib(placebo_memory.heap_budget),
+        vdi_stream_client__stats_mib(vdi_stream_client__video_memory(parsec_context))
+    );
+}
+
 /* Reset per-period render counters after a stats line is emitted. Counters that
  * are drained from other modules are reset through their own drain helpers. */
 static void
@@ -122,10 +217,133 @@ vdi_stream_client__render_stats_reset(struct parsec_context_s *parsec_context)
     parsec_context->stats_zero_copy_fallbacks = 0;
     parsec_context->stats_idle_waits = 0;
     parsec_context->stats_idle_wait_ms = 0;
+    parsec_context->stats_metrics_samples = 0;
+    parsec_context->stats_encode_latency = 0.0;
+    parsec_context->stats_encode_latency_max = 0.0;
+    parsec_context->stats_decode_latency = 0.0;
+    parsec_context->stats_decode_latency_max = 0.0;
+    parsec_context->stats_network_latency = 0.0;
+    parsec_context->stats_network_latency_max = 0.0;
+    parsec_context->stats_bitrate = 0.0;
+    parsec_context->stats_queued_frames = 0;
+    parsec_context->stats_queued_frames_max = 0;
+    parsec_context->stats_cadence_intervals = 0;
+    parsec_context->stats_cadence_mean_ms = 0.0;
+    parsec_context->stats_cadence_m2 = 0.0;
+    parsec_context->stats_cadence_longest_ns = 0;
+    parsec_context->stats_cadence_skipped_vsyncs = 0;
+    parsec_context->stats_cadence_duplicated_vsyncs = 0;
+    parsec_context->stats_cadence_source_gaps = 0;
+    parsec_context->stats_cadence_client_gaps = 0;
+    parsec_context->stats_cadence_idle_gaps = 0;
+}
+
+/* Accumulate the Parsec stream metrics from the latest client status. The main
+ * loop already polls the status for connection health, so this only reads the
+ * cached struct and is limited to PARSEC_METRICS_SAMPLE_MS to bound the work. */
+static void
+vdi_stream_client__metrics_sample(struct parsec_context_s *parsec_context)
+{
+    const ParsecMetrics *metrics = &parsec_context->client_status.self.metrics[DEFAULT_STREAM];
+    Uint64 now;
+
+    if (!parsec_context->stats_enabled || !vdi_stream_client__context_connected(parsec_context)) {
+        return;
+    }
+
+    now = SDL_GetTicks();
+    if (now < parsec_context->stats_metrics_next_tick) {
+        return;
+    }
+    parsec_context->stats_metrics_next_tick = now + PARSEC_METRICS_SAMPLE_MS;
+
+    parsec_context->stats_metrics_samples++;
+    parsec_context->stats_encode_latency += metrics->encodeLatency;
+    parsec_context->stats_encode_latency_max =
+        SDL_max(parsec_context->stats_encode_latency_max, (double)metrics->encodeLatency);
+    parsec_context->stats_decode_latency += metrics->decodeLatency;
+    parsec_context->stats_decode_latency_max =
+        SDL_max(parsec_context->stats_decode_latency_max, (double)metrics->decodeLatency);
+    parsec_context->stats_network_latency += metrics->networkLatency;
+    parsec_context->stats_network_latency_max =
+        SDL_max(parsec_context->stats_network_latency_max, (double)metrics->networkLatency);
+    parsec_context->stats_bitrate += metrics->bitrate;
+    parsec_context->stats_queued_frames += metrics->queuedFrames;
+    parsec_context->stats_queued_frames_max =
+        SDL_max(parsec_context->stats_queued_frames_max, (Uint64)metrics->queuedFrames);
+}
+
+/* Return the growth of a cumulative Parsec packet counter since the previous
+ * report. Counters restart on reconnect, so a smaller value is a new session. */
+static Uint64
+vdi_stream_client__metrics_delta(Uint32 value, Uint32 base)
+{
+    return value >= base ? (Uint64)(value - base) : (Uint64)value;
+}
+
+/* Remember the cumulative Parsec packet counters at the start of a period. */
+static void
+vdi_stream_client__metrics_rebase(struct parsec_context_s *parsec_context)
+{
+    const ParsecMetrics *metrics = &parsec_context->client_status.self.metrics[DEFAULT_STREAM];
+
+    parsec_context->stats_packets_sent_base = metrics->packetsSent;
+    parsec_context->stats_fast_retransmits_base = metrics->fastRTs;
+    parsec_context->stats_slow_retransmits_base = metrics->slowRTs;
+}
+
+/* Emit host, network and client latency shares reported by Parsec. Encode
+ * latency is spent on the host, network latency is the measured round trip and
+ * decode latency is the client share seen by the SDK. Retransmits relative to
+ * sent packets approximate packet loss on the video stream. */
+static void
+vdi_stream_client__metrics_stats(struct parsec_context_s *parsec_context)
+{
+    const ParsecMetrics *metrics = &parsec_context->client_status.self.metrics[DEFAULT_STREAM];
+    double samples = parsec_context->stats_metrics_samples != 0
+                         ? (double)parsec_context->stats_metrics_samples
+                         : 1.0;
+    Uint64 packets_sent = vdi_stream_client__metrics_delta(
+        metrics->packetsSent, parsec_context->stats_packets_sent_base
+    );
+    Uint64 fast_retransmits = vdi_stream_client__metrics_delta(
+        metrics->fastRTs, parsec_context->stats_fast_retransmits_base
+    );
+    Uint64 slow_retransmits = vdi_stream_client__metrics_delta(
+        metrics->slowRTs, parsec_context->stats_slow_retransmits_base
+    );
+    double loss = packets_sent != 0
+                      ? (double)(fast_retransmits + slow_retransmits) * 100.0 / (double)packets_sent
+                      : 0.0;
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Network:\n"
+        "  samples: %llu\n"
+        "  latency:\n"
+        "    encode: avg=%.3fms, max=%.3fms\n"
+        "    network: avg=%.3fms, max=%.3fms\n"
+        "    decode: avg=%.3fms, max=%.3fms\n"
+        "  bitrate: host=%.3fMbps\n"
+        "  queue: avg=%.2f, max=%llu\n"
+        "  packets: sent=%llu, fast_retransmits=%llu, slow_retransmits=%llu, loss=%.2f%%\n",
+        (unsigned long long)parsec_context->stats_metrics_samples,
+        parsec_context->stats_encode_latency / samples, parsec_context->stats_encode_latency_max,
+        parsec_context->stats_network_latency / samples,
+        parsec_context->stats_network_latency_max,
+        parsec_context->stats_decode_latency / samples, parsec_context->stats_decode_latency_max,
+        parsec_context->stats_bitrate / samples,
+        (double)parsec_context->stats_queued_frames / samples,
+        (unsigned long long)parsec_context->stats_queued_frames_max,
+        (unsigned long long)packets_sent, (unsigned long long)fast_retransmits,
+        (unsigned long long)slow_retransmits, loss
+    );
+    vdi_stream_client__metrics_rebase(parsec_context);
 }
 
 /* Reconnect the existing Parsec client after first marking the stream
- * disconnected and waiting for audio/input worker calls to leave Parsec APIs. */
+ * disconnected and waiting for audio/input/frame worker calls to leave Parsec
+ * APIs. */
 static ParsecStatus
 vdi_stream_client__parsec_reconnect(
     struct parsec_context_s *parsec_context, ParsecClientConfig *cfg,
@@ -135,14 +353,20 @@ vdi_stream_client__parsec_reconnect(
     ParsecStatus e;
 
     vdi_stream_client__context_set_connection(parsec_context, false);
-    parsec_context->requested_width = 0;
-    parsec_context->requested_height = 0;
+    vdi_stream_client__video_wake(parsec_context);
     while (vdi_stream_client__context_audio_polling(parsec_context)) {
         SDL_Delay(1);
     }
     while (vdi_stream_client__context_input_polling(parsec_context)) {
         SDL_Delay(1);
     }
+    while (vdi_stream_client__context_render_polling(parsec_context)) {
+        SDL_Delay(1);
+    }
+    SDL_LockMutex(parsec_context->render_lock);
+    parsec_context->requested_width = 0;
+    parsec_context->requested_height = 0;
+    SDL_UnlockMutex(parsec_context->render_lock);
 
     ParsecClientDisconnect(parsec_context->parsec);
     e = ParsecClientConnect(parsec_context->parsec, cfg, vdi_config->session, vdi_config->peer);
@@ -179,8 +403,15 @@ vdi_stream_client__render_stats(struct parsec_context_s *parsec_context)
     Uint64 period_start_ms;
     Uint64 elapsed_ms;
     Uint64 sdl_events;
+    Uint64 input_messages;
+    Uint64 input_latency_ns;
+    Uint64 input_latency_max_ns;
     struct vdi_stream_client__parsec_ffmpeg_stats_s ffmpeg_stats = { 0 };
     double video_mbps;
+    Uint64 decode_ns;
+    double decode_fps;
+    double upload_fps;
+    const char *sustained;
 
     if (!parsec_context->stats_enabled) {
         return;
@@ -196,7 +427,17 @@ vdi_stream_client__render_stats(struct parsec_context_s *parsec_context)
         (void)atomic_exchange_explicit(
             &parsec_context->stats_sdl_events, (uint_fast64_t)0, memory_order_relaxed
         );
+        (void)atomic_exchange_explicit(
+            &parsec_context->stats_input_messages, (uint_fast64_t)0, memory_order_relaxed
+        );
+        (void)atomic_exchange_explicit(
+            &parsec_context->stats_input_latency_ns, (uint_fast64_t)0, memory_order_relaxed
+        );
+        (void)atomic_exchange_explicit(
+            &parsec_context->stats_input_latency_max_ns, (uint_fast64_t)0, memory_order_relaxed
+        );
         vdi_stream_client__render_stats_reset(parsec_context);
+        vdi_stream_client__metrics_rebase(parsec_context);
         parsec_context->stats_next_tick = now + parsec_context->stats_period_ms;
         return;
     }
@@ -214,20 +455,54 @@ vdi_stream_client__render_stats(struct parsec_context_s *parsec_context)
     sdl_events = (Uint64)atomic_exchange_explicit(
         &parsec_context->stats_sdl_events, (uint_fast64_t)0, memory_order_relaxed
     );
+    input_messages = (Uint64)atomic_exchange_explicit(
+        &parsec_context->stats_input_messages, (uint_fast64_t)0, memory_order_relaxed
+    );
+    input_latency_ns = (Uint64)atomic_exchange_explicit(
+        &parsec_context->stats_input_latency_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+    input_latency_max_ns = (Uint64)atomic_exchange_explicit(
+        &parsec_context->stats_input_latency_max_ns, (uint_fast64_t)0, memory_order_relaxed
+    );
+
+    /* Decode capacity counts the time the decode callback spends per frame. */
+    decode_ns = ffmpeg_stats.send_packet_ns + ffmpeg_stats.receive_frame_ns +
+                ffmpeg_stats.descriptor_fallback_ns;
+    decode_fps = vdi_stream_client__stats_fps(ffmpeg_stats.pipeline_frames, decode_ns);
+    upload_fps = vdi_stream_client__stats_fps(
+        parsec_context->stats_uploads, parsec_context->stats_upload_ns
+    );
+    if (ffmpeg_stats.pipeline_frames == 0) {
+        sustained = "n/a";
+    } else if (decode_fps >= PARSEC_TARGET_FPS &&
+               (parsec_context->stats_uploads == 0 || upload_fps >= PARSEC_TARGET_FPS)) {
+        sustained = "yes";
+    } else {
+        sustained = "no";
+    }
 
     SDL_LogInfo(
         SDL_LOG_CATEGORY_APPLICATION,
         "Render:\n"
         "  loop: loops=%llu, presents=%llu\n"
         "  events: sdl=%llu, parsec=%llu\n"
-        "  frames: frames=%llu, age=%llums\n"
+        "  input: messages=%llu, send_avg=%.3fms, send_max=%.3fms\n"
+        "  frames: frames=%llu, age=%llums, dropped=%llu\n"
         "  idle: waits=%llu, ms=%llu\n"
         "  bandwidth: video=%.3fMbps\n"
+        "  pipeline: threads=%u, type=%s, depth_avg=%.2f, depth_max=%llu, frame_allocs=%llu\n"
+        "  throughput: target=%dfps, decode=%.1ffps, upload=%.1ffps, sustained=%s\n"
+        "  reinit: inits=%llu, avg=%.3fms, device_reuse=%llu, context_reuse=%llu, "
+        "pool_reuse=%llu, saved=%.3fms\n"
+        "  recovery: errors=%llu, flushes=%llu, skipped=%llu, recoveries=%llu, "
+        "in_error=%.3fms\n"
         "  stages:\n"
         "    avcodec_send_packet: calls=%llu, total=%.3fms, avg=%.3fms\n"
         "    avcodec_receive_frame: calls=%llu, total=%.3fms, avg=%.3fms\n"
         "    av_hwframe_transfer_data: calls=%llu, total=%.3fms, avg=%.3fms\n"
         "    descriptor_fallback: calls=%llu, total=%.3fms, avg=%.3fms\n"
+        "    progressive_bands: calls=%llu, total=%.3fms, avg=%.3fms, frames=%llu, "
+        "incomplete=%llu\n"
         "    vaapi_zero_copy: calls=%llu, total=%.3fms, avg=%.3fms, fallbacks=%llu\n"
         "    sdl_upload: calls=%llu, total=%.3fms, avg=%.3fms\n"
         "    render: calls=%llu, total=%.3fms, avg=%.3fms\n"
@@ -235,9 +510,30 @@ vdi_stream_client__render_stats(struct parsec_context_s *parsec_context)
         (unsigned long long)parsec_context->stats_loops,
         (unsigned long long)parsec_context->stats_presents, (unsigned long long)sdl_events,
         (unsigned long long)parsec_context->stats_parsec_events,
+        (unsigned long long)input_messages,
+        vdi_stream_client__stats_avg_ms(input_latency_ns, input_messages),
+        vdi_stream_client__stats_ms(input_latency_max_ns),
         (unsigned long long)parsec_context->stats_frames, (unsigned long long)last_frame_age_ms,
+        (unsigned long long)ffmpeg_stats.frames_dropped,
         (unsigned long long)parsec_context->stats_idle_waits,
         (unsigned long long)parsec_context->stats_idle_wait_ms, video_mbps,
+        ffmpeg_stats.thread_count, ffmpeg_stats.frame_threads ? "frame" : "slice",
+        ffmpeg_stats.pipeline_frames != 0
+            ? (double)ffmpeg_stats.pipeline_depth / (double)ffmpeg_stats.pipeline_frames
+            : 0.0,
+        (unsigned long long)ffmpeg_stats.pipeline_depth_max,
+        (unsigned long long)ffmpeg_stats.frame_allocations, PARSEC_TARGET_FPS, decode_fps,
+        upload_fps, sustained, (unsigned long long)ffmpeg_stats.decoder_inits,
+        vdi_stream_client__stats_avg_ms(ffmpeg_stats.decoder_init_ns, ffmpeg_stats.decoder_inits),
+        (unsigned long long)ffmpeg_stats.device_reuses,
+        (unsigned long long)ffmpeg_stats.context_reuses,
+        (unsigned long long)ffmpeg_stats.pool_reuses,
+        vdi_stream_client__stats_ms(ffmpeg_stats.reuse_saved_ns),
+        (unsigned long long)ffmpeg_stats.decode_errors,
+        (unsigned long long)ffmpeg_stats.decode_flushes,
+        (unsigned long long)ffmpeg_stats.resync_dropped,
+        (unsigned long long)ffmpeg_stats.recoveries,
+        vdi_stream_client__stats_ms(ffmpeg_stats.error_ns),
         (unsigned long long)ffmpeg_stats.send_packet_calls,
         vdi_stream_client__stats_ms(ffmpeg_stats.send_packet_ns),
         vdi_stream_client__stats_avg_ms(
@@ -258,6 +554,11 @@ vdi_stream_client__render_stats(struct parsec_context_s *parsec_context)
         vdi_stream_client__stats_avg_ms(
             ffmpeg_stats.descriptor_fallback_ns, ffmpeg_stats.descriptor_fallback_calls
         ),
+        (unsigned long long)ffmpeg_stats.band_calls,
+        vdi_stream_client__stats_ms(ffmpeg_stats.band_ns),
+        vdi_stream_client__stats_avg_ms(ffmpeg_stats.band_ns, ffmpeg_stats.band_calls),
+        (unsigned long long)ffmpeg_stats.band_frames,
+        (unsigned long long)ffmpeg_stats.band_incomplete,
         (unsigned long long)parsec_context->stats_zero_copy_calls,
         vdi_stream_client__stats_ms(parsec_context->stats_zero_copy_ns),
         vdi_stream_client__stats_avg_ms(
@@ -280,23 +581,41 @@ vdi_stream_client__render_stats(struct parsec_context_s *parsec_context)
             parsec_context->stats_present_ns, parsec_context->stats_present_calls
         )
     );
+    vdi_stream_client__metrics_stats(parsec_context);
+    vdi_stream_client__video_cadence_stats(parsec_context);
+    vdi_stream_client__memory_stats(parsec_context);
+    vdi_stream_client__clock_stats(parsec_context);
+    vdi_stream_client__shadow_stats(parsec_context);
+    vdi_stream_client__degrade_stats(parsec_context);
+    vdi_stream_client__present_stats(parsec_context);
+    vdi_stream_client__damage_stats(parsec_context);
+    vdi_stream_client__pool_stats();
 
     parsec_context->stats_next_tick = now + parsec_context->stats_period_ms;
     vdi_stream_client__render_stats_reset(parsec_context);
 }
 
 /* Signal every worker thread to stop and wait for them to release shared runtime
- * resources. Network threads are joined first so USB redirect I/O cannot keep
- * using context state while input/audio teardown continues. */
+ * resources. The frame thread is woken and joined first so no frame poll is left
+ * running, then network threads so USB redirect I/O cannot keep using context
+ * state while input/audio teardown continues. */
 static void
 vdi_stream_client__stop_threads(
-    struct parsec_context_s *parsec_context, SDL_Thread **input_thread, SDL_Thread **audio_thread,
-    SDL_Thread *network_thread[USB_MAX], Uint32 usb_count
+    struct parsec_context_s *parsec_context, SDL_Thread **render_thread,
+    SDL_Thread **input_thread, SDL_Thread **audio_thread, SDL_Thread *network_thread[USB_MAX],
+    Uint32 usb_count
 )
 {
     bool network_started = false;
 
     vdi_stream_client__context_set_done(parsec_context, true);
+    vdi_stream_client__video_wake(parsec_context);
+
+    if (*render_thread != NULL) {
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Stop Frame Thread\n");
+        SDL_WaitThread(*render_thread, NULL);
+        *render_thread = NULL;
+    }
 
     if (usb_count > 0) {
         for (Uint32 count = 0; count < usb_count; count++) {
@@ -447,40 +766,31 @@ vdi_stream_client__cursor(
     vdi_stream_client__context_set_input_relative(parsec_context, cursor->relative);
 }
 
-/* Rebuild the SDL surface and texture used for centered connection-state text
- * overlays such as "Reconnecting..." or "Closing...". */
+/* Rebuild the SDL surface used for centered connection-state text overlays such
+ * as "Reconnecting..." or "Closing...". It is converted into a texture on the
+ * next overlay redraw. */
 Sint32
 vdi_stream_client__render_text(void *opaque, const char *text)
 {
     struct parsec_context_s *parsec_context = (struct parsec_context_s *)opaque;
     SDL_Color color = { 0x88, 0x88, 0x88, 0xFF };
-
-    SDL_DestroyTexture(parsec_context->texture_ttf);
-    parsec_context->texture_ttf = NULL;
-
-    if (parsec_context->surface_ttf != NULL) {
-        SDL_DestroySurface(parsec_context->surface_ttf);
-        parsec_context->surface_ttf = NULL;
-    }
+    SDL_Surface *surface;
 
     /* Create the text surface. */
-    parsec_context->surface_ttf = TTF_RenderText_Blended(parsec_context->font, text, 0, color);
-    if (parsec_context->surface_ttf == NULL) {
+    surface = TTF_RenderText_Blended(parsec_context->font, text, 0, color);
+    if (surface == NULL) {
         SDL_LogError(
             SDL_LOG_CATEGORY_APPLICATION, "TTF surface creation failed: %s\n", SDL_GetError()
         );
         return VDI_STREAM_CLIENT_ERROR;
     }
 
-    /* Convert the text into an SDL texture. */
-    parsec_context->texture_ttf =
-        SDL_CreateTextureFromSurface(parsec_context->renderer, parsec_context->surface_ttf);
-    if (parsec_context->texture_ttf == NULL) {
-        SDL_LogError(
-            SDL_LOG_CATEGORY_APPLICATION, "TTF texture creation failed: %s\n", SDL_GetError()
-        );
-        return VDI_STREAM_CLIENT_ERROR;
-    }
+    /* Hand the surface over to the next overlay redraw. */
+    SDL_LockMutex(parsec_context->render_lock);
+    SDL_DestroySurface(parsec_context->surface_ttf);
+    parsec_context->surface_ttf = surface;
+    parsec_context->texture_ttf_stale = true;
+    SDL_UnlockMutex(parsec_context->render_lock);
 
     /* No error. */
     return VDI_STREAM_CLIENT_SUCCESS;
@@ -707,7 +1017,8 @@ struct vdi_stream_client__video_decoder_policy_s
 };
 
 /* Translate the command-line decoder mode into booleans used by Parsec
- * negotiation and FFmpeg acceleration setup. */
+ * negotiation and FFmpeg acceleration setup. Auto-tuning has already replaced
+ * auto-bench with a concrete mode. */
 static bool
 vdi_stream_client__video_decoder_policy(
     vdi_video_decoder_e video_decoder, struct vdi_stream_client__video_decoder_policy_s *policy
@@ -736,6 +1047,12 @@ vdi_stream_client__video_decoder_policy(
             .acceleration = true,
         };
         return true;
+    case VDI_VIDEO_DECODER_SW_HEVC_444:
+        *policy = (struct vdi_stream_client__video_decoder_policy_s){
+            .hevc = true,
+            .color444 = true,
+        };
+        return true;
     case VDI_VIDEO_DECODER_SW_HEVC_420:
         *policy = (struct vdi_stream_client__video_decoder_policy_s){
             .hevc = true,
@@ -744,6 +1061,8 @@ vdi_stream_client__video_decoder_policy(
     case VDI_VIDEO_DECODER_SW_H264_420:
         *policy = (struct vdi_stream_client__video_decoder_policy_s){ 0 };
         return true;
+    case VDI_VIDEO_DECODER_AUTO_BENCH:
+        break;
     }
     return false;
 }
@@ -901,8 +1220,8 @@ vdi_stream_client__video_setup(
 }
 
 /* Own the application lifetime after command-line parsing. This initializes SDL,
- * Parsec, FFmpeg, audio, input, optional USB redirect threads, then runs the
- * main render/event loop until shutdown or an unrecoverable error. */
+ * Parsec, FFmpeg, audio, input, render and optional USB redirect threads, then
+ * runs the main event loop until shutdown or an unrecoverable error. */
 Sint32
 vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
 {
@@ -919,11 +1238,13 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
     Uint32 ffmpeg_decoder_index = UINT32_MAX;
     bool hevc_attempt_active = false;
     bool h264_fallback_done = false;
+    bool skip_hevc = false;
     bool h264_acceleration = false;
     bool hevc_acceleration = false;
     bool hevc444_acceleration = false;
-    bool hardware_decoding;
+    bool acceleration;
     Uint32 device;
+    SDL_Thread *render_thread = NULL;
     SDL_Thread *input_thread = NULL;
     SDL_Thread *audio_thread = NULL;
     SDL_Thread *network_thread[USB_MAX] = { 0 };
@@ -944,6 +1265,31 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         goto error;
     }
 
+    /* Render lock shared by the main and frame thread. */
+    parsec_context.render_lock = SDL_CreateMutex();
+    if (parsec_context.render_lock == NULL) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Render lock creation failed: %s\n", SDL_GetError()
+        );
+        goto error;
+    }
+
+    /* Frame handover from the frame thread to the main thread. */
+    parsec_context.frame_consumed = SDL_CreateCondition();
+    if (parsec_context.frame_consumed == NULL) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Frame condition creation failed: %s\n", SDL_GetError()
+        );
+        goto error;
+    }
+    parsec_context.frame_event = SDL_RegisterEvents(1);
+    if (parsec_context.frame_event == 0) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Frame event registration failed: %s\n", SDL_GetError()
+        );
+        goto error;
+    }
+
     /* TTF init. */
     SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Initialize TTF\n");
     if (!TTF_Init()) {
@@ -979,6 +1325,20 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
 
     SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Initialize Video\n");
 
+    /* Decoding and uploads run on the worker pool, which auto-tuning measures too. */
+    if (!vdi_stream_client__pool_init(vdi_config->worker_threads)) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__copy_init()) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__tune_video_decoder(vdi_config)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Video decoder auto-tuning failed\n");
+        goto error;
+    }
+
     if (!vdi_stream_client__video_decoder_policy(vdi_config->video_decoder, &decoder_policy)) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid video decoder policy\n");
         goto error;
@@ -1018,8 +1378,9 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         }
     }
 
+    /* The software HEVC decoder handles the 4:4:4 range extension profile. */
     if (decoder_policy.color444 && cfg.video[DEFAULT_STREAM].decoderH265 == 1) {
-        if (hevc444_acceleration) {
+        if (hevc444_acceleration || !decoder_policy.acceleration) {
             SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Disable Chroma Subsampling\n");
             cfg.video[DEFAULT_STREAM].decoder444 = 1;
         } else {
@@ -1028,12 +1389,15 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         }
     }
 
+    vdi_stream_client__parsec_ffmpeg_progressive_enable(vdi_config->progressive_upload == 1);
+
     /* Configure client-side FFmpeg for H.264 and H.265. The public Linux SDK
      * exposes a hidden FFmpeg decoder entry; replace that entry with the client
      * decoder so both codecs use the same owned VAAPI or software path. */
     if (!vdi_stream_client__parsec_ffmpeg_decoder_enable(
             &parsec_context, &ffmpeg_decoder_index, h264_acceleration, hevc_acceleration,
-            cfg.video[DEFAULT_STREAM].decoder444 == 1
+            cfg.video[DEFAULT_STREAM].decoder444 == 1, vdi_config->decoder_threads,
+            vdi_config->decoder_thread_type
         )) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg decoder injection failed\n");
         goto error;
@@ -1049,6 +1413,32 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         goto error;
     }
 
+    if (!vdi_stream_client__clock_init(&parsec_context, vdi_config->clock_sync)) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__shadow_init(&parsec_context, vdi_config->shadow_decoder)) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__degrade_init(&parsec_context, vdi_config->degradation)) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__profile_init(
+            &parsec_context, vdi_config->peer, vdi_config->video_decoder
+        )) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__present_init(&parsec_context, vdi_config->present_mode)) {
+        goto error;
+    }
+
+    if (!vdi_stream_client__damage_init(&parsec_context)) {
+        goto error;
+    }
+
     /* Check if reconnect should be disabled. */
     if (vdi_config->reconnect == 0) {
         SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Disable automatic reconnect\n");
@@ -1079,6 +1469,12 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Disable clipboard sharing\n");
     }
 
+    /* Peers which needed the H.264 fallback before skip the HEVC round trip. */
+    vdi_stream_client__profile_apply(&parsec_context, hevc_attempt_active, &skip_hevc);
+    if (skip_hevc) {
+        vdi_stream_client__use_h264_fallback(&cfg, &hevc_attempt_active, &h264_fallback_done);
+    }
+
     for (;;) {
         wait_time = 0;
         vdi_stream_client__context_set_connection(&parsec_context, false);
@@ -1178,9 +1574,11 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         goto error;
     }
 
-    hardware_decoding = vdi_stream_client__parsec_ffmpeg_decoder_is_hardware();
-    window_flags |= vdi_stream_client__video_window_flags(hardware_decoding);
-    if (!vdi_stream_client__video_setup(&parsec_context, window_flags, hardware_decoding)) {
+    /* Software decoding renders through libplacebo only when auto-bench found it faster. */
+    acceleration =
+        vdi_stream_client__parsec_ffmpeg_decoder_is_hardware() || vdi_config->software_placebo;
+    window_flags |= vdi_stream_client__video_window_flags(acceleration);
+    if (!vdi_stream_client__video_setup(&parsec_context, window_flags, acceleration)) {
         if ((window_flags & SDL_WINDOW_VULKAN) == 0) {
             goto error;
         }
@@ -1251,39 +1649,64 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
         goto error;
     }
 
+    /* Frames are polled and decoded on their own thread and handed over to the
+     * event loop below, which owns the renderer as SDL requires. A present
+     * waiting for vsync therefore still holds up event pumping for up to one
+     * refresh, while the frame thread keeps decoding. */
+    render_thread = SDL_CreateThread(
+        vdi_stream_client__video_thread, "vdi_stream_client__video_thread", &parsec_context
+    );
+    if (render_thread == NULL) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Frame thread creation failed: %s\n", SDL_GetError()
+        );
+        goto error;
+    }
+
     /* Event loop. */
     while (!vdi_stream_client__context_done(&parsec_context)) {
-        Uint64 loop_sdl_events = 0;
-        Uint64 loop_parsec_events = 0;
-        Uint64 loop_frames = 0;
-        Uint64 loop_presents = 0;
-        Uint64 idle_start = 0;
-        bool local_interaction = false;
-        bool rendered = false;
-
-        force_redraw = vdi_stream_client__context_input_force_redraw(&parsec_context);
+        Sint32 width;
+        Sint32 height;
+        bool scaled;
+        Uint64 idle_start;
+        Uint32 timeout;
+
+        force_redraw = false;
         if (parsec_context.stats_enabled) {
-            loop_sdl_events = (Uint64)atomic_load_explicit(
-                &parsec_context.stats_sdl_events, memory_order_relaxed
-            );
-            loop_parsec_events = parsec_context.stats_parsec_events;
-            loop_frames = parsec_context.stats_frames;
-            loop_presents = parsec_context.stats_presents;
             parsec_context.stats_loops++;
         }
 
+        /* Sleep until an event, a handed over frame or a present deadline. Only
+         * this loop consumes frame wakeups, and a frame handed over before the
+         * wait makes the timeout zero. */
+        timeout = vdi_stream_client__video_timeout(&parsec_context);
+        idle_start = parsec_context.stats_enabled ? SDL_GetTicks() : 0;
+        SDL_WaitEventTimeout(NULL, (Sint32)timeout);
+        SDL_FlushEvent(parsec_context.frame_event);
+        if (parsec_context.stats_enabled) {
+            SDL_LockMutex(parsec_context.render_lock);
+            parsec_context.stats_idle_waits++;
+            parsec_context.stats_idle_wait_ms += SDL_GetTicks() - idle_start;
+            SDL_UnlockMutex(parsec_context.render_lock);
+        }
+
         SDL_PumpEvents();
-        local_interaction = vdi_stream_client__context_input_local_interaction(&parsec_context);
         vdi_stream_client__handle_input_commands(&input_context, &force_redraw);
 
-        /* Prioritize SDL responsiveness after local interaction without forcing
-         * redundant presents of the last video frame. */
-        parsec_context.render_timeout = local_interaction ? 0 : 5;
-
         vdi_stream_client__handle_connection_status(
             &parsec_context, vdi_config, &cfg, &last_time, &force_redraw, &hevc_attempt_active,
             &h264_fallback_done
         );
+        if (force_redraw) {
+            vdi_stream_client__context_set_input_force_redraw(&parsec_context);
+        }
+        vdi_stream_client__metrics_sample(&parsec_context);
+        SDL_LockMutex(parsec_context.render_lock);
+        vdi_stream_client__clock_update(&parsec_context);
+        vdi_stream_client__degrade_update(&parsec_context);
+        vdi_stream_client__present_update(&parsec_context);
+        SDL_UnlockMutex(parsec_context.render_lock);
+        vdi_stream_client__profile_update(&parsec_context, h264_fallback_done);
 
         for (ParsecClientEvent event; ParsecClientPollEvents(parsec_context.parsec, 0, &event);) {
             if (parsec_context.stats_enabled) {
@@ -1298,7 +1721,11 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
                 );
                 break;
             case CLIENT_EVENT_USER_DATA:
-                if (vdi_config->clipboard == 1) {
+                if (event.userData.id == PARSEC_CLOCK_MSG) {
+                    SDL_LockMutex(parsec_context.render_lock);
+                    vdi_stream_client__clock_user_data(&parsec_context, event.userData.key);
+                    SDL_UnlockMutex(parsec_context.render_lock);
+                } else if (vdi_config->clipboard == 1) {
                     vdi_stream_client__clipboard(
                         &parsec_context, event.userData.id, event.userData.key
                     );
@@ -1309,57 +1736,32 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
             }
         }
 
-        if (parsec_context.stats_enabled) {
-            idle_start = SDL_GetTicks();
-        }
-        rendered = vdi_stream_client__video_render(&parsec_context, force_redraw);
-
-        /* Check if we need to resize window due to client resolution change. */
-        if ((parsec_context.window_width !=
-                 parsec_context.client_status.decoder[DEFAULT_STREAM].width ||
-             parsec_context.window_height !=
-                 parsec_context.client_status.decoder[DEFAULT_STREAM].height) &&
-            parsec_context.client_status.decoder[DEFAULT_STREAM].width > 0 &&
-            parsec_context.client_status.decoder[DEFAULT_STREAM].height > 0) {
+        /* Check if we need to resize window due to client resolution change.
+         * A stream shrunk by the degradation ladder is scaled up instead. */
+        SDL_LockMutex(parsec_context.render_lock);
+        scaled = vdi_stream_client__degrade_dimensions(&parsec_context, &width, &height);
+        SDL_UnlockMutex(parsec_context.render_lock);
+        width = parsec_context.client_status.decoder[DEFAULT_STREAM].width;
+        height = parsec_context.client_status.decoder[DEFAULT_STREAM].height;
+        if ((parsec_context.window_width != width || parsec_context.window_height != height) &&
+            width > 0 && height > 0 && !scaled) {
             SDL_LogInfo(
                 SDL_LOG_CATEGORY_APPLICATION, "Change resolution from %dx%d to %dx%d\n",
-                parsec_context.window_width, parsec_context.window_height,
-                parsec_context.client_status.decoder[DEFAULT_STREAM].width,
-                parsec_context.client_status.decoder[DEFAULT_STREAM].height
+                parsec_context.window_width, parsec_context.window_height, width, height
             );
             vdi_stream_client__window_unlock_size(parsec_context.window);
-            vdi_stream_client__window_enforce_size(
-                parsec_context.window, parsec_context.client_status.decoder[DEFAULT_STREAM].width,
-                parsec_context.client_status.decoder[DEFAULT_STREAM].height
-            );
-            parsec_context.window_width =
-                parsec_context.client_status.decoder[DEFAULT_STREAM].width;
-            parsec_context.window_height =
-                parsec_context.client_status.decoder[DEFAULT_STREAM].height;
+            vdi_stream_client__window_enforce_size(parsec_context.window, width, height);
+            SDL_LockMutex(parsec_context.render_lock);
+            parsec_context.window_width = width;
+            parsec_context.window_height = height;
+            SDL_UnlockMutex(parsec_context.render_lock);
         }
 
-        /* Do not add a blanket SDL_Delay(1) to the streaming hot path. When
-         * connected, ParsecClientPollFrame(timeout) and SDL_RenderPresent(vsync)
-         * are the pacing points. Sleeping here adds latency and can cap/jitter
-         * frame delivery. When disconnected, no frame source is blocking this
-         * loop, so keep a small coarse idle sleep to avoid busy-spinning while
-         * reconnecting or showing the overlay. */
-        if (!vdi_stream_client__context_connected(&parsec_context) && !rendered &&
-            parsec_context.render_timeout > 0) {
-            SDL_Delay(parsec_context.render_timeout);
-        }
-
-        if (parsec_context.stats_enabled &&
-            (Uint64)atomic_load_explicit(&parsec_context.stats_sdl_events, memory_order_relaxed) ==
-                loop_sdl_events &&
-            parsec_context.stats_parsec_events == loop_parsec_events &&
-            parsec_context.stats_frames == loop_frames &&
-            parsec_context.stats_presents == loop_presents && !rendered) {
-            parsec_context.stats_idle_waits++;
-            parsec_context.stats_idle_wait_ms += SDL_GetTicks() - idle_start;
-        }
+        vdi_stream_client__video_render(&parsec_context);
 
+        SDL_LockMutex(parsec_context.render_lock);
         vdi_stream_client__render_stats(&parsec_context);
+        SDL_UnlockMutex(parsec_context.render_lock);
     }
 
     /* Already release any grabbed keyboard because thread termination can take some time. */
@@ -1367,15 +1769,25 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
     SDL_SetWindowKeyboardGrab(parsec_context.window, false);
 
     vdi_stream_client__stop_threads(
-        &parsec_context, &input_thread, &audio_thread, network_thread, vdi_config->usb_count
+        &parsec_context, &render_thread, &input_thread, &audio_thread, network_thread,
+        vdi_config->usb_count
     );
     vdi_stream_client__input_destroy(&input_context);
+    vdi_stream_client__clock_destroy(&parsec_context);
 
     /* Destroy video resources before releasing the Parsec client. */
     vdi_stream_client__video_destroy(&parsec_context);
 
     /* Parsec destroy. */
     ParsecDestroy(parsec_context.parsec);
+    vdi_stream_client__shadow_destroy(&parsec_context);
+    vdi_stream_client__degrade_destroy(&parsec_context);
+    vdi_stream_client__profile_destroy(&parsec_context);
+    vdi_stream_client__present_destroy(&parsec_context);
+    vdi_stream_client__damage_destroy(&parsec_context);
+    vdi_stream_client__parsec_ffmpeg_release();
+    vdi_stream_client__copy_destroy();
+    vdi_stream_client__pool_destroy();
 
     /* TTF destroy. */
     TTF_CloseFont(parsec_context.font);
@@ -1385,6 +1797,8 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
     vdi_stream_client__audio_destroy(&parsec_context);
     SDL_DestroySurface(parsec_context.surface_ttf);
     SDL_DestroyWindow(parsec_context.window);
+    SDL_DestroyCondition(parsec_context.frame_consumed);
+    SDL_DestroyMutex(parsec_context.render_lock);
     SDL_Quit();
 
     /* Terminate loop. */
@@ -1393,15 +1807,25 @@ vdi_stream_client__event_loop(struct vdi_config_s *vdi_config)
 error:
 
     vdi_stream_client__stop_threads(
-        &parsec_context, &input_thread, &audio_thread, network_thread, vdi_config->usb_count
+        &parsec_context, &render_thread, &input_thread, &audio_thread, network_thread,
+        vdi_config->usb_count
     );
     vdi_stream_client__input_destroy(&input_context);
+    vdi_stream_client__clock_destroy(&parsec_context);
 
     /* Destroy video resources before releasing the Parsec client. */
     vdi_stream_client__video_destroy(&parsec_context);
 
     /* Parsec destroy. */
     ParsecDestroy(parsec_context.parsec);
+    vdi_stream_client__shadow_destroy(&parsec_context);
+    vdi_stream_client__degrade_destroy(&parsec_context);
+    vdi_stream_client__profile_destroy(&parsec_context);
+    vdi_stream_client__present_destroy(&parsec_context);
+    vdi_stream_client__damage_destroy(&parsec_context);
+    vdi_stream_client__parsec_ffmpeg_release();
+    vdi_stream_client__copy_destroy();
+    vdi_stream_client__pool_destroy();
 
     /* TTF destroy. */
     TTF_CloseFont(parsec_context.font);
@@ -1411,6 +1835,8 @@ error:
     vdi_stream_client__audio_destroy(&parsec_context);
     SDL_DestroySurface(parsec_context.surface_ttf);
     SDL_DestroyWindow(parsec_context.window);
+    SDL_DestroyCondition(parsec_context.frame_consumed);
+    SDL_DestroyMutex(parsec_context.render_lock);
     SDL_Quit();
 
     /* Return with error. */
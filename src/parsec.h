@@ -50,14 +50,32 @@
 /* forward declarations. */
 struct vdi_config_s;
 struct vdi_stream_client__placebo_s;
+struct vdi_stream_client__clock_s;
+struct vdi_stream_client__shadow_s;
+struct vdi_stream_client__degrade_s;
+struct vdi_stream_client__profile_s;
+struct vdi_stream_client__present_s;
+struct vdi_stream_client__damage_s;
 
 /* define audio defaults. */
 #define PARSEC_AUDIO_CHANNELS 2
 #define PARSEC_AUDIO_SAMPLE_RATE 48000
 #define PARSEC_AUDIO_FRAMES_PER_PACKET 960
+#define PARSEC_AUDIO_MIN_BUFFER 1
+#define PARSEC_AUDIO_MAX_BUFFER 6
 
 /* define parsec messages. */
 #define PARSEC_CLIPBOARD_MSG 7
+#define PARSEC_CLOCK_MSG 0x56444343
+
+/* define parsec metrics sampling interval. */
+#define PARSEC_METRICS_SAMPLE_MS 100
+
+/* define frame rate a client must sustain for smooth 1080p60 streaming. */
+#define PARSEC_TARGET_FPS 60
+
+/* define frame intervals treated as idle host instead of stutter. */
+#define PARSEC_CADENCE_IDLE_MS 250
 
 /* parsec configuration. */
 struct parsec_context_s
@@ -67,7 +85,7 @@ struct parsec_context_s
     atomic_bool done;
     atomic_bool connection;
     atomic_bool input_polling;
-    atomic_bool input_local_interaction;
+    atomic_bool render_polling;
     atomic_bool input_force_redraw;
     atomic_bool input_relative;
     atomic_bool input_relative_mouse;
@@ -89,6 +107,13 @@ struct parsec_context_s
     /* video. */
     SDL_Window *window;
     SDL_Renderer *renderer;
+    SDL_Mutex *render_lock;
+    SDL_Condition *frame_consumed;
+    const ParsecFrame *pending_frame;
+    const void *pending_image;
+    ParsecFrame pending_kept;
+    Uint64 pending_descriptor[4];
+    Uint32 frame_event;
     SDL_Cursor *cursor;
     Sint32 window_width;
     Sint32 window_height;
@@ -98,8 +123,11 @@ struct parsec_context_s
     /* sdl textures for rendering. */
     SDL_Surface *surface_ttf;
     SDL_Texture *texture_ttf;
+    bool texture_ttf_stale;
     SDL_Texture *texture_video;
     SDL_Texture *frame_video_texture;
+    Sint32 frame_video_width;
+    Sint32 frame_video_height;
     struct vdi_stream_client__placebo_s *placebo;
     bool frame_video_updated;
     SDL_PixelFormat pixel_format_video;
@@ -113,6 +141,8 @@ struct parsec_context_s
     atomic_bool audio_polling;
     Uint32 min_buffer;
     Uint32 max_buffer;
+    atomic_uint_fast64_t audio_underruns;
+    atomic_uint_fast64_t audio_overflows;
 
     /* timeouts. */
     Uint32 timeout;
@@ -126,6 +156,9 @@ struct parsec_context_s
     Uint64 stats_last_frame_tick;
     Uint64 stats_loops;
     atomic_uint_fast64_t stats_sdl_events;
+    atomic_uint_fast64_t stats_input_messages;
+    atomic_uint_fast64_t stats_input_latency_ns;
+    atomic_uint_fast64_t stats_input_latency_max_ns;
     Uint64 stats_parsec_events;
     Uint64 stats_frames;
     Uint64 stats_presents;
@@ -140,6 +173,54 @@ struct parsec_context_s
     Uint64 stats_zero_copy_fallbacks;
     Uint64 stats_idle_waits;
     Uint64 stats_idle_wait_ms;
+
+    /* parsec metrics stats. */
+    Uint64 stats_metrics_next_tick;
+    Uint64 stats_metrics_samples;
+    double stats_encode_latency;
+    double stats_encode_latency_max;
+    double stats_decode_latency;
+    double stats_decode_latency_max;
+    double stats_network_latency;
+    double stats_network_latency_max;
+    double stats_bitrate;
+    Uint64 stats_queued_frames;
+    Uint64 stats_queued_frames_max;
+    Uint32 stats_packets_sent_base;
+    Uint32 stats_fast_retransmits_base;
+    Uint32 stats_slow_retransmits_base;
+
+    /* frame cadence stats. */
+    Uint64 stats_cadence_arrival_ns;
+    Uint64 stats_cadence_present_ns;
+    float stats_cadence_refresh_rate;
+    Uint64 stats_cadence_intervals;
+    double stats_cadence_mean_ms;
+    double stats_cadence_m2;
+    Uint64 stats_cadence_longest_ns;
+    Uint64 stats_cadence_skipped_vsyncs;
+    Uint64 stats_cadence_duplicated_vsyncs;
+    Uint64 stats_cadence_source_gaps;
+    Uint64 stats_cadence_client_gaps;
+    Uint64 stats_cadence_idle_gaps;
+
+    /* host clock synchronization. */
+    struct vdi_stream_client__clock_s *clock;
+
+    /* shadow decoding of the live bitstream. */
+    struct vdi_stream_client__shadow_s *shadow;
+
+    /* load-adaptive decoder degradation. */
+    struct vdi_stream_client__degrade_s *degrade;
+
+    /* learned per-peer connection profile. */
+    struct vdi_stream_client__profile_s *profile;
+
+    /* presentation mode and frame pacing. */
+    struct vdi_stream_client__present_s *present;
+
+    /* damage tracking of software texture uploads. */
+    struct vdi_stream_client__damage_s *damage;
 };
 
 /* Read the shared shutdown flag with acquire ordering so worker threads observe
@@ -226,26 +307,26 @@ vdi_stream_client__context_set_input_polling(
     atomic_store_explicit(&parsec_context->input_polling, input_polling, memory_order_release);
 }
 
-/* Consume and clear the local-interaction marker. The render loop uses the
- * one-shot signal to temporarily reduce frame-poll latency after SDL input. */
+/* Read whether the frame thread is inside a Parsec frame poll. Reconnect waits
+ * on this flag before disconnecting the shared client. */
 static inline bool
-vdi_stream_client__context_input_local_interaction(struct parsec_context_s *parsec_context)
+vdi_stream_client__context_render_polling(struct parsec_context_s *parsec_context)
 {
-    return atomic_exchange_explicit(
-        &parsec_context->input_local_interaction, false, memory_order_acq_rel
-    );
+    return atomic_load_explicit(&parsec_context->render_polling, memory_order_acquire);
 }
 
-/* Set the one-shot local-interaction marker when the input thread receives any
- * SDL event that should make the next render loop iteration more responsive. */
+/* Mark the section where the frame thread may poll frames through the Parsec
+ * client. */
 static inline void
-vdi_stream_client__context_set_input_local_interaction(struct parsec_context_s *parsec_context)
+vdi_stream_client__context_set_render_polling(
+    struct parsec_context_s *parsec_context, bool render_polling
+)
 {
-    atomic_store_explicit(&parsec_context->input_local_interaction, true, memory_order_release);
+    atomic_store_explicit(&parsec_context->render_polling, render_polling, memory_order_release);
 }
 
-/* Consume and clear the force-redraw marker. It lets worker-side events request
- * a main-thread redraw without repeatedly presenting the same frame. */
+/* Consume and clear the force-redraw marker. It lets other threads request a
+ * redraw from the main thread without repeatedly presenting the same frame. */
 static inline bool
 vdi_stream_client__context_input_force_redraw(struct parsec_context_s *parsec_context)
 {
@@ -16,6 +16,8 @@
 #include "config.h"
 #endif
 
+#include "copy.h"
+#include "damage.h"
 #include "ffmpeg.h"
 #include "placebo.h"
 
@@ -24,6 +26,7 @@
 #include <libavutil/frame.h>
 #include <libavutil/hwcontext.h>
 #include <libavutil/hwcontext_drm.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/pixdesc.h>
 #include <libavutil/pixfmt.h>
 #include <libdrm/drm_fourcc.h>
@@ -35,6 +38,10 @@
 #include <unistd.h>
 #include <vulkan/vulkan.h>
 
+/* define host-mapped upload defaults. */
+#define VDI_STREAM_CLIENT_PLACEBO_HOST_ALIGN 64u
+#define VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS 16u
+
 struct vdi_stream_client__placebo_s
 {
     pl_log log;
@@ -44,6 +51,12 @@ struct vdi_stream_client__placebo_s
     pl_renderer renderer;
     pl_tex target;
     SDL_Texture *texture;
+    AVFrame *upload_frame;
+    AVFrame *host_frame;
+    pl_buf host_buffer;
+    pl_tex host_textures[4];
+    AVBufferRef *mapped_ref;
+    pl_buf mapped_buffer;
     VkSemaphore ready;
     Uint64 ready_value;
     Sint32 width;
@@ -51,9 +64,12 @@ struct vdi_stream_client__placebo_s
     char import_failure[256];
     bool target_held;
     bool linear_import;
+    bool memory_budget;
     bool direct_disabled;
     bool direct_logged;
     bool upload_logged;
+    bool mapped_logged;
+    bool host_disabled;
 };
 
 struct vdi_stream_client__placebo_source_s
@@ -67,6 +83,19 @@ struct vdi_stream_client__placebo_source_s
     bool mapped_avframe;
 };
 
+/* One persistently mapped buffer lent to the software decoder frame pools. The
+ * registry lives outside the renderer, because the pools release their buffers
+ * when the decoder goes away, which is after the renderer teardown. */
+struct vdi_stream_client__placebo_mapped_s
+{
+    pl_buf buffer;
+};
+
+static SDL_SpinLock vdi_stream_client__placebo_mapped_lock;
+static pl_gpu vdi_stream_client__placebo_mapped_gpu;
+static struct vdi_stream_client__placebo_mapped_s
+    *vdi_stream_client__placebo_mapped[VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS];
+
 /* Forward libplacebo warnings and errors into SDL logging while suppressing
  * lower-priority chatter from the rendering library. */
 static void
@@ -737,18 +766,214 @@ error:
     return false;
 }
 
+/* Round value up to a multiple of alignment. Vulkan transfer alignments are not
+ * required to be powers of two, so FFALIGN cannot be used here. */
+static size_t
+vdi_stream_client__placebo_align(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/* Buffer release callback for the host-mapped staging frame. The memory belongs
+ * to the libplacebo buffer and is freed with it. */
+static void
+vdi_stream_client__placebo_host_free(void *opaque, uint8_t *data)
+{
+    (void)opaque;
+    (void)data;
+}
+
+/* Release the host-mapped staging frame and its buffer once the GPU no longer
+ * reads from it. The upload textures are kept for the next frame size. */
+static void
+vdi_stream_client__placebo_host_release(struct vdi_stream_client__placebo_s *placebo)
+{
+    av_frame_free(&placebo->host_frame);
+    if (placebo->host_buffer != NULL) {
+        pl_buf_poll(placebo->vulkan->gpu, placebo->host_buffer, UINT64_MAX);
+        pl_buf_destroy(placebo->vulkan->gpu, &placebo->host_buffer);
+    }
+}
+
+/* Return a software AVFrame whose planes live in a host-mapped libplacebo
+ * buffer, laid out with the pitch and offset alignment required for buffer to
+ * texture copies. Frames written there reach the GPU with one DMA transfer per
+ * plane instead of being staged again by libplacebo. A reused frame is returned
+ * only after the previous upload finished reading it. Returns NULL when the
+ * device cannot map such a buffer, so callers use the regular upload path. */
+static AVFrame *
+vdi_stream_client__placebo_host_frame(
+    struct vdi_stream_client__placebo_s *placebo, enum AVPixelFormat format, Sint32 width,
+    Sint32 height
+)
+{
+    pl_gpu gpu = placebo->vulkan->gpu;
+    Sint32 linesizes[4] = { 0 };
+    ptrdiff_t pitches[4] = { 0 };
+    size_t plane_sizes[4] = { 0 };
+    size_t offsets[4] = { 0 };
+    size_t pitch_align =
+        SDL_max(gpu->limits.align_tex_xfer_pitch, VDI_STREAM_CLIENT_PLACEBO_HOST_ALIGN);
+    size_t offset_align =
+        SDL_max(gpu->limits.align_tex_xfer_offset, VDI_STREAM_CLIENT_PLACEBO_HOST_ALIGN);
+    size_t size = 0;
+
+    if (placebo->host_disabled) {
+        return NULL;
+    }
+    if (placebo->host_frame != NULL && placebo->host_frame->format == format &&
+        placebo->host_frame->width == width && placebo->host_frame->height == height) {
+        pl_buf_poll(gpu, placebo->host_buffer, UINT64_MAX);
+        return placebo->host_frame;
+    }
+    vdi_stream_client__placebo_host_release(placebo);
+
+    if (av_image_fill_linesizes(linesizes, format, width) < 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < 4 && linesizes[i] > 0; i++) {
+        pitches[i] = (ptrdiff_t)vdi_stream_client__placebo_align((size_t)linesizes[i], pitch_align);
+    }
+    if (av_image_fill_plane_sizes(plane_sizes, format, height, pitches) < 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < 4; i++) {
+        offsets[i] = size;
+        size = vdi_stream_client__placebo_align(size + plane_sizes[i], offset_align);
+    }
+
+    if (size > gpu->limits.max_mapped_size) {
+        placebo->host_disabled = true;
+    } else {
+        placebo->host_buffer = pl_buf_create(gpu, pl_buf_params(.size = size, .host_mapped = true));
+        placebo->host_disabled = placebo->host_buffer == NULL;
+    }
+    if (placebo->host_disabled) {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "Host-mapped Vulkan upload buffer unavailable, using texture uploads\n"
+        );
+        return NULL;
+    }
+
+    placebo->host_frame = av_frame_alloc();
+    if (placebo->host_frame == NULL) {
+        goto error;
+    }
+    placebo->host_frame->format = format;
+    placebo->host_frame->width = width;
+    placebo->host_frame->height = height;
+    placebo->host_frame->buf[0] = av_buffer_create(
+        placebo->host_buffer->data, size, vdi_stream_client__placebo_host_free, NULL, 0
+    );
+    if (placebo->host_frame->buf[0] == NULL) {
+        goto error;
+    }
+    for (size_t i = 0; i < 4 && pitches[i] > 0; i++) {
+        placebo->host_frame->data[i] = placebo->host_buffer->data + offsets[i];
+        placebo->host_frame->linesize[i] = (Sint32)pitches[i];
+    }
+    return placebo->host_frame;
+
+error:
+    vdi_stream_client__placebo_host_release(placebo);
+    return NULL;
+}
+
+/* Upload the planes of a frame living in a host-mapped buffer straight from
+ * that buffer into upload textures kept across frames. */
+static bool
+vdi_stream_client__placebo_source_upload_host(
+    struct vdi_stream_client__placebo_s *placebo, const AVFrame *host_frame, pl_buf buffer,
+    struct vdi_stream_client__placebo_source_s *source
+)
+{
+    const AVPixFmtDescriptor *pixel_descriptor = av_pix_fmt_desc_get(host_frame->format);
+    struct pl_plane_data plane_data[4] = { 0 };
+    int plane_count;
+
+    pl_frame_from_avframe(&source->frame, host_frame);
+    plane_count =
+        pl_plane_data_from_pixfmt(plane_data, &source->frame.repr.bits, host_frame->format);
+    if (pixel_descriptor == NULL || plane_count <= 0 || plane_count != source->frame.num_planes) {
+        SDL_memset(source, 0, sizeof(*source));
+        return false;
+    }
+
+    for (int i = 0; i < plane_count; i++) {
+        Sint32 width = host_frame->width;
+        Sint32 height = host_frame->height;
+
+        if (i == 1 || i == 2) {
+            width = AV_CEIL_RSHIFT(width, pixel_descriptor->log2_chroma_w);
+            height = AV_CEIL_RSHIFT(height, pixel_descriptor->log2_chroma_h);
+        }
+        plane_data[i].width = width;
+        plane_data[i].height = height;
+        plane_data[i].row_stride = (size_t)host_frame->linesize[i];
+        plane_data[i].buf = buffer;
+        plane_data[i].buf_offset = (size_t)(host_frame->data[i] - buffer->data);
+        if (!pl_upload_plane(
+                placebo->vulkan->gpu, &source->frame.planes[i], &placebo->host_textures[i],
+                &plane_data[i]
+            )) {
+            SDL_memset(source, 0, sizeof(*source));
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Let libplacebo upload the planes of a software AVFrame to temporary GPU
+ * textures described by source->frame. */
+static bool
+vdi_stream_client__placebo_source_upload_software(
+    struct vdi_stream_client__placebo_s *placebo, const AVFrame *sw_frame,
+    struct vdi_stream_client__placebo_source_s *source
+)
+{
+    if (!pl_map_avframe_ex(
+            placebo->vulkan->gpu, &source->frame,
+            pl_avframe_params(.frame = sw_frame, .tex = source->textures)
+        )) {
+        SDL_strlcpy(
+            placebo->import_failure, "libplacebo AVFrame upload failed",
+            sizeof(placebo->import_failure)
+        );
+        for (size_t i = 0; i < 4; i++) {
+            pl_tex_destroy(placebo->vulkan->gpu, &source->textures[i]);
+        }
+        SDL_memset(source, 0, sizeof(*source));
+        return false;
+    }
+    source->mapped_avframe = true;
+    return true;
+}
+
 /* Fallback path for VA-API frames that cannot be imported directly. It transfers
- * the hardware frame to a software AVFrame and lets libplacebo upload it to
- * temporary GPU textures. */
+ * the hardware frame into the host-mapped staging frame, or into a software
+ * AVFrame kept across calls when host mapping is unavailable, and uploads it to
+ * GPU textures. */
 static bool
 vdi_stream_client__placebo_source_upload(
     struct vdi_stream_client__placebo_s *placebo, const AVFrame *av_frame,
     struct vdi_stream_client__placebo_source_s *source
 )
 {
-    AVFrame *sw_frame = av_frame_alloc();
+    const AVHWFramesContext *frames_context =
+        (const AVHWFramesContext *)av_frame->hw_frames_ctx->data;
+    AVFrame *sw_frame;
     Sint32 err;
 
+    sw_frame = vdi_stream_client__placebo_host_frame(
+        placebo, frames_context->sw_format, av_frame->width, av_frame->height
+    );
+    if (sw_frame == NULL && placebo->upload_frame == NULL) {
+        placebo->upload_frame = av_frame_alloc();
+    }
+    if (sw_frame == NULL) {
+        sw_frame = placebo->upload_frame;
+    }
     if (sw_frame == NULL) {
         SDL_strlcpy(
             placebo->import_failure, "software AVFrame allocation failed",
@@ -762,27 +987,152 @@ vdi_stream_client__placebo_source_upload(
             placebo->import_failure, sizeof(placebo->import_failure),
             "FFmpeg hardware frame transfer failed (%d)", err
         );
-        av_frame_free(&sw_frame);
         return false;
     }
-    if (!pl_map_avframe_ex(
-            placebo->vulkan->gpu, &source->frame,
-            pl_avframe_params(.frame = sw_frame, .tex = source->textures)
+    if (sw_frame == placebo->host_frame && sw_frame->data[0] == placebo->host_buffer->data &&
+        vdi_stream_client__placebo_source_upload_host(
+            placebo, sw_frame, placebo->host_buffer, source
         )) {
-        SDL_strlcpy(
-            placebo->import_failure, "libplacebo AVFrame upload failed",
-            sizeof(placebo->import_failure)
-        );
-        av_frame_free(&sw_frame);
-        for (size_t i = 0; i < 4; i++) {
-            pl_tex_destroy(placebo->vulkan->gpu, &source->textures[i]);
+        return true;
+    }
+    return vdi_stream_client__placebo_source_upload_software(placebo, sw_frame, source);
+}
+
+/* Buffer release callback of a mapped decoder buffer. The Vulkan buffer is
+ * destroyed here unless the renderer teardown already did so. */
+static void
+vdi_stream_client__placebo_mapped_free(void *opaque, uint8_t *data)
+{
+    struct vdi_stream_client__placebo_mapped_s *mapped = opaque;
+
+    (void)data;
+    SDL_LockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    for (size_t i = 0; i < VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS; i++) {
+        if (vdi_stream_client__placebo_mapped[i] == mapped) {
+            vdi_stream_client__placebo_mapped[i] = NULL;
         }
-        SDL_memset(source, 0, sizeof(*source));
-        return false;
     }
-    source->mapped_avframe = true;
-    av_frame_free(&sw_frame);
-    return true;
+    if (mapped->buffer != NULL) {
+        pl_buf_destroy(vdi_stream_client__placebo_mapped_gpu, &mapped->buffer);
+    }
+    SDL_UnlockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    SDL_free(mapped);
+}
+
+/* Buffer provider of the software decoder frame pools. Each pool buffer is a
+ * persistently mapped, host cached Vulkan buffer, so the decoder writes planes
+ * where the GPU copies them from and still reads its reference frames at
+ * cached speed. Returns NULL when the ring is full or the device cannot map
+ * the size, and the pool falls back to heap memory. */
+static AVBufferRef *
+vdi_stream_client__placebo_mapped_alloc(size_t size)
+{
+    struct vdi_stream_client__placebo_mapped_s *mapped = NULL;
+    AVBufferRef *buffer = NULL;
+    pl_gpu gpu;
+    size_t index = VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS;
+
+    SDL_LockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    gpu = vdi_stream_client__placebo_mapped_gpu;
+    for (size_t i = 0; i < VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS; i++) {
+        if (vdi_stream_client__placebo_mapped[i] == NULL) {
+            index = i;
+            break;
+        }
+    }
+    if (gpu == NULL || index == VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS ||
+        size > gpu->limits.max_mapped_size) {
+        goto done;
+    }
+    mapped = SDL_calloc(1, sizeof(*mapped));
+    if (mapped == NULL) {
+        goto done;
+    }
+    mapped->buffer = pl_buf_create(
+        gpu, pl_buf_params(
+                 .size = size, .host_mapped = true, .host_writable = true,
+                 .host_readable = true, .memory_type = PL_BUF_MEM_HOST
+             )
+    );
+    if (mapped->buffer == NULL ||
+        (uintptr_t)mapped->buffer->data % VDI_STREAM_CLIENT_PLACEBO_HOST_ALIGN != 0) {
+        goto done;
+    }
+    buffer = av_buffer_create(
+        mapped->buffer->data, size, vdi_stream_client__placebo_mapped_free, mapped, 0
+    );
+    if (buffer != NULL) {
+        vdi_stream_client__placebo_mapped[index] = mapped;
+    }
+
+done:
+    if (buffer == NULL && mapped != NULL) {
+        pl_buf_destroy(gpu, &mapped->buffer);
+        SDL_free(mapped);
+    }
+    SDL_UnlockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    return buffer;
+}
+
+/* Return the mapped buffer holding all planes of a software AVFrame, or NULL
+ * when the decoder wrote the frame to other memory. The frame's own buffer
+ * reference keeps the returned buffer alive. */
+static pl_buf
+vdi_stream_client__placebo_mapped_find(const AVFrame *av_frame)
+{
+    pl_buf buffer = NULL;
+
+    if (av_frame->buf[0] == NULL || av_frame->buf[1] != NULL) {
+        return NULL;
+    }
+    SDL_LockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    for (size_t i = 0; i < VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS; i++) {
+        if (vdi_stream_client__placebo_mapped[i] != NULL &&
+            vdi_stream_client__placebo_mapped[i]->buffer->data == av_frame->buf[0]->data) {
+            buffer = vdi_stream_client__placebo_mapped[i]->buffer;
+            break;
+        }
+    }
+    SDL_UnlockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    return buffer;
+}
+
+/* Give the decoder buffer of the previous mapped upload back to its frame pool
+ * once the GPU finished reading from it. */
+static void
+vdi_stream_client__placebo_mapped_release(struct vdi_stream_client__placebo_s *placebo)
+{
+    if (placebo->mapped_ref == NULL) {
+        return;
+    }
+    pl_buf_poll(placebo->vulkan->gpu, placebo->mapped_buffer, UINT64_MAX);
+    placebo->mapped_buffer = NULL;
+    av_buffer_unref(&placebo->mapped_ref);
+}
+
+/* Stop lending mapped buffers to the decoder frame pools and destroy the ones
+ * still lent out before the Vulkan device goes away. The pools keep pointing at
+ * that memory until the decoder is destroyed, but decoding has stopped by the
+ * time the renderer is torn down, so nothing touches it anymore. */
+static void
+vdi_stream_client__placebo_mapped_stop(struct vdi_stream_client__placebo_s *placebo)
+{
+    if (placebo->vulkan == NULL ||
+        vdi_stream_client__placebo_mapped_gpu != placebo->vulkan->gpu) {
+        return;
+    }
+    vdi_stream_client__parsec_ffmpeg_buffer_provider(NULL);
+    vdi_stream_client__placebo_mapped_release(placebo);
+
+    SDL_LockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    for (size_t i = 0; i < VDI_STREAM_CLIENT_PLACEBO_MAPPED_BUFFERS; i++) {
+        if (vdi_stream_client__placebo_mapped[i] != NULL) {
+            pl_buf_destroy(placebo->vulkan->gpu, &vdi_stream_client__placebo_mapped[i]->buffer);
+            vdi_stream_client__placebo_mapped[i] = NULL;
+        }
+    }
+    vdi_stream_client__placebo_mapped_gpu = NULL;
+    SDL_UnlockSpinlock(&vdi_stream_client__placebo_mapped_lock);
 }
 
 /* Ensure the libplacebo render target and SDL texture wrapper exist for the
@@ -880,6 +1230,21 @@ vdi_stream_client__placebo_disable(
     }
 }
 
+/* Check whether libplacebo enabled a Vulkan device extension, so optional
+ * queries are only issued against devices that accepted the extension. */
+static bool
+vdi_stream_client__placebo_has_extension(
+    struct vdi_stream_client__placebo_s *placebo, const char *name
+)
+{
+    for (int i = 0; i < placebo->vulkan->num_extensions; i++) {
+        if (SDL_strcmp(placebo->vulkan->extensions[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /* Initialize the libplacebo Vulkan bridge for an SDL Vulkan window. This creates
  * the shared Vulkan renderer, SDL renderer wrapper, timeline semaphore, and
  * capability flags needed for VA-API DRM PRIME rendering. */
@@ -888,6 +1253,7 @@ vdi_stream_client__placebo_init(struct parsec_context_s *parsec_context)
 {
     struct vdi_stream_client__placebo_s *placebo;
     SDL_PropertiesID props = 0;
+    const char *const device_extensions[] = { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME };
     const char *const *extensions;
     Uint32 extension_count;
     VkPhysicalDeviceProperties device_properties;
@@ -937,13 +1303,17 @@ vdi_stream_client__placebo_init(struct parsec_context_s *parsec_context)
         pl_vulkan_params(
                 .instance = placebo->instance->instance,
                 .get_proc_addr = placebo->instance->get_proc_addr, .surface = placebo->surface,
-                .async_transfer = false, .async_compute = false, .queue_count = 1
+                .async_transfer = false, .async_compute = false, .queue_count = 1,
+                .opt_extensions = device_extensions,
+                .num_opt_extensions = (int)SDL_arraysize(device_extensions)
         )
     );
     if (placebo->vulkan == NULL) {
         SDL_strlcpy(failure, "libplacebo Vulkan device creation failed", sizeof(failure));
         goto error;
     }
+    placebo->memory_budget =
+        vdi_stream_client__placebo_has_extension(placebo, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
     if ((placebo->vulkan->gpu->import_caps.tex & PL_HANDLE_DMA_BUF) == 0) {
 
         /* Pre-GFX9 RADV exports linear RadeonSI video surfaces but does not
@@ -1030,6 +1400,12 @@ vdi_stream_client__placebo_init(struct parsec_context_s *parsec_context)
             "Use RADV linear external-memory import without DRM modifiers\n"
         );
     }
+
+    /* Let software decoders write frames into buffers the GPU can copy from. */
+    SDL_LockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    vdi_stream_client__placebo_mapped_gpu = placebo->vulkan->gpu;
+    SDL_UnlockSpinlock(&vdi_stream_client__placebo_mapped_lock);
+    vdi_stream_client__parsec_ffmpeg_buffer_provider(vdi_stream_client__placebo_mapped_alloc);
     return true;
 
 error:
@@ -1039,9 +1415,108 @@ error:
     return false;
 }
 
+/* Render one software frame the decoder wrote into a mapped buffer with
+ * libplacebo. The GPU copies the planes straight from that buffer, so no CPU
+ * copy is left between decoding and rendering. The buffer stays referenced
+ * until the next mapped upload, which keeps the decoder pool from recycling it
+ * while the GPU still reads it. Returns false, with the frame untouched, when
+ * the frame lives in other memory or the upload failed, so the caller uploads
+ * it through SDL instead. */
+static bool
+vdi_stream_client__placebo_render_mapped(
+    struct parsec_context_s *parsec_context, struct vdi_stream_client__placebo_s *placebo,
+    const ParsecFrame *frame, const void *image
+)
+{
+    struct vdi_stream_client__placebo_source_s source = { 0 };
+    struct pl_frame target = {
+        .num_planes = 1,
+        .planes = { {
+            .components = 4,
+            .component_mapping = { 0, 1, 2, 3 },
+        } },
+        .repr = pl_color_repr_rgb,
+        .color = pl_color_space_srgb,
+    };
+    pl_gpu gpu = placebo->vulkan->gpu;
+    size_t pitch_align = SDL_max(gpu->limits.align_tex_xfer_pitch, 1);
+    size_t offset_align = SDL_max(gpu->limits.align_tex_xfer_offset, 1);
+    AVFrame *av_frame;
+    pl_buf buffer;
+    Uint64 stage_start_ns;
+    bool rendered = false;
+
+    av_frame = vdi_stream_client__parsec_ffmpeg_frame_acquire(frame, image);
+    if (av_frame == NULL || av_frame->hw_frames_ctx != NULL) {
+        return false;
+    }
+    buffer = vdi_stream_client__placebo_mapped_find(av_frame);
+    if (buffer == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < 4 && av_frame->data[i] != NULL; i++) {
+        if ((size_t)(av_frame->data[i] - buffer->data) % offset_align != 0 ||
+            (size_t)av_frame->linesize[i] % pitch_align != 0) {
+            return false;
+        }
+    }
+
+    stage_start_ns = parsec_context->stats_enabled ? SDL_GetTicksNS() : 0;
+    if (!vdi_stream_client__placebo_target_create(
+            parsec_context, placebo, av_frame->width, av_frame->height
+        )) {
+        goto done;
+    }
+    vdi_stream_client__placebo_release_target(placebo);
+    if (!vdi_stream_client__placebo_source_upload_host(placebo, av_frame, buffer, &source)) {
+        goto done;
+    }
+
+    target.planes[0].texture = placebo->target;
+    rendered = pl_render_image(placebo->renderer, &source.frame, &target, &pl_render_fast_params);
+    if (!vdi_stream_client__placebo_hold_target(placebo)) {
+        vdi_stream_client__placebo_target_destroy(parsec_context, placebo);
+        rendered = false;
+    }
+    vdi_stream_client__placebo_source_unmap(placebo, &source);
+
+    /* The upload was submitted, so the buffer must not be recycled before the
+     * GPU is done with it, even if rendering failed. */
+    vdi_stream_client__placebo_mapped_release(placebo);
+    placebo->mapped_ref = av_buffer_ref(av_frame->buf[0]);
+    if (placebo->mapped_ref != NULL) {
+        placebo->mapped_buffer = buffer;
+    } else {
+        pl_buf_poll(gpu, buffer, UINT64_MAX);
+    }
+    if (!rendered) {
+        goto done;
+    }
+
+    /* SDL texture uploads after this frame must not rely on old damage. */
+    vdi_stream_client__damage_reset(parsec_context->damage);
+    parsec_context->frame_video_texture = placebo->texture;
+    if (!placebo->mapped_logged) {
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "Use libplacebo Vulkan upload from host-mapped decoder buffers\n"
+        );
+        placebo->mapped_logged = true;
+    }
+
+done:
+    if (parsec_context->stats_enabled) {
+        parsec_context->stats_zero_copy_calls++;
+        parsec_context->stats_zero_copy_ns += SDL_GetTicksNS() - stage_start_ns;
+    }
+    return rendered;
+}
+
 /* Render one VA-API hardware frame with libplacebo. The function first tries
  * direct DMA-BUF import, falls back to Vulkan upload when import fails, and
- * publishes the SDL texture that now contains the rendered RGB frame. */
+ * publishes the SDL texture that now contains the rendered RGB frame. Software
+ * frames in mapped decoder buffers are rendered from there, without setting
+ * handled, so a failed attempt still ends in the SDL upload. */
 bool
 vdi_stream_client__placebo_render(
     struct parsec_context_s *parsec_context, const ParsecFrame *frame, const void *image,
@@ -1067,15 +1542,18 @@ vdi_stream_client__placebo_render(
     if (handled != NULL) {
         *handled = false;
     }
-    if (placebo == NULL || !vdi_stream_client__parsec_ffmpeg_frame_is_hardware(frame, image)) {
+    if (placebo == NULL || !vdi_stream_client__parsec_ffmpeg_frame_is_descriptor(frame, image)) {
         return false;
     }
+    if (!vdi_stream_client__parsec_ffmpeg_frame_is_hardware(frame, image)) {
+        return vdi_stream_client__placebo_render_mapped(parsec_context, placebo, frame, image);
+    }
     if (handled != NULL) {
         *handled = true;
     }
 
     stage_start_ns = parsec_context->stats_enabled ? SDL_GetTicksNS() : 0;
-    av_frame = vdi_stream_client__parsec_ffmpeg_frame_ref(frame, image);
+    av_frame = vdi_stream_client__parsec_ffmpeg_frame_acquire(frame, image);
     if (av_frame == NULL || av_frame->format != AV_PIX_FMT_VAAPI) {
         vdi_stream_client__placebo_disable(parsec_context, placebo, "invalid hardware frame");
         goto done;
@@ -1130,7 +1608,8 @@ vdi_stream_client__placebo_render(
     if (placebo->direct_disabled && !placebo->upload_logged) {
         SDL_LogInfo(
             SDL_LOG_CATEGORY_APPLICATION,
-            "Use AV_PIX_FMT_VAAPI with libplacebo Vulkan upload fallback\n"
+            "Use AV_PIX_FMT_VAAPI with libplacebo Vulkan %s upload fallback\n",
+            placebo->host_buffer != NULL ? "host-mapped" : "texture"
         );
         placebo->upload_logged = true;
     } else if (!placebo->direct_disabled && !placebo->direct_logged) {
@@ -1143,7 +1622,6 @@ vdi_stream_client__placebo_render(
     }
 
 done:
-    av_frame_free(&av_frame);
     if (parsec_context->stats_enabled) {
         parsec_context->stats_zero_copy_calls++;
         parsec_context->stats_zero_copy_ns += SDL_GetTicksNS() - stage_start_ns;
@@ -1151,6 +1629,223 @@ done:
     return rendered;
 }
 
+/* Initialize libplacebo without a window for the headless render benchmark. Any
+ * Vulkan device is accepted, including software rasterizers such as lavapipe,
+ * and frames are rendered into an offscreen RGBA8 target of the given size,
+ * which is host readable when the format allows it. */
+bool
+vdi_stream_client__placebo_offscreen_init(
+    struct parsec_context_s *parsec_context, Sint32 width, Sint32 height
+)
+{
+    struct vdi_stream_client__placebo_s *placebo;
+    VkPhysicalDeviceProperties device_properties;
+    pl_fmt rgba;
+
+    placebo = SDL_calloc(1, sizeof(*placebo));
+    if (placebo == NULL) {
+        return false;
+    }
+    parsec_context->placebo = placebo;
+
+    placebo->log = pl_log_create(
+        PL_API_VER,
+        pl_log_params(.log_cb = vdi_stream_client__placebo_log, .log_level = PL_LOG_WARN)
+    );
+    placebo->instance = pl_vk_inst_create(placebo->log, &pl_vk_inst_default_params);
+    if (placebo->instance == NULL) {
+        SDL_SetError("Vulkan instance creation failed");
+        goto error;
+    }
+    placebo->vulkan = pl_vulkan_create(
+        placebo->log,
+        pl_vulkan_params(
+                .instance = placebo->instance->instance,
+                .get_proc_addr = placebo->instance->get_proc_addr, .allow_software = true,
+                .async_transfer = false, .async_compute = false, .queue_count = 1
+        )
+    );
+    if (placebo->vulkan == NULL) {
+        SDL_SetError("libplacebo Vulkan device creation failed");
+        goto error;
+    }
+    placebo->renderer = pl_renderer_create(placebo->log, placebo->vulkan->gpu);
+    rgba = pl_find_named_fmt(placebo->vulkan->gpu, "rgba8");
+    if (placebo->renderer == NULL || rgba == NULL || (rgba->caps & PL_FMT_CAP_RENDERABLE) == 0) {
+        SDL_SetError("libplacebo renderer creation failed");
+        goto error;
+    }
+    placebo->target = pl_tex_create(
+        placebo->vulkan->gpu,
+        pl_tex_params(
+                .w = width, .h = height, .format = rgba, .renderable = true,
+                .host_readable = (rgba->caps & PL_FMT_CAP_HOST_READABLE) != 0
+        )
+    );
+    if (placebo->target == NULL) {
+        SDL_SetError("libplacebo offscreen target creation failed");
+        goto error;
+    }
+    placebo->width = width;
+    placebo->height = height;
+
+    vkGetPhysicalDeviceProperties(placebo->vulkan->phys_device, &device_properties);
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Use %s Vulkan device for offscreen rendering\n",
+        device_properties.deviceName
+    );
+    return true;
+
+error:
+    vdi_stream_client__placebo_destroy(parsec_context);
+    return false;
+}
+
+/* Copy a software AVFrame into the host-mapped staging frame with the plane
+ * copy kernels and upload it from there. Returns false when host mapping is
+ * unavailable or the upload failed, leaving source empty. */
+static bool
+vdi_stream_client__placebo_offscreen_upload_host(
+    struct vdi_stream_client__placebo_s *placebo, const AVFrame *av_frame,
+    struct vdi_stream_client__placebo_source_s *source
+)
+{
+    const AVPixFmtDescriptor *pixel_descriptor = av_pix_fmt_desc_get(av_frame->format);
+    AVFrame *host_frame;
+
+    host_frame = vdi_stream_client__placebo_host_frame(
+        placebo, av_frame->format, av_frame->width, av_frame->height
+    );
+    if (host_frame == NULL || pixel_descriptor == NULL ||
+        av_frame_copy_props(host_frame, av_frame) < 0) {
+        return false;
+    }
+    for (Sint32 plane = 0; plane < av_pix_fmt_count_planes(av_frame->format); plane++) {
+        Sint32 height = plane == 1 || plane == 2
+                            ? AV_CEIL_RSHIFT(av_frame->height, pixel_descriptor->log2_chroma_h)
+                            : av_frame->height;
+
+        vdi_stream_client__copy_plane(
+            host_frame->data[plane], host_frame->linesize[plane], av_frame->data[plane],
+            av_frame->linesize[plane],
+            av_image_get_linesize(av_frame->format, av_frame->width, plane), height
+        );
+    }
+    return vdi_stream_client__placebo_source_upload_host(
+        placebo, host_frame, placebo->host_buffer, source
+    );
+}
+
+/* Upload and render one software AVFrame into the offscreen target and wait for
+ * the GPU, accounting upload, render submission and completion separately. The
+ * upload goes through the host-mapped staging buffer when the device has one. */
+bool
+vdi_stream_client__placebo_offscreen_render(
+    struct parsec_context_s *parsec_context, const struct AVFrame *av_frame,
+    struct vdi_stream_client__placebo_stages_s *stages
+)
+{
+    struct vdi_stream_client__placebo_s *placebo = parsec_context->placebo;
+    struct vdi_stream_client__placebo_source_s source = { 0 };
+    struct pl_frame target = {
+        .num_planes = 1,
+        .planes = { {
+            .texture = placebo->target,
+            .components = 4,
+            .component_mapping = { 0, 1, 2, 3 },
+        } },
+        .repr = pl_color_repr_rgb,
+        .color = pl_color_space_srgb,
+    };
+    Uint64 stage_start_ns = SDL_GetTicksNS();
+    bool rendered;
+
+    if (!vdi_stream_client__placebo_offscreen_upload_host(placebo, av_frame, &source) &&
+        !vdi_stream_client__placebo_source_upload_software(placebo, av_frame, &source)) {
+        return false;
+    }
+    stages->upload_ns += SDL_GetTicksNS() - stage_start_ns;
+
+    stage_start_ns = SDL_GetTicksNS();
+    rendered = pl_render_image(placebo->renderer, &source.frame, &target, &pl_render_fast_params);
+    stages->render_ns += SDL_GetTicksNS() - stage_start_ns;
+
+    stage_start_ns = SDL_GetTicksNS();
+    pl_gpu_finish(placebo->vulkan->gpu);
+    stages->finish_ns += SDL_GetTicksNS() - stage_start_ns;
+
+    vdi_stream_client__placebo_source_unmap(placebo, &source);
+    return rendered;
+}
+
+/* Download the offscreen target as RGBA8 rows of the given pitch so rendered
+ * frames can be compared against their source. */
+bool
+vdi_stream_client__placebo_offscreen_read(
+    struct parsec_context_s *parsec_context, Uint8 *pixels, size_t pitch
+)
+{
+    struct vdi_stream_client__placebo_s *placebo = parsec_context->placebo;
+
+    if (placebo == NULL || placebo->target == NULL || !placebo->target->params.host_readable) {
+        SDL_SetError("libplacebo offscreen target is not host readable");
+        return false;
+    }
+    if (!pl_tex_download(
+            placebo->vulkan->gpu,
+            pl_tex_transfer_params(.tex = placebo->target, .ptr = pixels, .row_pitch = pitch)
+        )) {
+        SDL_SetError("libplacebo offscreen target download failed");
+        return false;
+    }
+    return true;
+}
+
+/* Report Vulkan memory held for rendering. The render target is estimated from
+ * its RGBA8 size; device-local heap usage and budget come from the driver when
+ * VK_EXT_memory_budget is available and cover all allocations of this process. */
+void
+vdi_stream_client__placebo_memory(
+    struct parsec_context_s *parsec_context, struct vdi_stream_client__placebo_memory_s *memory
+)
+{
+    struct vdi_stream_client__placebo_s *placebo;
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+    };
+    VkPhysicalDeviceMemoryProperties2 properties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+        .pNext = &budget,
+    };
+
+    if (memory == NULL) {
+        return;
+    }
+    SDL_memset(memory, 0, sizeof(*memory));
+    if (parsec_context == NULL || parsec_context->placebo == NULL) {
+        return;
+    }
+    placebo = parsec_context->placebo;
+
+    if (placebo->target != NULL) {
+        memory->target_bytes = (Uint64)placebo->width * (Uint64)placebo->height * 4u;
+    }
+    if (placebo->vulkan == NULL || !placebo->memory_budget) {
+        return;
+    }
+
+    vkGetPhysicalDeviceMemoryProperties2(placebo->vulkan->phys_device, &properties);
+    for (Uint32 i = 0; i < properties.memoryProperties.memoryHeapCount; i++) {
+        const VkMemoryHeap *heap = &properties.memoryProperties.memoryHeaps[i];
+
+        if ((heap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) {
+            continue;
+        }
+        memory->heap_usage += budget.heapUsage[i];
+        memory->heap_budget += budget.heapBudget[i];
+    }
+}
+
 /* Destroy the libplacebo bridge, SDL renderer wrapper, Vulkan surface, and all
  * target resources owned by parsec_context->placebo. */
 void
@@ -1163,11 +1858,19 @@ vdi_stream_client__placebo_destroy(struct parsec_context_s *parsec_context)
     }
     placebo = parsec_context->placebo;
 
+    vdi_stream_client__placebo_mapped_stop(placebo);
     vdi_stream_client__placebo_target_destroy(parsec_context, placebo);
     if (placebo->vulkan != NULL) {
         pl_vulkan_sem_destroy(placebo->vulkan->gpu, &placebo->ready);
     }
     pl_renderer_destroy(&placebo->renderer);
+    av_frame_free(&placebo->upload_frame);
+    if (placebo->vulkan != NULL) {
+        vdi_stream_client__placebo_host_release(placebo);
+        for (size_t i = 0; i < 4; i++) {
+            pl_tex_destroy(placebo->vulkan->gpu, &placebo->host_textures[i]);
+        }
+    }
 
     SDL_DestroyRenderer(parsec_context->renderer);
     parsec_context->renderer = NULL;
@@ -17,11 +17,40 @@
 
 #include "parsec.h"
 
+struct AVFrame;
+
+struct vdi_stream_client__placebo_memory_s
+{
+    Uint64 target_bytes;
+    Uint64 heap_usage;
+    Uint64 heap_budget;
+};
+
+struct vdi_stream_client__placebo_stages_s
+{
+    Uint64 upload_ns;
+    Uint64 render_ns;
+    Uint64 finish_ns;
+};
+
 bool vdi_stream_client__placebo_init(struct parsec_context_s *parsec_context);
+bool vdi_stream_client__placebo_offscreen_init(
+    struct parsec_context_s *parsec_context, Sint32 width, Sint32 height
+);
+bool vdi_stream_client__placebo_offscreen_render(
+    struct parsec_context_s *parsec_context, const struct AVFrame *av_frame,
+    struct vdi_stream_client__placebo_stages_s *stages
+);
+bool vdi_stream_client__placebo_offscreen_read(
+    struct parsec_context_s *parsec_context, Uint8 *pixels, size_t pitch
+);
 bool vdi_stream_client__placebo_render(
     struct parsec_context_s *parsec_context, const ParsecFrame *frame, const void *image,
     bool *handled
 );
+void vdi_stream_client__placebo_memory(
+    struct parsec_context_s *parsec_context, struct vdi_stream_client__placebo_memory_s *memory
+);
 void vdi_stream_client__placebo_destroy(struct parsec_context_s *parsec_context);
 
 #endif /* VDI_STREAM_CLIENT_PLACEBO_H */
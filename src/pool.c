@@ -0,0 +1,392 @@
+/*
+ *  pool.c -- process-wide worker pool
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "client.h"
+#include "pool.h"
+
+/* system includes. */
+#include <stdatomic.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* define worker pool defaults. */
+#define VDI_STREAM_CLIENT_POOL_BATCHES 4u
+
+/* One batch of independent jobs submitted by a caller. Jobs are claimed with
+ * an atomic counter by the caller and every idle worker, so a slow job never
+ * holds back the others. Workers count themselves in active while they look
+ * at the batch, which keeps its slot from being reused under them. */
+struct vdi_stream_client__pool_batch_s
+{
+    void (*job)(void *data, Sint32 index, Sint32 thread);
+    void *data;
+    Sint32 count;
+    Sint32 threads;
+    SDL_Semaphore *done;
+    atomic_bool busy;
+    atomic_bool published;
+    atomic_int next;
+    atomic_int joined;
+    atomic_int finished;
+    atomic_int active;
+};
+
+/* pool workers, pending batches and per-period stats. */
+static struct
+{
+    SDL_Thread *threads[WORKER_THREADS_MAX];
+    Uint32 worker_count;
+    SDL_Mutex *lock;
+    SDL_Condition *wake;
+    Uint64 epoch;
+    Sint32 render_cpu;
+#ifdef __linux__
+    cpu_set_t worker_cpus;
+#endif
+    atomic_bool quit;
+    struct vdi_stream_client__pool_batch_s batches[VDI_STREAM_CLIENT_POOL_BATCHES];
+    atomic_uint_fast64_t stats_batches;
+    atomic_uint_fast64_t stats_jobs;
+    atomic_uint_fast64_t stats_worker_jobs;
+    atomic_uint_fast64_t stats_inline;
+} vdi_stream_client__pool = { .render_cpu = -1 };
+
+/* Claim and run jobs of a batch until none are left. Returns true if this
+ * thread finished the last job of the batch. */
+static bool
+vdi_stream_client__pool_work(struct vdi_stream_client__pool_batch_s *batch, Sint32 thread)
+{
+    bool last = false;
+    Sint32 jobs = 0;
+
+    for (Sint32 index = atomic_fetch_add_explicit(&batch->next, 1, memory_order_relaxed);
+         index < batch->count;
+         index = atomic_fetch_add_explicit(&batch->next, 1, memory_order_relaxed)) {
+        batch->job(batch->data, index, thread);
+        jobs++;
+        last = atomic_fetch_add_explicit(&batch->finished, 1, memory_order_acq_rel) + 1 ==
+               batch->count;
+    }
+    if (thread != 0 && jobs != 0) {
+        atomic_fetch_add_explicit(
+            &vdi_stream_client__pool.stats_worker_jobs, (uint_fast64_t)jobs, memory_order_relaxed
+        );
+    }
+    return last;
+}
+
+/* Reserve the last CPU the process may run on for the frame thread and let
+ * workers use all others, so decode and conversion jobs do not compete with
+ * polling frames. Nothing is reserved on a single CPU. */
+static void
+vdi_stream_client__pool_reserve(void)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+
+    vdi_stream_client__pool.render_cpu = -1;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) != 0 || CPU_COUNT(&cpus) < 2) {
+        return;
+    }
+    for (Sint32 cpu = CPU_SETSIZE - 1; cpu >= 0; cpu--) {
+        if (CPU_ISSET(cpu, &cpus)) {
+            vdi_stream_client__pool.render_cpu = cpu;
+            break;
+        }
+    }
+    CPU_CLR(vdi_stream_client__pool.render_cpu, &cpus);
+    vdi_stream_client__pool.worker_cpus = cpus;
+#endif
+}
+
+/* Keep a worker off the CPU reserved for the frame thread. */
+static void
+vdi_stream_client__pool_pin(void)
+{
+#ifdef __linux__
+    if (vdi_stream_client__pool.render_cpu >= 0) {
+        (void)pthread_setaffinity_np(
+            pthread_self(), sizeof(vdi_stream_client__pool.worker_cpus),
+            &vdi_stream_client__pool.worker_cpus
+        );
+    }
+#endif
+}
+
+/* Pool worker. It sleeps until a batch is published, joins every batch that
+ * still has unclaimed jobs and a free thread index, and goes back to sleep
+ * once all batches are drained. */
+static Sint32
+vdi_stream_client__pool_thread(void *data)
+{
+    Uint64 seen = 0;
+
+    (void)data;
+    vdi_stream_client__pool_pin();
+    for (;;) {
+        bool worked = false;
+
+        SDL_LockMutex(vdi_stream_client__pool.lock);
+        while (seen == vdi_stream_client__pool.epoch &&
+               !atomic_load_explicit(&vdi_stream_client__pool.quit, memory_order_acquire)) {
+            SDL_WaitCondition(vdi_stream_client__pool.wake, vdi_stream_client__pool.lock);
+        }
+        seen = vdi_stream_client__pool.epoch;
+        SDL_UnlockMutex(vdi_stream_client__pool.lock);
+        if (atomic_load_explicit(&vdi_stream_client__pool.quit, memory_order_acquire)) {
+            break;
+        }
+
+        do {
+            worked = false;
+            for (Uint32 i = 0; i < VDI_STREAM_CLIENT_POOL_BATCHES; i++) {
+                struct vdi_stream_client__pool_batch_s *batch = &vdi_stream_client__pool.batches[i];
+                Sint32 thread;
+
+                if (!atomic_load_explicit(&batch->published, memory_order_acquire)) {
+                    continue;
+                }
+
+                /* The caller may have retired the batch in the meantime. Both
+                 * sides store their flag before loading the other one, which
+                 * needs sequential consistency to rule out that each misses
+                 * the other's store. */
+                atomic_fetch_add_explicit(&batch->active, 1, memory_order_seq_cst);
+                if (!atomic_load_explicit(&batch->published, memory_order_seq_cst) ||
+                    atomic_load_explicit(&batch->next, memory_order_relaxed) >= batch->count) {
+                    atomic_fetch_sub_explicit(&batch->active, 1, memory_order_release);
+                    continue;
+                }
+                thread = atomic_fetch_add_explicit(&batch->joined, 1, memory_order_relaxed);
+                if (thread < batch->threads) {
+                    if (vdi_stream_client__pool_work(batch, thread)) {
+                        SDL_SignalSemaphore(batch->done);
+                    }
+                    worked = true;
+                }
+                atomic_fetch_sub_explicit(&batch->active, 1, memory_order_release);
+            }
+        } while (worked);
+    }
+    return 0;
+}
+
+/* Start the worker pool. Zero workers sizes the pool to the logical CPU cores
+ * minus the one left to the frame thread. A failure to start workers leaves
+ * every caller running its jobs alone. */
+bool
+vdi_stream_client__pool_init(Uint32 workers)
+{
+    if (workers == 0) {
+        workers = (Uint32)SDL_max(SDL_GetNumLogicalCPUCores() - 1, 0);
+    }
+    workers = SDL_min(workers, (Uint32)WORKER_THREADS_MAX);
+
+    vdi_stream_client__pool_reserve();
+    atomic_store_explicit(&vdi_stream_client__pool.quit, false, memory_order_relaxed);
+    vdi_stream_client__pool.epoch = 0;
+    vdi_stream_client__pool.lock = SDL_CreateMutex();
+    vdi_stream_client__pool.wake = SDL_CreateCondition();
+    if (vdi_stream_client__pool.lock == NULL || vdi_stream_client__pool.wake == NULL) {
+        workers = 0;
+    }
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_POOL_BATCHES; i++) {
+        vdi_stream_client__pool.batches[i].done = SDL_CreateSemaphore(0);
+        if (vdi_stream_client__pool.batches[i].done == NULL) {
+            workers = 0;
+        }
+    }
+
+    for (Uint32 i = 0; i < workers; i++) {
+        vdi_stream_client__pool.threads[i] =
+            SDL_CreateThread(vdi_stream_client__pool_thread, "vdi_worker", NULL);
+        if (vdi_stream_client__pool.threads[i] == NULL) {
+            break;
+        }
+        vdi_stream_client__pool.worker_count++;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Use worker pool with %u threads\n",
+        vdi_stream_client__pool.worker_count
+    );
+    return true;
+}
+
+/* Pin the calling frame thread to the CPU kept free of workers. */
+void
+vdi_stream_client__pool_pin_render(void)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+
+    if (vdi_stream_client__pool.render_cpu < 0) {
+        return;
+    }
+    CPU_ZERO(&cpus);
+    CPU_SET(vdi_stream_client__pool.render_cpu, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0) {
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION, "Pin frame thread to CPU %d\n",
+            vdi_stream_client__pool.render_cpu
+        );
+    }
+#endif
+}
+
+/* Return the number of threads a batch can run on, the workers and the
+ * caller. */
+Uint32
+vdi_stream_client__pool_threads(void)
+{
+    return vdi_stream_client__pool.worker_count + 1;
+}
+
+/* Run count jobs on at most threads threads and return once all finished. The
+ * caller always works on its own batch as thread 0, so batches submitted from
+ * inside a job, or while every worker is busy, still make progress. Workers
+ * get thread indices 1 up to threads - 1 in the order they join. */
+void
+vdi_stream_client__pool_run(
+    void (*job)(void *data, Sint32 index, Sint32 thread), void *data, Sint32 count, Sint32 threads
+)
+{
+    struct vdi_stream_client__pool_batch_s *batch = NULL;
+
+    if (count <= 0) {
+        return;
+    }
+    atomic_fetch_add_explicit(&vdi_stream_client__pool.stats_batches, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(
+        &vdi_stream_client__pool.stats_jobs, (uint_fast64_t)count, memory_order_relaxed
+    );
+
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_POOL_BATCHES && count > 1 && threads > 1 &&
+                       vdi_stream_client__pool.worker_count != 0;
+         i++) {
+        bool expected = false;
+
+        if (atomic_compare_exchange_strong_explicit(
+                &vdi_stream_client__pool.batches[i].busy, &expected, true, memory_order_acquire,
+                memory_order_relaxed
+            )) {
+            batch = &vdi_stream_client__pool.batches[i];
+            break;
+        }
+    }
+    if (batch == NULL) {
+        if (count > 1) {
+            atomic_fetch_add_explicit(
+                &vdi_stream_client__pool.stats_inline, 1, memory_order_relaxed
+            );
+        }
+        for (Sint32 index = 0; index < count; index++) {
+            job(data, index, 0);
+        }
+        return;
+    }
+
+    batch->job = job;
+    batch->data = data;
+    batch->count = count;
+    batch->threads = threads;
+    atomic_store_explicit(&batch->next, 0, memory_order_relaxed);
+    atomic_store_explicit(&batch->joined, 1, memory_order_relaxed);
+    atomic_store_explicit(&batch->finished, 0, memory_order_relaxed);
+    atomic_store_explicit(&batch->published, true, memory_order_release);
+
+    SDL_LockMutex(vdi_stream_client__pool.lock);
+    vdi_stream_client__pool.epoch++;
+    SDL_BroadcastCondition(vdi_stream_client__pool.wake);
+    SDL_UnlockMutex(vdi_stream_client__pool.lock);
+
+    if (!vdi_stream_client__pool_work(batch, 0)) {
+        SDL_WaitSemaphore(batch->done);
+    }
+
+    /* Retire the batch and wait for workers still looking at it. */
+    atomic_store_explicit(&batch->published, false, memory_order_seq_cst);
+    while (atomic_load_explicit(&batch->active, memory_order_seq_cst) != 0) {
+        SDL_CPUPauseInstruction();
+    }
+    atomic_store_explicit(&batch->busy, false, memory_order_release);
+}
+
+/* Print the batches and jobs run during the stats period and the share of jobs
+ * the workers took from their callers. */
+void
+vdi_stream_client__pool_stats(void)
+{
+    Uint64 batches = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__pool.stats_batches, (uint_fast64_t)0, memory_order_relaxed
+    );
+    Uint64 jobs = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__pool.stats_jobs, (uint_fast64_t)0, memory_order_relaxed
+    );
+    Uint64 worker_jobs = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__pool.stats_worker_jobs, (uint_fast64_t)0, memory_order_relaxed
+    );
+    Uint64 inline_batches = (Uint64)atomic_exchange_explicit(
+        &vdi_stream_client__pool.stats_inline, (uint_fast64_t)0, memory_order_relaxed
+    );
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Workers:\n"
+        "  pool: threads=%u, batches=%llu, jobs=%llu, worker_share=%.1f%%, inline=%llu\n",
+        vdi_stream_client__pool_threads(), (unsigned long long)batches, (unsigned long long)jobs,
+        jobs != 0 ? (double)worker_jobs * 100.0 / (double)jobs : 0.0,
+        (unsigned long long)inline_batches
+    );
+}
+
+/* Stop the workers. Callers must not submit batches anymore. */
+void
+vdi_stream_client__pool_destroy(void)
+{
+    SDL_LockMutex(vdi_stream_client__pool.lock);
+    atomic_store_explicit(&vdi_stream_client__pool.quit, true, memory_order_release);
+    SDL_BroadcastCondition(vdi_stream_client__pool.wake);
+    SDL_UnlockMutex(vdi_stream_client__pool.lock);
+    for (Uint32 i = 0; i < vdi_stream_client__pool.worker_count; i++) {
+        SDL_WaitThread(vdi_stream_client__pool.threads[i], NULL);
+        vdi_stream_client__pool.threads[i] = NULL;
+    }
+    vdi_stream_client__pool.worker_count = 0;
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_POOL_BATCHES; i++) {
+        SDL_DestroySemaphore(vdi_stream_client__pool.batches[i].done);
+        vdi_stream_client__pool.batches[i].done = NULL;
+    }
+    SDL_DestroyCondition(vdi_stream_client__pool.wake);
+    SDL_DestroyMutex(vdi_stream_client__pool.lock);
+    vdi_stream_client__pool.wake = NULL;
+    vdi_stream_client__pool.lock = NULL;
+}
@@ -0,0 +1,39 @@
+/*
+ *  pool.h -- process-wide worker pool
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_POOL_H
+#define VDI_STREAM_CLIENT_POOL_H
+
+/* sdl includes. */
+#include <SDL3/SDL.h>
+
+/* worker pool. */
+bool vdi_stream_client__pool_init(Uint32 workers);
+void vdi_stream_client__pool_pin_render(void);
+Uint32 vdi_stream_client__pool_threads(void);
+void vdi_stream_client__pool_run(
+    void (*job)(void *data, Sint32 index, Sint32 thread), void *data, Sint32 count, Sint32 threads
+);
+void vdi_stream_client__pool_stats(void);
+void vdi_stream_client__pool_destroy(void);
+
+#endif /* VDI_STREAM_CLIENT_POOL_H */
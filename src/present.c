@@ -0,0 +1,370 @@
+/*
+ *  present.c -- presentation mode and frame pacing
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "client.h"
+#include "parsec.h"
+#include "present.h"
+#include "video.h"
+
+/* define frame pacing defaults. */
+#define VDI_STREAM_CLIENT_PRESENT_MARGIN_NS 1000000u
+#define VDI_STREAM_CLIENT_PRESENT_REFRESH_MS 1000
+#define VDI_STREAM_CLIENT_PRESENT_PHASE_NS 1000000000u
+#define VDI_STREAM_CLIENT_PRESENT_IDLE_NS 100000000u
+#define VDI_STREAM_CLIENT_PRESENT_BLOCKED_SHARE 4
+#define VDI_STREAM_CLIENT_PRESENT_EWMA_SHIFT 3
+
+/* User-facing present mode names indexed by vdi_present_mode_e. */
+static const char *const vdi_stream_client__present_modes[] = {
+    "fifo",
+    "mailbox",
+    "immediate",
+    "adaptive",
+};
+
+/* presentation state. */
+struct vdi_stream_client__present_s
+{
+
+    /* configured mode and the vsync setting the renderer accepted. */
+    vdi_present_mode_e mode;
+    Sint32 vsync;
+
+    /* display refresh period, zero while unknown. */
+    Uint64 refresh_ns;
+    Uint64 refresh_tick;
+
+    /* scheduler estimates, the vblank phase is learned from vsync'd presents. */
+    Uint64 vblank_ns;
+    Uint64 present_ns;
+    Uint64 arrival_ns;
+    Uint64 arrival_interval_ns;
+    Uint64 render_ns;
+    bool pending;
+
+    /* per-period stats. */
+    Uint64 stats_presents;
+    Uint64 stats_superseded;
+    Uint64 stats_blocked;
+    Uint64 stats_latency_ns;
+    Uint64 stats_latency_max_ns;
+};
+
+/* Move an exponentially weighted average one step towards a new sample. */
+static Uint64
+vdi_stream_client__present_ewma(Uint64 average, Uint64 sample)
+{
+    if (average == 0) {
+        return sample;
+    }
+    return average - (average >> VDI_STREAM_CLIENT_PRESENT_EWMA_SHIFT) +
+           (sample >> VDI_STREAM_CLIENT_PRESENT_EWMA_SHIFT);
+}
+
+/* Re-read the refresh rate of the display showing the window. */
+static void
+vdi_stream_client__present_refresh(
+    struct parsec_context_s *parsec_context, struct vdi_stream_client__present_s *present
+)
+{
+    float refresh_rate = vdi_stream_client__video_refresh_rate(parsec_context);
+
+    present->refresh_ns = refresh_rate > 0.0f ? (Uint64)(1000000000.0 / refresh_rate) : 0;
+    present->refresh_tick = SDL_GetTicks();
+}
+
+/* Compute the time a waiting frame must be rendered by. Returns false when the
+ * mode or missing display timing leaves nothing to pace, and sets queued when
+ * an earlier present still occupies the next refresh, so the frame may only
+ * follow at the deadline. */
+static bool
+vdi_stream_client__present_deadline(
+    const struct vdi_stream_client__present_s *present, Uint64 now, Uint64 *deadline_ns,
+    bool *queued
+)
+{
+    Uint64 lead_ns = present->render_ns + VDI_STREAM_CLIENT_PRESENT_MARGIN_NS;
+    Uint64 vblank_ns;
+
+    if (present->mode == VDI_PRESENT_MODE_IMMEDIATE || present->refresh_ns == 0) {
+        return false;
+    }
+
+    /* Without vsync a refresh can't be missed, only presented twice. */
+    if (present->mode == VDI_PRESENT_MODE_MAILBOX) {
+        *deadline_ns =
+            present->present_ns + present->refresh_ns - VDI_STREAM_CLIENT_PRESENT_MARGIN_NS;
+        *queued = true;
+        return true;
+    }
+
+    /* A stale phase has drifted too far to aim at a vblank. */
+    if (present->vblank_ns == 0 || now - present->vblank_ns > VDI_STREAM_CLIENT_PRESENT_PHASE_NS) {
+        return false;
+    }
+
+    vblank_ns = present->vblank_ns +
+                ((now - present->vblank_ns) / present->refresh_ns + 1) * present->refresh_ns;
+    *queued = present->present_ns > vblank_ns - present->refresh_ns;
+    if (*queued) {
+        vblank_ns += present->refresh_ns;
+    }
+    *deadline_ns = vblank_ns > lead_ns ? vblank_ns - lead_ns : 0;
+    return true;
+}
+
+/* Initialize the presentation state for the configured mode. The renderer is
+ * configured later by video initialization. */
+bool
+vdi_stream_client__present_init(
+    struct parsec_context_s *parsec_context, vdi_present_mode_e present_mode
+)
+{
+    parsec_context->present = SDL_calloc(1, sizeof(*parsec_context->present));
+    if (parsec_context->present == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate presentation state\n");
+        return false;
+    }
+    parsec_context->present->mode = present_mode;
+    return true;
+}
+
+/* Apply the present mode to a freshly created renderer. SDL has no mailbox
+ * vsync setting, so mailbox presents without vsync and the scheduler limits it
+ * to the newest frame once per refresh. Adaptive vsync falls back to vsync on
+ * renderers that refuse it. */
+void
+vdi_stream_client__present_configure(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__present_s *present = parsec_context->present;
+    vdi_present_mode_e mode = present != NULL ? present->mode : VDI_PRESENT_MODE_FIFO;
+    Sint32 vsync = 1;
+
+    if (mode == VDI_PRESENT_MODE_MAILBOX || mode == VDI_PRESENT_MODE_IMMEDIATE) {
+        vsync = SDL_RENDERER_VSYNC_DISABLED;
+    }
+    if (mode == VDI_PRESENT_MODE_ADAPTIVE) {
+        vsync = SDL_RENDERER_VSYNC_ADAPTIVE;
+        if (!SDL_SetRenderVSync(parsec_context->renderer, vsync)) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "Adaptive vsync not supported, falling back to fifo: %s\n", SDL_GetError()
+            );
+            vsync = 1;
+        }
+    }
+    if (vsync != SDL_RENDERER_VSYNC_ADAPTIVE &&
+        !SDL_SetRenderVSync(parsec_context->renderer, vsync)) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "SDL_SetRenderVSync failed: %s\n", SDL_GetError()
+        );
+    }
+    if (present == NULL) {
+        return;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Use %s present mode\n",
+        vdi_stream_client__present_modes[present->mode]
+    );
+    present->vsync = vsync;
+    present->vblank_ns = 0;
+    present->present_ns = 0;
+    present->pending = false;
+    vdi_stream_client__present_refresh(parsec_context, present);
+}
+
+/* Pick up refresh rate changes after the window moved between displays. This
+ * runs on the main thread under the render lock. */
+void
+vdi_stream_client__present_update(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__present_s *present = parsec_context->present;
+
+    if (present == NULL || parsec_context->renderer == NULL ||
+        SDL_GetTicks() - present->refresh_tick < VDI_STREAM_CLIENT_PRESENT_REFRESH_MS) {
+        return;
+    }
+    vdi_stream_client__present_refresh(parsec_context, present);
+}
+
+/* Record the arrival of a decoded frame. The arrival interval predicts when
+ * the next frame completes decoding; a frame still waiting for its present is
+ * superseded by the new one. */
+void
+vdi_stream_client__present_frame(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__present_s *present = parsec_context->present;
+    Uint64 now = SDL_GetTicksNS();
+
+    if (present == NULL) {
+        return;
+    }
+    if (present->arrival_ns != 0 && now - present->arrival_ns < VDI_STREAM_CLIENT_PRESENT_IDLE_NS) {
+        present->arrival_interval_ns = vdi_stream_client__present_ewma(
+            present->arrival_interval_ns, now - present->arrival_ns
+        );
+    }
+    if (present->pending) {
+        present->stats_superseded++;
+    }
+    present->arrival_ns = now;
+    present->pending = true;
+}
+
+/* Shorten the main thread event wait so a waiting frame is presented at its
+ * deadline even if no newer frame arrives. */
+Uint32
+vdi_stream_client__present_timeout(struct parsec_context_s *parsec_context, Uint32 timeout)
+{
+    const struct vdi_stream_client__present_s *present = parsec_context->present;
+    Uint64 now = SDL_GetTicksNS();
+    Uint64 deadline_ns;
+    bool queued;
+
+    if (present == NULL || !present->pending ||
+        !vdi_stream_client__present_deadline(present, now, &deadline_ns, &queued)) {
+        return timeout;
+    }
+    if (deadline_ns <= now) {
+        return 0;
+    }
+
+    /* Round up, a wait ending just before the deadline would only spin. */
+    return (Uint32)SDL_min((Uint64)timeout, (deadline_ns - now + 999999u) / 1000000u);
+}
+
+/* Decide whether the newest frame should be rendered now. A frame waits while
+ * a present already occupies the next refresh, which keeps at most one frame
+ * queued, or while a newer frame is predicted to finish decoding before the
+ * deadline and would replace it anyway. */
+bool
+vdi_stream_client__present_due(struct parsec_context_s *parsec_context)
+{
+    const struct vdi_stream_client__present_s *present = parsec_context->present;
+    Uint64 now = SDL_GetTicksNS();
+    Uint64 deadline_ns;
+    bool queued;
+
+    if (present == NULL ||
+        !vdi_stream_client__present_deadline(present, now, &deadline_ns, &queued) ||
+        now >= deadline_ns) {
+        return true;
+    }
+    if (queued) {
+        return false;
+    }
+    return present->arrival_interval_ns == 0 ||
+           present->arrival_ns + present->arrival_interval_ns >= deadline_ns;
+}
+
+/* Account a finished present. Every vsync'd present re-anchors the vblank
+ * phase: one that blocked for a good part of a refresh returned at a vblank,
+ * any other moves the phase forward to the last vblank before it returned, so
+ * the phase never goes stale while frames are presented. Presents that did not
+ * block measure the render cost the deadline has to leave room for. */
+void
+vdi_stream_client__present_done(
+    struct parsec_context_s *parsec_context, Uint64 start_ns, Uint64 end_ns
+)
+{
+    struct vdi_stream_client__present_s *present = parsec_context->present;
+    Uint64 present_ns = end_ns - start_ns;
+    Uint64 latency_ns;
+
+    if (present == NULL) {
+        return;
+    }
+    if (present->vsync != SDL_RENDERER_VSYNC_DISABLED && present->refresh_ns != 0 &&
+        present_ns * VDI_STREAM_CLIENT_PRESENT_BLOCKED_SHARE > present->refresh_ns) {
+        present->vblank_ns = end_ns;
+        present->stats_blocked++;
+    } else {
+        present->render_ns = vdi_stream_client__present_ewma(present->render_ns, present_ns);
+        if (present->vsync != SDL_RENDERER_VSYNC_DISABLED && present->refresh_ns != 0) {
+            present->vblank_ns =
+                present->vblank_ns == 0
+                    ? end_ns
+                    : end_ns - (end_ns - present->vblank_ns) % present->refresh_ns;
+        }
+    }
+    present->present_ns = end_ns;
+
+    if (!present->pending) {
+        return;
+    }
+    latency_ns = end_ns - present->arrival_ns;
+    present->stats_presents++;
+    present->stats_latency_ns += latency_ns;
+    present->stats_latency_max_ns = SDL_max(present->stats_latency_max_ns, latency_ns);
+    present->pending = false;
+}
+
+/* Print the present mode, the frames presented or superseded during the stats
+ * period and the latency from frame arrival to the return of its present. */
+void
+vdi_stream_client__present_stats(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__present_s *present = parsec_context->present;
+
+    if (present == NULL) {
+        return;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Present:\n"
+        "  mode: %s, vsync=%d, refresh=%.2fHz\n"
+        "  frames: presented=%llu, superseded=%llu, blocked=%llu\n"
+        "  latency: avg=%.3fms, max=%.3fms\n"
+        "  pacing: interval=%.3fms, render=%.3fms\n",
+        vdi_stream_client__present_modes[present->mode], present->vsync,
+        present->refresh_ns != 0 ? 1000000000.0 / (double)present->refresh_ns : 0.0,
+        (unsigned long long)present->stats_presents,
+        (unsigned long long)present->stats_superseded, (unsigned long long)present->stats_blocked,
+        present->stats_presents != 0
+            ? (double)present->stats_latency_ns / (double)present->stats_presents / 1000000.0
+            : 0.0,
+        (double)present->stats_latency_max_ns / 1000000.0,
+        (double)present->arrival_interval_ns / 1000000.0, (double)present->render_ns / 1000000.0
+    );
+
+    present->stats_presents = 0;
+    present->stats_superseded = 0;
+    present->stats_blocked = 0;
+    present->stats_latency_ns = 0;
+    present->stats_latency_max_ns = 0;
+}
+
+/* Release the presentation state. */
+void
+vdi_stream_client__present_destroy(struct parsec_context_s *parsec_context)
+{
+    SDL_free(parsec_context->present);
+    parsec_context->present = NULL;
+}
@@ -0,0 +1,317 @@
+/*
+ *  profile.c -- learned per-peer connection profiles
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "cache.h"
+#include "client.h"
+#include "ffmpeg.h"
+#include "parsec.h"
+#include "profile.h"
+
+/* define profile defaults. */
+#define VDI_STREAM_CLIENT_PROFILE_WARMUP_MS 5000
+#define VDI_STREAM_CLIENT_PROFILE_HEVC_RETRY 10
+#define VDI_STREAM_CLIENT_PROFILE_AUDIO_EVENTS 8
+#define VDI_STREAM_CLIENT_PROFILE_AUDIO_MIN_MAX 4
+#define VDI_STREAM_CLIENT_PROFILE_AUDIO_MAX_MAX 16
+#define VDI_STREAM_CLIENT_PROFILE_AUDIO_CALM_MS 60000
+
+/* Layout of the cached profile value. Decode latency is stored in units of
+ * 10us, every other field saturates at its width. */
+#define VDI_STREAM_CLIENT_PROFILE_H265 (1u << 0)
+#define VDI_STREAM_CLIENT_PROFILE_COLOR444 (1u << 1)
+#define VDI_STREAM_CLIENT_PROFILE_HARDWARE (1u << 2)
+#define VDI_STREAM_CLIENT_PROFILE_H264_FALLBACK (1u << 3)
+#define VDI_STREAM_CLIENT_PROFILE_DECODE_SHIFT 8
+#define VDI_STREAM_CLIENT_PROFILE_DECODE_MASK 0xffffu
+#define VDI_STREAM_CLIENT_PROFILE_QUEUED_SHIFT 24
+#define VDI_STREAM_CLIENT_PROFILE_AUDIO_MIN_SHIFT 32
+#define VDI_STREAM_CLIENT_PROFILE_AUDIO_MAX_SHIFT 40
+#define VDI_STREAM_CLIENT_PROFILE_HEVC_SKIPS_SHIFT 48
+#define VDI_STREAM_CLIENT_PROFILE_BYTE_MASK 0xffu
+
+/* per-peer profile state. */
+struct vdi_stream_client__profile_s
+{
+
+    /* cache entry, one name per peer, keyed by the decoder environment. */
+    char name[160];
+    char key[320];
+    Uint64 stored;
+    bool found;
+
+    /* observations of the current connection. */
+    bool connected;
+    bool h265;
+    bool color444;
+    bool hardware;
+    bool h264_fallback;
+    bool hevc_skipped;
+    Uint64 next_sample_ns;
+    double decode_ms;
+    Uint64 decode_samples;
+    Uint32 queued_max;
+};
+
+/* Extract one byte wide field of a stored profile. */
+static Uint32
+vdi_stream_client__profile_byte(Uint64 value, Uint32 shift)
+{
+    return (Uint32)(value >> shift) & VDI_STREAM_CLIENT_PROFILE_BYTE_MASK;
+}
+
+/* Create the profile of a peer and load what earlier connections learned. The
+ * entry is keyed by the VA-API driver and the decoder mode, so a driver update
+ * or another mode starts from scratch. */
+bool
+vdi_stream_client__profile_init(
+    struct parsec_context_s *parsec_context, const char *peer, vdi_video_decoder_e video_decoder
+)
+{
+    struct vdi_stream_client__profile_s *profile;
+    char vaapi_key[256];
+    size_t length;
+
+    if (peer == NULL || peer[0] == '\0') {
+        return true;
+    }
+
+    profile = SDL_calloc(1, sizeof(*profile));
+    if (profile == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate peer profile\n");
+        return false;
+    }
+    parsec_context->profile = profile;
+
+    /* Peer ids are alphanumeric, anything else would break the cache format. */
+    length = (size_t)SDL_snprintf(profile->name, sizeof(profile->name), "profile.%s", peer);
+    for (size_t i = 0; i < length && i < sizeof(profile->name) - 1; i++) {
+        if (!SDL_isalnum((unsigned char)profile->name[i]) && profile->name[i] != '.') {
+            profile->name[i] = '_';
+        }
+    }
+    if (!vdi_stream_client__cache_vaapi_key(vaapi_key, sizeof(vaapi_key))) {
+        SDL_strlcpy(vaapi_key, "none", sizeof(vaapi_key));
+    }
+    SDL_snprintf(profile->key, sizeof(profile->key), "%s-mode%d", vaapi_key, (int)video_decoder);
+    profile->found =
+        vdi_stream_client__cache_lookup(profile->name, profile->key, &profile->stored);
+    return true;
+}
+
+/* Apply a loaded profile before connecting: restore the learned audio buffer
+ * thresholds and ask the caller to skip the HEVC attempt against peers which
+ * needed the H.264 fallback, retrying HEVC every few connections in case the
+ * host changed. */
+void
+vdi_stream_client__profile_apply(
+    struct parsec_context_s *parsec_context, bool hevc_requested, bool *skip_hevc
+)
+{
+    struct vdi_stream_client__profile_s *profile = parsec_context->profile;
+    Uint64 stored;
+    Uint32 audio_min;
+    Uint32 audio_max;
+
+    *skip_hevc = false;
+    if (profile == NULL || !profile->found) {
+        return;
+    }
+    stored = profile->stored;
+    audio_min = vdi_stream_client__profile_byte(stored, VDI_STREAM_CLIENT_PROFILE_AUDIO_MIN_SHIFT);
+    audio_max = vdi_stream_client__profile_byte(stored, VDI_STREAM_CLIENT_PROFILE_AUDIO_MAX_SHIFT);
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Use peer profile: codec=%s, color=%s, decoder=%s, h264_fallback=%s, decode=%.2fms, "
+        "queued_max=%u, audio_buffer=%u-%u\n",
+        (stored & VDI_STREAM_CLIENT_PROFILE_H265) != 0 ? "H.265" : "H.264",
+        (stored & VDI_STREAM_CLIENT_PROFILE_COLOR444) != 0 ? "4:4:4" : "4:2:0",
+        (stored & VDI_STREAM_CLIENT_PROFILE_HARDWARE) != 0 ? "hardware" : "software",
+        (stored & VDI_STREAM_CLIENT_PROFILE_H264_FALLBACK) != 0 ? "yes" : "no",
+        (double)((stored >> VDI_STREAM_CLIENT_PROFILE_DECODE_SHIFT) &
+                 VDI_STREAM_CLIENT_PROFILE_DECODE_MASK) /
+            100.0,
+        vdi_stream_client__profile_byte(stored, VDI_STREAM_CLIENT_PROFILE_QUEUED_SHIFT), audio_min,
+        audio_max
+    );
+
+    if (parsec_context->audio != NULL && audio_min != 0 && audio_max > audio_min) {
+        parsec_context->min_buffer = audio_min;
+        parsec_context->max_buffer = audio_max;
+    }
+
+    if (!hevc_requested || (stored & VDI_STREAM_CLIENT_PROFILE_H264_FALLBACK) == 0) {
+        return;
+    }
+    if (vdi_stream_client__profile_byte(stored, VDI_STREAM_CLIENT_PROFILE_HEVC_SKIPS_SHIFT) >=
+        VDI_STREAM_CLIENT_PROFILE_HEVC_RETRY) {
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Retry H.265 (HEVC) with peer\n");
+        return;
+    }
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Skip H.265 (HEVC), peer needed H.264 (AVC) fallback\n"
+    );
+    profile->hevc_skipped = true;
+    *skip_hevc = true;
+}
+
+/* Observe the running connection. The negotiated codec and decoder are taken
+ * once the decoder runs, decode latency and queued frames only after a warmup
+ * so decoder setup and the first keyframe do not count as steady state. */
+void
+vdi_stream_client__profile_update(struct parsec_context_s *parsec_context, bool h264_fallback)
+{
+    struct vdi_stream_client__profile_s *profile = parsec_context->profile;
+    const ParsecMetrics *metrics = &parsec_context->client_status.self.metrics[DEFAULT_STREAM];
+    const ParsecDecoderStatus *decoder = &parsec_context->client_status.decoder[DEFAULT_STREAM];
+    Uint64 now;
+
+    if (profile == NULL || !vdi_stream_client__context_connected(parsec_context) ||
+        !parsec_context->decoder || decoder->width == 0) {
+        return;
+    }
+
+    now = SDL_GetTicksNS();
+    if (!profile->connected) {
+        profile->connected = true;
+        profile->next_sample_ns = now + (Uint64)VDI_STREAM_CLIENT_PROFILE_WARMUP_MS * 1000000;
+    }
+    profile->h265 = decoder->h265 != 0;
+    profile->color444 = decoder->color444 != 0;
+    profile->hardware = vdi_stream_client__parsec_ffmpeg_decoder_is_hardware();
+    profile->h264_fallback = h264_fallback;
+    if (now < profile->next_sample_ns) {
+        return;
+    }
+
+    profile->next_sample_ns = now + (Uint64)PARSEC_METRICS_SAMPLE_MS * 1000000;
+    profile->decode_ms += metrics->decodeLatency;
+    profile->decode_samples++;
+    profile->queued_max = SDL_max(profile->queued_max, metrics->queuedFrames);
+}
+
+/* Learn audio buffer thresholds from the current connection. Repeated
+ * underruns raise the playback threshold, repeated overflows the limit. A
+ * steady-state connection of at least a minute without either lowers them one
+ * step back towards the defaults, so a single bad network does not keep the
+ * latency up for good. */
+static void
+vdi_stream_client__profile_audio(
+    struct parsec_context_s *parsec_context,
+    const struct vdi_stream_client__profile_s *profile, Uint32 *audio_min, Uint32 *audio_max
+)
+{
+    bool calm = profile->decode_samples * PARSEC_METRICS_SAMPLE_MS >=
+                VDI_STREAM_CLIENT_PROFILE_AUDIO_CALM_MS;
+
+    Uint64 underruns =
+        atomic_load_explicit(&parsec_context->audio_underruns, memory_order_relaxed);
+    Uint64 overflows =
+        atomic_load_explicit(&parsec_context->audio_overflows, memory_order_relaxed);
+
+    *audio_min = parsec_context->min_buffer;
+    *audio_max = parsec_context->max_buffer;
+    if (underruns >= VDI_STREAM_CLIENT_PROFILE_AUDIO_EVENTS &&
+        *audio_min < VDI_STREAM_CLIENT_PROFILE_AUDIO_MIN_MAX) {
+        (*audio_min)++;
+        (*audio_max)++;
+    }
+    if (overflows >= VDI_STREAM_CLIENT_PROFILE_AUDIO_EVENTS &&
+        *audio_max < VDI_STREAM_CLIENT_PROFILE_AUDIO_MAX_MAX) {
+        *audio_max += 2;
+    }
+    if (calm && underruns == 0 && *audio_min > PARSEC_AUDIO_MIN_BUFFER) {
+        (*audio_min)--;
+        (*audio_max)--;
+    }
+    if (calm && overflows == 0 && *audio_max > PARSEC_AUDIO_MAX_BUFFER &&
+        *audio_max - 2 > *audio_min) {
+        *audio_max = SDL_max(*audio_max - 2, (Uint32)PARSEC_AUDIO_MAX_BUFFER);
+    }
+}
+
+/* Store what the connection learned and release the profile. Connections
+ * which never ran the decoder keep the previous profile. */
+void
+vdi_stream_client__profile_destroy(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__profile_s *profile = parsec_context->profile;
+    Uint64 decode = 0;
+    Uint64 value = 0;
+    Uint32 hevc_skips = 0;
+    Uint32 audio_min = 0;
+    Uint32 audio_max = 0;
+
+    if (profile == NULL) {
+        return;
+    }
+    if (!profile->connected) {
+        goto done;
+    }
+
+    if (profile->decode_samples != 0) {
+        decode = (Uint64)(profile->decode_ms * 100.0 / (double)profile->decode_samples);
+    } else if (profile->found) {
+        decode = (profile->stored >> VDI_STREAM_CLIENT_PROFILE_DECODE_SHIFT) &
+                 VDI_STREAM_CLIENT_PROFILE_DECODE_MASK;
+    }
+    if (profile->hevc_skipped) {
+        hevc_skips = vdi_stream_client__profile_byte(
+                         profile->stored, VDI_STREAM_CLIENT_PROFILE_HEVC_SKIPS_SHIFT
+                     ) +
+                     1;
+    }
+    if (parsec_context->audio != NULL) {
+        vdi_stream_client__profile_audio(parsec_context, profile, &audio_min, &audio_max);
+    }
+
+    value = (profile->h265 ? VDI_STREAM_CLIENT_PROFILE_H265 : 0u) |
+            (profile->color444 ? VDI_STREAM_CLIENT_PROFILE_COLOR444 : 0u) |
+            (profile->hardware ? VDI_STREAM_CLIENT_PROFILE_HARDWARE : 0u) |
+            (profile->h264_fallback ? VDI_STREAM_CLIENT_PROFILE_H264_FALLBACK : 0u);
+    value |= SDL_min(decode, (Uint64)VDI_STREAM_CLIENT_PROFILE_DECODE_MASK)
+             << VDI_STREAM_CLIENT_PROFILE_DECODE_SHIFT;
+    value |= (Uint64)SDL_min(profile->queued_max, VDI_STREAM_CLIENT_PROFILE_BYTE_MASK)
+             << VDI_STREAM_CLIENT_PROFILE_QUEUED_SHIFT;
+    value |= (Uint64)audio_min << VDI_STREAM_CLIENT_PROFILE_AUDIO_MIN_SHIFT;
+    value |= (Uint64)audio_max << VDI_STREAM_CLIENT_PROFILE_AUDIO_MAX_SHIFT;
+    value |= (Uint64)SDL_min(hevc_skips, VDI_STREAM_CLIENT_PROFILE_BYTE_MASK)
+             << VDI_STREAM_CLIENT_PROFILE_HEVC_SKIPS_SHIFT;
+    vdi_stream_client__cache_store(profile->name, profile->key, value);
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Store peer profile: codec=%s, h264_fallback=%s, decode=%.2fms, queued_max=%u, "
+        "audio_buffer=%u-%u\n",
+        profile->h265 ? "H.265" : "H.264", profile->h264_fallback ? "yes" : "no",
+        (double)decode / 100.0, profile->queued_max, audio_min, audio_max
+    );
+
+done:
+    SDL_free(profile);
+    parsec_context->profile = NULL;
+}
@@ -0,0 +1,40 @@
+/*
+ *  profile.h -- learned per-peer connection profiles
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_PROFILE_H
+#define VDI_STREAM_CLIENT_PROFILE_H
+
+/* internal includes. */
+#include "client.h"
+#include "parsec.h"
+
+/* per-peer profiles. */
+bool vdi_stream_client__profile_init(
+    struct parsec_context_s *parsec_context, const char *peer, vdi_video_decoder_e video_decoder
+);
+void vdi_stream_client__profile_apply(
+    struct parsec_context_s *parsec_context, bool hevc_requested, bool *skip_hevc
+);
+void vdi_stream_client__profile_update(struct parsec_context_s *parsec_context, bool h264_fallback);
+void vdi_stream_client__profile_destroy(struct parsec_context_s *parsec_context);
+
+#endif /* VDI_STREAM_CLIENT_PROFILE_H */
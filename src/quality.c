@@ -0,0 +1,197 @@
+/*
+ *  quality.c -- objective image quality scoring
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "quality.h"
+
+/* define quality scoring defaults. */
+#define VDI_STREAM_CLIENT_QUALITY_PSNR_MAX 100.0
+#define VDI_STREAM_CLIENT_QUALITY_SSIM_WINDOW 8
+#define VDI_STREAM_CLIENT_QUALITY_EDGE_THRESHOLD 128.0f
+
+/* Convert a mean squared error of 8-bit samples into PSNR, capping identical
+ * images at VDI_STREAM_CLIENT_QUALITY_PSNR_MAX instead of infinity. */
+static double
+vdi_stream_client__quality_psnr(double squared_error, Uint64 samples)
+{
+    double mse;
+
+    if (samples == 0) {
+        return 0.0;
+    }
+    mse = squared_error / (double)samples;
+    if (mse <= 0.0) {
+        return VDI_STREAM_CLIENT_QUALITY_PSNR_MAX;
+    }
+    return SDL_min(10.0 * SDL_log10(255.0 * 255.0 / mse), VDI_STREAM_CLIENT_QUALITY_PSNR_MAX);
+}
+
+/* Convert an RGBA image into BT.601 luma, which the SSIM and edge metrics use
+ * as the plane carrying text and structure. */
+static void
+vdi_stream_client__quality_luma(
+    const Uint8 *pixels, Sint32 pitch, Sint32 width, Sint32 height, float *luma
+)
+{
+    for (Sint32 y = 0; y < height; y++) {
+        const Uint8 *row = pixels + (ptrdiff_t)y * pitch;
+
+        for (Sint32 x = 0; x < width; x++) {
+            luma[(size_t)y * width + x] =
+                0.299f * row[x * 4] + 0.587f * row[x * 4 + 1] + 0.114f * row[x * 4 + 2];
+        }
+    }
+}
+
+/* Compute the Sobel gradient magnitude of an interior luma sample. */
+static float
+vdi_stream_client__quality_gradient(const float *luma, Sint32 width, Sint32 x, Sint32 y)
+{
+    const float *above = luma + (size_t)(y - 1) * width + x;
+    const float *center = luma + (size_t)y * width + x;
+    const float *below = luma + (size_t)(y + 1) * width + x;
+    float gx =
+        (above[1] + 2.0f * center[1] + below[1]) - (above[-1] + 2.0f * center[-1] + below[-1]);
+    float gy = (below[-1] + 2.0f * below[0] + below[1]) - (above[-1] + 2.0f * above[0] + above[1]);
+
+    return SDL_sqrtf(gx * gx + gy * gy);
+}
+
+/* Compute the mean SSIM over non-overlapping windows with the usual stability
+ * constants for 8-bit samples. */
+static double
+vdi_stream_client__quality_ssim(
+    const float *reference, const float *image, Sint32 width, Sint32 height
+)
+{
+    const double c1 = (0.01 * 255.0) * (0.01 * 255.0);
+    const double c2 = (0.03 * 255.0) * (0.03 * 255.0);
+    const Sint32 window = VDI_STREAM_CLIENT_QUALITY_SSIM_WINDOW;
+    const double samples = (double)(window * window);
+    double ssim = 0.0;
+    Uint64 windows = 0;
+
+    for (Sint32 y = 0; y + window <= height; y += window) {
+        for (Sint32 x = 0; x + window <= width; x += window) {
+            double sum_a = 0.0, sum_b = 0.0, sum_aa = 0.0, sum_bb = 0.0, sum_ab = 0.0;
+            double mean_a, mean_b, var_a, var_b, covariance;
+
+            for (Sint32 j = 0; j < window; j++) {
+                for (Sint32 i = 0; i < window; i++) {
+                    size_t index = (size_t)(y + j) * width + (x + i);
+                    double a = reference[index];
+                    double b = image[index];
+
+                    sum_a += a;
+                    sum_b += b;
+                    sum_aa += a * a;
+                    sum_bb += b * b;
+                    sum_ab += a * b;
+                }
+            }
+            mean_a = sum_a / samples;
+            mean_b = sum_b / samples;
+            var_a = sum_aa / samples - mean_a * mean_a;
+            var_b = sum_bb / samples - mean_b * mean_b;
+            covariance = sum_ab / samples - mean_a * mean_b;
+            ssim += ((2.0 * mean_a * mean_b + c1) * (2.0 * covariance + c2)) /
+                    ((mean_a * mean_a + mean_b * mean_b + c1) * (var_a + var_b + c2));
+            windows++;
+        }
+    }
+    return windows != 0 ? ssim / (double)windows : 0.0;
+}
+
+/* Score an RGBA image against its RGBA reference. Besides whole-image PSNR and
+ * SSIM, pixels on strong reference edges are scored separately because chroma
+ * subsampling and filtering hurt text long before they move global averages. */
+bool
+vdi_stream_client__quality_score(
+    const Uint8 *reference, Sint32 reference_pitch, const Uint8 *image, Sint32 image_pitch,
+    Sint32 width, Sint32 height, struct vdi_stream_client__quality_s *quality
+)
+{
+    float *reference_luma = NULL;
+    float *image_luma = NULL;
+    double squared_error = 0.0;
+    double edge_squared_error = 0.0;
+    double reference_energy = 0.0;
+    double image_energy = 0.0;
+    Uint64 edge_pixels = 0;
+    bool scored = false;
+
+    SDL_memset(quality, 0, sizeof(*quality));
+    reference_luma = SDL_malloc((size_t)width * (size_t)height * sizeof(float));
+    image_luma = SDL_malloc((size_t)width * (size_t)height * sizeof(float));
+    if (reference_luma == NULL || image_luma == NULL) {
+        goto done;
+    }
+    vdi_stream_client__quality_luma(reference, reference_pitch, width, height, reference_luma);
+    vdi_stream_client__quality_luma(image, image_pitch, width, height, image_luma);
+
+    for (Sint32 y = 0; y < height; y++) {
+        const Uint8 *reference_row = reference + (ptrdiff_t)y * reference_pitch;
+        const Uint8 *image_row = image + (ptrdiff_t)y * image_pitch;
+
+        for (Sint32 x = 0; x < width; x++) {
+            double pixel_error = 0.0;
+            float gradient;
+
+            for (Sint32 c = 0; c < 3; c++) {
+                double difference = (double)reference_row[x * 4 + c] - image_row[x * 4 + c];
+
+                pixel_error += difference * difference;
+            }
+            squared_error += pixel_error;
+            if (x == 0 || y == 0 || x == width - 1 || y == height - 1) {
+                continue;
+            }
+
+            gradient = vdi_stream_client__quality_gradient(reference_luma, width, x, y);
+            if (gradient < VDI_STREAM_CLIENT_QUALITY_EDGE_THRESHOLD) {
+                continue;
+            }
+            edge_squared_error += pixel_error;
+            reference_energy += gradient;
+            image_energy += vdi_stream_client__quality_gradient(image_luma, width, x, y);
+            edge_pixels++;
+        }
+    }
+
+    quality->psnr =
+        vdi_stream_client__quality_psnr(squared_error, (Uint64)width * (Uint64)height * 3u);
+    quality->ssim = vdi_stream_client__quality_ssim(reference_luma, image_luma, width, height);
+    quality->edge_psnr = vdi_stream_client__quality_psnr(edge_squared_error, edge_pixels * 3u);
+    quality->edge_retention =
+        reference_energy > 0.0 ? image_energy * 100.0 / reference_energy : 0.0;
+    scored = true;
+
+done:
+    SDL_free(reference_luma);
+    SDL_free(image_luma);
+    return scored;
+}
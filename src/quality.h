@@ -0,0 +1,44 @@
+/*
+ *  quality.h -- objective image quality scoring
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_QUALITY_H
+#define VDI_STREAM_CLIENT_QUALITY_H
+
+/* sdl includes. */
+#include <SDL3/SDL.h>
+
+/* quality scores of one rendered image against its reference. */
+struct vdi_stream_client__quality_s
+{
+    double psnr;           /* peak signal-to-noise ratio over all RGB samples in dB. */
+    double ssim;           /* mean structural similarity of luma over 8x8 windows. */
+    double edge_psnr;      /* peak signal-to-noise ratio over strong reference edges in dB. */
+    double edge_retention; /* gradient energy kept on strong reference edges in percent. */
+};
+
+/* quality scoring. */
+bool vdi_stream_client__quality_score(
+    const Uint8 *reference, Sint32 reference_pitch, const Uint8 *image, Sint32 image_pitch,
+    Sint32 width, Sint32 height, struct vdi_stream_client__quality_s *quality
+);
+
+#endif /* VDI_STREAM_CLIENT_QUALITY_H */
@@ -0,0 +1,510 @@
+/*
+ *  shadow.c -- shadow decoding of the live video bitstream
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "client.h"
+#include "ffmpeg.h"
+#include "parsec.h"
+#include "shadow.h"
+
+/* ffmpeg includes. */
+#include <libavcodec/avcodec.h>
+#include <libavutil/adler32.h>
+#include <libavutil/common.h>
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+
+/* define shadow decoding defaults. */
+#define VDI_STREAM_CLIENT_SHADOW_QUEUE 8
+
+/* One compressed packet waiting for the shadow decoder. */
+struct vdi_stream_client__shadow_packet_s
+{
+    AVPacket *packet;
+    enum AVCodecID codec_id;
+    bool flush;
+};
+
+/* shadow decoder state. */
+struct vdi_stream_client__shadow_s
+{
+
+    /* decoder configuration and worker. */
+    vdi_shadow_decoder_e mode;
+    SDL_Thread *thread;
+    AVCodecContext *codec;
+    AVBufferRef *hw_device_ctx;
+    enum AVCodecID codec_id;
+    AVFrame *frame;
+    AVFrame *sw_frame;
+
+    /* bounded packet queue shared with the Parsec decode callback. */
+    SDL_Mutex *lock;
+    SDL_Condition *ready;
+    struct vdi_stream_client__shadow_packet_s queue[VDI_STREAM_CLIENT_SHADOW_QUEUE];
+    Uint32 queue_head;
+    Uint32 queue_count;
+    bool resync;
+    bool quit;
+
+    /* per-period stats, guarded by lock. */
+    Uint64 stats_queued;
+    Uint64 stats_dropped;
+    Uint64 stats_skipped;
+    Uint64 stats_resyncs;
+    Uint32 stats_queue_max;
+    Uint64 stats_packets;
+    Uint64 stats_frames;
+    Uint64 stats_errors;
+    Uint64 stats_decode_ns;
+    Uint64 stats_decode_max_ns;
+    Uint32 stats_checksum;
+};
+
+/* The Parsec decode callback carries no client context, so the running shadow
+ * decoder is published here. It is set before the Parsec client connects and
+ * cleared only after the client is destroyed. */
+static struct vdi_stream_client__shadow_s *vdi_stream_client__shadow_active;
+
+/* Return the command line name of a shadow decoder mode. */
+static const char *
+vdi_stream_client__shadow_name(vdi_shadow_decoder_e mode)
+{
+    switch (mode) {
+    case VDI_SHADOW_DECODER_SW_SLICE:
+        return "sw-slice";
+    case VDI_SHADOW_DECODER_SW_FRAME:
+        return "sw-frame";
+    case VDI_SHADOW_DECODER_HW:
+        return "hw";
+    default:
+        return "none";
+    }
+}
+
+/* Check whether an Annex B packet starts a decodable sequence: an IDR picture
+ * for H.264 or an IRAP picture for H.265. */
+bool
+vdi_stream_client__shadow_keyframe(enum AVCodecID codec_id, const Uint8 *data, size_t size)
+{
+    for (size_t i = 0; i + 3 < size; i++) {
+        Uint8 type;
+
+        if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1) {
+            continue;
+        }
+        if (codec_id == AV_CODEC_ID_HEVC) {
+            type = (data[i + 3] >> 1) & 0x3f;
+            if (type >= 16 && type <= 23) {
+                return true;
+            }
+        } else {
+            type = data[i + 3] & 0x1f;
+            if (type == 5) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* FFmpeg get_format callback of the hardware shadow decoder that prefers
+ * VA-API surfaces and otherwise lets FFmpeg decode in software. */
+static enum AVPixelFormat
+vdi_stream_client__shadow_get_format(AVCodecContext *codec, const enum AVPixelFormat *formats)
+{
+    (void)codec;
+
+    for (const enum AVPixelFormat *format = formats; *format != AV_PIX_FMT_NONE; format++) {
+        if (*format == AV_PIX_FMT_VAAPI) {
+            return *format;
+        }
+    }
+    return formats[0];
+}
+
+/* Release the shadow codec context and its hardware device. */
+static void
+vdi_stream_client__shadow_close(struct vdi_stream_client__shadow_s *shadow)
+{
+    avcodec_free_context(&shadow->codec);
+    av_buffer_unref(&shadow->hw_device_ctx);
+    shadow->codec_id = AV_CODEC_ID_NONE;
+}
+
+/* Open the shadow codec context for a codec in the configured mode. Unlike the
+ * live decoder, the frame threaded mode drops low delay so FFmpeg may pipeline
+ * pictures across threads. */
+static bool
+vdi_stream_client__shadow_open(struct vdi_stream_client__shadow_s *shadow, enum AVCodecID codec_id)
+{
+    const AVCodec *codec = avcodec_find_decoder(codec_id);
+
+    vdi_stream_client__shadow_close(shadow);
+    if (codec == NULL) {
+        return false;
+    }
+    shadow->codec = avcodec_alloc_context3(codec);
+    if (shadow->codec == NULL) {
+        return false;
+    }
+
+    shadow->codec->thread_count = 0;
+    shadow->codec->thread_type =
+        shadow->mode == VDI_SHADOW_DECODER_SW_FRAME ? FF_THREAD_FRAME : FF_THREAD_SLICE;
+    if (shadow->mode != VDI_SHADOW_DECODER_SW_FRAME) {
+        shadow->codec->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    }
+    if (shadow->mode == VDI_SHADOW_DECODER_HW) {
+        shadow->hw_device_ctx = vdi_stream_client__parsec_ffmpeg_vaapi_device();
+        if (shadow->hw_device_ctx == NULL) {
+            vdi_stream_client__shadow_close(shadow);
+            return false;
+        }
+        shadow->codec->hw_device_ctx = av_buffer_ref(shadow->hw_device_ctx);
+        shadow->codec->get_format = vdi_stream_client__shadow_get_format;
+    }
+    if (avcodec_open2(shadow->codec, codec, NULL) < 0) {
+        vdi_stream_client__shadow_close(shadow);
+        return false;
+    }
+    shadow->codec_id = codec_id;
+    return true;
+}
+
+/* Compute the Adler-32 checksum over the visible samples of a decoded frame,
+ * downloading hardware surfaces first, so outputs can be compared across
+ * decoder configurations. */
+static bool
+vdi_stream_client__shadow_checksum(
+    struct vdi_stream_client__shadow_s *shadow, const AVFrame *frame, Uint32 *checksum
+)
+{
+    const AVPixFmtDescriptor *descriptor;
+    Uint32 adler = 1;
+
+    if (frame->hw_frames_ctx != NULL) {
+        av_frame_unref(shadow->sw_frame);
+        if (av_hwframe_transfer_data(shadow->sw_frame, frame, 0) < 0) {
+            return false;
+        }
+        frame = shadow->sw_frame;
+    }
+    descriptor = av_pix_fmt_desc_get(frame->format);
+    if (descriptor == NULL) {
+        return false;
+    }
+
+    for (Sint32 plane = 0; plane < 4 && frame->data[plane] != NULL; plane++) {
+        Sint32 rows = plane == 0 || plane == 3
+                          ? frame->height
+                          : AV_CEIL_RSHIFT(frame->height, descriptor->log2_chroma_h);
+        Sint32 bytes = av_image_get_linesize(frame->format, frame->width, plane);
+
+        for (Sint32 y = 0; bytes > 0 && y < rows; y++) {
+            adler = av_adler32_update(
+                adler, frame->data[plane] + (ptrdiff_t)y * frame->linesize[plane], (size_t)bytes
+            );
+        }
+    }
+    *checksum = adler;
+    return true;
+}
+
+/* Decode one queued packet and drain every frame it completes, recording the
+ * decode time, errors and the checksum of the latest frame. */
+static void
+vdi_stream_client__shadow_decode(
+    struct vdi_stream_client__shadow_s *shadow, struct vdi_stream_client__shadow_packet_s *entry
+)
+{
+    Uint64 start_ns = SDL_GetTicksNS();
+    Uint64 decode_ns;
+    Uint64 frames = 0;
+    Uint32 checksum = 0;
+    bool checksummed = false;
+    bool failed = false;
+    Sint32 err;
+
+    if (shadow->codec == NULL || shadow->codec_id != entry->codec_id) {
+        if (!vdi_stream_client__shadow_open(shadow, entry->codec_id)) {
+            failed = true;
+            goto done;
+        }
+    } else if (entry->flush) {
+        avcodec_flush_buffers(shadow->codec);
+    }
+
+    err = avcodec_send_packet(shadow->codec, entry->packet);
+    if (err < 0 && err != AVERROR(EAGAIN)) {
+        failed = true;
+        goto done;
+    }
+    for (;;) {
+        err = avcodec_receive_frame(shadow->codec, shadow->frame);
+        if (err == AVERROR(EAGAIN) || err == AVERROR_EOF) {
+            break;
+        }
+        if (err < 0) {
+            failed = true;
+            break;
+        }
+        frames++;
+        if (vdi_stream_client__shadow_checksum(shadow, shadow->frame, &checksum)) {
+            checksummed = true;
+        } else {
+            failed = true;
+        }
+        av_frame_unref(shadow->frame);
+    }
+
+done:
+    decode_ns = SDL_GetTicksNS() - start_ns;
+    SDL_LockMutex(shadow->lock);
+    shadow->stats_packets++;
+    shadow->stats_frames += frames;
+    shadow->stats_errors += failed ? 1 : 0;
+    shadow->stats_decode_ns += decode_ns;
+    shadow->stats_decode_max_ns = SDL_max(shadow->stats_decode_max_ns, decode_ns);
+    if (checksummed) {
+        shadow->stats_checksum = checksum;
+    }
+    if (failed) {
+        shadow->resync = true;
+    }
+    SDL_UnlockMutex(shadow->lock);
+}
+
+/* Shadow decoder worker. It runs at low priority and only ever consumes packets
+ * the live decoder has already been given, so it cannot delay presentation. */
+static Sint32
+vdi_stream_client__shadow_thread(void *data)
+{
+    struct vdi_stream_client__shadow_s *shadow = data;
+    struct vdi_stream_client__shadow_packet_s entry;
+
+    SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+    for (;;) {
+        SDL_LockMutex(shadow->lock);
+        while (shadow->queue_count == 0 && !shadow->quit) {
+            SDL_WaitCondition(shadow->ready, shadow->lock);
+        }
+        if (shadow->quit) {
+            SDL_UnlockMutex(shadow->lock);
+            break;
+        }
+        entry = shadow->queue[shadow->queue_head];
+        shadow->queue[shadow->queue_head].packet = NULL;
+        shadow->queue_head = (shadow->queue_head + 1) % VDI_STREAM_CLIENT_SHADOW_QUEUE;
+        shadow->queue_count--;
+        SDL_UnlockMutex(shadow->lock);
+
+        vdi_stream_client__shadow_decode(shadow, &entry);
+        av_packet_free(&entry.packet);
+    }
+    return 0;
+}
+
+/* Start the shadow decoder selected with --shadow-decoder. It is a no-op when
+ * shadow decoding is disabled. */
+bool
+vdi_stream_client__shadow_init(
+    struct parsec_context_s *parsec_context, vdi_shadow_decoder_e shadow_decoder
+)
+{
+    struct vdi_stream_client__shadow_s *shadow;
+
+    parsec_context->shadow = NULL;
+    if (shadow_decoder == VDI_SHADOW_DECODER_NONE) {
+        return true;
+    }
+
+    shadow = SDL_calloc(1, sizeof(*shadow));
+    if (shadow == NULL) {
+        return false;
+    }
+    parsec_context->shadow = shadow;
+    shadow->mode = shadow_decoder;
+    shadow->codec_id = AV_CODEC_ID_NONE;
+    shadow->resync = true;
+    shadow->frame = av_frame_alloc();
+    shadow->sw_frame = av_frame_alloc();
+    shadow->lock = SDL_CreateMutex();
+    shadow->ready = SDL_CreateCondition();
+    if (shadow->frame == NULL || shadow->sw_frame == NULL || shadow->lock == NULL ||
+        shadow->ready == NULL) {
+        goto error;
+    }
+    shadow->thread =
+        SDL_CreateThread(vdi_stream_client__shadow_thread, "vdi_shadow_decoder", shadow);
+    if (shadow->thread == NULL) {
+        goto error;
+    }
+
+    vdi_stream_client__shadow_active = shadow;
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Use %s shadow decoder\n",
+        vdi_stream_client__shadow_name(shadow_decoder)
+    );
+    return true;
+
+error:
+    SDL_LogError(
+        SDL_LOG_CATEGORY_APPLICATION, "Shadow decoder initialization failed: %s\n",
+        SDL_GetError()
+    );
+    vdi_stream_client__shadow_destroy(parsec_context);
+    return false;
+}
+
+/* Queue a copy of one packet the live decoder received. When the queue is full
+ * the packet is dropped and the shadow decoder skips ahead to the next keyframe
+ * instead of decoding a broken reference chain. */
+void
+vdi_stream_client__shadow_submit(enum AVCodecID codec_id, const void *data, Uint32 size)
+{
+    struct vdi_stream_client__shadow_s *shadow = vdi_stream_client__shadow_active;
+    struct vdi_stream_client__shadow_packet_s *entry;
+    Uint32 tail;
+    bool keyframe;
+
+    if (shadow == NULL || data == NULL || size == 0) {
+        return;
+    }
+    keyframe = vdi_stream_client__shadow_keyframe(codec_id, data, size);
+
+    SDL_LockMutex(shadow->lock);
+    if (shadow->queue_count == VDI_STREAM_CLIENT_SHADOW_QUEUE) {
+        shadow->stats_dropped++;
+        shadow->resync = true;
+        goto done;
+    }
+    if (shadow->resync && !keyframe) {
+        shadow->stats_skipped++;
+        goto done;
+    }
+
+    tail = (shadow->queue_head + shadow->queue_count) % VDI_STREAM_CLIENT_SHADOW_QUEUE;
+    entry = &shadow->queue[tail];
+    entry->packet = av_packet_alloc();
+    if (entry->packet == NULL || av_new_packet(entry->packet, (int)size) < 0) {
+        av_packet_free(&entry->packet);
+        shadow->stats_dropped++;
+        shadow->resync = true;
+        goto done;
+    }
+    SDL_memcpy(entry->packet->data, data, size);
+    entry->codec_id = codec_id;
+    entry->flush = shadow->resync;
+    if (shadow->resync) {
+        shadow->stats_resyncs++;
+        shadow->resync = false;
+    }
+    shadow->queue_count++;
+    shadow->stats_queued++;
+    shadow->stats_queue_max = SDL_max(shadow->stats_queue_max, shadow->queue_count);
+    SDL_SignalCondition(shadow->ready);
+
+done:
+    SDL_UnlockMutex(shadow->lock);
+}
+
+/* Print the shadow decoder block of the render statistics and reset its
+ * per-period counters. */
+void
+vdi_stream_client__shadow_stats(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__shadow_s *shadow = parsec_context->shadow;
+
+    if (shadow == NULL) {
+        return;
+    }
+
+    SDL_LockMutex(shadow->lock);
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Shadow:\n"
+        "  queue: mode=%s, queued=%llu, dropped=%llu, skipped=%llu, resyncs=%llu, max=%u\n"
+        "  decode: packets=%llu, frames=%llu, errors=%llu, avg=%.3fms, max=%.3fms\n"
+        "  checksum: adler32=%08x\n",
+        vdi_stream_client__shadow_name(shadow->mode), (unsigned long long)shadow->stats_queued,
+        (unsigned long long)shadow->stats_dropped, (unsigned long long)shadow->stats_skipped,
+        (unsigned long long)shadow->stats_resyncs, shadow->stats_queue_max,
+        (unsigned long long)shadow->stats_packets, (unsigned long long)shadow->stats_frames,
+        (unsigned long long)shadow->stats_errors,
+        shadow->stats_packets != 0
+            ? (double)shadow->stats_decode_ns / 1000000.0 / (double)shadow->stats_packets
+            : 0.0,
+        (double)shadow->stats_decode_max_ns / 1000000.0, shadow->stats_checksum
+    );
+
+    shadow->stats_queued = 0;
+    shadow->stats_dropped = 0;
+    shadow->stats_skipped = 0;
+    shadow->stats_resyncs = 0;
+    shadow->stats_queue_max = shadow->queue_count;
+    shadow->stats_packets = 0;
+    shadow->stats_frames = 0;
+    shadow->stats_errors = 0;
+    shadow->stats_decode_ns = 0;
+    shadow->stats_decode_max_ns = 0;
+    SDL_UnlockMutex(shadow->lock);
+}
+
+/* Stop the shadow decoder worker and release queued packets and codec state.
+ * Must run after the Parsec client is destroyed so no decode callback can
+ * submit packets anymore. */
+void
+vdi_stream_client__shadow_destroy(struct parsec_context_s *parsec_context)
+{
+    struct vdi_stream_client__shadow_s *shadow = parsec_context->shadow;
+
+    if (shadow == NULL) {
+        return;
+    }
+    vdi_stream_client__shadow_active = NULL;
+
+    if (shadow->thread != NULL) {
+        SDL_LockMutex(shadow->lock);
+        shadow->quit = true;
+        SDL_SignalCondition(shadow->ready);
+        SDL_UnlockMutex(shadow->lock);
+        SDL_WaitThread(shadow->thread, NULL);
+    }
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_SHADOW_QUEUE; i++) {
+        av_packet_free(&shadow->queue[i].packet);
+    }
+    vdi_stream_client__shadow_close(shadow);
+    av_frame_free(&shadow->frame);
+    av_frame_free(&shadow->sw_frame);
+    SDL_DestroyCondition(shadow->ready);
+    SDL_DestroyMutex(shadow->lock);
+    SDL_free(shadow);
+    parsec_context->shadow = NULL;
+}
@@ -0,0 +1,42 @@
+/*
+ *  shadow.h -- shadow decoding of the live video bitstream
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_SHADOW_H
+#define VDI_STREAM_CLIENT_SHADOW_H
+
+/* internal includes. */
+#include "client.h"
+#include "parsec.h"
+
+/* ffmpeg includes. */
+#include <libavcodec/avcodec.h>
+
+/* shadow decoding. */
+bool vdi_stream_client__shadow_init(
+    struct parsec_context_s *parsec_context, vdi_shadow_decoder_e shadow_decoder
+);
+bool vdi_stream_client__shadow_keyframe(enum AVCodecID codec_id, const Uint8 *data, size_t size);
+void vdi_stream_client__shadow_submit(enum AVCodecID codec_id, const void *data, Uint32 size);
+void vdi_stream_client__shadow_stats(struct parsec_context_s *parsec_context);
+void vdi_stream_client__shadow_destroy(struct parsec_context_s *parsec_context);
+
+#endif /* VDI_STREAM_CLIENT_SHADOW_H */
@@ -0,0 +1,694 @@
+/*
+ *  tune.c -- startup auto-tuning of the video decoder mode
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "cache.h"
+#include "client.h"
+#include "ffmpeg.h"
+#include "parsec.h"
+#include "placebo.h"
+#include "tune.h"
+#include "video.h"
+
+/* ffmpeg includes. */
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/pixfmt.h>
+
+/* define auto-tuning defaults. */
+#define VDI_STREAM_CLIENT_TUNE_WIDTH 1920
+#define VDI_STREAM_CLIENT_TUNE_HEIGHT 1080
+#define VDI_STREAM_CLIENT_TUNE_FRAMES 8
+#define VDI_STREAM_CLIENT_TUNE_BUDGET_NS 3000000000ULL
+#define VDI_STREAM_CLIENT_TUNE_PIXELS_MAX (1920 * 1080)
+#define VDI_STREAM_CLIENT_TUNE_TITLE_HEIGHT 32
+#define VDI_STREAM_CLIENT_TUNE_GLYPH_WIDTH 8
+#define VDI_STREAM_CLIENT_TUNE_GLYPH_HEIGHT 16
+#define VDI_STREAM_CLIENT_TUNE_CACHE_PLACEBO 0x100u
+
+/* Candidate modes in the order the client prefers them for image quality. */
+static const struct vdi_stream_client__tune_candidate_s
+{
+    const char *name;
+    vdi_video_decoder_e video_decoder;
+    bool hardware;
+    bool hevc;
+    bool color444;
+} vdi_stream_client__tune_candidates[] = {
+    { "hw-hevc-444", VDI_VIDEO_DECODER_HW_HEVC_444, true, true, true },
+    { "hw-hevc-420", VDI_VIDEO_DECODER_HW_HEVC_420, true, true, false },
+    { "hw-h264-420", VDI_VIDEO_DECODER_HW_H264_420, true, false, false },
+    { "sw-hevc-444", VDI_VIDEO_DECODER_SW_HEVC_444, false, true, true },
+    { "sw-hevc-420", VDI_VIDEO_DECODER_SW_HEVC_420, false, true, false },
+    { "sw-h264-420", VDI_VIDEO_DECODER_SW_H264_420, false, false, false },
+};
+
+/* Encoded sample stream of one codec and chroma format. */
+struct vdi_stream_client__tune_sample_s
+{
+    AVPacket *packets[VDI_STREAM_CLIENT_TUNE_FRAMES];
+    Uint32 count;
+    bool tried;
+    bool encoded;
+};
+
+/* State of one auto-tuning run. Renderers and sample streams are created on
+ * first use, so candidates skipped early never pay for them. Large desktops are
+ * measured at a quarter of their pixels or less and the times scaled up, which
+ * keeps sample generation and encoding inside the time budget. */
+struct vdi_stream_client__tune_s
+{
+    struct parsec_context_s placebo_context;
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    struct vdi_stream_client__tune_sample_s samples[3]; /* h264 4:2:0, hevc 4:2:0, hevc 4:4:4 */
+    Sint32 target_width;
+    Sint32 target_height;
+    Sint32 width;
+    Sint32 height;
+    Uint64 deadline_ns;
+    bool placebo_tried;
+    bool placebo;
+};
+
+/* Return the luma of one pixel of the synthetic desktop: a dark title bar over
+ * a light window filled with lines of 8x16 glyphs, scrolled down by row rows. */
+static Uint8
+vdi_stream_client__tune_luma(Sint32 x, Sint32 y, Uint32 row)
+{
+    Uint32 line;
+    Uint32 hash;
+    Uint32 bit;
+
+    if (y < VDI_STREAM_CLIENT_TUNE_TITLE_HEIGHT) {
+        return 80;
+    }
+    row += (Uint32)y;
+    line = row / VDI_STREAM_CLIENT_TUNE_GLYPH_HEIGHT;
+    hash = ((Uint32)(x / VDI_STREAM_CLIENT_TUNE_GLYPH_WIDTH) * 73856093u) ^ (line * 19349663u);
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    if ((hash & 7) < 2) {
+        return 235;
+    }
+    bit = ((row % VDI_STREAM_CLIENT_TUNE_GLYPH_HEIGHT) >> 1) * 4 +
+          ((Uint32)(x % VDI_STREAM_CLIENT_TUNE_GLYPH_WIDTH) >> 1);
+    return ((hash >> bit) & 1) != 0 ? 16 : 235;
+}
+
+/* Draw synthetic desktop frame number index. Every frame scrolls the text by
+ * one line like a terminal or an editor, so encoded samples carry real motion
+ * between frames instead of a static picture. */
+static AVFrame *
+vdi_stream_client__tune_frame(enum AVPixelFormat format, Sint32 width, Sint32 height, Uint32 index)
+{
+    const AVPixFmtDescriptor *descriptor = av_pix_fmt_desc_get(format);
+    AVFrame *frame = av_frame_alloc();
+    Sint32 chroma_width;
+    Sint32 chroma_height;
+
+    if (frame == NULL || descriptor == NULL) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    frame->colorspace = AVCOL_SPC_BT709;
+    frame->color_range = AVCOL_RANGE_MPEG;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    for (Sint32 y = 0; y < height; y++) {
+        Uint8 *luma = frame->data[0] + (ptrdiff_t)y * frame->linesize[0];
+
+        for (Sint32 x = 0; x < width; x++) {
+            luma[x] =
+                vdi_stream_client__tune_luma(x, y, index * VDI_STREAM_CLIENT_TUNE_GLYPH_HEIGHT);
+        }
+    }
+
+    chroma_width = AV_CEIL_RSHIFT(width, descriptor->log2_chroma_w);
+    chroma_height = AV_CEIL_RSHIFT(height, descriptor->log2_chroma_h);
+    for (Sint32 y = 0; y < chroma_height; y++) {
+        bool title = (y << descriptor->log2_chroma_h) < VDI_STREAM_CLIENT_TUNE_TITLE_HEIGHT;
+        Uint8 u = title ? 170 : 128;
+        Uint8 v = title ? 110 : 128;
+
+        if (format == AV_PIX_FMT_NV12) {
+            Uint8 *uv = frame->data[1] + (ptrdiff_t)y * frame->linesize[1];
+
+            for (Sint32 x = 0; x < chroma_width; x++) {
+                uv[x * 2] = u;
+                uv[x * 2 + 1] = v;
+            }
+            continue;
+        }
+        SDL_memset(frame->data[1] + (ptrdiff_t)y * frame->linesize[1], u, chroma_width);
+        SDL_memset(frame->data[2] + (ptrdiff_t)y * frame->linesize[2], v, chroma_width);
+    }
+    return frame;
+}
+
+/* Encode the synthetic frames into the sample stream of one codec and chroma
+ * format with the fastest low-latency encoder settings. The encoder is flushed
+ * early once the deadline passes. Fails when no encoder for the codec is
+ * available, it rejects the chroma format or fewer than two packets came out. */
+static bool
+vdi_stream_client__tune_encode(
+    struct vdi_stream_client__tune_sample_s *sample, bool hevc, bool color444, Sint32 width,
+    Sint32 height, Uint64 deadline_ns
+)
+{
+    const AVCodec *codec = avcodec_find_encoder_by_name(hevc ? "libx265" : "libx264");
+    enum AVPixelFormat format = color444 ? AV_PIX_FMT_YUV444P : AV_PIX_FMT_YUV420P;
+    AVCodecContext *context = NULL;
+    AVPacket *packet = NULL;
+    bool encoded = false;
+
+    if (codec == NULL) {
+        codec = avcodec_find_encoder(hevc ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264);
+    }
+    if (codec == NULL) {
+        goto done;
+    }
+    context = avcodec_alloc_context3(codec);
+    packet = av_packet_alloc();
+    if (context == NULL || packet == NULL) {
+        goto done;
+    }
+    context->width = width;
+    context->height = height;
+    context->pix_fmt = format;
+    context->time_base = (AVRational){ 1, PARSEC_TARGET_FPS };
+    context->framerate = (AVRational){ PARSEC_TARGET_FPS, 1 };
+    context->gop_size = VDI_STREAM_CLIENT_TUNE_FRAMES;
+    context->max_b_frames = 0;
+    av_opt_set(context->priv_data, "preset", "ultrafast", 0);
+    av_opt_set(context->priv_data, "tune", "zerolatency", 0);
+    av_opt_set(context->priv_data, "x265-params", "log-level=error", 0);
+    if (avcodec_open2(context, codec, NULL) < 0) {
+        goto done;
+    }
+
+    /* The last pass sends no frame, which flushes the encoder. */
+    for (Uint32 i = 0; i <= VDI_STREAM_CLIENT_TUNE_FRAMES; i++) {
+        bool flush = i == VDI_STREAM_CLIENT_TUNE_FRAMES || SDL_GetTicksNS() > deadline_ns;
+        AVFrame *frame = NULL;
+        Sint32 err;
+
+        if (!flush) {
+            frame = vdi_stream_client__tune_frame(format, width, height, i);
+            if (frame == NULL) {
+                goto done;
+            }
+            frame->pts = i;
+        }
+        err = avcodec_send_frame(context, frame);
+        av_frame_free(&frame);
+        while (err >= 0) {
+            err = avcodec_receive_packet(context, packet);
+            if (err >= 0 && sample->count < VDI_STREAM_CLIENT_TUNE_FRAMES) {
+                sample->packets[sample->count] = av_packet_clone(packet);
+                if (sample->packets[sample->count] == NULL) {
+                    err = AVERROR(ENOMEM);
+                } else {
+                    sample->count++;
+                }
+            }
+            av_packet_unref(packet);
+        }
+        if (err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+            goto done;
+        }
+        if (flush) {
+            break;
+        }
+    }
+    encoded = sample->count >= 2;
+
+done:
+    av_packet_free(&packet);
+    avcodec_free_context(&context);
+    return encoded;
+}
+
+/* Return the sample stream of a candidate, encoding it on first use. */
+static const struct vdi_stream_client__tune_sample_s *
+vdi_stream_client__tune_sample(
+    struct vdi_stream_client__tune_s *tune,
+    const struct vdi_stream_client__tune_candidate_s *candidate
+)
+{
+    struct vdi_stream_client__tune_sample_s *sample =
+        &tune->samples[candidate->hevc ? (candidate->color444 ? 2 : 1) : 0];
+
+    if (!sample->tried) {
+        sample->tried = true;
+        sample->encoded = vdi_stream_client__tune_encode(
+            sample, candidate->hevc, candidate->color444, tune->width, tune->height,
+            tune->deadline_ns
+        );
+    }
+    return sample->encoded ? sample : NULL;
+}
+
+/* Measure the average libplacebo render and completion time of frames in the
+ * given format. Hardware frames are imported into Vulkan without copies, so
+ * their uploads are left out. Software frames count the upload. It copies the
+ * planes into a host-mapped staging buffer first, a step the mapped decoder
+ * buffers skip at runtime, so libplacebo is measured on the slow side. */
+static bool
+vdi_stream_client__tune_render_placebo(
+    struct vdi_stream_client__tune_s *tune, enum AVPixelFormat format, bool upload,
+    Uint64 *render_ns
+)
+{
+    struct vdi_stream_client__placebo_stages_s stages = { 0 };
+    struct vdi_stream_client__placebo_stages_s warmup = { 0 };
+    AVFrame *frames[2] = { 0 };
+    Uint32 count = 0;
+    bool rendered = false;
+
+    if (!tune->placebo_tried) {
+        tune->placebo_tried = true;
+        tune->placebo = vdi_stream_client__placebo_offscreen_init(
+            &tune->placebo_context, tune->width, tune->height
+        );
+        if (!tune->placebo) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION, "Auto-bench libplacebo renderer unavailable: %s\n",
+                SDL_GetError()
+            );
+        }
+    }
+    if (!tune->placebo) {
+        return false;
+    }
+
+    for (Uint32 i = 0; i < SDL_arraysize(frames); i++) {
+        frames[i] = vdi_stream_client__tune_frame(format, tune->width, tune->height, i);
+        if (frames[i] == NULL) {
+            goto done;
+        }
+    }
+
+    /* The first frame compiles the shaders and is not timed. */
+    if (!vdi_stream_client__placebo_offscreen_render(&tune->placebo_context, frames[0], &warmup)) {
+        goto done;
+    }
+    for (; count < VDI_STREAM_CLIENT_TUNE_FRAMES; count++) {
+        if (count != 0 && SDL_GetTicksNS() > tune->deadline_ns) {
+            break;
+        }
+        if (!vdi_stream_client__placebo_offscreen_render(
+                &tune->placebo_context, frames[count % SDL_arraysize(frames)], &stages
+            )) {
+            goto done;
+        }
+    }
+    *render_ns = ((upload ? stages.upload_ns : 0) + stages.render_ns + stages.finish_ns) / count;
+    rendered = true;
+
+done:
+    for (Uint32 i = 0; i < SDL_arraysize(frames); i++) {
+        av_frame_free(&frames[i]);
+    }
+    return rendered;
+}
+
+/* Measure the average time to upload frames of the software decoder output
+ * format into a streaming texture and draw it with the renderer the client
+ * would use, created for a hidden window. Software modes compare this against
+ * rendering the same frames through libplacebo. */
+static bool
+vdi_stream_client__tune_render_sdl(
+    struct vdi_stream_client__tune_s *tune, bool color444, Uint64 *render_ns
+)
+{
+    enum AVPixelFormat format = color444 ? AV_PIX_FMT_YUV444P : AV_PIX_FMT_YUV420P;
+    AVFrame *frames[2] = { 0 };
+    SDL_Texture *texture = NULL;
+    SDL_PixelFormat pixel_format;
+    Uint64 upload_ns = 0;
+    Uint64 draw_ns = 0;
+    Uint32 count = 0;
+    bool rendered = false;
+
+    if (tune->renderer == NULL) {
+        tune->window = SDL_CreateWindow(
+            "VDI Stream Client", tune->width, tune->height,
+            SDL_WINDOW_HIDDEN | vdi_stream_client__video_window_flags(false)
+        );
+        if (tune->window != NULL) {
+            tune->renderer = SDL_CreateRenderer(tune->window, NULL);
+        }
+        if (tune->renderer == NULL) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION, "Auto-bench SDL renderer unavailable: %s\n",
+                SDL_GetError()
+            );
+            return false;
+        }
+    }
+
+    for (Uint32 i = 0; i < SDL_arraysize(frames); i++) {
+        frames[i] = vdi_stream_client__tune_frame(format, tune->width, tune->height, i);
+        if (frames[i] == NULL) {
+            goto done;
+        }
+    }
+    if (!vdi_stream_client__parsec_ffmpeg_avframe_texture_format(frames[0], &pixel_format)) {
+        goto done;
+    }
+    texture = SDL_CreateTexture(
+        tune->renderer, pixel_format, SDL_TEXTUREACCESS_STREAMING, tune->width, tune->height
+    );
+    if (texture == NULL ||
+        !vdi_stream_client__parsec_ffmpeg_avframe_update(texture, frames[0], NULL)) {
+        goto done;
+    }
+    for (; count < VDI_STREAM_CLIENT_TUNE_FRAMES; count++) {
+        Uint64 draw_start_ns;
+
+        if (count != 0 && SDL_GetTicksNS() > tune->deadline_ns) {
+            break;
+        }
+        if (!vdi_stream_client__parsec_ffmpeg_avframe_update(
+                texture, frames[count % SDL_arraysize(frames)], &upload_ns
+            )) {
+            goto done;
+        }
+        draw_start_ns = SDL_GetTicksNS();
+        if (!SDL_RenderTexture(tune->renderer, texture, NULL, NULL) ||
+            !SDL_FlushRenderer(tune->renderer)) {
+            goto done;
+        }
+        draw_ns += SDL_GetTicksNS() - draw_start_ns;
+    }
+    *render_ns = (upload_ns + draw_ns) / count;
+    rendered = true;
+
+done:
+    SDL_DestroyTexture(texture);
+    for (Uint32 i = 0; i < SDL_arraysize(frames); i++) {
+        av_frame_free(&frames[i]);
+    }
+    return rendered;
+}
+
+/* Pick the resolution to measure at: the configured one, or the pixel size of
+ * the primary desktop which the host resolution follows by default. */
+static void
+vdi_stream_client__tune_resolution(
+    const struct vdi_config_s *vdi_config, Sint32 *width, Sint32 *height
+)
+{
+    const SDL_DisplayMode *mode = SDL_GetDesktopDisplayMode(SDL_GetPrimaryDisplay());
+
+    *width = VDI_STREAM_CLIENT_TUNE_WIDTH;
+    *height = VDI_STREAM_CLIENT_TUNE_HEIGHT;
+    if (vdi_config->width > 0 && vdi_config->height > 0) {
+        *width = vdi_config->width;
+        *height = vdi_config->height;
+    } else if (mode != NULL && mode->w > 0 && mode->h > 0) {
+        *width = (Sint32)((float)mode->w * mode->pixel_density);
+        *height = (Sint32)((float)mode->h * mode->pixel_density);
+    }
+    *width &= ~1;
+    *height &= ~1;
+}
+
+/* Halve the target resolution until it fits the measured pixel cap. */
+static void
+vdi_stream_client__tune_capped(
+    Sint32 target_width, Sint32 target_height, Sint32 *width, Sint32 *height
+)
+{
+    *width = target_width;
+    *height = target_height;
+    while ((Sint64)*width * *height > VDI_STREAM_CLIENT_TUNE_PIXELS_MAX) {
+        *width = (*width / 2) & ~1;
+        *height = (*height / 2) & ~1;
+    }
+}
+
+/* Return the command line name of a concrete video decoder mode. */
+static const char *
+vdi_stream_client__tune_name(vdi_video_decoder_e video_decoder)
+{
+    for (size_t i = 0; i < SDL_arraysize(vdi_stream_client__tune_candidates); i++) {
+        if (vdi_stream_client__tune_candidates[i].video_decoder == video_decoder) {
+            return vdi_stream_client__tune_candidates[i].name;
+        }
+    }
+    return "unknown";
+}
+
+/* Measure the render time of a candidate. Hardware modes render through
+ * libplacebo. Software modes are uploaded and drawn with the SDL renderer and,
+ * where a Vulkan device is available, through libplacebo too, and the faster
+ * of both is used and reported in placebo. */
+static bool
+vdi_stream_client__tune_render(
+    struct vdi_stream_client__tune_s *tune,
+    const struct vdi_stream_client__tune_candidate_s *candidate, Uint64 *render_ns, bool *placebo
+)
+{
+    enum AVPixelFormat format = candidate->color444 ? AV_PIX_FMT_YUV444P : AV_PIX_FMT_YUV420P;
+    Uint64 placebo_ns;
+    bool rendered;
+
+    *placebo = candidate->hardware;
+    if (candidate->hardware) {
+        return vdi_stream_client__tune_render_placebo(
+            tune, candidate->color444 ? AV_PIX_FMT_YUV444P : AV_PIX_FMT_NV12, false, render_ns
+        );
+    }
+
+    rendered = vdi_stream_client__tune_render_sdl(tune, candidate->color444, render_ns);
+    if (vdi_stream_client__tune_render_placebo(tune, format, true, &placebo_ns) &&
+        (!rendered || placebo_ns < *render_ns)) {
+        *render_ns = placebo_ns;
+        *placebo = true;
+        rendered = true;
+    }
+    return rendered;
+}
+
+/* Measure every candidate within the time budget and return the first one, in
+ * quality order, whose decode plus render time fits the frame interval. If
+ * none does, the fastest measured candidate wins. Times measured below the
+ * target resolution are scaled up by the pixel ratio. software_placebo is set
+ * when a software mode wins through libplacebo. A hardware mode without a
+ * sample stream is unmeasured rather than excluded: its VA-API profile is
+ * there, so it is picked in quality order like the default mode would be, and
+ * unmeasured is set so the choice is not cached. Software modes depend on the
+ * CPU too much to be picked unmeasured. Returns false if no candidate could be
+ * measured or picked at all. */
+static bool
+vdi_stream_client__tune_measure(
+    struct vdi_stream_client__tune_s *tune, vdi_video_decoder_e *choice, bool *software_placebo,
+    bool *unmeasured
+)
+{
+    const Uint64 interval_ns = SDL_NS_PER_SECOND / PARSEC_TARGET_FPS;
+    const double scale = (double)tune->target_width * tune->target_height /
+                         ((double)tune->width * tune->height);
+    Uint64 fastest_ns = UINT64_MAX;
+    bool h264 = false;
+    bool hevc = false;
+    bool hevc444 = false;
+
+    (void)vdi_stream_client__parsec_ffmpeg_vaapi_codecs(&h264, &hevc, &hevc444);
+
+    for (size_t i = 0; i < SDL_arraysize(vdi_stream_client__tune_candidates); i++) {
+        const struct vdi_stream_client__tune_candidate_s *candidate =
+            &vdi_stream_client__tune_candidates[i];
+        const struct vdi_stream_client__tune_sample_s *sample;
+        Uint64 decode_ns;
+        Uint64 render_ns;
+        bool supported = candidate->hevc ? (candidate->color444 ? hevc444 : hevc) : h264;
+        bool rendered_placebo;
+
+        if (candidate->hardware && !supported) {
+            SDL_LogInfo(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "Auto-bench: mode=%s skipped without VA-API support\n", candidate->name
+            );
+            continue;
+        }
+        if (SDL_GetTicksNS() > tune->deadline_ns) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION, "Auto-bench: mode=%s skipped after time budget\n",
+                candidate->name
+            );
+            continue;
+        }
+
+        sample = vdi_stream_client__tune_sample(tune, candidate);
+        if (sample == NULL && candidate->hardware) {
+            SDL_LogInfo(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "Auto-bench: mode=%s unmeasured without sample stream, use it by default\n",
+                candidate->name
+            );
+            *choice = candidate->video_decoder;
+            *software_placebo = false;
+            *unmeasured = true;
+            return true;
+        }
+        if (sample == NULL) {
+            SDL_LogInfo(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "Auto-bench: mode=%s unmeasured without sample stream\n", candidate->name
+            );
+            continue;
+        }
+        if (!vdi_stream_client__parsec_ffmpeg_sample_decode(
+                candidate->hevc, candidate->hardware, sample->packets, sample->count,
+                tune->deadline_ns, &decode_ns
+            ) ||
+            !vdi_stream_client__tune_render(tune, candidate, &render_ns, &rendered_placebo)) {
+            SDL_LogWarn(
+                SDL_LOG_CATEGORY_APPLICATION, "Auto-bench: mode=%s failed\n", candidate->name
+            );
+            continue;
+        }
+        decode_ns = (Uint64)((double)decode_ns * scale);
+        render_ns = (Uint64)((double)render_ns * scale);
+
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "Auto-bench: mode=%s, renderer=%s, decode=%.3fms, render=%.3fms, interval=%.3fms\n",
+            candidate->name, rendered_placebo ? "libplacebo" : "sdl",
+            (double)decode_ns / 1000000.0, (double)render_ns / 1000000.0,
+            (double)interval_ns / 1000000.0
+        );
+        if (decode_ns + render_ns <= interval_ns) {
+            *choice = candidate->video_decoder;
+            *software_placebo = rendered_placebo && !candidate->hardware;
+            return true;
+        }
+        if (decode_ns + render_ns < fastest_ns) {
+            fastest_ns = decode_ns + render_ns;
+            *choice = candidate->video_decoder;
+            *software_placebo = rendered_placebo && !candidate->hardware;
+        }
+    }
+    return fastest_ns != UINT64_MAX;
+}
+
+/* Resolve --video-decoder auto-bench into a concrete mode, and for software
+ * modes the renderer, before the decoder policy is applied. The choice is
+ * cached per VA-API driver and resolution, so only the first start on a
+ * machine spends the measurement budget. */
+bool
+vdi_stream_client__tune_video_decoder(struct vdi_config_s *vdi_config)
+{
+    struct vdi_stream_client__tune_s *tune;
+    vdi_video_decoder_e choice = VDI_VIDEO_DECODER_HW_HEVC_444;
+    char vaapi_key[256];
+    char key[320];
+    Uint64 cached;
+    Uint64 start_ns;
+    bool measured;
+    bool software_placebo = false;
+    bool unmeasured = false;
+
+    if (vdi_config->video_decoder != VDI_VIDEO_DECODER_AUTO_BENCH) {
+        return true;
+    }
+
+    tune = SDL_calloc(1, sizeof(*tune));
+    if (tune == NULL) {
+        return false;
+    }
+    vdi_stream_client__tune_resolution(vdi_config, &tune->target_width, &tune->target_height);
+    if (!vdi_stream_client__cache_vaapi_key(vaapi_key, sizeof(vaapi_key))) {
+        SDL_strlcpy(vaapi_key, "none", sizeof(vaapi_key));
+    }
+    SDL_snprintf(
+        key, sizeof(key), "%s-%dx%d", vaapi_key, tune->target_width, tune->target_height
+    );
+    if (vdi_stream_client__cache_lookup("tune.video_decoder", key, &cached) &&
+        (cached & ~(Uint64)VDI_STREAM_CLIENT_TUNE_CACHE_PLACEBO) < VDI_VIDEO_DECODER_AUTO_BENCH) {
+        vdi_config->video_decoder =
+            (vdi_video_decoder_e)(cached & ~(Uint64)VDI_STREAM_CLIENT_TUNE_CACHE_PLACEBO);
+        vdi_config->software_placebo = (cached & VDI_STREAM_CLIENT_TUNE_CACHE_PLACEBO) != 0;
+        SDL_LogInfo(
+            SDL_LOG_CATEGORY_APPLICATION, "Use cached auto-bench video decoder %s%s for %s\n",
+            vdi_stream_client__tune_name(vdi_config->video_decoder),
+            vdi_config->software_placebo ? " with libplacebo" : "", key
+        );
+        SDL_free(tune);
+        return true;
+    }
+
+    vdi_stream_client__tune_capped(
+        tune->target_width, tune->target_height, &tune->width, &tune->height
+    );
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Auto-bench video decoders for %dx%d at %dx%d\n",
+        tune->target_width, tune->target_height, tune->width, tune->height
+    );
+    start_ns = SDL_GetTicksNS();
+    tune->deadline_ns = start_ns + VDI_STREAM_CLIENT_TUNE_BUDGET_NS;
+    measured = vdi_stream_client__tune_measure(tune, &choice, &software_placebo, &unmeasured);
+    if (!measured) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Auto-bench measured no video decoder\n");
+    }
+    if (measured && !unmeasured) {
+        vdi_stream_client__cache_store(
+            "tune.video_decoder", key,
+            choice | (software_placebo ? VDI_STREAM_CLIENT_TUNE_CACHE_PLACEBO : 0)
+        );
+    }
+    vdi_config->video_decoder = choice;
+    vdi_config->software_placebo = software_placebo;
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Select %s video decoder%s after %.1fms\n",
+        vdi_stream_client__tune_name(choice), software_placebo ? " with libplacebo" : "",
+        (double)(SDL_GetTicksNS() - start_ns) / 1000000.0
+    );
+
+    for (Uint32 i = 0; i < SDL_arraysize(tune->samples); i++) {
+        for (Uint32 j = 0; j < tune->samples[i].count; j++) {
+            av_packet_free(&tune->samples[i].packets[j]);
+        }
+    }
+    SDL_DestroyRenderer(tune->renderer);
+    SDL_DestroyWindow(tune->window);
+    vdi_stream_client__placebo_destroy(&tune->placebo_context);
+    SDL_free(tune);
+    return true;
+}
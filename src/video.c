@@ -27,9 +27,14 @@
 
 /* internal includes. */
 #include "client.h"
+#include "clock.h"
+#include "damage.h"
+#include "degrade.h"
 #include "ffmpeg.h"
 #include "parsec.h"
 #include "placebo.h"
+#include "pool.h"
+#include "present.h"
 
 /* system includes. */
 #include <limits.h>
@@ -55,21 +60,27 @@ vdi_stream_client__video_render_texture(
     return rendered;
 }
 
-/* Present the SDL renderer and account for both attempted and successful
- * presents. The caller still logs SDL errors because it knows the context. */
+/* Present the SDL renderer, feed the present timing to the frame pacing
+ * scheduler and account for both attempted and successful presents. The render
+ * lock is not held across the present, which may block on vsync. The caller
+ * still logs SDL errors because it knows the context. */
 static bool
 vdi_stream_client__video_present(struct parsec_context_s *parsec_context)
 {
-    Uint64 present_start_ns = parsec_context->stats_enabled ? SDL_GetTicksNS() : 0;
+    Uint64 present_start_ns = SDL_GetTicksNS();
     bool presented = SDL_RenderPresent(parsec_context->renderer);
+    Uint64 present_end_ns = SDL_GetTicksNS();
 
+    SDL_LockMutex(parsec_context->render_lock);
+    vdi_stream_client__present_done(parsec_context, present_start_ns, present_end_ns);
     if (parsec_context->stats_enabled) {
         parsec_context->stats_present_calls++;
-        parsec_context->stats_present_ns += SDL_GetTicksNS() - present_start_ns;
+        parsec_context->stats_present_ns += present_end_ns - present_start_ns;
         if (presented) {
             parsec_context->stats_presents++;
         }
     }
+    SDL_UnlockMutex(parsec_context->render_lock);
     return presented;
 }
 
@@ -145,6 +156,7 @@ vdi_stream_client__video_texture(
     parsec_context->texture_width = frame->fullWidth;
     parsec_context->texture_height = frame->fullHeight;
     parsec_context->pixel_format_video = pixel_format;
+    vdi_stream_client__damage_reset(parsec_context->damage);
     if (format_changed) {
         pixel_format_name = SDL_GetPixelFormatName(pixel_format);
         SDL_LogInfo(
@@ -155,13 +167,121 @@ vdi_stream_client__video_texture(
     return true;
 }
 
-/* Parsec frame callback used by the render loop. It first gives libplacebo a
- * chance to render VA-API hardware frames, then falls back to SDL texture
- * uploads for FFmpeg descriptor frames or raw Parsec image buffers. */
+/* Upload a rectangle of a raw Parsec image buffer, or the whole buffer for a
+ * NULL rectangle. Rectangles start at even coordinates, so chroma offsets of
+ * the 4:2:0 formats stay exact. */
+static bool
+vdi_stream_client__video_raw_update(
+    SDL_Texture *texture, const ParsecFrame *frame, const Uint8 *pixels, const SDL_Rect *rect
+)
+{
+    size_t luma_bytes = (size_t)frame->fullWidth * frame->fullHeight;
+    size_t chroma_bytes = (size_t)(frame->fullWidth / 2) * (frame->fullHeight / 2);
+    Sint32 x = rect != NULL ? rect->x : 0;
+    Sint32 y = rect != NULL ? rect->y : 0;
+
+    switch (frame->format) {
+    case FORMAT_NV12:
+        return SDL_UpdateNVTexture(
+            texture, rect, pixels + (size_t)y * frame->fullWidth + x, frame->fullWidth,
+            pixels + luma_bytes + (size_t)(y / 2) * frame->fullWidth + x, frame->fullWidth
+        );
+    case FORMAT_I420:
+        return SDL_UpdateYUVTexture(
+            texture, rect, pixels + (size_t)y * frame->fullWidth + x, frame->fullWidth,
+            pixels + luma_bytes + (size_t)(y / 2) * (frame->fullWidth / 2) + x / 2,
+            frame->fullWidth / 2,
+            pixels + luma_bytes + chroma_bytes + (size_t)(y / 2) * (frame->fullWidth / 2) + x / 2,
+            frame->fullWidth / 2
+        );
+    case FORMAT_BGRA:
+    case FORMAT_RGBA:
+        return SDL_UpdateTexture(
+            texture, rect, pixels + ((size_t)y * frame->fullWidth + x) * 4, frame->fullWidth * 4
+        );
+    default:
+        return false;
+    }
+}
+
+/* Upload a raw Parsec image buffer, limited to the rectangles the damage
+ * tracker found changed since the previous frame. */
+static bool
+vdi_stream_client__video_raw_damage_update(
+    struct parsec_context_s *parsec_context, const ParsecFrame *frame, const Uint8 *pixels
+)
+{
+    struct vdi_stream_client__damage_plane_s planes[3];
+    size_t luma_bytes = (size_t)frame->fullWidth * frame->fullHeight;
+    size_t chroma_bytes = (size_t)(frame->fullWidth / 2) * (frame->fullHeight / 2);
+    const SDL_Rect *rects = NULL;
+    Sint32 plane_count = 0;
+    Sint32 count = -1;
+    bool ok = true;
+
+    switch (frame->format) {
+    case FORMAT_NV12:
+        planes[plane_count++] =
+            (struct vdi_stream_client__damage_plane_s){ pixels, frame->fullWidth, 0, 0, 1 };
+        planes[plane_count++] = (struct vdi_stream_client__damage_plane_s){
+            pixels + luma_bytes, frame->fullWidth, 1, 1, 2
+        };
+        break;
+    case FORMAT_I420:
+        planes[plane_count++] =
+            (struct vdi_stream_client__damage_plane_s){ pixels, frame->fullWidth, 0, 0, 1 };
+        planes[plane_count++] = (struct vdi_stream_client__damage_plane_s){
+            pixels + luma_bytes, frame->fullWidth / 2, 1, 1, 1
+        };
+        planes[plane_count++] = (struct vdi_stream_client__damage_plane_s){
+            pixels + luma_bytes + chroma_bytes, frame->fullWidth / 2, 1, 1, 1
+        };
+        break;
+    case FORMAT_BGRA:
+    case FORMAT_RGBA:
+        planes[plane_count++] =
+            (struct vdi_stream_client__damage_plane_s){ pixels, frame->fullWidth * 4, 0, 0, 4 };
+        break;
+    default:
+        break;
+    }
+    if (plane_count != 0) {
+        count = vdi_stream_client__damage_detect(
+            parsec_context->damage, planes, plane_count, frame->fullWidth, frame->fullHeight,
+            &rects
+        );
+    }
+
+    if (count < 0) {
+        ok = vdi_stream_client__video_raw_update(
+            parsec_context->texture_video, frame, pixels, NULL
+        );
+    }
+    for (Sint32 i = 0; i < count && ok; i++) {
+        ok = vdi_stream_client__video_raw_update(
+            parsec_context->texture_video, frame, pixels, &rects[i]
+        );
+    }
+    if (!ok) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Video texture update failed: %s\n", SDL_GetError()
+        );
+        vdi_stream_client__damage_reset(parsec_context->damage);
+    }
+    return ok;
+}
+
+/* Upload a frame handed over by the frame thread on the main thread. It first
+ * gives libplacebo a chance to render VA-API hardware frames and software
+ * frames in mapped decoder buffers, then falls back to SDL texture uploads of
+ * the damaged parts of FFmpeg descriptor frames or raw Parsec image buffers.
+ * The caller holds the render lock, which keeps the frame thread and with it
+ * the SDK image waiting. */
 static void
-vdi_stream_client__frame_video_update(const ParsecFrame *frame, const void *image, void *opaque)
+vdi_stream_client__frame_video_update(
+    struct parsec_context_s *parsec_context, const ParsecFrame *frame, const void *image
+)
 {
-    struct parsec_context_s *parsec_context = (struct parsec_context_s *)opaque;
     const Uint8 *pixels = (const Uint8 *)image;
     Uint64 upload_elapsed_ns = 0;
     Uint64 upload_start_ns = 0;
@@ -169,6 +289,10 @@ vdi_stream_client__frame_video_update(const ParsecFrame *frame, const void *imag
     bool placebo_handled = false;
     bool updated = false;
 
+    if (parsec_context->stats_enabled) {
+        parsec_context->stats_cadence_arrival_ns = SDL_GetTicksNS();
+    }
+    vdi_stream_client__clock_frame(parsec_context, frame, image);
     if (vdi_stream_client__placebo_render(parsec_context, frame, image, &placebo_handled)) {
         updated = true;
         goto done;
@@ -184,7 +308,7 @@ vdi_stream_client__frame_video_update(const ParsecFrame *frame, const void *imag
     if (vdi_stream_client__parsec_ffmpeg_frame_is_descriptor(frame, image)) {
         upload_attempted = true;
         updated = vdi_stream_client__parsec_ffmpeg_frame_update(
-            parsec_context->texture_video, frame, image,
+            parsec_context->texture_video, frame, image, parsec_context->damage,
             parsec_context->stats_enabled ? &upload_elapsed_ns : NULL
         );
         goto done;
@@ -195,52 +319,16 @@ vdi_stream_client__frame_video_update(const ParsecFrame *frame, const void *imag
     }
     upload_attempted = true;
 
-    switch (frame->format) {
-    case FORMAT_NV12:
-        if (!SDL_UpdateNVTexture(
-                parsec_context->texture_video, NULL, pixels, frame->fullWidth,
-                pixels + frame->fullWidth * frame->fullHeight, frame->fullWidth
-            )) {
-            SDL_LogError(
-                SDL_LOG_CATEGORY_APPLICATION, "Video texture update failed: %s\n", SDL_GetError()
-            );
-            goto done;
-        }
-        updated = true;
-        break;
-    case FORMAT_I420:
-        if (!SDL_UpdateYUVTexture(
-                parsec_context->texture_video, NULL, pixels, frame->fullWidth,
-                pixels + frame->fullWidth * frame->fullHeight, frame->fullWidth / 2,
-                pixels + frame->fullWidth * frame->fullHeight +
-                    (frame->fullWidth / 2) * (frame->fullHeight / 2),
-                frame->fullWidth / 2
-            )) {
-            SDL_LogError(
-                SDL_LOG_CATEGORY_APPLICATION, "Video texture update failed: %s\n", SDL_GetError()
-            );
-            goto done;
-        }
-        updated = true;
-        break;
-    case FORMAT_BGRA:
-    case FORMAT_RGBA:
-        if (!SDL_UpdateTexture(parsec_context->texture_video, NULL, pixels, frame->fullWidth * 4)) {
-            SDL_LogError(
-                SDL_LOG_CATEGORY_APPLICATION, "Video texture update failed: %s\n", SDL_GetError()
-            );
-            goto done;
-        }
-        updated = true;
-        break;
-    default:
-        goto done;
-    }
+    updated = vdi_stream_client__video_raw_damage_update(parsec_context, frame, pixels);
 
 done:
     if (updated && upload_attempted) {
         parsec_context->frame_video_texture = parsec_context->texture_video;
     }
+    if (updated) {
+        parsec_context->frame_video_width = (Sint32)frame->width;
+        parsec_context->frame_video_height = (Sint32)frame->height;
+    }
     if (upload_attempted && parsec_context->stats_enabled) {
         parsec_context->stats_uploads++;
         parsec_context->stats_upload_ns +=
@@ -252,18 +340,98 @@ done:
     }
     if (updated) {
         parsec_context->frame_video_updated = true;
+        vdi_stream_client__present_frame(parsec_context);
     }
     vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
 }
 
+/* Release a kept frame the main thread did not upload, because a newer frame
+ * supersedes it or the stream stops. The caller holds the render lock. */
+static void
+vdi_stream_client__frame_video_drop(struct parsec_context_s *parsec_context)
+{
+    if (parsec_context->pending_frame != &parsec_context->pending_kept) {
+        return;
+    }
+    vdi_stream_client__parsec_ffmpeg_frame_release(
+        parsec_context->pending_frame, parsec_context->pending_image
+    );
+    parsec_context->pending_frame = NULL;
+    parsec_context->pending_image = NULL;
+}
+
+/* Parsec frame callback of the frame thread. SDL renderers and textures belong
+ * to the main thread, so the frame is handed over and the main thread woken.
+ * Descriptor-backed frames are kept past the callback, so decoding continues
+ * while the main thread presents. Raw Parsec images are only valid inside the
+ * callback, which then waits until the main thread uploaded the image or the
+ * stream stops. */
+static void
+vdi_stream_client__frame_video_handoff(const ParsecFrame *frame, const void *image, void *opaque)
+{
+    struct parsec_context_s *parsec_context = (struct parsec_context_s *)opaque;
+    SDL_Event event = { 0 };
+
+    event.type = parsec_context->frame_event;
+    SDL_LockMutex(parsec_context->render_lock);
+    vdi_stream_client__frame_video_drop(parsec_context);
+    if (!vdi_stream_client__context_connected(parsec_context) ||
+        vdi_stream_client__context_done(parsec_context)) {
+        vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
+        SDL_UnlockMutex(parsec_context->render_lock);
+        return;
+    }
+
+    if (vdi_stream_client__parsec_ffmpeg_frame_keep(
+            frame, image, parsec_context->pending_descriptor,
+            sizeof(parsec_context->pending_descriptor)
+        )) {
+        parsec_context->pending_kept = *frame;
+        parsec_context->pending_frame = &parsec_context->pending_kept;
+        parsec_context->pending_image = parsec_context->pending_descriptor;
+        SDL_PushEvent(&event);
+        SDL_UnlockMutex(parsec_context->render_lock);
+        return;
+    }
+
+    parsec_context->pending_frame = frame;
+    parsec_context->pending_image = image;
+    SDL_PushEvent(&event);
+    while (parsec_context->pending_frame != NULL &&
+           vdi_stream_client__context_connected(parsec_context) &&
+           !vdi_stream_client__context_done(parsec_context)) {
+        SDL_WaitCondition(parsec_context->frame_consumed, parsec_context->render_lock);
+    }
+
+    /* A frame left over by a stopped stream is released without upload. */
+    if (parsec_context->pending_frame != NULL) {
+        parsec_context->pending_frame = NULL;
+        parsec_context->pending_image = NULL;
+        vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
+    }
+    SDL_UnlockMutex(parsec_context->render_lock);
+}
+
 /* Render the current text overlay centered in the window. This is used while
- * connecting, reconnecting, or shutting down when no fresh video frame exists. */
+ * connecting, reconnecting, or shutting down when no fresh video frame exists.
+ * The texture is rebuilt lazily after the text surface was replaced. */
 static void
 vdi_stream_client__frame_text(void *opaque)
 {
     struct parsec_context_s *parsec_context = (struct parsec_context_s *)opaque;
     SDL_FRect dst;
 
+    if (parsec_context->texture_ttf_stale) {
+        SDL_DestroyTexture(parsec_context->texture_ttf);
+        parsec_context->texture_ttf =
+            SDL_CreateTextureFromSurface(parsec_context->renderer, parsec_context->surface_ttf);
+        if (parsec_context->texture_ttf == NULL) {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "TTF texture creation failed: %s\n", SDL_GetError()
+            );
+        }
+        parsec_context->texture_ttf_stale = false;
+    }
     if (parsec_context->texture_ttf == NULL || parsec_context->surface_ttf == NULL) {
         return;
     }
@@ -281,55 +449,108 @@ vdi_stream_client__frame_text(void *opaque)
     );
 }
 
-/* Poll one Parsec video frame, update the active frame texture, and draw it to
- * the renderer. The function returns false when nothing changed and no forced
- * redraw was requested. */
+/* Upload the frame handed over by the frame thread, if any, and draw the active
+ * frame texture to the renderer. The function returns false when nothing
+ * changed and no forced redraw was requested, or while the frame pacing
+ * scheduler holds the newest frame back for its deadline. A held frame stays
+ * updated until presented. */
 static bool
-vdi_stream_client__frame_video(void *opaque, bool force_redraw)
+vdi_stream_client__frame_video(struct parsec_context_s *parsec_context, bool force_redraw)
 {
-    struct parsec_context_s *parsec_context = (struct parsec_context_s *)opaque;
+    Sint32 width;
+    Sint32 height;
     ParsecStatus e;
     SDL_FRect src;
+    bool drawn;
 
-    if (parsec_context->requested_width != parsec_context->window_width ||
-        parsec_context->requested_height != parsec_context->window_height) {
-        e = ParsecClientSetDimensions(
-            parsec_context->parsec, DEFAULT_STREAM, parsec_context->window_width,
-            parsec_context->window_height, 1
-        );
+    SDL_LockMutex(parsec_context->render_lock);
+    width = parsec_context->window_width;
+    height = parsec_context->window_height;
+
+    /* The degradation ladder may ask the host for a smaller stream. */
+    vdi_stream_client__degrade_dimensions(parsec_context, &width, &height);
+    if (parsec_context->requested_width != width || parsec_context->requested_height != height) {
+        e = ParsecClientSetDimensions(parsec_context->parsec, DEFAULT_STREAM, width, height, 1);
         if (e != PARSEC_OK) {
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Set dimensions failed with code: %d\n", e);
         } else {
-            parsec_context->requested_width = parsec_context->window_width;
-            parsec_context->requested_height = parsec_context->window_height;
+            parsec_context->requested_width = width;
+            parsec_context->requested_height = height;
         }
     }
 
-    parsec_context->frame_video_updated = false;
-    ParsecClientPollFrame(
-        parsec_context->parsec, DEFAULT_STREAM, vdi_stream_client__frame_video_update,
-        parsec_context->render_timeout, parsec_context
-    );
+    /* A frame thread waiting on a raw image polls on once it is uploaded. */
+    if (parsec_context->pending_frame != NULL) {
+        vdi_stream_client__frame_video_update(
+            parsec_context, parsec_context->pending_frame, parsec_context->pending_image
+        );
+        parsec_context->pending_frame = NULL;
+        parsec_context->pending_image = NULL;
+        SDL_SignalCondition(parsec_context->frame_consumed);
+    }
 
-    if (!force_redraw && !parsec_context->frame_video_updated) {
+    if (!force_redraw && (!parsec_context->frame_video_updated ||
+                          !vdi_stream_client__present_due(parsec_context))) {
+        SDL_UnlockMutex(parsec_context->render_lock);
         return false;
     }
 
     SDL_SetRenderDrawColor(parsec_context->renderer, 0x00, 0x00, 0x00, 0xFF);
     SDL_RenderClear(parsec_context->renderer);
 
-    if (parsec_context->frame_video_texture == NULL) {
-        return force_redraw;
+    /* The visible frame fills the window, which keeps its size while the
+     * degradation ladder asks the host for a smaller stream. */
+    drawn = force_redraw;
+    if (parsec_context->frame_video_texture != NULL) {
+        src.x = 0.0f;
+        src.y = 0.0f;
+        src.w = parsec_context->frame_video_width;
+        src.h = parsec_context->frame_video_height;
+        vdi_stream_client__video_render_texture(
+            parsec_context, parsec_context->frame_video_texture, &src, NULL
+        );
+        drawn = true;
     }
+    SDL_UnlockMutex(parsec_context->render_lock);
+    return drawn;
+}
 
-    src.x = 0.0f;
-    src.y = 0.0f;
-    src.w = parsec_context->window_width;
-    src.h = parsec_context->window_height;
-    vdi_stream_client__video_render_texture(
-        parsec_context, parsec_context->frame_video_texture, &src, NULL
-    );
-    return true;
+/* Estimate the backing memory of one SDL texture from its format and size. YUV
+ * formats store full-resolution luma plus two quarter-resolution chroma planes. */
+static Uint64
+vdi_stream_client__video_texture_bytes(const SDL_Texture *texture)
+{
+    Uint64 width;
+    Uint64 height;
+
+    if (texture == NULL) {
+        return 0;
+    }
+
+    width = (Uint64)texture->w;
+    height = (Uint64)texture->h;
+    switch (texture->format) {
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+    case SDL_PIXELFORMAT_IYUV:
+    case SDL_PIXELFORMAT_YV12:
+        return width * height + 2u * ((width + 1u) / 2u) * ((height + 1u) / 2u);
+    default:
+        break;
+    }
+    if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        return width * height * 2u;
+    }
+    return width * height * (Uint64)SDL_BYTESPERPIXEL(texture->format);
+}
+
+/* Estimate memory held by SDL-owned textures. The libplacebo target texture is
+ * a wrapper around a Vulkan image and is accounted by the placebo module. */
+Uint64
+vdi_stream_client__video_memory(struct parsec_context_s *parsec_context)
+{
+    return vdi_stream_client__video_texture_bytes(parsec_context->texture_video) +
+           vdi_stream_client__video_texture_bytes(parsec_context->texture_ttf);
 }
 
 /* Choose SDL window creation flags required by the selected rendering path.
@@ -340,6 +561,17 @@ vdi_stream_client__video_window_flags(bool acceleration)
     return acceleration ? SDL_WINDOW_VULKAN : 0;
 }
 
+/* Query the refresh rate of the display showing the window. Zero means unknown
+ * and disables the vsync accounting of the cadence analyzer and frame pacing. */
+float
+vdi_stream_client__video_refresh_rate(struct parsec_context_s *parsec_context)
+{
+    const SDL_DisplayMode *mode;
+
+    mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(parsec_context->window));
+    return mode != NULL ? mode->refresh_rate : 0.0f;
+}
+
 /* Initialize the renderer for the already-created window. The Vulkan path tries
  * libplacebo first so VA-API frames can be sampled without CPU copies. */
 bool
@@ -374,47 +606,228 @@ vdi_stream_client__video_init(struct parsec_context_s *parsec_context, bool acce
         SDL_LOG_CATEGORY_APPLICATION, "Use %s renderer\n",
         renderer_name != NULL ? renderer_name : "unknown"
     );
-    if (!SDL_SetRenderVSync(parsec_context->renderer, 1)) {
-        SDL_LogError(
-            SDL_LOG_CATEGORY_APPLICATION, "SDL_SetRenderVSync failed: %s\n", SDL_GetError()
+
+    /* Display queries belong to the main thread, which also renders. */
+    vdi_stream_client__present_configure(parsec_context);
+    parsec_context->stats_cadence_refresh_rate =
+        vdi_stream_client__video_refresh_rate(parsec_context);
+    return true;
+}
+
+/* Account the interval between two presents of new frames. Intervals are
+ * measured in display refreshes: more than one means vsyncs without a new
+ * frame, zero means two frames landed in one vsync. Each gap is blamed on the
+ * source when the frame arrived late or on the client when the frame waited
+ * longer than a refresh and a half for its present. */
+static void
+vdi_stream_client__video_cadence_sample(struct parsec_context_s *parsec_context)
+{
+    Uint64 now_ns;
+    Uint64 last_ns;
+    Uint64 interval_ns;
+    Uint64 refresh_ns = 0;
+    Uint64 vsyncs;
+    double interval_ms;
+    double delta_ms;
+
+    if (!parsec_context->stats_enabled || !parsec_context->frame_video_updated) {
+        return;
+    }
+
+    now_ns = SDL_GetTicksNS();
+    last_ns = parsec_context->stats_cadence_present_ns;
+    parsec_context->stats_cadence_present_ns = now_ns;
+    if (last_ns == 0) {
+        return;
+    }
+
+    interval_ns = now_ns - last_ns;
+    if (interval_ns > (Uint64)PARSEC_CADENCE_IDLE_MS * 1000000u) {
+        parsec_context->stats_cadence_idle_gaps++;
+        return;
+    }
+
+    interval_ms = (double)interval_ns / 1000000.0;
+    parsec_context->stats_cadence_intervals++;
+    delta_ms = interval_ms - parsec_context->stats_cadence_mean_ms;
+    parsec_context->stats_cadence_mean_ms +=
+        delta_ms / (double)parsec_context->stats_cadence_intervals;
+    parsec_context->stats_cadence_m2 +=
+        delta_ms * (interval_ms - parsec_context->stats_cadence_mean_ms);
+    parsec_context->stats_cadence_longest_ns =
+        SDL_max(parsec_context->stats_cadence_longest_ns, interval_ns);
+
+    if (parsec_context->stats_cadence_refresh_rate > 0.0f) {
+        refresh_ns = (Uint64)(1000000000.0 / parsec_context->stats_cadence_refresh_rate);
+    }
+    if (refresh_ns == 0) {
+        return;
+    }
+
+    vsyncs = (interval_ns + refresh_ns / 2) / refresh_ns;
+    if (vsyncs == 0) {
+        parsec_context->stats_cadence_duplicated_vsyncs++;
+        return;
+    }
+    if (vsyncs == 1) {
+        return;
+    }
+    parsec_context->stats_cadence_skipped_vsyncs += vsyncs - 1;
+    if (now_ns - parsec_context->stats_cadence_arrival_ns > refresh_ns + refresh_ns / 2) {
+        parsec_context->stats_cadence_client_gaps++;
+    } else {
+        parsec_context->stats_cadence_source_gaps++;
+    }
+}
+
+/* Emit the frame cadence of the period next to the render statistics. The
+ * stutter score is the interval deviation relative to the mean in percent, so
+ * a steady 30 fps stream on a 60 Hz display scores zero despite its skipped
+ * vsyncs. */
+void
+vdi_stream_client__video_cadence_stats(struct parsec_context_s *parsec_context)
+{
+    double stddev_ms = 0.0;
+    double stutter = 0.0;
+
+    if (parsec_context->stats_cadence_intervals > 1) {
+        stddev_ms = SDL_sqrt(
+            parsec_context->stats_cadence_m2 / (double)(parsec_context->stats_cadence_intervals - 1)
         );
     }
-    return true;
+    if (parsec_context->stats_cadence_mean_ms > 0.0) {
+        stutter = stddev_ms * 100.0 / parsec_context->stats_cadence_mean_ms;
+    }
+
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Cadence:\n"
+        "  refresh: %.2fHz\n"
+        "  intervals: count=%llu, avg=%.3fms, stddev=%.3fms, longest=%.3fms\n"
+        "  vsyncs: skipped=%llu, duplicated=%llu\n"
+        "  gaps: source=%llu, client=%llu, idle=%llu\n"
+        "  stutter: score=%.1f\n",
+        parsec_context->stats_cadence_refresh_rate,
+        (unsigned long long)parsec_context->stats_cadence_intervals,
+        parsec_context->stats_cadence_mean_ms, stddev_ms,
+        (double)parsec_context->stats_cadence_longest_ns / 1000000.0,
+        (unsigned long long)parsec_context->stats_cadence_skipped_vsyncs,
+        (unsigned long long)parsec_context->stats_cadence_duplicated_vsyncs,
+        (unsigned long long)parsec_context->stats_cadence_source_gaps,
+        (unsigned long long)parsec_context->stats_cadence_client_gaps,
+        (unsigned long long)parsec_context->stats_cadence_idle_gaps, stutter
+    );
+
+    /* Pick up refresh rate changes after the window moved between displays. */
+    parsec_context->stats_cadence_refresh_rate =
+        vdi_stream_client__video_refresh_rate(parsec_context);
 }
 
-/* Render one main-thread video iteration. Connected sessions draw Parsec video;
- * disconnected sessions periodically redraw the current text overlay. */
+/* Render one video iteration on the main thread, which owns the renderer as
+ * SDL requires. Connected sessions draw Parsec video; disconnected sessions
+ * periodically redraw the current text overlay. */
 bool
-vdi_stream_client__video_render(struct parsec_context_s *parsec_context, bool force_redraw)
+vdi_stream_client__video_render(struct parsec_context_s *parsec_context)
 {
+    bool force_redraw = vdi_stream_client__context_input_force_redraw(parsec_context);
+    bool presented;
+    bool drawn = false;
 
     /* Show Parsec frame. */
     if (vdi_stream_client__context_connected(parsec_context)) {
-        if (!vdi_stream_client__frame_video(parsec_context, force_redraw)) {
+        drawn = vdi_stream_client__frame_video(parsec_context, force_redraw);
+        if (!drawn) {
             return false;
         }
-        if (!vdi_stream_client__video_present(parsec_context)) {
+        presented = vdi_stream_client__video_present(parsec_context);
+        if (!presented) {
             SDL_LogError(
                 SDL_LOG_CATEGORY_APPLICATION, "SDL_RenderPresent failed: %s\n", SDL_GetError()
             );
         }
+        SDL_LockMutex(parsec_context->render_lock);
+        if (presented) {
+            vdi_stream_client__video_cadence_sample(parsec_context);
+            vdi_stream_client__clock_present(parsec_context);
+        }
+        parsec_context->frame_video_updated = false;
+        SDL_UnlockMutex(parsec_context->render_lock);
         return true;
     }
 
     /* Show reconnecting or shutdown text if available. */
+    SDL_LockMutex(parsec_context->render_lock);
     if (parsec_context->surface_ttf != NULL &&
         (force_redraw || SDL_GetTicks() >= parsec_context->next_overlay_tick)) {
         vdi_stream_client__frame_text(parsec_context);
-        if (!vdi_stream_client__video_present(parsec_context)) {
-            SDL_LogError(
-                SDL_LOG_CATEGORY_APPLICATION, "SDL_RenderPresent failed: %s\n", SDL_GetError()
+        parsec_context->next_overlay_tick = SDL_GetTicks() + parsec_context->timeout;
+        drawn = true;
+    }
+    SDL_UnlockMutex(parsec_context->render_lock);
+    if (drawn && !vdi_stream_client__video_present(parsec_context)) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "SDL_RenderPresent failed: %s\n", SDL_GetError()
+        );
+    }
+    return drawn;
+}
+
+/* Return how long the main thread may wait for events before a handed over
+ * frame or the frame pacing scheduler needs it to present. */
+Uint32
+vdi_stream_client__video_timeout(struct parsec_context_s *parsec_context)
+{
+    Uint32 timeout;
+
+    SDL_LockMutex(parsec_context->render_lock);
+    timeout = parsec_context->pending_frame != NULL
+                  ? 0
+                  : vdi_stream_client__present_timeout(
+                        parsec_context, parsec_context->render_timeout
+                    );
+    SDL_UnlockMutex(parsec_context->render_lock);
+    return timeout;
+}
+
+/* Drop a kept frame and wake a frame thread waiting for its raw image to be
+ * uploaded after the stream stopped or the client shuts down. */
+void
+vdi_stream_client__video_wake(struct parsec_context_s *parsec_context)
+{
+    SDL_LockMutex(parsec_context->render_lock);
+    vdi_stream_client__frame_video_drop(parsec_context);
+    SDL_BroadcastCondition(parsec_context->frame_consumed);
+    SDL_UnlockMutex(parsec_context->render_lock);
+}
+
+/* Poll Parsec frames until shutdown. Decoding happens inside the frame poll, so
+ * this thread runs the decoder without ever touching the renderer: every frame
+ * is handed over to the main thread, which uploads, draws and presents it while
+ * the next one decodes. */
+Sint32
+vdi_stream_client__video_thread(void *opaque)
+{
+    struct parsec_context_s *parsec_context = (struct parsec_context_s *)opaque;
+
+    vdi_stream_client__pool_pin_render();
+    while (!vdi_stream_client__context_done(parsec_context)) {
+        if (!vdi_stream_client__context_connected(parsec_context)) {
+            SDL_Delay(parsec_context->render_timeout);
+            continue;
+        }
+
+        vdi_stream_client__context_set_render_polling(parsec_context, true);
+        if (vdi_stream_client__context_connected(parsec_context) &&
+            !vdi_stream_client__context_done(parsec_context)) {
+            ParsecClientPollFrame(
+                parsec_context->parsec, DEFAULT_STREAM, vdi_stream_client__frame_video_handoff,
+                parsec_context->render_timeout, parsec_context
             );
         }
-        parsec_context->next_overlay_tick = SDL_GetTicks() + parsec_context->timeout;
-        return true;
+        vdi_stream_client__context_set_render_polling(parsec_context, false);
     }
 
-    return false;
+    return VDI_STREAM_CLIENT_SUCCESS;
 }
 
 /* Release renderer-owned textures and the optional libplacebo Vulkan bridge.
@@ -34,7 +34,13 @@ struct parsec_context_s;
 /* video rendering. */
 SDL_WindowFlags vdi_stream_client__video_window_flags(bool acceleration);
 bool vdi_stream_client__video_init(struct parsec_context_s *parsec_context, bool acceleration);
-bool vdi_stream_client__video_render(struct parsec_context_s *parsec_context, bool force_redraw);
+float vdi_stream_client__video_refresh_rate(struct parsec_context_s *parsec_context);
+bool vdi_stream_client__video_render(struct parsec_context_s *parsec_context);
+Uint32 vdi_stream_client__video_timeout(struct parsec_context_s *parsec_context);
+void vdi_stream_client__video_wake(struct parsec_context_s *parsec_context);
+Sint32 vdi_stream_client__video_thread(void *opaque);
+Uint64 vdi_stream_client__video_memory(struct parsec_context_s *parsec_context);
+void vdi_stream_client__video_cadence_stats(struct parsec_context_s *parsec_context);
 void vdi_stream_client__video_destroy(struct parsec_context_s *parsec_context);
 
 #endif /* VDI_STREAM_CLIENT_VIDEO_H */
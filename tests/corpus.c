@@ -0,0 +1,357 @@
+/*
+ *  corpus.c -- corrupted bitstream test of the FFmpeg decoder recovery
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* internal includes. */
+#include "../src/ffmpeg.c"
+#include "stream.h"
+
+/* system includes. */
+#include <stdlib.h>
+
+/* define corrupted bitstream test parameters. */
+#define VDI_STREAM_CLIENT_TEST_CORPUS_WIDTH 320
+#define VDI_STREAM_CLIENT_TEST_CORPUS_HEIGHT 192
+#define VDI_STREAM_CLIENT_TEST_CORPUS_GOP 30
+#define VDI_STREAM_CLIENT_TEST_CORPUS_PACKET 10
+#define VDI_STREAM_CLIENT_TEST_CORPUS_GARBAGE 5
+#define VDI_STREAM_CLIENT_TEST_CORPUS_STEP_MS 100
+
+/* Ways to damage the stream, applied to one packet in the middle of the GOP
+ * or, for the keyframe case, to the IDR picture. */
+enum vdi_stream_client__test_corpus_e
+{
+    VDI_STREAM_CLIENT_TEST_CORPUS_FLIPPED,
+    VDI_STREAM_CLIENT_TEST_CORPUS_TRUNCATED,
+    VDI_STREAM_CLIENT_TEST_CORPUS_ZEROED,
+    VDI_STREAM_CLIENT_TEST_CORPUS_GARBAGE_RUN,
+    VDI_STREAM_CLIENT_TEST_CORPUS_KEYFRAME,
+    VDI_STREAM_CLIENT_TEST_CORPUS_COUNT,
+};
+
+/* Names of the corpus entries for the log. */
+static const char *const vdi_stream_client__test_corpus_names[] = {
+    "flipped bytes", "truncated packet", "zeroed payload", "garbage packets", "broken keyframe",
+};
+
+/* Decode one packet the way the SDK and the renderer drive the decoder. The
+ * status is one of the three the SDK understands, and every decoded frame must
+ * be acquirable. Returns false on any other outcome. */
+static bool
+vdi_stream_client__test_corpus_packet(
+    void *decoder, const Uint8 *data, Uint32 size, Uint8 *frame_data, Sint32 *status
+)
+{
+    const ParsecFrame *frame = (const ParsecFrame *)frame_data;
+    const void *image = frame_data + sizeof(*frame);
+    Uint32 frame_size = 0;
+
+    *status = vdi_stream_client__parsec_ffmpeg_decode(decoder, data, size, frame_data, &frame_size);
+    if (*status == DECODE_WRN_ACCEPTED || *status == DECODE_ERR_DECODE) {
+        return true;
+    }
+    if (*status != PARSEC_OK ||
+        vdi_stream_client__parsec_ffmpeg_frame_acquire(frame, image) == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unexpected decode status: %d\n", *status);
+        return false;
+    }
+    vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
+    return true;
+}
+
+/* Decode one clean pass of the stream and return the number of frames, or -1
+ * if decoding failed. */
+static Sint32
+vdi_stream_client__test_corpus_replay(
+    void *decoder, const struct vdi_stream_client__test_stream_s *stream, Uint8 *frame_data
+)
+{
+    Sint32 frames = 0;
+
+    for (Uint32 i = 0; i < stream->count; i++) {
+        Sint32 status;
+
+        if (!vdi_stream_client__test_corpus_packet(
+                decoder, stream->packets[i]->data, (Uint32)stream->packets[i]->size, frame_data,
+                &status
+            )) {
+            return -1;
+        }
+        frames += status == PARSEC_OK ? 1 : 0;
+    }
+    return frames;
+}
+
+/* Copy a packet into a padded buffer and damage it. */
+static AVPacket *
+vdi_stream_client__test_corpus_damage(
+    const AVPacket *source, enum vdi_stream_client__test_corpus_e corpus, Uint32 seed
+)
+{
+    AVPacket *packet = av_packet_alloc();
+
+    if (packet == NULL || av_new_packet(packet, source->size) < 0) {
+        av_packet_free(&packet);
+        return NULL;
+    }
+    SDL_memcpy(packet->data, source->data, (size_t)source->size);
+
+    /* The first bytes carry the start code and NAL header. */
+    switch (corpus) {
+    case VDI_STREAM_CLIENT_TEST_CORPUS_FLIPPED:
+    case VDI_STREAM_CLIENT_TEST_CORPUS_KEYFRAME:
+        for (Sint32 i = 8; i < packet->size; i += 7) {
+            packet->data[i] ^= 0x55;
+        }
+        break;
+    case VDI_STREAM_CLIENT_TEST_CORPUS_TRUNCATED:
+        packet->size = SDL_max(packet->size / 2, 1);
+        break;
+    case VDI_STREAM_CLIENT_TEST_CORPUS_ZEROED:
+        SDL_memset(packet->data + 5, 0, (size_t)SDL_max(packet->size - 5, 0));
+        break;
+    case VDI_STREAM_CLIENT_TEST_CORPUS_GARBAGE_RUN:
+        for (Sint32 i = 0; i < packet->size; i++) {
+            seed = seed * 1103515245u + 12345u;
+            packet->data[i] = (Uint8)(seed >> 16);
+        }
+        break;
+    default:
+        break;
+    }
+    return packet;
+}
+
+/* Feed the stream with one corpus entry applied, then the clean stream again.
+ * Damage to a single packet must never flush the decoder, and the clean pass
+ * must decode the frames of a fresh decoder once its IDR arrives. Garbage may
+ * leave the decoder one frame of reordering delay, which is tolerated. */
+static bool
+vdi_stream_client__test_corpus_entry(
+    const struct vdi_stream_client__test_stream_s *stream,
+    enum vdi_stream_client__test_corpus_e corpus, Sint32 reference, Uint8 *frame_data
+)
+{
+    struct vdi_stream_client__parsec_ffmpeg_stats_s stats = { 0 };
+    Uint32 first =
+        corpus == VDI_STREAM_CLIENT_TEST_CORPUS_KEYFRAME ? 0 : VDI_STREAM_CLIENT_TEST_CORPUS_PACKET;
+    Uint32 last = first + (corpus == VDI_STREAM_CLIENT_TEST_CORPUS_GARBAGE_RUN
+                               ? VDI_STREAM_CLIENT_TEST_CORPUS_GARBAGE
+                               : 1);
+    Uint8 selector = 1;
+    void *decoder = NULL;
+    Sint32 frames;
+    bool passed = false;
+
+    if (vdi_stream_client__parsec_ffmpeg_init(&decoder, NULL, 0, &selector, NULL) != PARSEC_OK) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg decoder failed to initialize\n");
+        return false;
+    }
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+
+    for (Uint32 i = 0; i < stream->count; i++) {
+        AVPacket *packet = NULL;
+        Sint32 status;
+        bool decoded;
+
+        if (i >= first && i < last) {
+            packet = vdi_stream_client__test_corpus_damage(stream->packets[i], corpus, i);
+            if (packet == NULL) {
+                goto done;
+            }
+        }
+        decoded = vdi_stream_client__test_corpus_packet(
+            decoder, packet != NULL ? packet->data : stream->packets[i]->data,
+            (Uint32)(packet != NULL ? packet->size : stream->packets[i]->size), frame_data, &status
+        );
+        av_packet_free(&packet);
+        if (!decoded) {
+            goto done;
+        }
+    }
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+    if (last - first == 1 && corpus != VDI_STREAM_CLIENT_TEST_CORPUS_KEYFRAME &&
+        stats.decode_flushes != 0) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "%s: one damaged packet flushed the decoder\n",
+            vdi_stream_client__test_corpus_names[corpus]
+        );
+        goto done;
+    }
+
+    frames = vdi_stream_client__test_corpus_replay(decoder, stream, frame_data);
+    if (frames + 1 < reference) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "%s: clean stream decoded %d of %d frames\n",
+            vdi_stream_client__test_corpus_names[corpus], frames, reference
+        );
+        goto done;
+    }
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "%s: errors=%llu, flushes=%llu, recovered %d frames\n",
+        vdi_stream_client__test_corpus_names[corpus], (unsigned long long)stats.decode_errors,
+        (unsigned long long)stats.decode_flushes, frames
+    );
+    passed = true;
+
+done:
+    vdi_stream_client__parsec_ffmpeg_cleanup(&decoder);
+    return passed;
+}
+
+/* Drive the recovery state machine directly. A failing decoder is reported
+ * without a flush, corrupt input only flushes once it repeats, and the wait
+ * for a keyframe repeats the keyframe request and gives up after its time
+ * limit. */
+static bool
+vdi_stream_client__test_corpus_recover(
+    const struct vdi_stream_client__test_stream_s *stream, Uint8 *frame_data
+)
+{
+    struct vdi_stream_client__parsec_ffmpeg_decoder_s *ffmpeg;
+    struct vdi_stream_client__parsec_ffmpeg_stats_s stats = { 0 };
+    Uint64 start_ns;
+    Uint32 reports = 0;
+    Uint32 packet = 1;
+    Uint8 selector = 1;
+    void *decoder = NULL;
+    bool passed = false;
+
+    if (vdi_stream_client__parsec_ffmpeg_init(&decoder, NULL, 0, &selector, NULL) != PARSEC_OK) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg decoder failed to initialize\n");
+        return false;
+    }
+    ffmpeg = decoder;
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+
+    if (vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, AVERROR_EXTERNAL, false) !=
+            DECODE_ERR_DECODE ||
+        ffmpeg->resync) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Decoder failure started a resync\n");
+        goto done;
+    }
+    vdi_stream_client__parsec_ffmpeg_error_clear(ffmpeg);
+
+    for (Uint32 i = 1; i < VDI_STREAM_CLIENT_PARSEC_FFMPEG_RECOVER_PACKETS; i++) {
+        (void)vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, AVERROR_INVALIDDATA, false);
+        if (ffmpeg->resync) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Corrupt packet %u started a resync\n", i);
+            goto done;
+        }
+    }
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+    if (stats.decode_flushes != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Corrupt packets flushed the decoder\n");
+        goto done;
+    }
+    (void)vdi_stream_client__parsec_ffmpeg_recover(ffmpeg, AVERROR_INVALIDDATA, false);
+    if (!ffmpeg->resync) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Repeated corrupt packets kept decoding\n");
+        goto done;
+    }
+
+    /* P pictures are dropped while waiting and the keyframe request repeats. */
+    start_ns = SDL_GetTicksNS();
+    while (ffmpeg->resync) {
+        Sint32 status;
+
+        if (SDL_GetTicksNS() - start_ns >
+            (Uint64)VDI_STREAM_CLIENT_PARSEC_FFMPEG_RESYNC_MS * 2 * 1000000) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Resync never gave up on the keyframe\n");
+            goto done;
+        }
+        if (!vdi_stream_client__test_corpus_packet(
+                decoder, stream->packets[packet]->data, (Uint32)stream->packets[packet]->size,
+                frame_data, &status
+            )) {
+            goto done;
+        }
+        reports += status == DECODE_ERR_DECODE ? 1 : 0;
+        packet = packet + 1 < stream->count ? packet + 1 : 1;
+        SDL_Delay(VDI_STREAM_CLIENT_TEST_CORPUS_STEP_MS);
+    }
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+    if (reports < 2 || stats.resync_dropped == 0) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Resync dropped %llu packets with %u keyframe requests\n",
+            (unsigned long long)stats.resync_dropped, reports
+        );
+        goto done;
+    }
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Resync dropped %llu packets with %u keyframe requests\n",
+        (unsigned long long)stats.resync_dropped, reports
+    );
+    passed = true;
+
+done:
+    vdi_stream_client__parsec_ffmpeg_cleanup(&decoder);
+    return passed;
+}
+
+/* Decode a corpus of damaged variants of a synthetic stream with the software
+ * decoder and check that it recovers from each without reinitialization. */
+int
+main(void)
+{
+    struct vdi_stream_client__test_stream_s stream = { 0 };
+    Uint8 *frame_data = SDL_malloc(VDI_STREAM_CLIENT_PARSEC_MAX_FRAME_BUFFER);
+    Uint8 selector = 1;
+    void *decoder = NULL;
+    Sint32 reference;
+    int result = EXIT_FAILURE;
+
+    if (!vdi_stream_client__test_stream_encode(
+            &stream, VDI_STREAM_CLIENT_TEST_CORPUS_WIDTH, VDI_STREAM_CLIENT_TEST_CORPUS_HEIGHT,
+            VDI_STREAM_CLIENT_TEST_CORPUS_GOP
+        )) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "No H.264 encoder available, skipping\n");
+        result = VDI_STREAM_CLIENT_TEST_SKIP;
+        goto done;
+    }
+    if (frame_data == NULL ||
+        vdi_stream_client__parsec_ffmpeg_init(&decoder, NULL, 0, &selector, NULL) != PARSEC_OK) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg decoder failed to initialize\n");
+        goto done;
+    }
+    reference = vdi_stream_client__test_corpus_replay(decoder, &stream, frame_data);
+    vdi_stream_client__parsec_ffmpeg_cleanup(&decoder);
+    if (reference <= 0) {
+        goto done;
+    }
+
+    for (Uint32 corpus = 0; corpus < VDI_STREAM_CLIENT_TEST_CORPUS_COUNT; corpus++) {
+        if (!vdi_stream_client__test_corpus_entry(
+                &stream, (enum vdi_stream_client__test_corpus_e)corpus, reference, frame_data
+            )) {
+            goto done;
+        }
+    }
+    if (!vdi_stream_client__test_corpus_recover(&stream, frame_data)) {
+        goto done;
+    }
+    result = EXIT_SUCCESS;
+
+done:
+    vdi_stream_client__test_stream_free(&stream);
+    SDL_free(frame_data);
+    return result;
+}
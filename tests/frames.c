@@ -0,0 +1,195 @@
+/*
+ *  frames.c -- frame allocation test of the FFmpeg decoder
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* internal includes. */
+#include "../src/ffmpeg.c"
+#include "stream.h"
+
+/* system includes. */
+#include <stdlib.h>
+
+/* define frame allocation test parameters. */
+#define VDI_STREAM_CLIENT_TEST_FRAMES_WIDTH 320
+#define VDI_STREAM_CLIENT_TEST_FRAMES_HEIGHT 192
+#define VDI_STREAM_CLIENT_TEST_FRAMES_GOP 30
+#define VDI_STREAM_CLIENT_TEST_FRAMES_WARMUP 2
+#define VDI_STREAM_CLIENT_TEST_FRAMES_REPLAYS 100
+
+/* Decode one pass of the stream the way the SDK and the renderer drive the
+ * decoder, taking and releasing every frame before the next packet. Returns
+ * the number of frames decoded, or -1 if decoding failed. */
+static Sint32
+vdi_stream_client__test_frames_replay(
+    void *decoder, const struct vdi_stream_client__test_stream_s *stream, Uint8 *frame_data
+)
+{
+    const ParsecFrame *frame = (const ParsecFrame *)frame_data;
+    const void *image = frame_data + sizeof(*frame);
+    Sint32 frames = 0;
+
+    for (Uint32 i = 0; i < stream->count; i++) {
+        Uint32 frame_size = 0;
+        Sint32 status = vdi_stream_client__parsec_ffmpeg_decode(
+            decoder, stream->packets[i]->data, (Uint32)stream->packets[i]->size, frame_data,
+            &frame_size
+        );
+
+        if (status == DECODE_WRN_ACCEPTED) {
+            continue;
+        }
+        if (status != PARSEC_OK ||
+            vdi_stream_client__parsec_ffmpeg_frame_acquire(frame, image) == NULL) {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "Packet %u failed to decode: %d\n", i, status
+            );
+            return -1;
+        }
+        vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
+        frames++;
+    }
+    return frames;
+}
+
+/* Tear the decoder down while the renderer holds a frame, the way a reconnect
+ * can, and require that the held frame stays retained and readable until its
+ * release drops it. */
+static bool
+vdi_stream_client__test_frames_teardown(
+    void **decoder, const struct vdi_stream_client__test_stream_s *stream, Uint8 *frame_data
+)
+{
+    const ParsecFrame *frame = (const ParsecFrame *)frame_data;
+    const void *image = frame_data + sizeof(*frame);
+    struct vdi_stream_client__parsec_ffmpeg_memory_s memory = { 0 };
+    AVFrame *av_frame = NULL;
+
+    for (Uint32 i = 0; i < stream->count && av_frame == NULL; i++) {
+        Uint32 frame_size = 0;
+
+        if (vdi_stream_client__parsec_ffmpeg_decode(
+                *decoder, stream->packets[i]->data, (Uint32)stream->packets[i]->size, frame_data,
+                &frame_size
+            ) == PARSEC_OK) {
+            av_frame = vdi_stream_client__parsec_ffmpeg_frame_acquire(frame, image);
+        }
+    }
+    if (av_frame == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No frame decoded before teardown\n");
+        return false;
+    }
+
+    vdi_stream_client__parsec_ffmpeg_cleanup(decoder);
+    vdi_stream_client__parsec_ffmpeg_memory(&memory);
+    if (memory.retained_frames != 1 || av_frame->width != VDI_STREAM_CLIENT_TEST_FRAMES_WIDTH) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Held frame lost by teardown, %llu frames retained\n",
+            (unsigned long long)memory.retained_frames
+        );
+        vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
+        return false;
+    }
+
+    vdi_stream_client__parsec_ffmpeg_frame_release(frame, image);
+    vdi_stream_client__parsec_ffmpeg_memory(&memory);
+    if (memory.retained_frames != 0) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "%llu frames retained after release\n",
+            (unsigned long long)memory.retained_frames
+        );
+        return false;
+    }
+    return true;
+}
+
+/* Warm the software decoder up on a synthetic stream, which must allocate its
+ * frame buffers through the counted pool, then replay thousands of frames and
+ * require that not a single frame buffer is allocated any more. Finally tear
+ * the decoder down under a held frame. */
+int
+main(void)
+{
+    struct vdi_stream_client__test_stream_s stream = { 0 };
+    struct vdi_stream_client__parsec_ffmpeg_stats_s stats = { 0 };
+    Uint8 *frame_data = SDL_malloc(VDI_STREAM_CLIENT_PARSEC_MAX_FRAME_BUFFER);
+    Uint8 selector = 1;
+    void *decoder = NULL;
+    Sint32 frames = 0;
+    int result = EXIT_FAILURE;
+
+    if (!vdi_stream_client__test_stream_encode(
+            &stream, VDI_STREAM_CLIENT_TEST_FRAMES_WIDTH, VDI_STREAM_CLIENT_TEST_FRAMES_HEIGHT,
+            VDI_STREAM_CLIENT_TEST_FRAMES_GOP
+        )) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "No H.264 encoder available, skipping\n");
+        result = VDI_STREAM_CLIENT_TEST_SKIP;
+        goto done;
+    }
+    if (frame_data == NULL ||
+        vdi_stream_client__parsec_ffmpeg_init(&decoder, NULL, 0, &selector, NULL) != PARSEC_OK) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FFmpeg decoder failed to initialize\n");
+        goto done;
+    }
+
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_TEST_FRAMES_WARMUP; i++) {
+        if (vdi_stream_client__test_frames_replay(decoder, &stream, frame_data) <= 0) {
+            goto done;
+        }
+    }
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+    if (stats.frame_allocations == 0) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "Warm-up allocated no frame buffers from the pool\n"
+        );
+        goto done;
+    }
+
+    for (Uint32 i = 0; i < VDI_STREAM_CLIENT_TEST_FRAMES_REPLAYS; i++) {
+        Sint32 decoded = vdi_stream_client__test_frames_replay(decoder, &stream, frame_data);
+
+        if (decoded <= 0) {
+            goto done;
+        }
+        frames += decoded;
+    }
+    vdi_stream_client__parsec_ffmpeg_drain_stats(&stats);
+    if (stats.frame_allocations != 0) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "%llu frame buffers allocated over %d replayed frames\n",
+            (unsigned long long)stats.frame_allocations, frames
+        );
+        goto done;
+    }
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "Replayed %d frames without frame buffer allocations\n",
+        frames
+    );
+    if (!vdi_stream_client__test_frames_teardown(&decoder, &stream, frame_data)) {
+        goto done;
+    }
+    result = EXIT_SUCCESS;
+
+done:
+    vdi_stream_client__parsec_ffmpeg_cleanup(&decoder);
+    vdi_stream_client__test_stream_free(&stream);
+    SDL_free(frame_data);
+    return result;
+}
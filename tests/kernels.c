@@ -0,0 +1,229 @@
+/*
+ *  kernels.c -- plane copy kernel tests
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "../src/copy.h"
+
+/* system includes. */
+#include <stdlib.h>
+
+/* define kernel test parameters. */
+#define VDI_STREAM_CLIENT_TEST_KERNELS_HEIGHT 3
+#define VDI_STREAM_CLIENT_TEST_KERNELS_WIDTH_MAX 1921
+#define VDI_STREAM_CLIENT_TEST_KERNELS_PAD_MAX 67
+#define VDI_STREAM_CLIENT_TEST_KERNELS_OFFSET_MAX 3
+#define VDI_STREAM_CLIENT_TEST_KERNELS_GUARD 128
+#define VDI_STREAM_CLIENT_TEST_KERNELS_CANARY 0xa5
+
+/* Conversions under test. The four YCbCr 4:4:4 operations cover BT.601 and
+ * BT.709 in limited and full range. */
+typedef enum
+{
+    VDI_TEST_KERNELS_PLANE,
+    VDI_TEST_KERNELS_P010,
+    VDI_TEST_KERNELS_YUV444_601,
+    VDI_TEST_KERNELS_YUV444_601_FULL,
+    VDI_TEST_KERNELS_YUV444_709,
+    VDI_TEST_KERNELS_YUV444_709_FULL,
+    VDI_TEST_KERNELS_MAX,
+} vdi_test_kernels_operation_e;
+
+/* Widths around every vector size and its tail handling, odd ones included. */
+static const Sint32 vdi_stream_client__test_kernels_widths[] = {
+    1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 129, 255, 257, 1023, 1921,
+};
+
+/* Row pitch padding beyond the row bytes, odd ones included. */
+static const Sint32 vdi_stream_client__test_kernels_pads[] = { 0, 5, 67 };
+
+/* Buffers shared by all cases. */
+struct vdi_stream_client__test_kernels_s
+{
+    Uint8 *src;
+    Uint8 *expected;
+    Uint8 *actual;
+    size_t src_size;
+    size_t dst_size;
+};
+
+/* Return the bytes per sample an operation reads and per pixel it writes. */
+static void
+vdi_stream_client__test_kernels_bytes(
+    vdi_test_kernels_operation_e operation, Sint32 *src_bytes, Sint32 *dst_bytes
+)
+{
+    *src_bytes = operation == VDI_TEST_KERNELS_P010 ? 2 : 1;
+    *dst_bytes = operation >= VDI_TEST_KERNELS_YUV444_601 ? 4 : 1;
+}
+
+/* Run one operation with the selected kernels. YCbCr planes follow each other
+ * in the source buffer with the same pitch. */
+static void
+vdi_stream_client__test_kernels_run(
+    vdi_test_kernels_operation_e operation, Uint8 *dst, Sint32 dst_pitch, const Uint8 *src,
+    Sint32 src_pitch, Sint32 width, Sint32 height
+)
+{
+    const Uint8 *const planes[3] = {
+        src,
+        src + (size_t)src_pitch * (size_t)height,
+        src + (size_t)src_pitch * (size_t)height * 2,
+    };
+    const Sint32 pitches[3] = { src_pitch, src_pitch, src_pitch };
+    Sint32 yuv444 = (Sint32)operation - VDI_TEST_KERNELS_YUV444_601;
+
+    switch (operation) {
+    case VDI_TEST_KERNELS_PLANE:
+        vdi_stream_client__copy_plane(dst, dst_pitch, src, src_pitch, width, height);
+        break;
+    case VDI_TEST_KERNELS_P010:
+        vdi_stream_client__copy_p010_nv12(dst, dst_pitch, src, src_pitch, width, height);
+        break;
+    default:
+        vdi_stream_client__copy_yuv444_xrgb(
+            dst, dst_pitch, planes, pitches, width, height, (yuv444 & 2) != 0, (yuv444 & 1) != 0
+        );
+        break;
+    }
+}
+
+/* Run one case with the scalar reference and with a kernel and compare the
+ * whole destination buffers, so writes into the pitch padding or past the last
+ * row fail as well as wrong pixels. */
+static bool
+vdi_stream_client__test_kernels_case(
+    struct vdi_stream_client__test_kernels_s *buffers, vdi_copy_kernel_e kernel,
+    vdi_test_kernels_operation_e operation, Sint32 width, Sint32 pad, Sint32 offset
+)
+{
+    Sint32 src_bytes;
+    Sint32 dst_bytes;
+    Sint32 src_pitch;
+    Sint32 dst_pitch;
+
+    vdi_stream_client__test_kernels_bytes(operation, &src_bytes, &dst_bytes);
+    src_pitch = width * src_bytes + pad;
+    dst_pitch = width * dst_bytes + pad;
+
+    SDL_memset(buffers->expected, VDI_STREAM_CLIENT_TEST_KERNELS_CANARY, buffers->dst_size);
+    SDL_memset(buffers->actual, VDI_STREAM_CLIENT_TEST_KERNELS_CANARY, buffers->dst_size);
+    vdi_stream_client__copy_select(VDI_COPY_KERNEL_SCALAR);
+    vdi_stream_client__test_kernels_run(
+        operation, buffers->expected + offset, dst_pitch, buffers->src + offset, src_pitch, width,
+        VDI_STREAM_CLIENT_TEST_KERNELS_HEIGHT
+    );
+    vdi_stream_client__copy_select(kernel);
+    vdi_stream_client__test_kernels_run(
+        operation, buffers->actual + offset, dst_pitch, buffers->src + offset, src_pitch, width,
+        VDI_STREAM_CLIENT_TEST_KERNELS_HEIGHT
+    );
+    if (SDL_memcmp(buffers->expected, buffers->actual, buffers->dst_size) == 0) {
+        return true;
+    }
+
+    SDL_LogError(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "%s kernel differs from scalar: operation=%d, width=%d, pad=%d, offset=%d\n",
+        vdi_stream_client__copy_name(kernel), (int)operation, width, pad, offset
+    );
+    return false;
+}
+
+/* Compare every kernel the CPU supports with the scalar reference on random
+ * samples, for every operation, width, pitch padding and misalignment. The
+ * stream threshold is lifted, so small planes take the kernel rows too. */
+int
+main(void)
+{
+    struct vdi_stream_client__test_kernels_s buffers = { 0 };
+    Uint32 state = 0x9e3779b9u;
+    Uint32 failures = 0;
+    Uint32 cases = 0;
+    int result = EXIT_FAILURE;
+
+    buffers.src_size = (size_t)(VDI_STREAM_CLIENT_TEST_KERNELS_WIDTH_MAX * 2 +
+                                VDI_STREAM_CLIENT_TEST_KERNELS_PAD_MAX) *
+                           VDI_STREAM_CLIENT_TEST_KERNELS_HEIGHT * 3 +
+                       VDI_STREAM_CLIENT_TEST_KERNELS_GUARD;
+    buffers.dst_size = (size_t)(VDI_STREAM_CLIENT_TEST_KERNELS_WIDTH_MAX * 4 +
+                                VDI_STREAM_CLIENT_TEST_KERNELS_PAD_MAX) *
+                           VDI_STREAM_CLIENT_TEST_KERNELS_HEIGHT +
+                       VDI_STREAM_CLIENT_TEST_KERNELS_GUARD;
+    buffers.src = SDL_malloc(buffers.src_size);
+    buffers.expected = SDL_malloc(buffers.dst_size);
+    buffers.actual = SDL_malloc(buffers.dst_size);
+    if (buffers.src == NULL || buffers.expected == NULL || buffers.actual == NULL) {
+        goto done;
+    }
+    for (size_t i = 0; i < buffers.src_size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        buffers.src[i] = (Uint8)(state >> 24);
+    }
+
+    vdi_stream_client__copy_stream_threshold(0);
+    for (Sint32 kernel = VDI_COPY_KERNEL_SCALAR + 1; kernel < VDI_COPY_KERNEL_MAX; kernel++) {
+        if (!vdi_stream_client__copy_select((vdi_copy_kernel_e)kernel)) {
+            SDL_LogInfo(
+                SDL_LOG_CATEGORY_APPLICATION, "%s kernel not supported, skipping\n",
+                vdi_stream_client__copy_name((vdi_copy_kernel_e)kernel)
+            );
+            continue;
+        }
+        for (Sint32 operation = 0; operation < VDI_TEST_KERNELS_MAX; operation++) {
+            for (size_t w = 0; w < SDL_arraysize(vdi_stream_client__test_kernels_widths); w++) {
+                for (size_t p = 0; p < SDL_arraysize(vdi_stream_client__test_kernels_pads); p++) {
+                    for (Sint32 offset = 0; offset <= VDI_STREAM_CLIENT_TEST_KERNELS_OFFSET_MAX;
+                         offset++) {
+                        if (!vdi_stream_client__test_kernels_case(
+                                &buffers, (vdi_copy_kernel_e)kernel,
+                                (vdi_test_kernels_operation_e)operation,
+                                vdi_stream_client__test_kernels_widths[w],
+                                vdi_stream_client__test_kernels_pads[p], offset
+                            )) {
+                            failures++;
+                        }
+                        cases++;
+                    }
+                }
+            }
+        }
+    }
+    SDL_LogInfo(
+        SDL_LOG_CATEGORY_APPLICATION, "%u of %u kernel cases match the scalar reference\n",
+        cases - failures, cases
+    );
+    result = failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+done:
+    vdi_stream_client__copy_destroy();
+    SDL_free(buffers.src);
+    SDL_free(buffers.expected);
+    SDL_free(buffers.actual);
+    return result;
+}
@@ -0,0 +1,150 @@
+/*
+ *  stream.c -- synthetic video streams for the tests
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/* configuration includes. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* internal includes. */
+#include "stream.h"
+
+/* ffmpeg includes. */
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+
+/* Draw synthetic frame number index: diagonal luma bars moving by two pixels
+ * per frame over flat chroma, so P pictures carry real motion. */
+static AVFrame *
+vdi_stream_client__test_stream_frame(Sint32 width, Sint32 height, Uint32 index)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (frame == NULL) {
+        return NULL;
+    }
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    for (Sint32 y = 0; y < height; y++) {
+        Uint8 *luma = frame->data[0] + (ptrdiff_t)y * frame->linesize[0];
+
+        for (Sint32 x = 0; x < width; x++) {
+            luma[x] = (((Uint32)(x + y) + index * 2) & 32) != 0 ? 200 : 40;
+        }
+    }
+    for (Sint32 y = 0; y < height / 2; y++) {
+        SDL_memset(frame->data[1] + (ptrdiff_t)y * frame->linesize[1], 128, (size_t)width / 2);
+        SDL_memset(frame->data[2] + (ptrdiff_t)y * frame->linesize[2], 128, (size_t)width / 2);
+    }
+    return frame;
+}
+
+/* Encode frames synthetic pictures into an H.264 stream with a single GOP.
+ * Fails when FFmpeg has no H.264 encoder, in which case tests are skipped. */
+bool
+vdi_stream_client__test_stream_encode(
+    struct vdi_stream_client__test_stream_s *stream, Sint32 width, Sint32 height, Uint32 frames
+)
+{
+    const AVCodec *codec = avcodec_find_encoder_by_name("libx264");
+    AVCodecContext *context = NULL;
+    AVPacket *packet = NULL;
+    bool encoded = false;
+
+    stream->count = 0;
+    if (codec == NULL) {
+        codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    }
+    if (codec == NULL || frames > VDI_STREAM_CLIENT_TEST_STREAM_PACKETS) {
+        goto done;
+    }
+    context = avcodec_alloc_context3(codec);
+    packet = av_packet_alloc();
+    if (context == NULL || packet == NULL) {
+        goto done;
+    }
+    context->width = width;
+    context->height = height;
+    context->pix_fmt = AV_PIX_FMT_YUV420P;
+    context->time_base = (AVRational){ 1, 60 };
+    context->framerate = (AVRational){ 60, 1 };
+    context->gop_size = (int)frames;
+    context->max_b_frames = 0;
+    av_opt_set(context->priv_data, "preset", "ultrafast", 0);
+    av_opt_set(context->priv_data, "tune", "zerolatency", 0);
+    if (avcodec_open2(context, codec, NULL) < 0) {
+        goto done;
+    }
+
+    /* The last pass sends no frame, which flushes the encoder. */
+    for (Uint32 i = 0; i <= frames; i++) {
+        AVFrame *frame = NULL;
+        Sint32 err;
+
+        if (i < frames) {
+            frame = vdi_stream_client__test_stream_frame(width, height, i);
+            if (frame == NULL) {
+                goto done;
+            }
+            frame->pts = i;
+        }
+        err = avcodec_send_frame(context, frame);
+        av_frame_free(&frame);
+        while (err >= 0) {
+            err = avcodec_receive_packet(context, packet);
+            if (err >= 0 && stream->count < frames) {
+                stream->packets[stream->count] = av_packet_clone(packet);
+                if (stream->packets[stream->count] == NULL) {
+                    err = AVERROR(ENOMEM);
+                } else {
+                    stream->count++;
+                }
+            }
+            av_packet_unref(packet);
+        }
+        if (err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+            goto done;
+        }
+    }
+    encoded = stream->count == frames;
+
+done:
+    av_packet_free(&packet);
+    avcodec_free_context(&context);
+    return encoded;
+}
+
+/* Free the packets of an encoded synthetic stream. */
+void
+vdi_stream_client__test_stream_free(struct vdi_stream_client__test_stream_s *stream)
+{
+    for (Uint32 i = 0; i < stream->count; i++) {
+        av_packet_free(&stream->packets[i]);
+    }
+    stream->count = 0;
+}
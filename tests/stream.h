@@ -0,0 +1,51 @@
+/*
+ *  stream.h -- synthetic video streams for the tests
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+#ifndef VDI_STREAM_CLIENT_TEST_STREAM_H
+#define VDI_STREAM_CLIENT_TEST_STREAM_H
+
+/* sdl includes. */
+#include <SDL3/SDL.h>
+
+/* ffmpeg includes. */
+#include <libavcodec/avcodec.h>
+
+/* define synthetic stream limits. */
+#define VDI_STREAM_CLIENT_TEST_STREAM_PACKETS 64
+
+/* automake exit status of a skipped test. */
+#define VDI_STREAM_CLIENT_TEST_SKIP 77
+
+/* Encoded synthetic H.264 stream: one IDR picture followed by P pictures. */
+struct vdi_stream_client__test_stream_s
+{
+    AVPacket *packets[VDI_STREAM_CLIENT_TEST_STREAM_PACKETS];
+    Uint32 count;
+};
+
+/* synthetic stream functions. */
+bool vdi_stream_client__test_stream_encode(
+    struct vdi_stream_client__test_stream_s *stream, Sint32 width, Sint32 height, Uint32 frames
+);
+void vdi_stream_client__test_stream_free(struct vdi_stream_client__test_stream_s *stream);
+
+#endif /* VDI_STREAM_CLIENT_TEST_STREAM_H */
@@ -0,0 +1,116 @@
+/*
+ *  parsec-clock-agent.c -- reference host agent for vdi-stream-client clock sync
+ *
+ *  Copyright (c) 2026 Maik Broemme <mbroemme@libmpq.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permission under GNU GPL version 3 section 7 is described in
+ *  COPYING.EXCEPTION, allowing this program to link with the Parsec SDK.
+ */
+
+/*
+ * The agent hosts a Parsec desktop session through the SDK and answers the
+ * "ping SEQUENCE T1" user-data messages of vdi-stream-client --clock-sync host
+ * with "pong SEQUENCE T1 T2 T3", where T2 and T3 are the receive and send times
+ * in the host clock. Encoders that want capture-to-present latency must stamp
+ * frames with the same clock as a user-data-unregistered SEI carrying the UUID
+ * "vdi-stream-clock" followed by the capture time as big-endian nanoseconds.
+ *
+ * Build it on the host against the Parsec SDK:
+ *
+ *   cc -std=c17 -o parsec-clock-agent parsec-clock-agent.c -lparsec
+ */
+
+/* system includes. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* parsec includes. */
+#include <parsec/parsec.h>
+
+/* define parsec messages. (must match vdi-stream-client) */
+#define PARSEC_CLOCK_MSG 0x56444343
+
+/* Read the host clock in nanoseconds. */
+static uint64_t
+parsec_clock_agent__now_ns(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Answer one clock ping from a guest. Malformed messages are ignored. */
+static void
+parsec_clock_agent__pong(Parsec *parsec, uint32_t guest_id, const char *msg, uint64_t t2)
+{
+    unsigned long long sequence;
+    unsigned long long t1;
+    char pong[128];
+
+    if (msg == NULL || sscanf(msg, "ping %llu %llu", &sequence, &t1) != 2) {
+        return;
+    }
+    snprintf(
+        pong, sizeof(pong), "pong %llu %llu %" PRIu64 " %" PRIu64, sequence, t1, t2,
+        parsec_clock_agent__now_ns()
+    );
+    ParsecHostSendUserData(parsec, guest_id, PARSEC_CLOCK_MSG, pong);
+}
+
+/* Host the session given on the command line and answer clock pings until the
+ * process is terminated. */
+int
+main(int argc, char **argv)
+{
+    ParsecHostConfig cfg = PARSEC_HOST_DEFAULTS;
+    ParsecHostEvent event;
+    ParsecStatus e;
+    Parsec *parsec = NULL;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s SESSION\n", argv[0]);
+        return 1;
+    }
+
+    e = ParsecInit(NULL, NULL, NULL, &parsec);
+    if (e != PARSEC_OK) {
+        fprintf(stderr, "Parsec initialization failed with code: %d\n", e);
+        return 1;
+    }
+    e = ParsecHostStart(parsec, HOST_DESKTOP, &cfg, argv[1]);
+    if (e != PARSEC_OK) {
+        fprintf(stderr, "Parsec host start failed with code: %d\n", e);
+        ParsecDestroy(parsec);
+        return 1;
+    }
+
+    for (;;) {
+        if (!ParsecHostPollEvents(parsec, 100, &event)) {
+            continue;
+        }
+        if (event.type == HOST_EVENT_USER_DATA && event.userData.id == PARSEC_CLOCK_MSG) {
+            uint64_t t2 = parsec_clock_agent__now_ns();
+            char *msg = ParsecGetBuffer(parsec, event.userData.key);
+
+            parsec_clock_agent__pong(parsec, event.userData.guest.id, msg, t2);
+            ParsecFree(msg);
+        }
+    }
+}